@@ -37,10 +37,14 @@
 #define MSGPACK_DISABLE_LEGACY_CONVERT
 #endif
 
+#include "wamp_bridge.hpp"
 #include "wamp_event.hpp"
 #include "wamp_invocation.hpp"
+#include "wamp_procedure_dispatcher.hpp"
+#include "wamp_resilient_session.hpp"
 #include "wamp_session.hpp"
 #include "wamp_tcp_transport.hpp"
+#include "wamp_topic_dispatcher.hpp"
 #include "wamp_transport.hpp"
 #ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
 #include "wamp_uds_transport.hpp"
@@ -8,5 +8,12 @@
 #ifndef BOOST_THREAD_PROVIDES_FUTURE_WHEN_ALL_WHEN_ANY
 #define BOOST_THREAD_PROVIDES_FUTURE_WHEN_ALL_WHEN_ANY
 #endif
+// Required for future::then(executor, ...), see wamp_io_executor.hpp.
+#ifndef BOOST_THREAD_PROVIDES_EXECUTORS
+#define BOOST_THREAD_PROVIDES_EXECUTORS
+#endif
+#ifndef BOOST_THREAD_USES_MOVE
+#define BOOST_THREAD_USES_MOVE
+#endif
 
 #include <boost/thread/future.hpp>
@@ -61,6 +61,11 @@ class protocol_error : public std::runtime_error {
      protocol_error(const std::string& message) : std::runtime_error(message) {};
 };
 
+class publish_queue_full_error : public std::runtime_error {
+  public:
+     publish_queue_full_error() : std::runtime_error("publish queue is full") {};
+};
+
 } // namespace autobahn
 
 #endif // AUTOBAHN_EXCEPTIONS_HPP
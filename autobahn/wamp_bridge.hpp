@@ -0,0 +1,298 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_BRIDGE_HPP
+#define AUTOBAHN_WAMP_BRIDGE_HPP
+
+#include "boost_config.hpp"
+#include "wamp_call_options.hpp"
+#include "wamp_call_result.hpp"
+#include "wamp_event.hpp"
+#include "wamp_invocation.hpp"
+#include "wamp_object_view.hpp"
+#include "wamp_prepared_message.hpp"
+#include "wamp_publish_options.hpp"
+#include "wamp_registration.hpp"
+#include "wamp_session.hpp"
+#include "wamp_subscribe_options.hpp"
+#include "wamp_subscription.hpp"
+
+#include <atomic>
+#include <boost/thread/future.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <msgpack.hpp>
+#include <string>
+#include <vector>
+
+namespace autobahn {
+
+/*!
+ * What a wamp_bridge has relayed since it was constructed or its
+ * statistics were reset.
+ */
+struct wamp_bridge_stats
+{
+    /// The number of events relayed.
+    std::uint64_t events;
+
+    /// The number of calls relayed and answered with a result.
+    std::uint64_t calls;
+
+    /// The number of calls relayed and answered with an error.
+    std::uint64_t failed_calls;
+
+    /// The number of argument bytes relayed, both ways for calls.
+    std::uint64_t bytes;
+
+    /// The number of events, calls and results whose arguments had to be
+    /// re-encoded because the bytes they were received as were not kept.
+    std::uint64_t reencoded;
+
+    /// The sum and the maximum of the time from an event reaching the
+    /// bridge until it was handed to the target session, or until the
+    /// target router acknowledged it for acknowledged relays.
+    std::chrono::nanoseconds event_latency;
+    std::chrono::nanoseconds max_event_latency;
+
+    /// The sum and the maximum of the time from an invocation reaching the
+    /// bridge until the result or error of the relayed call was passed back.
+    std::chrono::nanoseconds call_latency;
+    std::chrono::nanoseconds max_call_latency;
+
+    /// The time over which the statistics were taken.
+    std::chrono::nanoseconds elapsed;
+
+    /// The mean event latency.
+    std::chrono::nanoseconds mean_event_latency() const;
+
+    /// The mean call latency, of calls answered with a result or an error.
+    std::chrono::nanoseconds mean_call_latency() const;
+
+    /// The events relayed per second.
+    double events_per_second() const;
+
+    /// The argument bytes relayed per second.
+    double bytes_per_second() const;
+};
+
+/*!
+ * Relays events, and optionally calls, from one session to another, e.g.
+ * from an edge router to a core router.
+ *
+ * Arguments are passed on in the msgpack encoding they were received in,
+ * with wamp_session::publish_raw(), wamp_session::call_raw() and
+ * wamp_invocation_impl::result_raw(), rather than being decoded and
+ * re-encoded. The bridge tells both sessions to keep the encoded arguments
+ * of what they receive, see wamp_session::set_keep_raw_arguments(); anything
+ * received before is re-encoded from its decoded arguments.
+ *
+ * Example:
+ * ```
+ * auto bridge = std::make_shared<autobahn::wamp_bridge>(edge, core);
+ * autobahn::wamp_subscribe_options prefix("prefix");
+ * bridge->relay_events("com.edge.", "com.core.", prefix);  // com.edge.tick -> com.core.tick
+ * bridge->relay_calls("com.edge.status", "com.core.status");
+ * ```
+ *
+ * The subscriptions and registrations hold on to the bridge weakly: once
+ * the bridge is gone, events are dropped and calls answered with an error.
+ * Its statistics can be read from any thread.
+ */
+class wamp_bridge :
+    public std::enable_shared_from_this<wamp_bridge>
+{
+public:
+    /*!
+     * Constructs a bridge between two sessions.
+     *
+     * @param source The session events are relayed from.
+     * @param target The session events are relayed to.
+     */
+    wamp_bridge(
+            const std::shared_ptr<wamp_session>& source,
+            const std::shared_ptr<wamp_session>& target);
+
+    wamp_bridge(const wamp_bridge&) = delete;
+    wamp_bridge& operator=(const wamp_bridge&) = delete;
+
+    const std::shared_ptr<wamp_session>& source() const;
+    const std::shared_ptr<wamp_session>& target() const;
+
+    /*!
+     * Relays the events of @p topic on the source session as events of
+     * @p target_topic on the target session.
+     *
+     * With a prefix subscription, the part of the topic of each event that
+     * follows @p topic is appended to @p target_topic, so that relaying
+     * "com.edge." to "com.core." relays "com.edge.tick" to "com.core.tick".
+     * With a wildcard subscription, the empty components of @p target_topic
+     * take the components of the topic of each event that the empty
+     * components of @p topic matched, in order, so that relaying
+     * "com.edge..tick" to "com.core..tick" relays "com.edge.hall.tick" to
+     * "com.core.hall.tick". Events of any other subscription are relayed
+     * to @p target_topic as it is.
+     *
+     * @param topic The topic to subscribe to on the source session.
+     * @param target_topic The topic to publish to on the target session.
+     * @param options The options to subscribe with.
+     * @param publish_options The options to publish with.
+     * @return A future that resolves to the subscription on the source session.
+     * @throw std::invalid_argument if @p target_topic of a wildcard relay has
+     *        more empty components than @p topic.
+     */
+    boost::future<wamp_subscription> relay_events(
+            const std::string& topic,
+            const std::string& target_topic,
+            const wamp_subscribe_options& options = wamp_subscribe_options(),
+            const wamp_publish_options& publish_options = wamp_publish_options());
+
+    /*!
+     * Registers @p procedure on the source session and relays its
+     * invocations as calls of @p target_procedure on the target session.
+     * The result or error of each call is passed back as the reply to the
+     * invocation. Progressive results are not relayed.
+     *
+     * @param procedure The procedure to register on the source session.
+     * @param target_procedure The procedure to call on the target session.
+     * @param options The options to call with.
+     * @return A future that resolves to the registration on the source session.
+     */
+    boost::future<wamp_registration> relay_calls(
+            const std::string& procedure,
+            const std::string& target_procedure,
+            const wamp_call_options& options = wamp_call_options());
+
+    /*!
+     * As relay_calls(), the other way round: registers @p procedure on the
+     * target session and relays its invocations as calls of
+     * @p source_procedure on the source session.
+     */
+    boost::future<wamp_registration> relay_calls_back(
+            const std::string& procedure,
+            const std::string& source_procedure,
+            const wamp_call_options& options = wamp_call_options());
+
+    /*!
+     * What the bridge has relayed so far.
+     */
+    wamp_bridge_stats stats() const;
+
+    /*!
+     * Starts taking the statistics anew.
+     */
+    void reset_stats();
+
+private:
+    struct event_relay
+    {
+        std::string topic;
+        std::string target_topic;
+        bool prefix;
+
+        // For wildcard relays to a target topic with empty components, the
+        // indexes of the empty components of the topic, whose values fill
+        // those of the target topic in order.
+        std::vector<std::size_t> wildcards;
+
+        wamp_publish_options options;
+
+        // Packed once for relays to a single target topic, nullptr otherwise.
+        std::unique_ptr<wamp_prepared_publication> prepared;
+    };
+
+    struct call_relay
+    {
+        std::weak_ptr<wamp_session> callee;
+        wamp_prepared_call prepared;
+    };
+
+    using clock = std::chrono::steady_clock;
+
+    boost::future<wamp_registration> relay_calls(
+            const std::shared_ptr<wamp_session>& caller,
+            const std::shared_ptr<wamp_session>& callee,
+            const std::string& procedure,
+            const std::string& target_procedure,
+            const wamp_call_options& options);
+
+    void relay_event(const event_relay& relay, const wamp_event& event);
+    void relay_invocation(const std::shared_ptr<call_relay>& relay, const wamp_invocation& invocation);
+
+    /*!
+     * The encoded positional or keyword arguments of an event, call result
+     * or invocation: the bytes they were received as, or if those were not
+     * kept, the decoded arguments packed into @p buffer.
+     */
+    template <typename Received>
+    wamp_bytes_view encoded_arguments(const Received& received, msgpack::sbuffer& buffer);
+
+    template <typename Received>
+    wamp_bytes_view encoded_kw_arguments(const Received& received, msgpack::sbuffer& buffer);
+
+    /*!
+     * The indexes of the empty components of a topic.
+     */
+    static std::vector<std::size_t> empty_components(const std::string& topic);
+
+    /*!
+     * The target topic of a wildcard relay for an event of the given topic.
+     */
+    static std::string fill_wildcards(const event_relay& relay, const std::string& topic);
+
+    void record_event(clock::time_point start, std::size_t bytes);
+    void record_call(clock::time_point start, std::size_t bytes, bool failed);
+    static void record_max(std::atomic<std::int64_t>& max, std::int64_t value);
+
+    std::shared_ptr<wamp_session> m_source;
+    std::shared_ptr<wamp_session> m_target;
+
+    std::atomic<std::uint64_t> m_events;
+    std::atomic<std::uint64_t> m_calls;
+    std::atomic<std::uint64_t> m_failed_calls;
+    std::atomic<std::uint64_t> m_bytes;
+    std::atomic<std::uint64_t> m_reencoded;
+
+    // Latencies in nanoseconds.
+    std::atomic<std::int64_t> m_event_latency;
+    std::atomic<std::int64_t> m_max_event_latency;
+    std::atomic<std::int64_t> m_call_latency;
+    std::atomic<std::int64_t> m_max_call_latency;
+
+    // When the statistics were last reset, in nanoseconds of the steady clock.
+    std::atomic<std::int64_t> m_stats_start;
+};
+
+} // namespace autobahn
+
+#include "wamp_bridge.ipp"
+
+#endif // AUTOBAHN_WAMP_BRIDGE_HPP
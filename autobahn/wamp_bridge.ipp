@@ -0,0 +1,428 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "wamp_arguments.hpp"
+#include "wamp_error.hpp"
+
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace autobahn {
+
+inline std::chrono::nanoseconds wamp_bridge_stats::mean_event_latency() const
+{
+    return events ? event_latency / static_cast<std::int64_t>(events) : std::chrono::nanoseconds(0);
+}
+
+inline std::chrono::nanoseconds wamp_bridge_stats::mean_call_latency() const
+{
+    std::uint64_t answered = calls + failed_calls;
+    return answered ? call_latency / static_cast<std::int64_t>(answered) : std::chrono::nanoseconds(0);
+}
+
+inline double wamp_bridge_stats::events_per_second() const
+{
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0 ? events / seconds : 0;
+}
+
+inline double wamp_bridge_stats::bytes_per_second() const
+{
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0 ? bytes / seconds : 0;
+}
+
+inline wamp_bridge::wamp_bridge(
+        const std::shared_ptr<wamp_session>& source,
+        const std::shared_ptr<wamp_session>& target)
+    : m_source(source)
+    , m_target(target)
+    , m_events(0)
+    , m_calls(0)
+    , m_failed_calls(0)
+    , m_bytes(0)
+    , m_reencoded(0)
+    , m_event_latency(0)
+    , m_max_event_latency(0)
+    , m_call_latency(0)
+    , m_max_call_latency(0)
+    , m_stats_start(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            clock::now().time_since_epoch()).count())
+{
+    // Events and invocations come in on the source, call results on either.
+    m_source->set_keep_raw_arguments(true);
+    m_target->set_keep_raw_arguments(true);
+}
+
+inline const std::shared_ptr<wamp_session>& wamp_bridge::source() const
+{
+    return m_source;
+}
+
+inline const std::shared_ptr<wamp_session>& wamp_bridge::target() const
+{
+    return m_target;
+}
+
+inline boost::future<wamp_subscription> wamp_bridge::relay_events(
+        const std::string& topic,
+        const std::string& target_topic,
+        const wamp_subscribe_options& options,
+        const wamp_publish_options& publish_options)
+{
+    auto relay = std::make_shared<event_relay>();
+    relay->topic = topic;
+    relay->target_topic = target_topic;
+    relay->prefix = options.is_match_set() && options.match() == "prefix";
+    if (options.is_match_set() && options.match() == "wildcard") {
+        std::size_t target_wildcards = empty_components(target_topic).size();
+        if (target_wildcards) {
+            relay->wildcards = empty_components(topic);
+            if (relay->wildcards.size() < target_wildcards) {
+                throw std::invalid_argument("target topic " + target_topic
+                        + " has more empty components than " + topic);
+            }
+        }
+    }
+    relay->options = publish_options;
+    if (!relay->prefix && relay->wildcards.empty()) {
+        relay->prepared.reset(new wamp_prepared_publication(target_topic, publish_options));
+    }
+
+    std::weak_ptr<wamp_bridge> weak_self = this->shared_from_this();
+    return m_source->subscribe(topic, [weak_self, relay](const wamp_event& event) {
+        auto shared_self = weak_self.lock();
+        if (shared_self) {
+            shared_self->relay_event(*relay, event);
+        }
+    }, options);
+}
+
+inline boost::future<wamp_registration> wamp_bridge::relay_calls(
+        const std::string& procedure,
+        const std::string& target_procedure,
+        const wamp_call_options& options)
+{
+    return relay_calls(m_source, m_target, procedure, target_procedure, options);
+}
+
+inline boost::future<wamp_registration> wamp_bridge::relay_calls_back(
+        const std::string& procedure,
+        const std::string& source_procedure,
+        const wamp_call_options& options)
+{
+    return relay_calls(m_target, m_source, procedure, source_procedure, options);
+}
+
+inline wamp_bridge_stats wamp_bridge::stats() const
+{
+    wamp_bridge_stats stats;
+    stats.events = m_events.load();
+    stats.calls = m_calls.load();
+    stats.failed_calls = m_failed_calls.load();
+    stats.bytes = m_bytes.load();
+    stats.reencoded = m_reencoded.load();
+    stats.event_latency = std::chrono::nanoseconds(m_event_latency.load());
+    stats.max_event_latency = std::chrono::nanoseconds(m_max_event_latency.load());
+    stats.call_latency = std::chrono::nanoseconds(m_call_latency.load());
+    stats.max_call_latency = std::chrono::nanoseconds(m_max_call_latency.load());
+    stats.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            clock::now().time_since_epoch()) - std::chrono::nanoseconds(m_stats_start.load());
+
+    return stats;
+}
+
+inline void wamp_bridge::reset_stats()
+{
+    m_events = 0;
+    m_calls = 0;
+    m_failed_calls = 0;
+    m_bytes = 0;
+    m_reencoded = 0;
+    m_event_latency = 0;
+    m_max_event_latency = 0;
+    m_call_latency = 0;
+    m_max_call_latency = 0;
+    m_stats_start = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            clock::now().time_since_epoch()).count();
+}
+
+inline boost::future<wamp_registration> wamp_bridge::relay_calls(
+        const std::shared_ptr<wamp_session>& caller,
+        const std::shared_ptr<wamp_session>& callee,
+        const std::string& procedure,
+        const std::string& target_procedure,
+        const wamp_call_options& options)
+{
+    // The callee is held weakly, as the caller keeps the procedure.
+    auto relay = std::make_shared<call_relay>(
+            call_relay{ callee, wamp_prepared_call(target_procedure, options) });
+
+    std::weak_ptr<wamp_bridge> weak_self = this->shared_from_this();
+    return caller->provide(procedure, [weak_self, relay](const wamp_invocation& invocation) {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            invocation->error("wamp.error.canceled");
+            return;
+        }
+        shared_self->relay_invocation(relay, invocation);
+    });
+}
+
+inline void wamp_bridge::relay_event(const event_relay& relay, const wamp_event& event)
+{
+    clock::time_point start = clock::now();
+
+    msgpack::sbuffer arguments_buffer(0);
+    msgpack::sbuffer kw_arguments_buffer(0);
+    wamp_bytes_view arguments = encoded_arguments(event, arguments_buffer);
+    wamp_bytes_view kw_arguments = encoded_kw_arguments(event, kw_arguments_buffer);
+    std::size_t bytes = arguments.size() + kw_arguments.size();
+
+    boost::future<wamp_publication> publication;
+    if (relay.prepared) {
+        publication = m_target->publish_raw(*relay.prepared, arguments, kw_arguments);
+    } else if (relay.prefix) {
+        std::string topic = relay.target_topic;
+        if (event.uri().compare(0, relay.topic.size(), relay.topic) == 0) {
+            topic.append(event.uri(), relay.topic.size(), std::string::npos);
+        }
+        publication = m_target->publish_raw(topic, arguments, kw_arguments, relay.options);
+    } else {
+        publication = m_target->publish_raw(fill_wildcards(relay, event.uri()),
+                arguments, kw_arguments, relay.options);
+    }
+
+    if (!relay.options.acknowledge()) {
+        record_event(start, bytes);
+        return;
+    }
+
+    std::weak_ptr<wamp_bridge> weak_self = this->shared_from_this();
+    publication.then([weak_self, start, bytes](boost::future<wamp_publication> published) {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+        try {
+            published.get();
+            shared_self->record_event(start, bytes);
+        } catch (const std::exception&) {
+            // Not relayed: the target router rejected the publication.
+        }
+    });
+}
+
+inline void wamp_bridge::relay_invocation(
+        const std::shared_ptr<call_relay>& relay, const wamp_invocation& invocation)
+{
+    clock::time_point start = clock::now();
+
+    auto callee = relay->callee.lock();
+    if (!callee) {
+        invocation->error("wamp.error.canceled");
+        return;
+    }
+
+    msgpack::sbuffer arguments_buffer(0);
+    msgpack::sbuffer kw_arguments_buffer(0);
+    wamp_bytes_view arguments = encoded_arguments(*invocation, arguments_buffer);
+    wamp_bytes_view kw_arguments = encoded_kw_arguments(*invocation, kw_arguments_buffer);
+    std::size_t bytes = arguments.size() + kw_arguments.size();
+
+    std::weak_ptr<wamp_bridge> weak_self = this->shared_from_this();
+    callee->call_raw(relay->prepared, arguments, kw_arguments).then(
+            [weak_self, invocation, start, bytes](boost::future<wamp_call_result> called) {
+        auto shared_self = weak_self.lock();
+        bool failed = false;
+        std::size_t result_bytes = 0;
+
+        // The reply goes back through the session that made the invocation.
+        try {
+            wamp_call_result result = called.get();
+            if (shared_self) {
+                msgpack::sbuffer arguments_buffer(0);
+                msgpack::sbuffer kw_arguments_buffer(0);
+                wamp_bytes_view arguments = shared_self->encoded_arguments(result, arguments_buffer);
+                wamp_bytes_view kw_arguments = shared_self->encoded_kw_arguments(result, kw_arguments_buffer);
+                result_bytes = arguments.size() + kw_arguments.size();
+                invocation->result_raw(arguments, kw_arguments);
+            } else {
+                invocation->error("wamp.error.canceled");
+            }
+        } catch (const wamp_error& e) {
+            failed = true;
+            if (invocation->sendable()) {
+                invocation->error(e.uri(), e.args<wamp_arguments>(), e.kw_args<wamp_kw_arguments>());
+            }
+        } catch (const std::exception& e) {
+            failed = true;
+            if (invocation->sendable()) {
+                std::map<std::string, std::string> error_kw_arguments;
+                error_kw_arguments["what"] = e.what();
+                invocation->error("wamp.error.runtime_error", EMPTY_ARGUMENTS, error_kw_arguments);
+            }
+        }
+
+        if (shared_self) {
+            shared_self->record_call(start, bytes + result_bytes, failed);
+        }
+    });
+}
+
+template <typename Received>
+inline wamp_bytes_view wamp_bridge::encoded_arguments(const Received& received, msgpack::sbuffer& buffer)
+{
+    wamp_bytes_view raw = received.raw_arguments();
+    if (!raw.empty() || received.number_of_arguments() == 0) {
+        return raw;
+    }
+
+    ++m_reencoded;
+    wamp_array_view arguments = received.arguments_view();
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(arguments.size());
+    for (const msgpack::object& argument : arguments) {
+        packer.pack(argument);
+    }
+
+    return wamp_bytes_view(buffer.data(), buffer.size());
+}
+
+template <typename Received>
+inline wamp_bytes_view wamp_bridge::encoded_kw_arguments(const Received& received, msgpack::sbuffer& buffer)
+{
+    wamp_bytes_view raw = received.raw_kw_arguments();
+    if (!raw.empty() || received.number_of_kw_arguments() == 0) {
+        return raw;
+    }
+
+    ++m_reencoded;
+    wamp_map_view kw_arguments = received.kw_arguments_view();
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_map(kw_arguments.size());
+    for (const msgpack::object_kv& kw_argument : kw_arguments) {
+        packer.pack(kw_argument.key);
+        packer.pack(kw_argument.val);
+    }
+
+    return wamp_bytes_view(buffer.data(), buffer.size());
+}
+
+inline void wamp_bridge::record_event(clock::time_point start, std::size_t bytes)
+{
+    std::int64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+
+    ++m_events;
+    m_bytes += bytes;
+    m_event_latency += latency;
+    record_max(m_max_event_latency, latency);
+}
+
+inline void wamp_bridge::record_call(clock::time_point start, std::size_t bytes, bool failed)
+{
+    std::int64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+
+    if (failed) {
+        ++m_failed_calls;
+    } else {
+        ++m_calls;
+    }
+    m_bytes += bytes;
+    m_call_latency += latency;
+    record_max(m_max_call_latency, latency);
+}
+
+inline std::vector<std::size_t> wamp_bridge::empty_components(const std::string& topic)
+{
+    std::vector<std::size_t> indexes;
+    std::size_t index = 0;
+    std::size_t start = 0;
+    while (true) {
+        std::size_t dot = topic.find('.', start);
+        std::size_t end = dot == std::string::npos ? topic.size() : dot;
+        if (end == start) {
+            indexes.push_back(index);
+        }
+        if (dot == std::string::npos) {
+            return indexes;
+        }
+        ++index;
+        start = dot + 1;
+    }
+}
+
+inline std::string wamp_bridge::fill_wildcards(const event_relay& relay, const std::string& topic)
+{
+    // The start and end of each component of the topic of the event.
+    std::vector<std::pair<std::size_t, std::size_t>> components;
+    std::size_t start = 0;
+    while (true) {
+        std::size_t dot = topic.find('.', start);
+        components.emplace_back(start, dot == std::string::npos ? topic.size() : dot);
+        if (dot == std::string::npos) {
+            break;
+        }
+        start = dot + 1;
+    }
+
+    std::string target_topic;
+    target_topic.reserve(relay.target_topic.size() + topic.size());
+    std::size_t next_wildcard = 0;
+    start = 0;
+    while (true) {
+        std::size_t dot = relay.target_topic.find('.', start);
+        std::size_t end = dot == std::string::npos ? relay.target_topic.size() : dot;
+        if (end == start) {
+            std::size_t index = relay.wildcards[next_wildcard++];
+            if (index < components.size()) {
+                target_topic.append(topic, components[index].first,
+                        components[index].second - components[index].first);
+            }
+        } else {
+            target_topic.append(relay.target_topic, start, end - start);
+        }
+        if (dot == std::string::npos) {
+            return target_topic;
+        }
+        target_topic.push_back('.');
+        start = dot + 1;
+    }
+}
+
+inline void wamp_bridge::record_max(std::atomic<std::int64_t>& max, std::int64_t value)
+{
+    std::int64_t current = max;
+    while (value > current && !max.compare_exchange_weak(current, value)) {
+    }
+}
+
+} // namespace autobahn
@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_BUFFER_POOL_HPP
+#define AUTOBAHN_WAMP_BUFFER_POOL_HPP
+
+#include <cstddef>
+#include <msgpack.hpp>
+#include <mutex>
+#include <vector>
+
+namespace autobahn {
+
+/*!
+ * A free list of buffers for packing outgoing messages into.
+ *
+ * Messages that are packed straight into a buffer take one from the pool,
+ * and the session hands it back once the transport has written it, so
+ * that a steady stream of messages reuses the same few buffers rather
+ * than allocating and growing a new one for each. The pool is safe to
+ * use from any thread.
+ */
+class wamp_buffer_pool
+{
+public:
+    /*!
+     * Constructs a pool.
+     *
+     * \param max_buffers The number of idle buffers kept at most.
+     * \param buffer_size The initial size of newly created buffers.
+     * \param max_buffer_size Buffers that have grown larger are freed rather
+     *        than kept, so one huge message does not pin its memory.
+     */
+    explicit wamp_buffer_pool(
+            std::size_t max_buffers = 32,
+            std::size_t buffer_size = 1024,
+            std::size_t max_buffer_size = 64 * 1024);
+
+    wamp_buffer_pool(const wamp_buffer_pool&) = delete;
+    wamp_buffer_pool& operator=(const wamp_buffer_pool&) = delete;
+
+    /*!
+     * Takes an empty buffer from the pool, or creates one if there is none.
+     */
+    msgpack::sbuffer acquire();
+
+    /*!
+     * Hands a buffer back to the pool. Its content is discarded.
+     */
+    void release(msgpack::sbuffer&& buffer);
+
+    /*!
+     * Changes the limits of the pool, see the constructor.
+     */
+    void set_limits(std::size_t max_buffers, std::size_t buffer_size, std::size_t max_buffer_size);
+
+    /*!
+     * The number of idle buffers in the pool.
+     */
+    std::size_t size() const;
+
+    /*!
+     * The number of buffers the pool had to create as it was empty.
+     */
+    std::size_t created() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<msgpack::sbuffer> m_buffers;
+    std::size_t m_max_buffers;
+    std::size_t m_buffer_size;
+    std::size_t m_max_buffer_size;
+    std::size_t m_created;
+};
+
+} // namespace autobahn
+
+#include "wamp_buffer_pool.ipp"
+
+#endif // AUTOBAHN_WAMP_BUFFER_POOL_HPP
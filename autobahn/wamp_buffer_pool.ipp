@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <utility>
+
+namespace autobahn {
+
+inline wamp_buffer_pool::wamp_buffer_pool(
+        std::size_t max_buffers, std::size_t buffer_size, std::size_t max_buffer_size)
+    : m_mutex()
+    , m_buffers()
+    , m_max_buffers(max_buffers)
+    , m_buffer_size(buffer_size)
+    , m_max_buffer_size(max_buffer_size)
+    , m_created(0)
+{
+    // Reserved up front so that releasing a buffer never allocates.
+    m_buffers.reserve(m_max_buffers);
+}
+
+inline msgpack::sbuffer wamp_buffer_pool::acquire()
+{
+    std::size_t buffer_size;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_buffers.empty()) {
+            msgpack::sbuffer buffer(std::move(m_buffers.back()));
+            m_buffers.pop_back();
+            return buffer;
+        }
+
+        ++m_created;
+        buffer_size = m_buffer_size;
+    }
+
+    return msgpack::sbuffer(buffer_size);
+}
+
+inline void wamp_buffer_pool::release(msgpack::sbuffer&& buffer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_buffers.size() < m_max_buffers && buffer.size() <= m_max_buffer_size) {
+        buffer.clear();
+        m_buffers.push_back(std::move(buffer));
+    }
+}
+
+inline void wamp_buffer_pool::set_limits(
+        std::size_t max_buffers, std::size_t buffer_size, std::size_t max_buffer_size)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_max_buffers = max_buffers;
+    m_buffer_size = buffer_size;
+    m_max_buffer_size = max_buffer_size;
+
+    if (m_buffers.size() > m_max_buffers) {
+        m_buffers.erase(m_buffers.begin() + m_max_buffers, m_buffers.end());
+    }
+    m_buffers.reserve(m_max_buffers);
+}
+
+inline std::size_t wamp_buffer_pool::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_buffers.size();
+}
+
+inline std::size_t wamp_buffer_pool::created() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_created;
+}
+
+} // namespace autobahn
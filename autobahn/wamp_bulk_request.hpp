@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_BULK_REQUEST_HPP
+#define AUTOBAHN_WAMP_BULK_REQUEST_HPP
+
+#include "boost_config.hpp"
+
+#include <boost/optional.hpp>
+#include <boost/thread/future.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace autobahn {
+
+/*!
+ * The outcome of one item of a bulk request, e.g. of a single subscription
+ * made with wamp_session::subscribe_many().
+ */
+template <typename T>
+class wamp_bulk_item
+{
+public:
+    wamp_bulk_item();
+
+    /*!
+     * Whether the router accepted the item.
+     */
+    bool succeeded() const;
+
+    /*!
+     * The result of the item, e.g. the subscription.
+     *
+     * @throw std::logic_error if the item did not succeed.
+     */
+    const T& value() const;
+
+    /*!
+     * The error URI the router rejected the item with, or an empty string.
+     */
+    const std::string& error_uri() const;
+
+    void set_value(const T& value);
+    void set_error_uri(const std::string& error_uri);
+
+private:
+    boost::optional<T> m_value;
+    std::string m_error_uri;
+};
+
+/*!
+ * An outstanding bulk request covering a contiguous range of request ids,
+ * one per item. The response is satisfied once every item has either been
+ * acknowledged or rejected.
+ */
+template <typename T, typename Handler>
+class wamp_bulk_request
+{
+public:
+    wamp_bulk_request(uint64_t first_request_id, std::vector<Handler>&& handlers);
+
+    uint64_t first_request_id() const;
+    std::size_t size() const;
+    bool contains(uint64_t request_id) const;
+
+    const Handler& handler(uint64_t request_id) const;
+    boost::promise<std::vector<wamp_bulk_item<T>>>& response();
+
+    /*!
+     * Records the outcome of one item. Ignored once the response is set.
+     *
+     * @return Whether that was the last outstanding item.
+     */
+    bool set_value(uint64_t request_id, const T& value);
+    bool set_error_uri(uint64_t request_id, const std::string& error_uri);
+
+    /*!
+     * Fails the whole request, unless its response is already set.
+     */
+    template <typename E>
+    void set_exception(const E& error);
+
+    /*!
+     * Whether the response is set, by the last item or by set_exception().
+     */
+    bool done() const;
+
+private:
+    bool item_done();
+
+    uint64_t m_first_request_id;
+    std::vector<Handler> m_handlers;
+    std::vector<wamp_bulk_item<T>> m_items;
+    std::size_t m_outstanding;
+    bool m_done;
+    boost::promise<std::vector<wamp_bulk_item<T>>> m_response;
+};
+
+} // namespace autobahn
+
+#include "wamp_bulk_request.ipp"
+
+#endif // AUTOBAHN_WAMP_BULK_REQUEST_HPP
@@ -0,0 +1,167 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdexcept>
+#include <utility>
+
+namespace autobahn {
+
+template <typename T>
+inline wamp_bulk_item<T>::wamp_bulk_item()
+    : m_value()
+    , m_error_uri()
+{
+}
+
+template <typename T>
+inline bool wamp_bulk_item<T>::succeeded() const
+{
+    return static_cast<bool>(m_value);
+}
+
+template <typename T>
+inline const T& wamp_bulk_item<T>::value() const
+{
+    if (!m_value) {
+        throw std::logic_error("bulk item failed: " + m_error_uri);
+    }
+    return *m_value;
+}
+
+template <typename T>
+inline const std::string& wamp_bulk_item<T>::error_uri() const
+{
+    return m_error_uri;
+}
+
+template <typename T>
+inline void wamp_bulk_item<T>::set_value(const T& value)
+{
+    m_value = value;
+}
+
+template <typename T>
+inline void wamp_bulk_item<T>::set_error_uri(const std::string& error_uri)
+{
+    m_error_uri = error_uri;
+}
+
+template <typename T, typename Handler>
+inline wamp_bulk_request<T, Handler>::wamp_bulk_request(
+        uint64_t first_request_id, std::vector<Handler>&& handlers)
+    : m_first_request_id(first_request_id)
+    , m_handlers(std::move(handlers))
+    , m_items(m_handlers.size())
+    , m_outstanding(m_handlers.size())
+    , m_done(false)
+    , m_response()
+{
+}
+
+template <typename T, typename Handler>
+inline uint64_t wamp_bulk_request<T, Handler>::first_request_id() const
+{
+    return m_first_request_id;
+}
+
+template <typename T, typename Handler>
+inline std::size_t wamp_bulk_request<T, Handler>::size() const
+{
+    return m_handlers.size();
+}
+
+template <typename T, typename Handler>
+inline bool wamp_bulk_request<T, Handler>::contains(uint64_t request_id) const
+{
+    return request_id >= m_first_request_id && request_id - m_first_request_id < m_handlers.size();
+}
+
+template <typename T, typename Handler>
+inline const Handler& wamp_bulk_request<T, Handler>::handler(uint64_t request_id) const
+{
+    return m_handlers[request_id - m_first_request_id];
+}
+
+template <typename T, typename Handler>
+inline boost::promise<std::vector<wamp_bulk_item<T>>>& wamp_bulk_request<T, Handler>::response()
+{
+    return m_response;
+}
+
+template <typename T, typename Handler>
+inline bool wamp_bulk_request<T, Handler>::set_value(uint64_t request_id, const T& value)
+{
+    if (m_done) {
+        return false;
+    }
+    m_items[request_id - m_first_request_id].set_value(value);
+    return item_done();
+}
+
+template <typename T, typename Handler>
+inline bool wamp_bulk_request<T, Handler>::set_error_uri(uint64_t request_id, const std::string& error_uri)
+{
+    if (m_done) {
+        return false;
+    }
+    m_items[request_id - m_first_request_id].set_error_uri(error_uri);
+    return item_done();
+}
+
+template <typename T, typename Handler>
+inline bool wamp_bulk_request<T, Handler>::item_done()
+{
+    if (--m_outstanding > 0) {
+        return false;
+    }
+
+    m_done = true;
+    m_response.set_value(std::move(m_items));
+    return true;
+}
+
+template <typename T, typename Handler>
+template <typename E>
+inline void wamp_bulk_request<T, Handler>::set_exception(const E& error)
+{
+    if (m_done) {
+        return;
+    }
+    m_done = true;
+    m_response.set_exception(error);
+}
+
+template <typename T, typename Handler>
+inline bool wamp_bulk_request<T, Handler>::done() const
+{
+    return m_done;
+}
+
+} // namespace autobahn
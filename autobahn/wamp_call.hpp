@@ -36,6 +36,7 @@
 
 #include <boost/thread/future.hpp>
 
+#include <functional>
 #include <msgpack.hpp>
 
 namespace autobahn {
@@ -44,13 +45,23 @@ namespace autobahn {
 class wamp_call
 {
 public:
+    using progress_handler = std::function<void(wamp_call_result&&)>;
+
     wamp_call();
 
     boost::promise<wamp_call_result>& result();
     void set_result(wamp_call_result&& value);
 
+    /*!
+     * Sets the handler that progressive results of the call are passed
+     * to; without one they are dropped.
+     */
+    void set_progress_handler(progress_handler&& handler);
+    void set_progress(wamp_call_result&& value);
+
 private:
     boost::promise<wamp_call_result> m_result;
+    progress_handler m_progress_handler;
 };
 
 } // namespace autobahn
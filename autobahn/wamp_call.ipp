@@ -32,6 +32,7 @@ namespace autobahn {
 
 inline wamp_call::wamp_call()
     : m_result()
+    , m_progress_handler()
 {
 }
 
@@ -45,4 +46,16 @@ inline void wamp_call::set_result(wamp_call_result&& value)
     m_result.set_value(std::move(value));
 }
 
+inline void wamp_call::set_progress_handler(progress_handler&& handler)
+{
+    m_progress_handler = std::move(handler);
+}
+
+inline void wamp_call::set_progress(wamp_call_result&& value)
+{
+    if (m_progress_handler) {
+        m_progress_handler(std::move(value));
+    }
+}
+
 } // namespace autobahn
@@ -31,6 +31,8 @@
 #ifndef AUTOBAHN_WAMP_CALL_OPTIONS_HPP
 #define AUTOBAHN_WAMP_CALL_OPTIONS_HPP
 
+#include "wamp_payload.hpp"
+
 #include <chrono>
 
 namespace autobahn {
@@ -49,8 +51,24 @@ public:
 
     void set_timeout(const std::chrono::milliseconds& timeout);
 
+    /*!
+     * Whether the callee may send progressive results before the final
+     * one, see wamp_session::call_streamed().
+     */
+    bool receive_progress() const;
+    void set_receive_progress(bool receive_progress);
+
+    /*!
+     * The payload transparency options sent with an opaque payload, see
+     * wamp_session::call_payload().
+     */
+    const wamp_payload_options& payload_options() const;
+    void set_payload_options(const wamp_payload_options& payload_options);
+
 private:
     std::chrono::milliseconds m_timeout;
+    bool m_receive_progress;
+    wamp_payload_options m_payload_options;
 };
 
 } // namespace autobahn
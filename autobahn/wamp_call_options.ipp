@@ -28,6 +28,7 @@
 //
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <cstring>
 #include <msgpack.hpp>
 #include <string>
 #include <unordered_map>
@@ -36,6 +37,8 @@ namespace autobahn {
 
 inline wamp_call_options::wamp_call_options()
     : m_timeout()
+    , m_receive_progress(false)
+    , m_payload_options()
 {
 }
 
@@ -49,6 +52,26 @@ inline void wamp_call_options::set_timeout(const std::chrono::milliseconds& time
     m_timeout = timeout;
 }
 
+inline bool wamp_call_options::receive_progress() const
+{
+    return m_receive_progress;
+}
+
+inline void wamp_call_options::set_receive_progress(bool receive_progress)
+{
+    m_receive_progress = receive_progress;
+}
+
+inline const wamp_payload_options& wamp_call_options::payload_options() const
+{
+    return m_payload_options;
+}
+
+inline void wamp_call_options::set_payload_options(const wamp_payload_options& payload_options)
+{
+    m_payload_options = payload_options;
+}
+
 } // namespace autobahn
 
 namespace msgpack {
@@ -65,11 +88,20 @@ struct convert<autobahn::wamp_call_options>
         std::unordered_map<std::string, msgpack::object> options_map;
         object >> options_map;
 
-        const auto options_map_itr = options_map.find("timeout");
+        auto options_map_itr = options_map.find("timeout");
         if (options_map_itr != options_map.end()) {
             options.set_timeout(std::chrono::milliseconds(options_map_itr->second.as<unsigned>()));
         }
 
+        options_map_itr = options_map.find("receive_progress");
+        if (options_map_itr != options_map.end()) {
+            options.set_receive_progress(options_map_itr->second.as<bool>());
+        }
+
+        autobahn::wamp_payload_options payload_options;
+        payload_options.read(object);
+        options.set_payload_options(payload_options);
+
         return object;
     }
 };
@@ -82,16 +114,33 @@ struct pack<autobahn::wamp_call_options>
             msgpack::packer<Stream>& packer,
             autobahn::wamp_call_options const& options) const
     {
-        std::unordered_map<std::string, unsigned> options_map;
+        // Packed entry by entry, as the values differ in type.
         const auto& timeout = options.timeout();
+        uint32_t size = (timeout.count() > 0 ? 1 : 0)
+                + (options.receive_progress() ? 1 : 0)
+                + options.payload_options().size();
+        packer.pack_map(size);
+
         if (timeout.count() > 0) {
-            options_map["timeout"] = timeout.count();
+            pack_key(packer, "timeout");
+            packer.pack(static_cast<unsigned>(timeout.count()));
         }
-
-        packer.pack(options_map);
+        if (options.receive_progress()) {
+            pack_key(packer, "receive_progress");
+            packer.pack_true();
+        }
+        options.payload_options().pack_entries(packer);
 
         return packer;
     }
+
+    template <typename Stream>
+    static void pack_key(msgpack::packer<Stream>& packer, const char* key)
+    {
+        uint32_t size = static_cast<uint32_t>(std::strlen(key));
+        packer.pack_str(size);
+        packer.pack_str_body(key, size);
+    }
 };
 
 template <>
@@ -107,6 +156,10 @@ struct object_with_zone<autobahn::wamp_call_options>
         if (timeout.count() != 0) {
             options_map["timeout"] = msgpack::object(timeout.count());
         }
+        if (options.receive_progress()) {
+            options_map["receive_progress"] = msgpack::object(true);
+        }
+        options.payload_options().insert_entries(options_map, object.zone);
 
         object << options_map;
     }
@@ -31,6 +31,11 @@
 #ifndef AUTOBAHN_WAMP_CALL_RESULT_HPP
 #define AUTOBAHN_WAMP_CALL_RESULT_HPP
 
+#include "wamp_object_view.hpp"
+#include "wamp_payload.hpp"
+#include "wamp_zone_pool.hpp"
+
+#include <memory>
 #include <msgpack.hpp>
 #include <string>
 
@@ -42,12 +47,20 @@ public:
     wamp_call_result();
     wamp_call_result(msgpack::zone&& zone);
 
+    /*!
+     * Constructs a result whose zone is handed back to @p zone_pool when
+     * the result is destroyed.
+     */
+    wamp_call_result(msgpack::zone&& zone, const std::shared_ptr<wamp_zone_pool>& zone_pool);
+
     wamp_call_result(const wamp_call_result& other) = delete;
     wamp_call_result(wamp_call_result&& other);
 
     wamp_call_result& operator=(const wamp_call_result& other) = delete;
     wamp_call_result& operator=(wamp_call_result&& other);
 
+    ~wamp_call_result();
+
     /*!
      * The number of positional arguments returned from the call.
      */
@@ -119,11 +132,10 @@ public:
      *
      * Overloads are provided for `std::string` and `char*` as @p key type.
      *
-     * This function uses key string comparisons to find the matching value, O(n) with n being
-     * the number of map elements. Memory allocation for keys is avoided though. For larger maps,
-     * you might want to prioritize look-up performance by using `std::map`, `std::unordered_map`
-     * or custom types with custom deserialization. To do this, use kw_arguments<Map>() or
-     * get_kw_arguments<Map>(map), then access the items from there.
+     * Small maps are searched with key string comparisons, O(n) with n being the number of map
+     * elements, without allocating. For maps with at least wamp_map_index::MIN_INDEXED_SIZE
+     * elements a hash index over the keys is built on the first look-up, so that every further
+     * look-up is O(1).
      *
      * Example:
      * `std::string id = result.kw_argument<std::string>("id");`
@@ -143,11 +155,10 @@ public:
      *
      * Overloads are provided for `std::string` and `char*` as @p key type.
      *
-     * This function uses key string comparisons to find the matching value, O(n) with n being
-     * the number of map elements. Memory allocation for keys is avoided though. For larger maps,
-     * you might want to prioritize look-up performance by using `std::map`, `std::unordered_map`
-     * or custom types with custom deserialization. To do this, use kw_arguments<Map>() or
-     * get_kw_arguments<Map>(map), then access the items from there.
+     * Small maps are searched with key string comparisons, O(n) with n being the number of map
+     * elements, without allocating. For maps with at least wamp_map_index::MIN_INDEXED_SIZE
+     * elements a hash index over the keys is built on the first look-up, so that every further
+     * look-up is O(1).
      *
      * Example:
      * `std::string id = result.kw_argument_or("id", std::string());`
@@ -185,16 +196,107 @@ public:
     template <typename Map>
     void get_kw_arguments(Map& kw_args) const;
 
+    /*!
+     * Non-owning view of the positional arguments returned from the call.
+     *
+     * The view, and any string or byte view taken from its elements, points
+     * into the call result and is only valid as long as the call result lives.
+     *
+     * Example:
+     * `for (const msgpack::object& argument : result.arguments_view()) { ... }`
+     */
+    wamp_array_view arguments_view() const;
+
+    /*!
+     * Non-owning view of the keyword arguments returned from the call.
+     *
+     * The view is only valid as long as the call result lives.
+     */
+    wamp_map_view kw_arguments_view() const;
+
+    /*!
+     * Non-owning view of the positional argument returned from the call with the given @p index,
+     * without copying it out of the call result. View is one of wamp_string_view,
+     * wamp_bytes_view, wamp_array_view or wamp_map_view.
+     *
+     * Example:
+     * `wamp_string_view id = result.argument_view<wamp_string_view>(0);`
+     *
+     * @throw std::out_of_range
+     * @throw std::bad_cast
+     */
+    template <typename View>
+    View argument_view(std::size_t index) const;
+
+    /*!
+     * Non-owning view of the keyword argument returned from the call with the given @p key.
+     * See argument_view().
+     *
+     * Example:
+     * `wamp_string_view id = result.kw_argument_view<wamp_string_view>("id");`
+     *
+     * @throw std::out_of_range if there is no keyword argument with the given @p key.
+     * @throw msgpack::type_error if no keyword arguments were received, or if
+     *        the value cannot be viewed as a View.
+     */
+    template <typename View>
+    View kw_argument_view(wamp_string_view key) const;
+
+    /*!
+     * The positional arguments returned from the call, still msgpack-encoded as they
+     * were received, e.g. to be passed on with wamp_session::call_raw() or
+     * wamp_session::publish_raw() without decoding and re-encoding them.
+     *
+     * The bytes are only kept if the session was told to, see
+     * wamp_session::set_keep_raw_arguments(), and only for messages from
+     * the router; otherwise, and if there are no positional arguments, the
+     * view is empty. It is only valid as long
+     * as the result lives.
+     */
+    wamp_bytes_view raw_arguments() const;
+
+    /*!
+     * The keyword arguments returned from the call, still msgpack-encoded as they were
+     * received. See raw_arguments().
+     */
+    wamp_bytes_view raw_kw_arguments() const;
+
+    /*!
+     * The payload transparency options the result was returned with, see
+     * payload(); not set unless it carries an opaque payload.
+     */
+    const wamp_payload_options& payload_options() const;
+
+    /*!
+     * The opaque application payload returned from the call, with
+     * wamp_invocation_impl::result_payload(): the bytes of its only positional
+     * argument, a binary, as they were sent. Only the message around the
+     * payload is unpacked; the payload itself is not decoded, and the view
+     * points into the received message, so it is only valid as long as the
+     * result lives.
+     *
+     * @throw std::bad_cast if there is no opaque payload.
+     */
+    wamp_bytes_view payload() const;
+
     //
     // functions only called internally by wamp_session
 
     void set_arguments(const msgpack::object& arguments);
     void set_kw_arguments(const msgpack::object& kw_arguments);
+    void set_raw_arguments(const wamp_bytes_view& raw_arguments);
+    void set_raw_kw_arguments(const wamp_bytes_view& raw_kw_arguments);
+    void set_details(const msgpack::object& details);
 
 private:
     msgpack::zone m_zone;
+    std::shared_ptr<wamp_zone_pool> m_zone_pool;
     msgpack::object m_arguments;
     msgpack::object m_kw_arguments;
+    wamp_bytes_view m_raw_arguments;
+    wamp_bytes_view m_raw_kw_arguments;
+    wamp_map_index m_kw_index;
+    wamp_payload_options m_payload_options;
 };
 
 } // namespace autobahn
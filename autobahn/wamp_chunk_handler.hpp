@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_CHUNK_HANDLER_HPP
+#define AUTOBAHN_WAMP_CHUNK_HANDLER_HPP
+
+#include "wamp_object_view.hpp"
+
+#include <cstddef>
+#include <functional>
+
+namespace autobahn {
+
+/// The chunk size of wamp_invocation_impl::result_chunked() unless given.
+static const std::size_t DEFAULT_CHUNK_SIZE = 1024 * 1024;
+
+/// The largest result wamp_invocation_impl::result_chunked() sends whole to a
+/// caller that did not ask for progressive results, the largest message a
+/// WAMP RawSocket transport can carry.
+static const std::size_t MAX_UNCHUNKED_RESULT_SIZE = 16 * 1024 * 1024;
+
+/// Source of a result sent in chunks with wamp_invocation_impl::result_chunked().
+/// Called on the session's io thread, it writes the next bytes of the result
+/// to @p data, at most @p size of them, and returns how many it wrote, or 0
+/// once the result is complete.
+typedef std::function<std::size_t(char* data, std::size_t size)> wamp_chunk_source;
+
+/// Handler type for use with wamp_session::call_streamed(), called on the
+/// session's io thread with each chunk of the result as it arrives.
+typedef std::function<void(const wamp_bytes_view& chunk)> wamp_chunk_handler;
+
+} // namespace autobahn
+
+#endif // AUTOBAHN_WAMP_CHUNK_HANDLER_HPP
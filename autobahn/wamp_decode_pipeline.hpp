@@ -0,0 +1,210 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_DECODE_PIPELINE_HPP
+#define AUTOBAHN_WAMP_DECODE_PIPELINE_HPP
+
+#include "boost_config.hpp"
+#include "wamp_message.hpp"
+#include "wamp_zone_pool.hpp"
+
+#include <boost/asio/io_service.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace autobahn {
+
+/*!
+ * Decodes inbound messages for a transport, handing large ones to a
+ * separate io service so that the io thread keeps reading while they are
+ * decoded.
+ *
+ * The transport frames each message and pushes it on the io thread.
+ * Messages smaller than the threshold are decoded right away; larger ones
+ * are decoded on the decode service, which may be run by any number of
+ * threads. Decoded messages are passed to the message handler on the io
+ * thread. A message waits for messages received before it only if they
+ * belong to the same subscription (EVENT), the same call (RESULT and
+ * ERROR) or the same registration (INVOCATION), so that the order within
+ * each of these is kept while small messages overtake large ones of
+ * others. All other messages, e.g. SUBSCRIBED or GOODBYE, wait for every
+ * message before them and hold back every message after them.
+ *
+ * A message that fails to decode is passed to the error handler instead,
+ * once it would have been passed on, and every message still in the
+ * pipeline is dropped with it.
+ *
+ * Apart from decode(), the pipeline must only be used on the io thread.
+ */
+class wamp_decode_pipeline :
+        public std::enable_shared_from_this<wamp_decode_pipeline>
+{
+public:
+    using message_handler = std::function<void(wamp_message&&)>;
+    using error_handler = std::function<void(std::exception_ptr)>;
+
+    /*!
+     * Constructs a pipeline.
+     *
+     * \param io_service The io service of the transport, which messages are handed over on.
+     * \param decode_service The io service to decode large messages on.
+     * \param threshold The size in bytes from which messages are decoded on the decode service.
+     */
+    wamp_decode_pipeline(
+            boost::asio::io_service& io_service,
+            boost::asio::io_service& decode_service,
+            std::size_t threshold);
+
+    wamp_decode_pipeline(const wamp_decode_pipeline&) = delete;
+    wamp_decode_pipeline& operator=(const wamp_decode_pipeline&) = delete;
+
+    /*!
+     * The size in bytes from which messages are decoded on the decode service.
+     */
+    std::size_t threshold() const;
+
+    /*!
+     * Sets the handler that decoded messages are passed to.
+     */
+    void set_message_handler(message_handler&& handler);
+
+    /*!
+     * Sets the handler that the errors of messages that failed to decode
+     * are passed to, on the io thread. Without one, such messages are
+     * dropped silently.
+     */
+    void set_error_handler(error_handler&& handler);
+
+    /*!
+     * Sets the pool that messages are unpacked into, or nullptr for none.
+     */
+    void set_zone_pool(const std::shared_ptr<wamp_zone_pool>& zone_pool);
+
+    /*!
+     * Sets whether messages keep the bytes of their fields as received,
+     * see decode().
+     */
+    void set_keep_raw_fields(bool keep_raw_fields);
+
+    /*!
+     * Decodes a message below the threshold on the calling io thread. The
+     * data only needs to be valid for the duration of the call.
+     */
+    void push(const char* data, std::size_t length);
+
+    /*!
+     * Decodes a large message on the decode service.
+     */
+    void push(const std::shared_ptr<std::vector<char>>& frame);
+
+    /*!
+     * Drops all messages that have not been passed on yet, e.g. because
+     * the transport lost its connection.
+     */
+    void clear();
+
+    /*!
+     * The number of messages received but not passed on yet.
+     */
+    std::size_t pending() const;
+
+    /*!
+     * Unpacks a serialized message, into a zone from the given pool if any.
+     *
+     * With @p keep_raw_fields set, the message is copied into its zone and
+     * unpacked field by field, so that wamp_message::raw_field() returns the
+     * bytes each field was received as. Strings and binaries then point into
+     * that copy rather than being copied once more.
+     */
+    static wamp_message decode(const char* data, std::size_t length,
+            const std::shared_ptr<wamp_zone_pool>& zone_pool, bool keep_raw_fields = false);
+
+private:
+    /*!
+     * What a message has to stay in order with: the messages of the same
+     * kind and id, or every message if it is a barrier.
+     */
+    struct ordering
+    {
+        bool barrier;
+        std::uint64_t kind;
+        std::uint64_t id;
+    };
+
+    struct entry
+    {
+        std::uint64_t sequence;
+        ordering order;
+        bool ready;
+        wamp_message message;
+        std::exception_ptr error;
+    };
+
+    static wamp_message decode_raw_fields(const char* data, std::size_t length, msgpack::zone&& zone);
+    static bool reference_frame(msgpack::type::object_type type, std::size_t length, void* user_data);
+
+    static ordering peek(const char* data, std::size_t length);
+    static bool peek_array_size(const unsigned char*& data, const unsigned char* end, std::uint64_t& size);
+    static bool peek_uint(const unsigned char*& data, const unsigned char* end, std::uint64_t& value);
+    static bool conflicts(const ordering& earlier, const ordering& later);
+
+    void decoded(std::uint64_t generation, std::uint64_t sequence,
+            wamp_message&& message, std::exception_ptr error);
+    void flush();
+    void fail(std::exception_ptr error);
+
+    boost::asio::io_service& m_io_service;
+    boost::asio::io_service& m_decode_service;
+    std::size_t m_threshold;
+    message_handler m_handler;
+    error_handler m_error_handler;
+    std::shared_ptr<wamp_zone_pool> m_zone_pool;
+    bool m_keep_raw_fields;
+
+    // Messages received but not passed on yet, in the order received.
+    std::deque<entry> m_entries;
+
+    // The sequence number of the next message received.
+    std::uint64_t m_sequence;
+
+    // Bumped by clear(), so that decodes still running are dropped.
+    std::uint64_t m_generation;
+};
+
+} // namespace autobahn
+
+#include "wamp_decode_pipeline.ipp"
+
+#endif // AUTOBAHN_WAMP_DECODE_PIPELINE_HPP
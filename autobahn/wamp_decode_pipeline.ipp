@@ -0,0 +1,405 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "exceptions.hpp"
+#include "wamp_message_type.hpp"
+
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace autobahn {
+
+inline wamp_decode_pipeline::wamp_decode_pipeline(
+        boost::asio::io_service& io_service,
+        boost::asio::io_service& decode_service,
+        std::size_t threshold)
+    : m_io_service(io_service)
+    , m_decode_service(decode_service)
+    , m_threshold(threshold)
+    , m_handler()
+    , m_error_handler()
+    , m_zone_pool()
+    , m_keep_raw_fields(false)
+    , m_entries()
+    , m_sequence(0)
+    , m_generation(0)
+{
+}
+
+inline std::size_t wamp_decode_pipeline::threshold() const
+{
+    return m_threshold;
+}
+
+inline void wamp_decode_pipeline::set_message_handler(message_handler&& handler)
+{
+    m_handler = std::move(handler);
+}
+
+inline void wamp_decode_pipeline::set_error_handler(error_handler&& handler)
+{
+    m_error_handler = std::move(handler);
+}
+
+inline void wamp_decode_pipeline::set_zone_pool(const std::shared_ptr<wamp_zone_pool>& zone_pool)
+{
+    m_zone_pool = zone_pool;
+}
+
+inline void wamp_decode_pipeline::set_keep_raw_fields(bool keep_raw_fields)
+{
+    m_keep_raw_fields = keep_raw_fields;
+}
+
+inline void wamp_decode_pipeline::push(const char* data, std::size_t length)
+{
+    // Without anything to wait for, the message is passed on right away.
+    if (m_entries.empty()) {
+        wamp_message message(0);
+        try {
+            message = decode(data, length, m_zone_pool, m_keep_raw_fields);
+        } catch (...) {
+            fail(std::current_exception());
+            return;
+        }
+        if (m_handler) {
+            m_handler(std::move(message));
+        }
+        return;
+    }
+
+    entry decoded_entry = { m_sequence++, peek(data, length), true, wamp_message(0), nullptr };
+    try {
+        decoded_entry.message = decode(data, length, m_zone_pool, m_keep_raw_fields);
+    } catch (...) {
+        decoded_entry.error = std::current_exception();
+    }
+    m_entries.push_back(std::move(decoded_entry));
+
+    flush();
+}
+
+inline void wamp_decode_pipeline::push(const std::shared_ptr<std::vector<char>>& frame)
+{
+    std::uint64_t sequence = m_sequence++;
+    std::uint64_t generation = m_generation;
+    entry pending_entry = { sequence, peek(frame->data(), frame->size()), false, wamp_message(0), nullptr };
+    m_entries.push_back(std::move(pending_entry));
+
+    auto weak_self = std::weak_ptr<wamp_decode_pipeline>(this->shared_from_this());
+    auto zone_pool = m_zone_pool;
+    bool keep_raw_fields = m_keep_raw_fields;
+
+    m_decode_service.post([weak_self, frame, zone_pool, keep_raw_fields, generation, sequence]() {
+        auto message = std::make_shared<wamp_message>(0);
+        std::exception_ptr error;
+        try {
+            *message = decode(frame->data(), frame->size(), zone_pool, keep_raw_fields);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        shared_self->m_io_service.post([weak_self, generation, sequence, message, error]() {
+            auto shared_self = weak_self.lock();
+            if (!shared_self) {
+                return;
+            }
+            shared_self->decoded(generation, sequence, std::move(*message), error);
+        });
+    });
+}
+
+inline void wamp_decode_pipeline::clear()
+{
+    m_entries.clear();
+    ++m_generation;
+}
+
+inline std::size_t wamp_decode_pipeline::pending() const
+{
+    return m_entries.size();
+}
+
+inline wamp_message wamp_decode_pipeline::decode(const char* data, std::size_t length,
+        const std::shared_ptr<wamp_zone_pool>& zone_pool, bool keep_raw_fields)
+{
+    if (keep_raw_fields) {
+        return decode_raw_fields(data, length, zone_pool ? zone_pool->acquire() : msgpack::zone());
+    }
+
+    wamp_message::message_fields fields;
+
+    if (zone_pool) {
+        msgpack::zone zone = zone_pool->acquire();
+        std::size_t offset = 0;
+        msgpack::object object = msgpack::unpack(zone, data, length, offset);
+        object.convert(fields);
+
+        return wamp_message(std::move(fields), std::move(zone));
+    }
+
+    msgpack::unpacked result = msgpack::unpack(data, length);
+    result.get().convert(fields);
+
+    return wamp_message(std::move(fields), std::move(*(result.zone())));
+}
+
+inline wamp_message wamp_decode_pipeline::decode_raw_fields(
+        const char* data, std::size_t length, msgpack::zone&& zone)
+{
+    // The frame is copied into the zone, where the views of the fields and
+    // the strings and binaries referencing it live as long as the fields.
+    char* frame = static_cast<char*>(zone.allocate_no_align(length));
+    std::memcpy(frame, data, length);
+
+    const unsigned char* position = reinterpret_cast<const unsigned char*>(frame);
+    std::uint64_t size = 0;
+    if (!peek_array_size(position, position + length, size) || size > length) {
+        throw protocol_error("message must be an array");
+    }
+    std::size_t offset = position - reinterpret_cast<const unsigned char*>(frame);
+
+    wamp_message::message_fields fields;
+    fields.reserve(size);
+    wamp_bytes_view* raw_fields = static_cast<wamp_bytes_view*>(
+            zone.allocate_align(size * sizeof(wamp_bytes_view)));
+    for (std::size_t index = 0; index < size; ++index) {
+        std::size_t start = offset;
+        fields.push_back(msgpack::unpack(zone, frame, length, offset, &reference_frame));
+        new (raw_fields + index) wamp_bytes_view(frame + start, offset - start);
+    }
+
+    wamp_message message(std::move(fields), std::move(zone));
+    message.set_raw_fields(raw_fields);
+
+    return message;
+}
+
+inline bool wamp_decode_pipeline::reference_frame(
+        msgpack::type::object_type /* type */, std::size_t /* length */, void* /* user_data */)
+{
+    return true;
+}
+
+inline wamp_decode_pipeline::ordering wamp_decode_pipeline::peek(const char* data, std::size_t length)
+{
+    const ordering barrier = { true, 0, 0 };
+
+    const unsigned char* position = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = position + length;
+    std::uint64_t size = 0;
+    std::uint64_t type = 0;
+    if (!peek_array_size(position, end, size) || size < 3 || !peek_uint(position, end, type)) {
+        return barrier;
+    }
+
+    std::uint64_t id = 0;
+    switch (static_cast<message_type>(type)) {
+        case message_type::EVENT:
+            // [EVENT, SUBSCRIBED.Subscription|id, ...]
+            if (peek_uint(position, end, id)) {
+                return ordering{ false, type, id };
+            }
+            break;
+        case message_type::RESULT:
+            // [RESULT, CALL.Request|id, ...]
+            if (peek_uint(position, end, id)) {
+                return ordering{ false, static_cast<std::uint64_t>(message_type::CALL), id };
+            }
+            break;
+        case message_type::ERROR: {
+            // [ERROR, REQUEST.Type|int, REQUEST.Request|id, ...], only errors
+            // of calls are kept in order with their results.
+            std::uint64_t request_type = 0;
+            if (peek_uint(position, end, request_type)
+                    && request_type == static_cast<std::uint64_t>(message_type::CALL)
+                    && peek_uint(position, end, id)) {
+                return ordering{ false, request_type, id };
+            }
+            break;
+        }
+        case message_type::INVOCATION: {
+            // [INVOCATION, Request|id, REGISTERED.Registration|id, ...]
+            std::uint64_t request_id = 0;
+            if (peek_uint(position, end, request_id) && peek_uint(position, end, id)) {
+                return ordering{ false, type, id };
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    return barrier;
+}
+
+inline bool wamp_decode_pipeline::peek_array_size(
+        const unsigned char*& data, const unsigned char* end, std::uint64_t& size)
+{
+    if (data == end) {
+        return false;
+    }
+
+    unsigned char format = *data++;
+    std::size_t length = 0;
+    if ((format & 0xf0) == 0x90) {
+        size = format & 0x0f;
+        return true;
+    } else if (format == 0xdc) {
+        length = 2;
+    } else if (format == 0xdd) {
+        length = 4;
+    } else {
+        return false;
+    }
+
+    if (static_cast<std::size_t>(end - data) < length) {
+        return false;
+    }
+    size = 0;
+    for (std::size_t i = 0; i < length; ++i) {
+        size = (size << 8) | data[i];
+    }
+    data += length;
+
+    return true;
+}
+
+inline bool wamp_decode_pipeline::peek_uint(
+        const unsigned char*& data, const unsigned char* end, std::uint64_t& value)
+{
+    if (data == end) {
+        return false;
+    }
+
+    unsigned char format = *data++;
+    std::size_t length = 0;
+    if (format <= 0x7f) {
+        value = format;
+        return true;
+    } else if (format == 0xcc) {
+        length = 1;
+    } else if (format == 0xcd) {
+        length = 2;
+    } else if (format == 0xce) {
+        length = 4;
+    } else if (format == 0xcf) {
+        length = 8;
+    } else {
+        return false;
+    }
+
+    if (static_cast<std::size_t>(end - data) < length) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t i = 0; i < length; ++i) {
+        value = (value << 8) | data[i];
+    }
+    data += length;
+
+    return true;
+}
+
+inline bool wamp_decode_pipeline::conflicts(const ordering& earlier, const ordering& later)
+{
+    return earlier.barrier || later.barrier
+            || (earlier.kind == later.kind && earlier.id == later.id);
+}
+
+inline void wamp_decode_pipeline::decoded(std::uint64_t generation, std::uint64_t sequence,
+        wamp_message&& message, std::exception_ptr error)
+{
+    if (generation != m_generation) {
+        return;
+    }
+
+    for (auto& pending_entry : m_entries) {
+        if (pending_entry.sequence == sequence) {
+            pending_entry.message = std::move(message);
+            pending_entry.error = error;
+            pending_entry.ready = true;
+            break;
+        }
+    }
+
+    flush();
+}
+
+inline void wamp_decode_pipeline::flush()
+{
+    std::uint64_t generation = m_generation;
+
+    std::size_t index = 0;
+    while (index < m_entries.size()) {
+        const entry& candidate = m_entries[index];
+        bool blocked = !candidate.ready;
+        for (std::size_t earlier = 0; !blocked && earlier < index; ++earlier) {
+            blocked = conflicts(m_entries[earlier].order, candidate.order);
+        }
+        if (blocked) {
+            ++index;
+            continue;
+        }
+
+        // Taken out before it is passed on, as the handler may clear the pipeline.
+        wamp_message message = std::move(m_entries[index].message);
+        std::exception_ptr error = m_entries[index].error;
+        m_entries.erase(m_entries.begin() + index);
+
+        if (error) {
+            fail(error);
+            return;
+        }
+        if (m_handler) {
+            m_handler(std::move(message));
+        }
+        if (generation != m_generation) {
+            return;
+        }
+    }
+}
+
+inline void wamp_decode_pipeline::fail(std::exception_ptr error)
+{
+    // The stream cannot be trusted past a message that failed to decode.
+    clear();
+    if (m_error_handler) {
+        m_error_handler(error);
+    }
+}
+
+} // namespace autobahn
@@ -30,17 +30,80 @@
 
 #include <boost/lexical_cast.hpp>
 #include <stdexcept>
+#include <typeinfo>
 #include "wamp_arguments.hpp"
 
 namespace autobahn {
 
 inline wamp_event::wamp_event(msgpack::zone&& zone)
     : m_zone(std::move(zone))
+    , m_zone_pool()
     , m_arguments(EMPTY_ARGUMENTS)
     , m_kw_arguments(EMPTY_KW_ARGUMENTS)
 {
 }
 
+inline wamp_event::wamp_event(
+        msgpack::zone&& zone, const std::shared_ptr<wamp_zone_pool>& zone_pool)
+    : m_zone(std::move(zone))
+    , m_zone_pool(zone_pool)
+    , m_arguments(EMPTY_ARGUMENTS)
+    , m_kw_arguments(EMPTY_KW_ARGUMENTS)
+{
+}
+
+inline wamp_event::wamp_event(wamp_event&& other)
+    : m_zone(std::move(other.m_zone))
+    , m_zone_pool(std::move(other.m_zone_pool))
+    , m_arguments(other.m_arguments)
+    , m_kw_arguments(other.m_kw_arguments)
+    , m_raw_arguments(other.m_raw_arguments)
+    , m_raw_kw_arguments(other.m_raw_kw_arguments)
+    , m_kw_index(std::move(other.m_kw_index))
+    , m_uri(std::move(other.m_uri))
+    , m_payload_options(std::move(other.m_payload_options))
+{
+    other.m_arguments = EMPTY_ARGUMENTS;
+    other.m_kw_arguments = EMPTY_KW_ARGUMENTS;
+    other.m_raw_arguments = wamp_bytes_view();
+    other.m_raw_kw_arguments = wamp_bytes_view();
+}
+
+inline wamp_event& wamp_event::operator=(wamp_event&& other)
+{
+    if (this == &other) {
+        return *this;
+    }
+
+    if (m_zone_pool) {
+        m_zone_pool->release(std::move(m_zone));
+    }
+
+    m_arguments = other.m_arguments;
+    m_kw_arguments = other.m_kw_arguments;
+    m_raw_arguments = other.m_raw_arguments;
+    m_raw_kw_arguments = other.m_raw_kw_arguments;
+    m_kw_index = std::move(other.m_kw_index);
+    m_uri = std::move(other.m_uri);
+    m_payload_options = std::move(other.m_payload_options);
+    m_zone = std::move(other.m_zone);
+    m_zone_pool = std::move(other.m_zone_pool);
+
+    other.m_arguments = EMPTY_ARGUMENTS;
+    other.m_kw_arguments = EMPTY_KW_ARGUMENTS;
+    other.m_raw_arguments = wamp_bytes_view();
+    other.m_raw_kw_arguments = wamp_bytes_view();
+
+    return *this;
+}
+
+inline wamp_event::~wamp_event()
+{
+    if (m_zone_pool) {
+        m_zone_pool->release(std::move(m_zone));
+    }
+}
+
 inline const std::string& wamp_event::uri() const
 {
     return m_uri;
@@ -90,15 +153,11 @@ inline T wamp_event::kw_argument(const std::string& key) const
     if (m_kw_arguments.type != msgpack::type::MAP) {
         throw msgpack::type_error();
     }
-    for (std::size_t i = 0; i < m_kw_arguments.via.map.size; ++i) {
-        const msgpack::object_kv& kv = m_kw_arguments.via.map.ptr[i];
-        if (kv.key.type == msgpack::type::STR && key.size() == kv.key.via.str.size
-                && key.compare(0, key.size(), kv.key.via.str.ptr, kv.key.via.str.size) == 0)
-        {
-            return kv.val.as<T>();
-        }
+    const msgpack::object* value = m_kw_index.find(wamp_map_view(m_kw_arguments.via.map), key);
+    if (!value) {
+        throw std::out_of_range(key + " keyword argument doesn't exist");
     }
-    throw std::out_of_range(key + " keyword argument doesn't exist");
+    return value->as<T>();
 }
 
 template <typename T>
@@ -107,16 +166,11 @@ inline T wamp_event::kw_argument(const char* key) const
     if (m_kw_arguments.type != msgpack::type::MAP) {
         throw msgpack::type_error();
     }
-    std::size_t key_size = strlen(key);
-    for (std::size_t i = 0; i < m_kw_arguments.via.map.size; ++i) {
-        const msgpack::object_kv& kv = m_kw_arguments.via.map.ptr[i];
-        if (kv.key.type == msgpack::type::STR && key_size == kv.key.via.str.size
-                && memcmp(key, kv.key.via.str.ptr, key_size) == 0)
-        {
-            return kv.val.as<T>();
-        }
+    const msgpack::object* value = m_kw_index.find(wamp_map_view(m_kw_arguments.via.map), key);
+    if (!value) {
+        throw std::out_of_range(std::string(key) + " keyword argument doesn't exist");
     }
-    throw std::out_of_range(std::string(key) + " keyword argument doesn't exist");
+    return value->as<T>();
 }
 
 template <typename T>
@@ -125,15 +179,8 @@ inline T wamp_event::kw_argument_or(const std::string& key, const T& fallback) c
     if (m_kw_arguments.type != msgpack::type::MAP) {
         throw msgpack::type_error();
     }
-    for (std::size_t i = 0; i < m_kw_arguments.via.map.size; ++i) {
-        const msgpack::object_kv& kv = m_kw_arguments.via.map.ptr[i];
-        if (kv.key.type == msgpack::type::STR && key.size() == kv.key.via.str.size
-                && key.compare(0, key.size(), kv.key.via.str.ptr, kv.key.via.str.size) == 0)
-        {
-            return kv.val.as<T>();
-        }
-    }
-    return fallback;
+    const msgpack::object* value = m_kw_index.find(wamp_map_view(m_kw_arguments.via.map), key);
+    return value ? value->as<T>() : fallback;
 }
 
 template <typename T>
@@ -142,16 +189,8 @@ inline T wamp_event::kw_argument_or(const char* key, const T& fallback) const
     if (m_kw_arguments.type != msgpack::type::MAP) {
         throw msgpack::type_error();
     }
-    std::size_t key_size = strlen(key);
-    for (std::size_t i = 0; i < m_kw_arguments.via.map.size; ++i) {
-        const msgpack::object_kv& kv = m_kw_arguments.via.map.ptr[i];
-        if (kv.key.type == msgpack::type::STR && key_size == kv.key.via.str.size
-                && memcmp(key, kv.key.via.str.ptr, key_size) == 0)
-        {
-            return kv.val.as<T>();
-        }
-    }
-    throw fallback;
+    const msgpack::object* value = m_kw_index.find(wamp_map_view(m_kw_arguments.via.map), key);
+    return value ? value->as<T>() : fallback;
 }
 
 template <typename Map>
@@ -166,6 +205,40 @@ inline void wamp_event::get_kw_arguments(Map& kw_args) const
     m_kw_arguments.convert(kw_args);
 }
 
+inline wamp_array_view wamp_event::arguments_view() const
+{
+    return m_arguments.type == msgpack::type::ARRAY
+            ? wamp_array_view(m_arguments.via.array) : wamp_array_view();
+}
+
+inline wamp_map_view wamp_event::kw_arguments_view() const
+{
+    return m_kw_arguments.type == msgpack::type::MAP
+            ? wamp_map_view(m_kw_arguments.via.map) : wamp_map_view();
+}
+
+template <typename View>
+inline View wamp_event::argument_view(std::size_t index) const
+{
+    if (m_arguments.type != msgpack::type::ARRAY || m_arguments.via.array.size <= index) {
+        throw std::out_of_range("no argument at index " + boost::lexical_cast<std::string>(index));
+    }
+    return view_of<View>(m_arguments.via.array.ptr[index]);
+}
+
+template <typename View>
+inline View wamp_event::kw_argument_view(wamp_string_view key) const
+{
+    if (m_kw_arguments.type != msgpack::type::MAP) {
+        throw msgpack::type_error();
+    }
+    const msgpack::object* value = m_kw_index.find(wamp_map_view(m_kw_arguments.via.map), key);
+    if (!value) {
+        throw std::out_of_range(key.to_string() + " keyword argument doesn't exist");
+    }
+    return view_of<View>(*value);
+}
+
 inline void wamp_event::set_arguments(const msgpack::object& arguments)
 {
     m_arguments = arguments;
@@ -174,11 +247,51 @@ inline void wamp_event::set_arguments(const msgpack::object& arguments)
 inline void wamp_event::set_kw_arguments(const msgpack::object& kw_arguments)
 {
     m_kw_arguments = kw_arguments;
+    m_kw_index.reset();
+}
+
+inline wamp_bytes_view wamp_event::raw_arguments() const
+{
+    return m_raw_arguments;
+}
+
+inline wamp_bytes_view wamp_event::raw_kw_arguments() const
+{
+    return m_raw_kw_arguments;
+}
+
+inline void wamp_event::set_raw_arguments(const wamp_bytes_view& raw_arguments)
+{
+    m_raw_arguments = raw_arguments;
+}
+
+inline void wamp_event::set_raw_kw_arguments(const wamp_bytes_view& raw_kw_arguments)
+{
+    m_raw_kw_arguments = raw_kw_arguments;
+}
+
+inline const wamp_payload_options& wamp_event::payload_options() const
+{
+    return m_payload_options;
+}
+
+inline wamp_bytes_view wamp_event::payload() const
+{
+    if (!m_payload_options.is_set()) {
+        throw std::bad_cast();
+    }
+    return payload_argument(m_arguments);
 }
 
 inline void wamp_event::set_details(const msgpack::object& details)
 {
     m_uri = std::move(value_for_key_or<std::string>(details, "topic", std::string()));
+    m_payload_options.read(details);
+}
+
+inline void wamp_event::set_uri(const std::string& uri)
+{
+    m_uri = uri;
 }
 
 } // namespace autobahn
@@ -32,11 +32,13 @@
 #define AUTOBAHN_WAMP_EVENT_HANDLER_HPP
 
 #include "wamp_event.hpp"
+#include "wamp_inplace_function.hpp"
 
 namespace autobahn {
 
-/// Handler type for use with wamp_session::subscribe
-typedef std::function<void(const wamp_event&)> wamp_event_handler;
+/// Handler type for use with wamp_session::subscribe. Handlers capturing
+/// up to 64 bytes of state are stored without allocating.
+typedef wamp_inplace_function<void(const wamp_event&)> wamp_event_handler;
 
 } // namespace autobahn
 
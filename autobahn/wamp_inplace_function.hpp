@@ -0,0 +1,211 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_INPLACE_FUNCTION_HPP
+#define AUTOBAHN_WAMP_INPLACE_FUNCTION_HPP
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace autobahn {
+
+namespace detail {
+
+/// Whether Function can be called with Args and its result converted to R.
+template <typename Function, typename R, typename... Args>
+struct is_callable_as
+{
+    template <typename F>
+    static auto test(int) -> decltype(std::declval<F&>()(std::declval<Args>()...), std::true_type());
+
+    template <typename F>
+    static std::false_type test(...);
+
+    template <typename F, bool callable>
+    struct converts : std::false_type {};
+
+    template <typename F>
+    struct converts<F, true> : std::integral_constant<bool, std::is_void<R>::value
+            || std::is_convertible<decltype(std::declval<F&>()(std::declval<Args>()...)), R>::value> {};
+
+    static const bool value = converts<Function, decltype(test<Function>(0))::value>::value;
+};
+
+/// The most strictly aligned of the fundamental types, standing in for
+/// std::max_align_t which older standard libraries lack.
+union max_align
+{
+    long double long_double_value;
+    long long long_long_value;
+    double double_value;
+    void* pointer_value;
+    void (*function_pointer_value)();
+};
+
+/// Whether a callable is a null function pointer or an empty std::function,
+/// which convert to an empty wamp_inplace_function.
+template <typename Function>
+bool is_null_callable(const Function&) noexcept { return false; }
+
+template <typename R, typename... Args>
+bool is_null_callable(R (* const& function)(Args...)) noexcept { return function == nullptr; }
+
+template <typename Signature>
+bool is_null_callable(const std::function<Signature>& function) noexcept { return !function; }
+
+} // namespace detail
+
+template <typename Signature, std::size_t Capacity = 64>
+class wamp_inplace_function;
+
+/*!
+ * A copyable function wrapper, like std::function, that stores callables
+ * of up to Capacity bytes in place rather than on the heap.
+ *
+ * Lambdas that capture a handful of pointers, shared pointers or strings
+ * fit in the buffer, so storing, copying and calling them does not
+ * allocate and calls do not chase a pointer to the callable. Larger
+ * callables, and callables that may throw when moved, are still accepted
+ * and kept on the heap.
+ */
+template <typename R, typename... Args, std::size_t Capacity>
+class wamp_inplace_function<R(Args...), Capacity>
+{
+public:
+    /*!
+     * The number of bytes available for callables stored in place.
+     */
+    static const std::size_t capacity = Capacity;
+
+    /*!
+     * Constructs an empty function.
+     */
+    wamp_inplace_function() noexcept;
+    wamp_inplace_function(std::nullptr_t) noexcept;
+
+    /*!
+     * Constructs a function that calls the given callable. A null function
+     * pointer or an empty std::function yields an empty function.
+     */
+    template <typename Function, typename = typename std::enable_if<
+            !std::is_same<typename std::decay<Function>::type, wamp_inplace_function>::value
+            && detail::is_callable_as<typename std::decay<Function>::type, R, Args...>::value>::type>
+    wamp_inplace_function(Function&& function);
+
+    wamp_inplace_function(const wamp_inplace_function& other);
+    wamp_inplace_function(wamp_inplace_function&& other) noexcept;
+
+    wamp_inplace_function& operator=(const wamp_inplace_function& other);
+    wamp_inplace_function& operator=(wamp_inplace_function&& other) noexcept;
+    wamp_inplace_function& operator=(std::nullptr_t) noexcept;
+
+    ~wamp_inplace_function();
+
+    /*!
+     * Calls the stored callable.
+     *
+     * @throw std::bad_function_call if the function is empty.
+     */
+    R operator()(Args... args) const;
+
+    /*!
+     * Whether or not the function holds a callable.
+     */
+    explicit operator bool() const noexcept;
+
+    /*!
+     * Whether or not the callable is stored in place, rather than on the heap.
+     */
+    bool stored_inline() const noexcept;
+
+    void swap(wamp_inplace_function& other) noexcept;
+
+private:
+    using storage_type = typename std::aligned_storage<Capacity, alignof(detail::max_align)>::type;
+
+    struct operations
+    {
+        R (*invoke)(void* storage, Args&&... args);
+        void (*copy)(void* destination, const void* source);
+        void (*move)(void* destination, void* source) noexcept;
+        void (*destroy)(void* storage) noexcept;
+        bool stored_inline;
+    };
+
+    template <typename Function>
+    struct fits_inline : std::integral_constant<bool, sizeof(Function) <= Capacity
+            && alignof(detail::max_align) % alignof(Function) == 0
+            && std::is_nothrow_move_constructible<Function>::value> {};
+
+    template <typename Function>
+    struct inline_operations
+    {
+        static R invoke(void* storage, Args&&... args);
+        static void copy(void* destination, const void* source);
+        static void move(void* destination, void* source) noexcept;
+        static void destroy(void* storage) noexcept;
+        static const operations table;
+    };
+
+    template <typename Function>
+    struct heap_operations
+    {
+        static R invoke(void* storage, Args&&... args);
+        static void copy(void* destination, const void* source);
+        static void move(void* destination, void* source) noexcept;
+        static void destroy(void* storage) noexcept;
+        static const operations table;
+    };
+
+    template <typename Function>
+    void store(Function&& function, std::true_type /* inline */);
+
+    template <typename Function>
+    void store(Function&& function, std::false_type /* inline */);
+
+    void clear() noexcept;
+
+    mutable storage_type m_storage;
+    const operations* m_operations;
+};
+
+template <typename R, typename... Args, std::size_t Capacity>
+bool operator==(const wamp_inplace_function<R(Args...), Capacity>& function, std::nullptr_t) noexcept;
+
+template <typename R, typename... Args, std::size_t Capacity>
+bool operator!=(const wamp_inplace_function<R(Args...), Capacity>& function, std::nullptr_t) noexcept;
+
+} // namespace autobahn
+
+#include "wamp_inplace_function.ipp"
+
+#endif // AUTOBAHN_WAMP_INPLACE_FUNCTION_HPP
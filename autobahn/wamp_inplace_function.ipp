@@ -0,0 +1,272 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <functional>
+#include <new>
+
+namespace autobahn {
+
+template <typename R, typename... Args, std::size_t Capacity>
+const std::size_t wamp_inplace_function<R(Args...), Capacity>::capacity;
+
+template <typename R, typename... Args, std::size_t Capacity>
+template <typename Function>
+inline R wamp_inplace_function<R(Args...), Capacity>::inline_operations<Function>::invoke(void* storage, Args&&... args)
+{
+    return static_cast<R>((*static_cast<Function*>(storage))(std::forward<Args>(args)...));
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+template <typename Function>
+inline void wamp_inplace_function<R(Args...), Capacity>::inline_operations<Function>::copy(void* destination, const void* source)
+{
+    new (destination) Function(*static_cast<const Function*>(source));
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+template <typename Function>
+inline void wamp_inplace_function<R(Args...), Capacity>::inline_operations<Function>::move(void* destination, void* source) noexcept
+{
+    new (destination) Function(std::move(*static_cast<Function*>(source)));
+    static_cast<Function*>(source)->~Function();
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+template <typename Function>
+inline void wamp_inplace_function<R(Args...), Capacity>::inline_operations<Function>::destroy(void* storage) noexcept
+{
+    static_cast<Function*>(storage)->~Function();
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+template <typename Function>
+const typename wamp_inplace_function<R(Args...), Capacity>::operations wamp_inplace_function<R(Args...), Capacity>::inline_operations<Function>::table = {
+    &wamp_inplace_function<R(Args...), Capacity>::inline_operations<Function>::invoke,
+    &wamp_inplace_function<R(Args...), Capacity>::inline_operations<Function>::copy,
+    &wamp_inplace_function<R(Args...), Capacity>::inline_operations<Function>::move,
+    &wamp_inplace_function<R(Args...), Capacity>::inline_operations<Function>::destroy,
+    true
+};
+
+// Callables kept on the heap store a pointer to themselves in the buffer.
+
+template <typename R, typename... Args, std::size_t Capacity>
+template <typename Function>
+inline R wamp_inplace_function<R(Args...), Capacity>::heap_operations<Function>::invoke(void* storage, Args&&... args)
+{
+    return static_cast<R>((**static_cast<Function**>(storage))(std::forward<Args>(args)...));
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+template <typename Function>
+inline void wamp_inplace_function<R(Args...), Capacity>::heap_operations<Function>::copy(void* destination, const void* source)
+{
+    new (destination) Function*(new Function(**static_cast<Function* const*>(source)));
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+template <typename Function>
+inline void wamp_inplace_function<R(Args...), Capacity>::heap_operations<Function>::move(void* destination, void* source) noexcept
+{
+    new (destination) Function*(*static_cast<Function**>(source));
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+template <typename Function>
+inline void wamp_inplace_function<R(Args...), Capacity>::heap_operations<Function>::destroy(void* storage) noexcept
+{
+    delete *static_cast<Function**>(storage);
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+template <typename Function>
+const typename wamp_inplace_function<R(Args...), Capacity>::operations wamp_inplace_function<R(Args...), Capacity>::heap_operations<Function>::table = {
+    &wamp_inplace_function<R(Args...), Capacity>::heap_operations<Function>::invoke,
+    &wamp_inplace_function<R(Args...), Capacity>::heap_operations<Function>::copy,
+    &wamp_inplace_function<R(Args...), Capacity>::heap_operations<Function>::move,
+    &wamp_inplace_function<R(Args...), Capacity>::heap_operations<Function>::destroy,
+    false
+};
+
+template <typename R, typename... Args, std::size_t Capacity>
+inline wamp_inplace_function<R(Args...), Capacity>::wamp_inplace_function() noexcept
+    : m_storage()
+    , m_operations(nullptr)
+{
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inline wamp_inplace_function<R(Args...), Capacity>::wamp_inplace_function(std::nullptr_t) noexcept
+    : m_storage()
+    , m_operations(nullptr)
+{
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+template <typename Function, typename>
+inline wamp_inplace_function<R(Args...), Capacity>::wamp_inplace_function(Function&& function)
+    : m_storage()
+    , m_operations(nullptr)
+{
+    using function_type = typename std::decay<Function>::type;
+    if (!detail::is_null_callable(function)) {
+        store(std::forward<Function>(function), fits_inline<function_type>());
+    }
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inline wamp_inplace_function<R(Args...), Capacity>::wamp_inplace_function(const wamp_inplace_function& other)
+    : m_storage()
+    , m_operations(nullptr)
+{
+    if (other.m_operations) {
+        other.m_operations->copy(&m_storage, &other.m_storage);
+        m_operations = other.m_operations;
+    }
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inline wamp_inplace_function<R(Args...), Capacity>::wamp_inplace_function(wamp_inplace_function&& other) noexcept
+    : m_storage()
+    , m_operations(nullptr)
+{
+    if (other.m_operations) {
+        other.m_operations->move(&m_storage, &other.m_storage);
+        m_operations = other.m_operations;
+        other.m_operations = nullptr;
+    }
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inline wamp_inplace_function<R(Args...), Capacity>& wamp_inplace_function<R(Args...), Capacity>::operator=(const wamp_inplace_function& other)
+{
+    if (this != &other) {
+        wamp_inplace_function copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inline wamp_inplace_function<R(Args...), Capacity>& wamp_inplace_function<R(Args...), Capacity>::operator=(wamp_inplace_function&& other) noexcept
+{
+    if (this != &other) {
+        clear();
+        if (other.m_operations) {
+            other.m_operations->move(&m_storage, &other.m_storage);
+            m_operations = other.m_operations;
+            other.m_operations = nullptr;
+        }
+    }
+    return *this;
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inline wamp_inplace_function<R(Args...), Capacity>& wamp_inplace_function<R(Args...), Capacity>::operator=(std::nullptr_t) noexcept
+{
+    clear();
+    return *this;
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inline wamp_inplace_function<R(Args...), Capacity>::~wamp_inplace_function()
+{
+    clear();
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inline R wamp_inplace_function<R(Args...), Capacity>::operator()(Args... args) const
+{
+    if (!m_operations) {
+        throw std::bad_function_call();
+    }
+    return m_operations->invoke(&m_storage, std::forward<Args>(args)...);
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inline wamp_inplace_function<R(Args...), Capacity>::operator bool() const noexcept
+{
+    return m_operations != nullptr;
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inline bool wamp_inplace_function<R(Args...), Capacity>::stored_inline() const noexcept
+{
+    return m_operations && m_operations->stored_inline;
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inline void wamp_inplace_function<R(Args...), Capacity>::swap(wamp_inplace_function& other) noexcept
+{
+    wamp_inplace_function temporary(std::move(other));
+    other = std::move(*this);
+    *this = std::move(temporary);
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+template <typename Function>
+inline void wamp_inplace_function<R(Args...), Capacity>::store(Function&& function, std::true_type)
+{
+    using function_type = typename std::decay<Function>::type;
+    new (&m_storage) function_type(std::forward<Function>(function));
+    m_operations = &inline_operations<function_type>::table;
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+template <typename Function>
+inline void wamp_inplace_function<R(Args...), Capacity>::store(Function&& function, std::false_type)
+{
+    using function_type = typename std::decay<Function>::type;
+    new (&m_storage) function_type*(new function_type(std::forward<Function>(function)));
+    m_operations = &heap_operations<function_type>::table;
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inline void wamp_inplace_function<R(Args...), Capacity>::clear() noexcept
+{
+    if (m_operations) {
+        m_operations->destroy(&m_storage);
+        m_operations = nullptr;
+    }
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inline bool operator==(const wamp_inplace_function<R(Args...), Capacity>& function, std::nullptr_t) noexcept
+{
+    return !function;
+}
+
+template <typename R, typename... Args, std::size_t Capacity>
+inline bool operator!=(const wamp_inplace_function<R(Args...), Capacity>& function, std::nullptr_t) noexcept
+{
+    return static_cast<bool>(function);
+}
+
+} // namespace autobahn
@@ -32,22 +32,91 @@
 #define AUTOBAHN_WAMP_INVOCATION_HPP
 
 #include "wamp_arguments.hpp"
-
+#include "wamp_chunk_handler.hpp"
+#include "wamp_invocation_sink.hpp"
+#include "wamp_object_view.hpp"
+#include "wamp_payload.hpp"
+#include "wamp_zone_pool.hpp"
+
+#include <atomic>
+#include <boost/intrusive_ptr.hpp>
+#include <cstddef>
 #include <cstdint>
-#include <functional>
 #include <memory>
 #include <msgpack.hpp>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace autobahn {
 
-class wamp_message;
+class wamp_invocation_impl;
+
+using wamp_invocation = boost::intrusive_ptr<wamp_invocation_impl>;
+
+/*!
+ * A free list of invocation objects.
+ *
+ * The session takes an invocation from the pool for every INVOCATION it
+ * receives. Once the last wamp_invocation referring to it is gone, the
+ * invocation is reset and put back, so that a callee under load reuses
+ * the same few objects rather than allocating one per invocation. The
+ * pool is safe to use from any thread.
+ */
+class wamp_invocation_pool :
+        public std::enable_shared_from_this<wamp_invocation_pool>
+{
+public:
+    /*!
+     * Constructs a pool.
+     *
+     * \param max_invocations The number of idle invocations kept at most.
+     */
+    explicit wamp_invocation_pool(std::size_t max_invocations = 64);
+
+    wamp_invocation_pool(const wamp_invocation_pool&) = delete;
+    wamp_invocation_pool& operator=(const wamp_invocation_pool&) = delete;
+
+    ~wamp_invocation_pool();
+
+    /*!
+     * Takes an invocation from the pool, or creates one if there is none.
+     * The pool must be owned by a std::shared_ptr.
+     */
+    wamp_invocation acquire();
+
+    /*!
+     * Changes the number of idle invocations kept at most.
+     */
+    void set_limit(std::size_t max_invocations);
+
+    /*!
+     * The number of idle invocations in the pool.
+     */
+    std::size_t size() const;
+
+    /*!
+     * The number of invocations the pool had to create as it was empty.
+     */
+    std::size_t created() const;
+
+private:
+    friend void intrusive_ptr_release(wamp_invocation_impl* invocation);
+
+    void release(wamp_invocation_impl* invocation);
+
+    mutable std::mutex m_mutex;
+    std::vector<wamp_invocation_impl*> m_invocations;
+    std::size_t m_max_invocations;
+    std::size_t m_created;
+};
 
 class wamp_invocation_impl
 {
 public:
     wamp_invocation_impl();
     wamp_invocation_impl(wamp_invocation_impl&&) = delete; // copy wamp_invocation instead
+    ~wamp_invocation_impl();
 
     //add URI and details
     /*!
@@ -125,11 +194,10 @@ public:
      *
      * Overloads are provided for `std::string` and `char*` as @p key type.
      *
-     * This function uses key string comparisons to find the matching value, O(n) with n being
-     * the number of map elements. Memory allocation for keys is avoided though. For larger maps,
-     * you might want to prioritize look-up performance by using `std::map`, `std::unordered_map`
-     * or custom types with custom deserialization. To do this, use kw_arguments<Map>() or
-     * get_kw_arguments<Map>(map), then access the items from there.
+     * Small maps are searched with key string comparisons, O(n) with n being the number of map
+     * elements, without allocating. For maps with at least wamp_map_index::MIN_INDEXED_SIZE
+     * elements a hash index over the keys is built on the first look-up, so that every further
+     * look-up is O(1).
      *
      * Example:
      * `std::string id = invocation->kw_argument<std::string>("id");`
@@ -149,11 +217,10 @@ public:
      *
      * Overloads are provided for `std::string` and `char*` as @p key type.
      *
-     * This function uses key string comparisons to find the matching value, O(n) with n being
-     * the number of map elements. Memory allocation for keys is avoided though. For larger maps,
-     * you might want to prioritize look-up performance by using `std::map`, `std::unordered_map`
-     * or custom types with custom deserialization. To do this, use kw_arguments<Map>() or
-     * get_kw_arguments<Map>(map), then access the items from there.
+     * Small maps are searched with key string comparisons, O(n) with n being the number of map
+     * elements, without allocating. For maps with at least wamp_map_index::MIN_INDEXED_SIZE
+     * elements a hash index over the keys is built on the first look-up, so that every further
+     * look-up is O(1).
      *
      * Example:
      * `std::string id = invocation->kw_argument_or("id", std::string());`
@@ -225,6 +292,88 @@ public:
     template <typename List, typename Map>
     void result(const List& arguments, const Map& kw_arguments);
 
+    /*!
+     * Reply to the invocation with the given values as positional arguments.
+     *
+     * Unlike result(), the values are packed straight into the serialized
+     * YIELD message without first being converted to msgpack objects.
+     *
+     * Example:
+     * `invocation->packed_result(std::string("hello"), 42);`
+     */
+    template <typename... T>
+    void packed_result(const T&... values);
+
+    /*!
+     * Send progressive/partial result with pre-encoded arguments, see result_raw().
+     */
+    void progress_raw(const wamp_bytes_view& arguments,
+            const wamp_bytes_view& kw_arguments = wamp_bytes_view());
+
+    /*!
+     * Reply to the invocation with arguments that are msgpack-encoded
+     * already: @p arguments must hold an encoded array and @p kw_arguments,
+     * if not empty, an encoded map. The bytes are copied into the YIELD
+     * message as they are, without being decoded or re-encoded, so they
+     * only need to be valid for the duration of the call.
+     *
+     * Example:
+     * `invocation->result_raw(result.raw_arguments(), result.raw_kw_arguments());`
+     *
+     * @throw std::invalid_argument
+     */
+    void result_raw(const wamp_bytes_view& arguments,
+            const wamp_bytes_view& kw_arguments = wamp_bytes_view());
+
+    /*!
+     * Send progressive/partial result with an opaque payload, see result_payload().
+     */
+    void progress_payload(const wamp_bytes_view& payload,
+            const wamp_payload_options& payload_options);
+
+    /*!
+     * Reply to the invocation with an opaque application payload that the
+     * WAMP layer does not interpret: its bytes are sent as the only
+     * positional argument, a binary, and @p payload_options as the ppt_*
+     * options of the YIELD. The bytes only need to be valid for the
+     * duration of the call.
+     *
+     * Example:
+     * `invocation->result_payload(wamp_bytes_view(reply.data(), reply.size()), wamp_payload_options("x_myapp", "protobuf"));`
+     *
+     * @throw std::invalid_argument if no scheme is set in @p payload_options.
+     */
+    void result_payload(const wamp_bytes_view& payload,
+            const wamp_payload_options& payload_options);
+
+    /*!
+     * Reply to the invocation with a large binary result in chunks of
+     * @p chunk_size bytes, read from @p source one chunk at a time.
+     *
+     * Each chunk is sent as a progressive result whose only positional
+     * argument is a binary, and the last one as the final result, so that
+     * neither the whole result has to be held in memory nor a single
+     * message exceed the limits of the transport. The chunks are read and
+     * sent on the io thread, each after the handlers queued there before
+     * it, so that other messages of the session go out in between. Callers
+     * get the result with wamp_session::call_chunked() or
+     * wamp_session::call_streamed().
+     *
+     * If the caller did not ask for progressive results, the whole result
+     * is read and sent as a single final result instead, unless it is
+     * larger than MAX_UNCHUNKED_RESULT_SIZE, in which case the invocation
+     * is answered with a wamp.error.invalid_argument error. If @p source
+     * throws, the invocation is answered with a wamp.error.runtime_error
+     * error.
+     *
+     * Example:
+     * `invocation->result_chunked([file](char* data, std::size_t size) { return std::fread(data, 1, size, file); });`
+     *
+     * @throw std::invalid_argument if @p chunk_size is 0.
+     */
+    void result_chunked(wamp_chunk_source&& source,
+            std::size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
     /*!
      * Reply to the invocation with an error and no further details.
      */
@@ -244,6 +393,87 @@ public:
             const std::string& error_uri,
             const List& arguments, const Map& kw_arguments);
 
+    /*!
+     * Non-owning view of the positional arguments passed to the invocation.
+     *
+     * The view, and any string or byte view taken from its elements, points
+     * into the invocation and is only valid as long as the invocation lives.
+     *
+     * Example:
+     * `for (const msgpack::object& argument : invocation->arguments_view()) { ... }`
+     */
+    wamp_array_view arguments_view() const;
+
+    /*!
+     * Non-owning view of the keyword arguments passed to the invocation.
+     *
+     * The view is only valid as long as the invocation lives.
+     */
+    wamp_map_view kw_arguments_view() const;
+
+    /*!
+     * Non-owning view of the positional argument passed to the invocation with the given @p index,
+     * without copying it out of the invocation. View is one of wamp_string_view,
+     * wamp_bytes_view, wamp_array_view or wamp_map_view.
+     *
+     * Example:
+     * `wamp_string_view id = invocation->argument_view<wamp_string_view>(0);`
+     *
+     * @throw std::out_of_range
+     * @throw std::bad_cast
+     */
+    template <typename View>
+    View argument_view(std::size_t index) const;
+
+    /*!
+     * Non-owning view of the keyword argument passed to the invocation with the given @p key.
+     * See argument_view().
+     *
+     * Example:
+     * `wamp_string_view id = invocation->kw_argument_view<wamp_string_view>("id");`
+     *
+     * @throw std::out_of_range if there is no keyword argument with the given @p key.
+     * @throw msgpack::type_error if no keyword arguments were received, or if
+     *        the value cannot be viewed as a View.
+     */
+    template <typename View>
+    View kw_argument_view(wamp_string_view key) const;
+
+    /*!
+     * The positional arguments passed to the invocation, still
+     * msgpack-encoded as they were received, e.g. to be passed on with
+     * wamp_session::call_raw() without decoding and re-encoding them.
+     *
+     * The bytes are only kept if the session was told to, see
+     * wamp_session::set_keep_raw_arguments(), and not for calls made
+     * locally; otherwise, and if there are no positional arguments, the
+     * view is empty. It is only valid as long as the invocation lives.
+     */
+    wamp_bytes_view raw_arguments() const;
+
+    /*!
+     * The keyword arguments passed to the invocation, still msgpack-encoded
+     * as they were received. See raw_arguments().
+     */
+    wamp_bytes_view raw_kw_arguments() const;
+
+    /*!
+     * The payload transparency options the call was made with, see payload();
+     * not set unless it carries an opaque payload.
+     */
+    const wamp_payload_options& payload_options() const;
+
+    /*!
+     * The opaque application payload passed to the invocation, called with
+     * wamp_session::call_payload(): the bytes of its only positional argument,
+     * a binary, as they were sent. Only the message around the payload is
+     * unpacked; the payload itself is not decoded, and the view points into
+     * the invocation, so it is only valid as long as the invocation lives.
+     *
+     * @throw std::bad_cast if there is no opaque payload.
+     */
+    wamp_bytes_view payload() const;
+
     //
     // functions only called internally by wamp_session
 
@@ -252,37 +482,77 @@ public:
         intermediary
     } ;
 
-    using send_result_fn = std::function<void(const std::shared_ptr<wamp_message>&)>;
-    void set_send_result_fn(send_result_fn&&);
+    void set_sink(const std::weak_ptr<wamp_invocation_sink>& sink, bool local);
     void set_details(const msgpack::object& details);
     void set_request_id(std::uint64_t);
 	std::uint64_t get_request_id();
 	void set_zone(msgpack::zone&&);
+    void set_zone(msgpack::zone&& zone, const std::shared_ptr<wamp_zone_pool>& zone_pool);
     void set_arguments(const msgpack::object& arguments);
     void set_kw_arguments(const msgpack::object& kw_arguments);
+    void set_raw_arguments(const wamp_bytes_view& raw_arguments);
+    void set_raw_kw_arguments(const wamp_bytes_view& raw_kw_arguments);
     bool sendable() const;
 
 private:
+    friend class wamp_invocation_pool;
+    friend void intrusive_ptr_add_ref(wamp_invocation_impl* invocation);
+    friend void intrusive_ptr_release(wamp_invocation_impl* invocation);
+
+    void reset();
     void throw_if_not_sendable() const;
+    std::shared_ptr<wamp_invocation_sink> lock_sink();
+    void send_reply(const std::shared_ptr<wamp_invocation_sink>& sink,
+            msgpack::sbuffer&& buffer, bool final_reply);
 
     template <typename List>
     void send_result(const List& arguments, result_type resultType);
 
     template <typename List, typename Map>
     void send_result(const List& arguments, const Map& kw_arguments, result_type resultType);
-private:
 
+    void send_raw_result(const wamp_bytes_view& arguments,
+            const wamp_bytes_view& kw_arguments, result_type resultType);
 
+    void send_payload_result(const wamp_bytes_view& payload,
+            const wamp_payload_options& payload_options, result_type resultType);
+
+    void send_binary_result(const std::shared_ptr<wamp_invocation_sink>& sink,
+            const wamp_bytes_view& bytes, const wamp_payload_options& payload_options,
+            result_type resultType);
+
+    template <typename List, typename Map>
+    void send_error(const std::shared_ptr<wamp_invocation_sink>& sink,
+            const std::string& error_uri, const List& arguments, const Map& kw_arguments);
+
+    struct chunked_transfer
+    {
+        wamp_chunk_source source;
+        std::vector<char> chunk;
+    };
+
+    void send_chunk(const std::shared_ptr<chunked_transfer>& transfer);
+private:
+    std::atomic<std::size_t> m_ref_count;
+    std::shared_ptr<wamp_invocation_pool> m_pool;
     msgpack::zone m_zone;
+    std::shared_ptr<wamp_zone_pool> m_zone_pool;
     msgpack::object m_arguments;
     msgpack::object m_kw_arguments;
-    send_result_fn m_send_result_fn;
+    wamp_bytes_view m_raw_arguments;
+    wamp_bytes_view m_raw_kw_arguments;
+    wamp_map_index m_kw_index;
+    std::weak_ptr<wamp_invocation_sink> m_sink;
+    bool m_local;
+    std::atomic<bool> m_sendable;
     std::uint64_t m_request_id;
     std::string m_uri;
     bool m_progressive_results_expected;
+    wamp_payload_options m_payload_options;
 };
 
-using wamp_invocation = std::shared_ptr<wamp_invocation_impl>;
+void intrusive_ptr_add_ref(wamp_invocation_impl* invocation);
+void intrusive_ptr_release(wamp_invocation_impl* invocation);
 
 } // namespace autobahn
 
@@ -31,22 +31,159 @@
 #include "wamp_message.hpp"
 #include "wamp_message_type.hpp"
 
+#include <algorithm>
 #include <boost/lexical_cast.hpp>
+#include <map>
 #include <stdexcept>
 #include <tuple>
+#include <typeinfo>
 
 namespace autobahn {
 
+inline wamp_invocation_pool::wamp_invocation_pool(std::size_t max_invocations)
+    : m_mutex()
+    , m_invocations()
+    , m_max_invocations(max_invocations)
+    , m_created(0)
+{
+    m_invocations.reserve(max_invocations);
+}
+
+inline wamp_invocation_pool::~wamp_invocation_pool()
+{
+    for (wamp_invocation_impl* invocation : m_invocations) {
+        delete invocation;
+    }
+}
+
+inline wamp_invocation wamp_invocation_pool::acquire()
+{
+    wamp_invocation_impl* invocation = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_invocations.empty()) {
+            invocation = m_invocations.back();
+            m_invocations.pop_back();
+        } else {
+            ++m_created;
+        }
+    }
+
+    if (!invocation) {
+        invocation = new wamp_invocation_impl();
+    }
+    invocation->m_pool = shared_from_this();
+
+    return wamp_invocation(invocation);
+}
+
+inline void wamp_invocation_pool::release(wamp_invocation_impl* invocation)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_invocations.size() < m_max_invocations) {
+            m_invocations.push_back(invocation);
+            return;
+        }
+    }
+
+    delete invocation;
+}
+
+inline void wamp_invocation_pool::set_limit(std::size_t max_invocations)
+{
+    std::vector<wamp_invocation_impl*> surplus;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_max_invocations = max_invocations;
+        if (m_invocations.size() > max_invocations) {
+            surplus.assign(m_invocations.begin() + max_invocations, m_invocations.end());
+            m_invocations.resize(max_invocations);
+        }
+        m_invocations.reserve(max_invocations);
+    }
+
+    for (wamp_invocation_impl* invocation : surplus) {
+        delete invocation;
+    }
+}
+
+inline std::size_t wamp_invocation_pool::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_invocations.size();
+}
+
+inline std::size_t wamp_invocation_pool::created() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_created;
+}
+
+inline void intrusive_ptr_add_ref(wamp_invocation_impl* invocation)
+{
+    invocation->m_ref_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void intrusive_ptr_release(wamp_invocation_impl* invocation)
+{
+    if (invocation->m_ref_count.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    // Keep the pool alive while the invocation is handed back to it.
+    std::shared_ptr<wamp_invocation_pool> pool = std::move(invocation->m_pool);
+    if (pool) {
+        invocation->reset();
+        pool->release(invocation);
+    } else {
+        delete invocation;
+    }
+}
+
 inline wamp_invocation_impl::wamp_invocation_impl()
-    : m_zone()
+    : m_ref_count(0)
+    , m_pool()
+    , m_zone()
+    , m_zone_pool()
     , m_arguments(EMPTY_ARGUMENTS)
     , m_kw_arguments(EMPTY_KW_ARGUMENTS)
-    , m_send_result_fn()
+    , m_sink()
+    , m_local(false)
+    , m_sendable(false)
     , m_request_id(0)
     , m_progressive_results_expected(false)
+    , m_payload_options()
 {
 }
 
+inline wamp_invocation_impl::~wamp_invocation_impl()
+{
+    if (m_zone_pool) {
+        m_zone_pool->release(std::move(m_zone));
+    }
+}
+
+inline void wamp_invocation_impl::reset()
+{
+    if (m_zone_pool) {
+        m_zone_pool->release(std::move(m_zone));
+        m_zone_pool.reset();
+    }
+    m_arguments = EMPTY_ARGUMENTS;
+    m_kw_arguments = EMPTY_KW_ARGUMENTS;
+    m_raw_arguments = wamp_bytes_view();
+    m_raw_kw_arguments = wamp_bytes_view();
+    m_kw_index.reset();
+    m_sink.reset();
+    m_local = false;
+    m_sendable = false;
+    m_request_id = 0;
+    m_uri.clear();
+    m_progressive_results_expected = false;
+    m_payload_options = wamp_payload_options();
+}
+
 inline const std::string& wamp_invocation_impl::uri() const
 {
     return m_uri;
@@ -96,15 +233,11 @@ inline T wamp_invocation_impl::kw_argument(const std::string& key) const
     if (m_kw_arguments.type != msgpack::type::MAP) {
         throw msgpack::type_error();
     }
-    for (std::size_t i = 0; i < m_kw_arguments.via.map.size; ++i) {
-        const msgpack::object_kv& kv = m_kw_arguments.via.map.ptr[i];
-        if (kv.key.type == msgpack::type::STR && key.size() == kv.key.via.str.size
-                && key.compare(0, key.size(), kv.key.via.str.ptr, kv.key.via.str.size) == 0)
-        {
-            return kv.val.as<T>();
-        }
+    const msgpack::object* value = m_kw_index.find(wamp_map_view(m_kw_arguments.via.map), key);
+    if (!value) {
+        throw std::out_of_range(key + " keyword argument doesn't exist");
     }
-    throw std::out_of_range(key + " keyword argument doesn't exist");
+    return value->as<T>();
 }
 
 template <typename T>
@@ -113,16 +246,11 @@ inline T wamp_invocation_impl::kw_argument(const char* key) const
     if (m_kw_arguments.type != msgpack::type::MAP) {
         throw msgpack::type_error();
     }
-    std::size_t key_size = strlen(key);
-    for (std::size_t i = 0; i < m_kw_arguments.via.map.size; ++i) {
-        const msgpack::object_kv& kv = m_kw_arguments.via.map.ptr[i];
-        if (kv.key.type == msgpack::type::STR && key_size == kv.key.via.str.size
-                && memcmp(key, kv.key.via.str.ptr, key_size) == 0)
-        {
-            return kv.val.as<T>();
-        }
+    const msgpack::object* value = m_kw_index.find(wamp_map_view(m_kw_arguments.via.map), key);
+    if (!value) {
+        throw std::out_of_range(std::string(key) + " keyword argument doesn't exist");
     }
-    throw std::out_of_range(std::string(key) + " keyword argument doesn't exist");
+    return value->as<T>();
 }
 
 template <typename T>
@@ -131,15 +259,8 @@ inline T wamp_invocation_impl::kw_argument_or(const std::string& key, const T& f
     if (m_kw_arguments.type != msgpack::type::MAP) {
         throw msgpack::type_error();
     }
-    for (std::size_t i = 0; i < m_kw_arguments.via.map.size; ++i) {
-        const msgpack::object_kv& kv = m_kw_arguments.via.map.ptr[i];
-        if (kv.key.type == msgpack::type::STR && key.size() == kv.key.via.str.size
-                && key.compare(0, key.size(), kv.key.via.str.ptr, kv.key.via.str.size) == 0)
-        {
-            return kv.val.as<T>();
-        }
-    }
-    return fallback;
+    const msgpack::object* value = m_kw_index.find(wamp_map_view(m_kw_arguments.via.map), key);
+    return value ? value->as<T>() : fallback;
 }
 
 template <typename T>
@@ -148,16 +269,8 @@ inline T wamp_invocation_impl::kw_argument_or(const char* key, const T& fallback
     if (m_kw_arguments.type != msgpack::type::MAP) {
         throw msgpack::type_error();
     }
-    std::size_t key_size = strlen(key);
-    for (std::size_t i = 0; i < m_kw_arguments.via.map.size; ++i) {
-        const msgpack::object_kv& kv = m_kw_arguments.via.map.ptr[i];
-        if (kv.key.type == msgpack::type::STR && key_size == kv.key.via.str.size
-                && memcmp(key, kv.key.via.str.ptr, key_size) == 0)
-        {
-            return kv.val.as<T>();
-        }
-    }
-    return fallback;
+    const msgpack::object* value = m_kw_index.find(wamp_map_view(m_kw_arguments.via.map), key);
+    return value ? value->as<T>() : fallback;
 }
 
 
@@ -180,16 +293,20 @@ inline bool wamp_invocation_impl::progressive_results_expected() const
 
 inline void wamp_invocation_impl::empty_result()
 {
-    throw_if_not_sendable();
+    auto sink = lock_sink();
+    if (!sink) {
+        return;
+    }
 
     // [YIELD, INVOCATION.Request|id, Options|dict]
-    auto message = std::make_shared<wamp_message>(3);
-    message->set_field(0, static_cast<int>(message_type::YIELD));
-    message->set_field(1, m_request_id);
-    message->set_field(2, std::map<int, int>() /* No details */);
+    msgpack::sbuffer buffer = sink->acquire_reply_buffer();
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(3);
+    packer.pack(static_cast<int>(message_type::YIELD));
+    packer.pack(m_request_id);
+    packer.pack_map(0); // No details
 
-    m_send_result_fn(message);
-    m_send_result_fn = send_result_fn();
+    send_reply(sink, std::move(buffer), true);
 }
 
 template<typename List>
@@ -201,26 +318,31 @@ inline void wamp_invocation_impl::send_result(const List& arguments, wamp_invoca
         //Discard intermediate results.  Other option is to throw, since method could check if progressive results are expected
         return;
     }
+    auto sink = lock_sink();
+    if (!sink) {
+        return;
+    }
+
     // [YIELD, INVOCATION.Request|id, Options|dict, Arguments|list]
-    auto message = std::make_shared<wamp_message>(4);
-    message->set_field(0, static_cast<int>(message_type::YIELD));
-    message->set_field(1, m_request_id);
+    msgpack::sbuffer buffer = sink->acquire_reply_buffer();
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(4);
+    packer.pack(static_cast<int>(message_type::YIELD));
+    packer.pack(m_request_id);
     if (resultType == intermediary)
     {
-        message->set_field(2, std::map<std::string, bool>{ {"progress", true} });
+        packer.pack_map(1);
+        packer.pack_str(8);
+        packer.pack_str_body("progress", 8);
+        packer.pack_true();
     }
     else
     {
-        message->set_field(2, std::map<int, int>() /* No details */);
+        packer.pack_map(0); // No details
     }
-    message->set_field(3, arguments);
+    packer.pack(arguments);
 
-    m_send_result_fn(message);
-    if (resultType != intermediary)
-    {
-        //Final result clears send function
-        m_send_result_fn = send_result_fn();
-    }
+    send_reply(sink, std::move(buffer), resultType != intermediary);
 }
 
 template<typename List, typename Map>
@@ -233,30 +355,32 @@ inline void wamp_invocation_impl::send_result(
         //Discard intermediate results.  Other option is to throw, since method could check if progressive results are expected
         return;
     }
+    auto sink = lock_sink();
+    if (!sink) {
+        return;
+    }
 
     // [YIELD, INVOCATION.Request|id, Options|dict, Arguments|list, ArgumentsKw|dict]
-    auto message = std::make_shared<wamp_message>(5);
-    message->set_field(0, static_cast<int>(message_type::YIELD));
-    message->set_field(1, m_request_id);
-    
+    msgpack::sbuffer buffer = sink->acquire_reply_buffer();
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(5);
+    packer.pack(static_cast<int>(message_type::YIELD));
+    packer.pack(m_request_id);
     if (resultType == intermediary)
     {
-        message->set_field(2, std::map<std::string, bool>{ {"progress", true} });
+        packer.pack_map(1);
+        packer.pack_str(8);
+        packer.pack_str_body("progress", 8);
+        packer.pack_true();
     }
     else
     {
-        message->set_field(2, std::map<int, int>() /* No details */);
+        packer.pack_map(0); // No details
     }
+    packer.pack(arguments);
+    packer.pack(kw_arguments);
 
-    message->set_field(3, arguments);
-    message->set_field(4, kw_arguments);
-
-    m_send_result_fn(message);
-    if (resultType != intermediary)
-    {
-        //Final result clears send function
-        m_send_result_fn = send_result_fn();
-    }
+    send_reply(sink, std::move(buffer), resultType != intermediary);
 }
 
 template <typename List>
@@ -283,38 +407,240 @@ inline void wamp_invocation_impl::result(const List& arguments, const Map& kw_ar
     send_result<List, Map>(arguments, kw_arguments, final);
 }
 
-inline void wamp_invocation_impl::error(const std::string& error_uri)
+inline void wamp_invocation_impl::send_raw_result(const wamp_bytes_view& arguments,
+        const wamp_bytes_view& kw_arguments, wamp_invocation_impl::result_type resultType)
 {
     throw_if_not_sendable();
+    if (resultType == intermediary && !m_progressive_results_expected) {
+        return;
+    }
+    auto sink = lock_sink();
+    if (!sink) {
+        return;
+    }
+
+    // [YIELD, INVOCATION.Request|id, Options|dict, Arguments|list, ArgumentsKw|dict]
+    msgpack::sbuffer buffer = sink->acquire_reply_buffer();
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(3 + raw_argument_fields(arguments, kw_arguments));
+    packer.pack(static_cast<int>(message_type::YIELD));
+    packer.pack(m_request_id);
+    if (resultType == intermediary) {
+        packer.pack_map(1);
+        packer.pack_str(8);
+        packer.pack_str_body("progress", 8);
+        packer.pack_true();
+    } else {
+        packer.pack_map(0); // No details
+    }
+    pack_raw_arguments(buffer, arguments, kw_arguments);
+
+    send_reply(sink, std::move(buffer), resultType != intermediary);
+}
+
+inline void wamp_invocation_impl::progress_raw(
+        const wamp_bytes_view& arguments, const wamp_bytes_view& kw_arguments)
+{
+    send_raw_result(arguments, kw_arguments, intermediary);
+}
+
+inline void wamp_invocation_impl::result_raw(
+        const wamp_bytes_view& arguments, const wamp_bytes_view& kw_arguments)
+{
+    send_raw_result(arguments, kw_arguments, final);
+}
+
+inline void wamp_invocation_impl::send_payload_result(const wamp_bytes_view& payload,
+        const wamp_payload_options& payload_options, wamp_invocation_impl::result_type resultType)
+{
+    throw_if_not_sendable();
+    if (!payload_options.is_set()) {
+        throw std::invalid_argument("payload options must name a scheme");
+    }
+    if (resultType == intermediary && !m_progressive_results_expected) {
+        return;
+    }
+    auto sink = lock_sink();
+    if (!sink) {
+        return;
+    }
+
+    send_binary_result(sink, payload, payload_options, resultType);
+}
+
+inline void wamp_invocation_impl::send_binary_result(const std::shared_ptr<wamp_invocation_sink>& sink,
+        const wamp_bytes_view& bytes, const wamp_payload_options& payload_options,
+        wamp_invocation_impl::result_type resultType)
+{
+    // [YIELD, INVOCATION.Request|id, Options|dict, Arguments|list]
+    msgpack::sbuffer buffer = sink->acquire_reply_buffer();
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(4);
+    packer.pack(static_cast<int>(message_type::YIELD));
+    packer.pack(m_request_id);
+    if (resultType == intermediary) {
+        packer.pack_map(1 + payload_options.size());
+        packer.pack_str(8);
+        packer.pack_str_body("progress", 8);
+        packer.pack_true();
+    } else {
+        packer.pack_map(payload_options.size());
+    }
+    payload_options.pack_entries(packer);
+    pack_payload_argument(buffer, bytes);
+
+    send_reply(sink, std::move(buffer), resultType != intermediary);
+}
+
+inline void wamp_invocation_impl::progress_payload(
+        const wamp_bytes_view& payload, const wamp_payload_options& payload_options)
+{
+    send_payload_result(payload, payload_options, intermediary);
+}
+
+inline void wamp_invocation_impl::result_payload(
+        const wamp_bytes_view& payload, const wamp_payload_options& payload_options)
+{
+    send_payload_result(payload, payload_options, final);
+}
+
+inline void wamp_invocation_impl::result_chunked(wamp_chunk_source&& source, std::size_t chunk_size)
+{
+    if (chunk_size == 0) {
+        throw std::invalid_argument("chunk size must not be 0");
+    }
+    auto sink = lock_sink();
+    if (!sink) {
+        return;
+    }
+
+    // The transfer replies from here on; no other reply may be sent.
+    m_sendable = false;
+
+    auto transfer = std::make_shared<chunked_transfer>();
+    transfer->source = std::move(source);
+    transfer->chunk.resize(chunk_size);
+
+    wamp_invocation self(this);
+    sink->defer_reply([self, transfer]() {
+        self->send_chunk(transfer);
+    });
+}
+
+inline void wamp_invocation_impl::send_chunk(const std::shared_ptr<chunked_transfer>& transfer)
+{
+    auto sink = m_sink.lock();
+    if (!sink) {
+        return;
+    }
+
+    // The transfer made the invocation unsendable for other replies, so
+    // errors are sent without checking it.
+    std::vector<char>& chunk = transfer->chunk;
+    std::size_t size = 0;
+    bool complete = false;
+    try {
+        while (!complete) {
+            if (size == chunk.size()) {
+                if (m_progressive_results_expected || size > MAX_UNCHUNKED_RESULT_SIZE) {
+                    break;
+                }
+                // The caller takes the result in one piece only, one byte
+                // past the limit telling whether it is exceeded.
+                chunk.resize(std::min(chunk.size() * 2, MAX_UNCHUNKED_RESULT_SIZE + 1));
+            }
+            std::size_t written = transfer->source(chunk.data() + size, chunk.size() - size);
+            complete = written == 0;
+            size += written;
+        }
+    } catch (const std::exception& e) {
+        std::map<std::string, std::string> error_kw_arguments;
+        error_kw_arguments["what"] = e.what();
+        send_error(sink, "wamp.error.runtime_error", EMPTY_ARGUMENTS, error_kw_arguments);
+        return;
+    }
+
+    if (!m_progressive_results_expected && size > MAX_UNCHUNKED_RESULT_SIZE) {
+        std::map<std::string, std::string> error_kw_arguments;
+        error_kw_arguments["what"] = "the result is too large to be sent without progressive results";
+        send_error(sink, "wamp.error.invalid_argument", EMPTY_ARGUMENTS, error_kw_arguments);
+        return;
+    }
+
+    send_binary_result(sink, wamp_bytes_view(chunk.data(), size), wamp_payload_options(),
+            complete ? final : intermediary);
+    if (complete) {
+        return;
+    }
+
+    wamp_invocation self(this);
+    sink->defer_reply([self, transfer]() {
+        self->send_chunk(transfer);
+    });
+}
+
+template <typename... T>
+inline void wamp_invocation_impl::packed_result(const T&... values)
+{
+    auto sink = lock_sink();
+    if (!sink) {
+        return;
+    }
+
+    // [YIELD, INVOCATION.Request|id, Options|dict, Arguments|list]
+    msgpack::sbuffer buffer = sink->acquire_reply_buffer();
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(4);
+    packer.pack(static_cast<int>(message_type::YIELD));
+    packer.pack(m_request_id);
+    packer.pack_map(0);
+    packer.pack_array(sizeof...(T));
+    int expand[] = { 0, (packer.pack(values), 0)... };
+    (void) expand;
+
+    send_reply(sink, std::move(buffer), true);
+}
+
+inline void wamp_invocation_impl::error(const std::string& error_uri)
+{
+    auto sink = lock_sink();
+    if (!sink) {
+        return;
+    }
 
     // [ERROR, INVOCATION, INVOCATION.Request|id, Details|dict, Error|uri]
-    auto message = std::make_shared<wamp_message>(5);
-    message->set_field(0, static_cast<int>(message_type::ERROR));
-    message->set_field(1, static_cast<int>(message_type::INVOCATION));
-    message->set_field(2, m_request_id);
-    message->set_field(3, std::map<int, int>() /* No details */);
-    message->set_field(4, error_uri);
+    msgpack::sbuffer buffer = sink->acquire_reply_buffer();
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(5);
+    packer.pack(static_cast<int>(message_type::ERROR));
+    packer.pack(static_cast<int>(message_type::INVOCATION));
+    packer.pack(m_request_id);
+    packer.pack_map(0); // No details
+    packer.pack(error_uri);
 
-    m_send_result_fn(message);
-    m_send_result_fn = send_result_fn();
+    send_reply(sink, std::move(buffer), true);
 }
 
 template <typename List>
 inline void wamp_invocation_impl::error(const std::string& error_uri, const List& arguments)
 {
-    throw_if_not_sendable();
+    auto sink = lock_sink();
+    if (!sink) {
+        return;
+    }
 
     // [ERROR, INVOCATION, INVOCATION.Request|id, Details|dict, Error|uri, Arguments|list]
-    auto message = std::make_shared<wamp_message>(6);
-    message->set_field(0, static_cast<int>(message_type::ERROR));
-    message->set_field(1, static_cast<int>(message_type::INVOCATION));
-    message->set_field(2, m_request_id);
-    message->set_field(3, std::map<int, int>() /* No details */);
-    message->set_field(4, error_uri);
-    message->set_field(5, arguments);
+    msgpack::sbuffer buffer = sink->acquire_reply_buffer();
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(6);
+    packer.pack(static_cast<int>(message_type::ERROR));
+    packer.pack(static_cast<int>(message_type::INVOCATION));
+    packer.pack(m_request_id);
+    packer.pack_map(0); // No details
+    packer.pack(error_uri);
+    packer.pack(arguments);
 
-    m_send_result_fn(message);
-    m_send_result_fn = send_result_fn();
+    send_reply(sink, std::move(buffer), true);
 }
 
 template <typename List, typename Map>
@@ -322,31 +648,45 @@ inline void wamp_invocation_impl::error(
         const std::string& error_uri,
         const List& arguments, const Map& kw_arguments)
 {
-    throw_if_not_sendable();
+    auto sink = lock_sink();
+    if (!sink) {
+        return;
+    }
 
+    send_error(sink, error_uri, arguments, kw_arguments);
+}
+
+template <typename List, typename Map>
+inline void wamp_invocation_impl::send_error(const std::shared_ptr<wamp_invocation_sink>& sink,
+        const std::string& error_uri, const List& arguments, const Map& kw_arguments)
+{
     // [ERROR, INVOCATION, INVOCATION.Request|id, Details|dict, Error|uri, Arguments|list, ArgumentsKw|dict]
-    auto message = std::make_shared<wamp_message>(7);
-    message->set_field(0, static_cast<int>(message_type::ERROR));
-    message->set_field(1, static_cast<int>(message_type::INVOCATION));
-    message->set_field(2, m_request_id);
-    message->set_field(3, std::map<int, int>() /* No details */);
-    message->set_field(4, error_uri);
-    message->set_field(5, arguments);
-    message->set_field(6, kw_arguments);
+    msgpack::sbuffer buffer = sink->acquire_reply_buffer();
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(7);
+    packer.pack(static_cast<int>(message_type::ERROR));
+    packer.pack(static_cast<int>(message_type::INVOCATION));
+    packer.pack(m_request_id);
+    packer.pack_map(0); // No details
+    packer.pack(error_uri);
+    packer.pack(arguments);
+    packer.pack(kw_arguments);
 
-    m_send_result_fn(message);
-    m_send_result_fn = send_result_fn();
+    send_reply(sink, std::move(buffer), true);
 }
 
-inline void wamp_invocation_impl::set_send_result_fn(send_result_fn&& send_result)
+inline void wamp_invocation_impl::set_sink(const std::weak_ptr<wamp_invocation_sink>& sink, bool local)
 {
-    m_send_result_fn = std::move(send_result);
+    m_sink = sink;
+    m_local = local;
+    m_sendable = true;
 }
 
 inline void wamp_invocation_impl::set_details(const msgpack::object& details)
 {
     m_uri = std::move(value_for_key_or<std::string>(details, "procedure", std::string()));
     m_progressive_results_expected = value_for_key_or<bool>(details, "receive_progress", false);
+    m_payload_options.read(details);
 }
 
 inline void wamp_invocation_impl::set_request_id(std::uint64_t request_id)
@@ -364,6 +704,47 @@ inline void wamp_invocation_impl::set_zone(msgpack::zone&& zone)
     m_zone = std::move(zone);
 }
 
+inline void wamp_invocation_impl::set_zone(
+        msgpack::zone&& zone, const std::shared_ptr<wamp_zone_pool>& zone_pool)
+{
+    m_zone = std::move(zone);
+    m_zone_pool = zone_pool;
+}
+
+inline wamp_array_view wamp_invocation_impl::arguments_view() const
+{
+    return m_arguments.type == msgpack::type::ARRAY
+            ? wamp_array_view(m_arguments.via.array) : wamp_array_view();
+}
+
+inline wamp_map_view wamp_invocation_impl::kw_arguments_view() const
+{
+    return m_kw_arguments.type == msgpack::type::MAP
+            ? wamp_map_view(m_kw_arguments.via.map) : wamp_map_view();
+}
+
+template <typename View>
+inline View wamp_invocation_impl::argument_view(std::size_t index) const
+{
+    if (m_arguments.type != msgpack::type::ARRAY || m_arguments.via.array.size <= index) {
+        throw std::out_of_range("no argument at index " + boost::lexical_cast<std::string>(index));
+    }
+    return view_of<View>(m_arguments.via.array.ptr[index]);
+}
+
+template <typename View>
+inline View wamp_invocation_impl::kw_argument_view(wamp_string_view key) const
+{
+    if (m_kw_arguments.type != msgpack::type::MAP) {
+        throw msgpack::type_error();
+    }
+    const msgpack::object* value = m_kw_index.find(wamp_map_view(m_kw_arguments.via.map), key);
+    if (!value) {
+        throw std::out_of_range(key.to_string() + " keyword argument doesn't exist");
+    }
+    return view_of<View>(*value);
+}
+
 inline void wamp_invocation_impl::set_arguments(const msgpack::object& arguments)
 {
     m_arguments = arguments;
@@ -372,11 +753,45 @@ inline void wamp_invocation_impl::set_arguments(const msgpack::object& arguments
 inline void wamp_invocation_impl::set_kw_arguments(const msgpack::object& kw_arguments)
 {
     m_kw_arguments = kw_arguments;
+    m_kw_index.reset();
+}
+
+inline wamp_bytes_view wamp_invocation_impl::raw_arguments() const
+{
+    return m_raw_arguments;
+}
+
+inline wamp_bytes_view wamp_invocation_impl::raw_kw_arguments() const
+{
+    return m_raw_kw_arguments;
+}
+
+inline void wamp_invocation_impl::set_raw_arguments(const wamp_bytes_view& raw_arguments)
+{
+    m_raw_arguments = raw_arguments;
+}
+
+inline void wamp_invocation_impl::set_raw_kw_arguments(const wamp_bytes_view& raw_kw_arguments)
+{
+    m_raw_kw_arguments = raw_kw_arguments;
+}
+
+inline const wamp_payload_options& wamp_invocation_impl::payload_options() const
+{
+    return m_payload_options;
+}
+
+inline wamp_bytes_view wamp_invocation_impl::payload() const
+{
+    if (!m_payload_options.is_set()) {
+        throw std::bad_cast();
+    }
+    return payload_argument(m_arguments);
 }
 
 inline bool wamp_invocation_impl::sendable() const
 {
-    return static_cast<bool>(m_send_result_fn);
+    return m_sendable;
 }
 
 inline void wamp_invocation_impl::throw_if_not_sendable() const
@@ -387,4 +802,26 @@ inline void wamp_invocation_impl::throw_if_not_sendable() const
     }
 }
 
+inline std::shared_ptr<wamp_invocation_sink> wamp_invocation_impl::lock_sink()
+{
+    throw_if_not_sendable();
+
+    auto sink = m_sink.lock();
+    if (!sink) {
+        // The session is gone, so there is no one left to reply to.
+        m_sendable = false;
+    }
+    return sink;
+}
+
+inline void wamp_invocation_impl::send_reply(const std::shared_ptr<wamp_invocation_sink>& sink,
+        msgpack::sbuffer&& buffer, bool final_reply)
+{
+    // A failing send must not be followed by an error() reply to the same invocation.
+    if (final_reply) {
+        m_sendable = false;
+    }
+    sink->on_invocation_reply(wamp_message(std::move(buffer)), m_local);
+}
+
 } // namespace autobahn
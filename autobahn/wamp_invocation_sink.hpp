@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_INVOCATION_SINK_HPP
+#define AUTOBAHN_WAMP_INVOCATION_SINK_HPP
+
+#include "wamp_message.hpp"
+
+#include <functional>
+#include <msgpack.hpp>
+
+namespace autobahn {
+
+/*!
+ * Provides an abstraction for the session that invocations reply to.
+ */
+class wamp_invocation_sink
+{
+public:
+    /*!
+     * Called by an invocation for a buffer to pack its reply into.
+     *
+     * @return An empty buffer.
+     */
+    virtual msgpack::sbuffer acquire_reply_buffer() = 0;
+
+    /*!
+     * Called by an invocation when it replies, on whatever thread the
+     * procedure runs on.
+     *
+     * @param reply The YIELD or ERROR message.
+     * @param local Whether or not the invocation was made in process, so
+     *        that the reply goes to the calling session rather than the router.
+     */
+    virtual void on_invocation_reply(wamp_message&& reply, bool local) = 0;
+
+    /*!
+     * Called by an invocation that replies in several messages to run
+     * @p continuation on the io thread once the handlers queued there
+     * before it have run, so that other messages are sent in between.
+     */
+    virtual void defer_reply(std::function<void()>&& continuation) = 0;
+
+    /*!
+     * Default virtual destructor.
+     */
+    virtual ~wamp_invocation_sink() = default;
+};
+
+} // namespace autobahn
+
+#endif // AUTOBAHN_WAMP_INVOCATION_SINK_HPP
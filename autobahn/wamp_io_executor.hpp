@@ -0,0 +1,161 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_IO_EXECUTOR_HPP
+#define AUTOBAHN_WAMP_IO_EXECUTOR_HPP
+
+#include "boost_config.hpp"
+
+#include <atomic>
+#include <boost/asio/io_service.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/executors/executor.hpp>
+#include <boost/thread/future.hpp>
+#include <thread>
+
+namespace autobahn {
+
+/*!
+ * A boost executor that runs submitted closures on an io service.
+ *
+ * The session binds every future it hands out to one of these (see
+ * bind_executor()), so a continuation attached with `future.then(fn)` runs
+ * on the session's io service thread. Without it boost falls back to
+ * launching a new thread for each continuation.
+ *
+ * Closures are dispatched, i.e. they run inline when the submitting thread
+ * is already running the io service (which is the case whenever the session
+ * satisfies a promise) and are posted otherwise.
+ *
+ * The executor knows the io service thread from set_io_thread(), which the
+ * session calls from its handlers, as io_service::executor_type is not
+ * available with all supported Boost versions.
+ */
+class wamp_io_executor : public boost::executors::executor
+{
+public:
+    /*!
+     * Constructs an executor for the given io service.
+     *
+     * @param io_service The io service to run closures on. It must outlive
+     *        the executor.
+     */
+    wamp_io_executor(boost::asio::io_service& io_service);
+
+    virtual ~wamp_io_executor() override = default;
+
+    /*!
+     * Closes the executor. Closures submitted after closing are run inline
+     * on the submitting thread so that pending continuations are never lost.
+     */
+    virtual void close() override;
+
+    /*!
+     * Whether the executor has been closed.
+     */
+    virtual bool closed() override;
+
+    /*!
+     * Schedules the closure for execution on the io service, or runs it
+     * right away if called on a thread running the io service.
+     */
+    virtual void submit(work&& closure) override;
+
+    /*!
+     * Runs at most one ready handler of the io service.
+     *
+     * @return Whether a handler has been executed.
+     */
+    virtual bool try_executing_one() override;
+
+    /*!
+     * The io service closures are run on.
+     */
+    boost::asio::io_service& io_service();
+
+    /*!
+     * Records the calling thread as the one running the io service. Call
+     * this from handlers run by the io service.
+     */
+    void set_io_thread();
+
+    /*!
+     * Whether the calling thread is the one last recorded by set_io_thread().
+     */
+    bool running_in_io_thread() const;
+
+private:
+    boost::asio::io_service& m_io_service;
+    std::atomic<bool> m_closed;
+    std::atomic<std::thread::id> m_io_thread;
+};
+
+/*!
+ * Returns the future of @p promise, whose continuations run on @p executor
+ * unless a launch policy is given to then().
+ *
+ * The executor is set on the shared state of the promise, which keeps it
+ * alive, so continuations may still be attached after whoever handed out
+ * the future has gone away. No further shared state is created, except
+ * for `promise<void>`, which cannot be given an executor and is bound as a
+ * future instead.
+ *
+ * @param executor The executor to run continuations on.
+ * @param promise The promise whose future to bind.
+ * @return The bound future.
+ */
+template <typename T>
+boost::future<T> bind_executor(
+        const boost::shared_ptr<wamp_io_executor>& executor, boost::promise<T>& promise);
+
+boost::future<void> bind_executor(
+        const boost::shared_ptr<wamp_io_executor>& executor, boost::promise<void>& promise);
+
+/*!
+ * Returns a future that is satisfied with the outcome of @p future and whose
+ * continuations run on @p executor unless a launch policy is given to then().
+ *
+ * This is meant for futures that are not backed by a promise of ours, e.g.
+ * those returned by then(). Prefer binding the promise where there is one.
+ *
+ * @param executor The executor to run continuations on.
+ * @param future The future to bind.
+ * @return The bound future.
+ */
+template <typename T>
+boost::future<T> bind_executor(
+        const boost::shared_ptr<wamp_io_executor>& executor, boost::future<T>&& future);
+
+} // namespace autobahn
+
+#include "wamp_io_executor.ipp"
+
+#endif // AUTOBAHN_WAMP_IO_EXECUTOR_HPP
@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <memory>
+
+namespace autobahn {
+
+inline wamp_io_executor::wamp_io_executor(boost::asio::io_service& io_service)
+    : m_io_service(io_service)
+    , m_closed(false)
+    , m_io_thread(std::thread::id())
+{
+}
+
+inline void wamp_io_executor::close()
+{
+    m_closed = true;
+}
+
+inline bool wamp_io_executor::closed()
+{
+    return m_closed;
+}
+
+inline void wamp_io_executor::submit(work&& closure)
+{
+    if (m_closed || m_io_service.stopped()) {
+        closure();
+        return;
+    }
+
+    // Continuations of promises fulfilled on the io thread run right away,
+    // as dispatch() would run them, without allocating a shared copy.
+    if (running_in_io_thread()) {
+        closure();
+        return;
+    }
+
+    // The work type is move-only, so hand a shared copy to the io service.
+    auto shared_closure = std::make_shared<work>(std::move(closure));
+    m_io_service.dispatch([shared_closure]() {
+        (*shared_closure)();
+    });
+}
+
+inline bool wamp_io_executor::try_executing_one()
+{
+    return m_io_service.poll_one() > 0;
+}
+
+inline boost::asio::io_service& wamp_io_executor::io_service()
+{
+    return m_io_service;
+}
+
+inline void wamp_io_executor::set_io_thread()
+{
+    m_io_thread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+}
+
+inline bool wamp_io_executor::running_in_io_thread() const
+{
+    return m_io_thread.load(std::memory_order_relaxed) == std::this_thread::get_id();
+}
+
+template <typename T>
+inline boost::future<T> bind_executor(
+        const boost::shared_ptr<wamp_io_executor>& executor, boost::promise<T>& promise)
+{
+    promise.set_executor(executor);
+    return promise.get_future();
+}
+
+inline boost::future<void> bind_executor(
+        const boost::shared_ptr<wamp_io_executor>& executor, boost::promise<void>& promise)
+{
+    // boost::promise<void> cannot be given an executor.
+    return bind_executor(executor, promise.get_future());
+}
+
+template <typename T>
+inline boost::future<T> bind_executor(
+        const boost::shared_ptr<wamp_io_executor>& executor, boost::future<T>&& future)
+{
+    // The continuation holds on to the executor, which the returned future
+    // refers to, until continuations attached to that future are launched.
+    return future.then(*executor, [executor](boost::future<T> ready) {
+        return ready.get();
+    });
+}
+
+} // namespace autobahn
@@ -0,0 +1,96 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_LOCAL_PROCEDURES_HPP
+#define AUTOBAHN_WAMP_LOCAL_PROCEDURES_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace autobahn {
+
+class wamp_session;
+
+/*!
+ * The procedures provided by the sessions of a process, by URI, for
+ * calling them without a round trip through the router.
+ *
+ * Sessions opt in with wamp_session::set_local_procedures(), and enter
+ * their exact-match, single-callee registrations here once the router
+ * has acknowledged them. Sessions sharing an instance call each other's
+ * procedures directly. Safe to share between sessions running on
+ * different threads.
+ */
+class wamp_local_procedures
+{
+public:
+    wamp_local_procedures();
+
+    wamp_local_procedures(const wamp_local_procedures& other) = delete;
+    wamp_local_procedures& operator=(const wamp_local_procedures& other) = delete;
+
+    /*!
+     * Enters the registration of a procedure, replacing an earlier one for
+     * the same URI.
+     */
+    void add(const std::string& uri, const std::weak_ptr<wamp_session>& session,
+            uint64_t registration_id);
+
+    /*!
+     * Removes the registration of a procedure, unless the URI has been
+     * registered again since under another registration id.
+     */
+    void remove(const std::string& uri, uint64_t registration_id);
+
+    /*!
+     * The session providing the procedure with the given URI and the id of
+     * its registration, or nullptr if no live session provides it.
+     */
+    std::shared_ptr<wamp_session> find(const std::string& uri, uint64_t& registration_id) const;
+
+private:
+    struct registration
+    {
+        std::weak_ptr<wamp_session> session;
+        uint64_t id;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, registration> m_registrations;
+};
+
+} // namespace autobahn
+
+#include "wamp_local_procedures.ipp"
+
+#endif // AUTOBAHN_WAMP_LOCAL_PROCEDURES_HPP
@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+namespace autobahn {
+
+inline wamp_local_procedures::wamp_local_procedures()
+    : m_mutex()
+    , m_registrations()
+{
+}
+
+inline void wamp_local_procedures::add(
+        const std::string& uri, const std::weak_ptr<wamp_session>& session, uint64_t registration_id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_registrations[uri] = registration{session, registration_id};
+}
+
+inline void wamp_local_procedures::remove(const std::string& uri, uint64_t registration_id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto itr = m_registrations.find(uri);
+    if (itr != m_registrations.end() && itr->second.id == registration_id) {
+        m_registrations.erase(itr);
+    }
+}
+
+inline std::shared_ptr<wamp_session> wamp_local_procedures::find(
+        const std::string& uri, uint64_t& registration_id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto itr = m_registrations.find(uri);
+    if (itr == m_registrations.end()) {
+        return std::shared_ptr<wamp_session>();
+    }
+
+    registration_id = itr->second.id;
+    return itr->second.session.lock();
+}
+
+} // namespace autobahn
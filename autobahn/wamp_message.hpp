@@ -31,6 +31,8 @@
 #ifndef AUTOBAHN_WAMP_MESSAGE_HPP
 #define AUTOBAHN_WAMP_MESSAGE_HPP
 
+#include "wamp_object_view.hpp"
+
 #include <cstddef>
 #include <msgpack.hpp>
 #include <vector>
@@ -82,6 +84,16 @@ public:
      */
     wamp_message(message_fields&& fields, msgpack::zone&& zone);
 
+    /*!
+     * Constructs a wamp message from its msgpack serialization. The fields
+     * are only unpacked when they are accessed, so a message that has been
+     * packed straight into a buffer reaches the transport without any
+     * msgpack objects being created.
+     *
+     * @param buffer The serialized message.
+     */
+    explicit wamp_message(msgpack::sbuffer&& buffer);
+
     wamp_message(const wamp_message& other) = delete;
     wamp_message(wamp_message&& other);
 
@@ -158,24 +170,118 @@ public:
      */
     msgpack::zone&& zone();
 
+    /*!
+     * Pilfers the serialized message. The message must not be used
+     * afterwards.
+     *
+     * @return The serialized message.
+     */
+    msgpack::sbuffer&& buffer();
+
+    /*!
+     * Determines if the message holds its serialized representation.
+     *
+     * @return Whether or not the message is serialized.
+     */
+    bool is_serialized() const;
+
+    /*!
+     * Serializes the message fields, unless the message has already been
+     * serialized.
+     *
+     * @return The serialized message.
+     */
+    const msgpack::sbuffer& serialize();
+
+    /*!
+     * The bytes the field at the specified index was received as, still
+     * msgpack-encoded. Only messages decoded with their raw fields kept
+     * have them, see set_raw_fields(); for all others, and for a field that
+     * has been set since, the view is empty.
+     *
+     * The bytes live in the message zone, so they stay valid as long as
+     * the zone does, even after it has been pilfered.
+     *
+     * @param index The index of the target field.
+     *
+     * @return The encoded field, or an empty view.
+     */
+    wamp_bytes_view raw_field(std::size_t index) const;
+
+    /*!
+     * Sets the encoded bytes of all fields, one view per field. The views
+     * must be allocated in the message zone, as must the bytes they view.
+     *
+     * @param raw_fields The encoded fields.
+     */
+    void set_raw_fields(const wamp_bytes_view* raw_fields);
+
 private:
+    /*!
+     * Unpacks the serialized message into its fields, if not done already.
+     */
+    void unpack_fields() const;
+
     /*!
      * The zone used to allocate message fields. The zone must outlive
      * the fields. If the fields are pilfered then the zone must also
      * be pilferred and stored along with the fields.
      */
-    msgpack::zone m_zone;
+    mutable msgpack::zone m_zone;
 
     /*!
      * The fields comprising of the message. It is up to the user of this
      * class to ensure that a valid wamp message has been constructed.
+     * For a serialized message they are unpacked on first access.
      */
-    message_fields m_fields;
+    mutable message_fields m_fields;
+
+    /*!
+     * The encoded fields as received, one per field, or nullptr if they
+     * were not kept. Allocated in the zone.
+     */
+    const wamp_bytes_view* m_raw_fields;
+
+    /*!
+     * The serialized message, valid if m_serialized is set.
+     */
+    msgpack::sbuffer m_buffer;
+
+    /*!
+     * Whether m_buffer holds the serialization of the current fields.
+     */
+    bool m_serialized;
+
+    /*!
+     * Whether m_fields holds the current fields.
+     */
+    mutable bool m_unpacked;
 };
 
 /// Convenience operator for outputting a raw wamp message.
 std::ostream& operator<<(std::ostream& os, const wamp_message& message);
 
+/*!
+ * The number of fields that pack_raw_arguments() appends for the given
+ * arguments: none if both are empty, the Arguments if only they are given
+ * and both otherwise.
+ */
+std::size_t raw_argument_fields(const wamp_bytes_view& arguments, const wamp_bytes_view& kw_arguments);
+
+/*!
+ * Appends pre-encoded Arguments|list and ArgumentsKw|dict fields to a
+ * message being packed into @p buffer, copying the bytes as they are. If
+ * only keyword arguments are given, an empty list is written for the
+ * positional ones. Throws std::invalid_argument if the arguments are not
+ * an encoded array or the keyword arguments not an encoded map.
+ *
+ * @param buffer The buffer the message is packed into.
+ * @param arguments The encoded positional arguments, or an empty view.
+ * @param kw_arguments The encoded keyword arguments, or an empty view.
+ */
+void pack_raw_arguments(msgpack::sbuffer& buffer,
+        const wamp_bytes_view& arguments, const wamp_bytes_view& kw_arguments);
+
 } // namespace autobahn
 
 #include "wamp_message.ipp"
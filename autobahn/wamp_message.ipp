@@ -37,25 +37,52 @@ namespace autobahn {
 inline wamp_message::wamp_message(std::size_t num_fields)
     : m_zone()
     , m_fields(num_fields)
+    , m_raw_fields(nullptr)
+    , m_buffer(0)
+    , m_serialized(false)
+    , m_unpacked(true)
 {
 }
 
 inline wamp_message::wamp_message(std::size_t num_fields, msgpack::zone&& zone)
     : m_zone(std::move(zone))
     , m_fields(num_fields)
+    , m_raw_fields(nullptr)
+    , m_buffer(0)
+    , m_serialized(false)
+    , m_unpacked(true)
 {
 }
 
 inline wamp_message::wamp_message(message_fields&& fields, msgpack::zone&& zone)
     : m_zone(std::move(zone))
     , m_fields(std::move(fields))
+    , m_raw_fields(nullptr)
+    , m_buffer(0)
+    , m_serialized(false)
+    , m_unpacked(true)
+{
+}
+
+inline wamp_message::wamp_message(msgpack::sbuffer&& buffer)
+    : m_zone()
+    , m_fields()
+    , m_raw_fields(nullptr)
+    , m_buffer(std::move(buffer))
+    , m_serialized(true)
+    , m_unpacked(false)
 {
 }
 
 inline wamp_message::wamp_message(wamp_message&& other)
+    : m_buffer(0)
 {
     m_zone = std::move(other.m_zone);
     m_fields = std::move(other.m_fields);
+    m_raw_fields = other.m_raw_fields;
+    m_buffer = std::move(other.m_buffer);
+    m_serialized = other.m_serialized;
+    m_unpacked = other.m_unpacked;
 }
 
 inline wamp_message& wamp_message::operator=(wamp_message&& other)
@@ -66,12 +93,17 @@ inline wamp_message& wamp_message::operator=(wamp_message&& other)
 
     m_zone = std::move(other.m_zone);
     m_fields = std::move(other.m_fields);
+    m_raw_fields = other.m_raw_fields;
+    m_buffer = std::move(other.m_buffer);
+    m_serialized = other.m_serialized;
+    m_unpacked = other.m_unpacked;
 
     return *this;
 }
 
 inline const msgpack::object& wamp_message::field(std::size_t index) const
 {
+    unpack_fields();
     if (index >= m_fields.size()) {
         throw std::out_of_range("invalid message field index");
     }
@@ -82,6 +114,7 @@ inline const msgpack::object& wamp_message::field(std::size_t index) const
 template <typename Type>
 inline Type wamp_message::field(std::size_t index)
 {
+    unpack_fields();
     if (index >= m_fields.size()) {
         throw std::out_of_range("invalid message field index");
     }
@@ -92,15 +125,19 @@ inline Type wamp_message::field(std::size_t index)
 template <typename Type>
 inline void wamp_message::set_field(std::size_t index, const Type& type)
 {
+    unpack_fields();
     if (index >= m_fields.size()) {
         throw std::out_of_range("invalid message field index");
     }
 
     m_fields[index] = msgpack::object(type, m_zone);
+    m_raw_fields = nullptr;
+    m_serialized = false;
 }
 
 inline bool wamp_message::is_field_type(std::size_t index, msgpack::type::object_type type) const
 {
+    unpack_fields();
     if (index >= m_fields.size()) {
         throw std::out_of_range("invalid message field index");
     }
@@ -110,19 +147,78 @@ inline bool wamp_message::is_field_type(std::size_t index, msgpack::type::object
 
 inline std::size_t wamp_message::size() const
 {
+    unpack_fields();
     return m_fields.size();
 }
 
+inline const wamp_message::message_fields& wamp_message::fields() const
+{
+    unpack_fields();
+    return m_fields;
+}
+
 inline wamp_message::message_fields&& wamp_message::fields()
 {
+    unpack_fields();
     return std::move(m_fields);
 }
 
 inline msgpack::zone&& wamp_message::zone()
 {
+    unpack_fields();
     return std::move(m_zone);
 }
 
+inline msgpack::sbuffer&& wamp_message::buffer()
+{
+    m_serialized = false;
+    return std::move(m_buffer);
+}
+
+inline bool wamp_message::is_serialized() const
+{
+    return m_serialized;
+}
+
+inline const msgpack::sbuffer& wamp_message::serialize()
+{
+    if (!m_serialized) {
+        m_buffer.clear();
+        msgpack::packer<msgpack::sbuffer> packer(m_buffer);
+        packer.pack(m_fields);
+        m_serialized = true;
+    }
+
+    return m_buffer;
+}
+
+inline wamp_bytes_view wamp_message::raw_field(std::size_t index) const
+{
+    if (!m_raw_fields || index >= m_fields.size()) {
+        return wamp_bytes_view();
+    }
+
+    return m_raw_fields[index];
+}
+
+inline void wamp_message::set_raw_fields(const wamp_bytes_view* raw_fields)
+{
+    m_raw_fields = raw_fields;
+}
+
+inline void wamp_message::unpack_fields() const
+{
+    if (m_unpacked) {
+        return;
+    }
+
+    msgpack::unpacked result;
+    msgpack::unpack(result, m_buffer.data(), m_buffer.size());
+    result.get().convert(m_fields);
+    m_zone = std::move(*(result.zone()));
+    m_unpacked = true;
+}
+
 inline std::ostream& operator<<(std::ostream& os, const wamp_message& message)
 {
     std::size_t num_fields = message.size();
@@ -149,4 +245,41 @@ inline std::ostream& operator<<(std::ostream& os, const wamp_message& message)
     return os;
 }
 
+inline std::size_t raw_argument_fields(const wamp_bytes_view& arguments, const wamp_bytes_view& kw_arguments)
+{
+    if (!kw_arguments.empty()) {
+        return 2;
+    }
+    return arguments.empty() ? 0 : 1;
+}
+
+inline void pack_raw_arguments(msgpack::sbuffer& buffer,
+        const wamp_bytes_view& arguments, const wamp_bytes_view& kw_arguments)
+{
+    // Only the leading byte is checked: fixarray, array 16 or array 32 and
+    // fixmap, map 16 or map 32. The rest is passed on as it is.
+    if (!arguments.empty()) {
+        unsigned char format = static_cast<unsigned char>(arguments.data()[0]);
+        if ((format & 0xf0) != 0x90 && format != 0xdc && format != 0xdd) {
+            throw std::invalid_argument("raw arguments must be an encoded array");
+        }
+    }
+    if (!kw_arguments.empty()) {
+        unsigned char format = static_cast<unsigned char>(kw_arguments.data()[0]);
+        if ((format & 0xf0) != 0x80 && format != 0xde && format != 0xdf) {
+            throw std::invalid_argument("raw keyword arguments must be an encoded map");
+        }
+    }
+
+    if (!arguments.empty()) {
+        buffer.write(arguments.data(), arguments.size());
+    } else if (!kw_arguments.empty()) {
+        msgpack::packer<msgpack::sbuffer> packer(buffer);
+        packer.pack_array(0);
+    }
+    if (!kw_arguments.empty()) {
+        buffer.write(kw_arguments.data(), kw_arguments.size());
+    }
+}
+
 } // namespace autobahn
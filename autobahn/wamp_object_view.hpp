@@ -0,0 +1,203 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_OBJECT_VIEW_HPP
+#define AUTOBAHN_WAMP_OBJECT_VIEW_HPP
+
+#include <atomic>
+#include <boost/utility/string_view.hpp>
+#include <cstddef>
+#include <msgpack.hpp>
+#include <unordered_map>
+
+namespace autobahn {
+
+/*!
+ * Non-owning view of a msgpack STR field.
+ */
+using wamp_string_view = boost::string_view;
+
+/*!
+ * Non-owning view of the bytes of a msgpack BIN field.
+ */
+class wamp_bytes_view
+{
+public:
+    wamp_bytes_view();
+    wamp_bytes_view(const char* data, std::size_t size);
+
+    const char* data() const;
+    std::size_t size() const;
+    bool empty() const;
+
+    const char* begin() const;
+    const char* end() const;
+
+private:
+    const char* m_data;
+    std::size_t m_size;
+};
+
+/*!
+ * Non-owning view of the elements of a msgpack ARRAY field.
+ */
+class wamp_array_view
+{
+public:
+    wamp_array_view();
+    explicit wamp_array_view(const msgpack::object_array& array);
+
+    std::size_t size() const;
+    bool empty() const;
+
+    /*!
+     * The element at the given @p index.
+     *
+     * @throw std::out_of_range
+     */
+    const msgpack::object& at(std::size_t index) const;
+    const msgpack::object& operator[](std::size_t index) const;
+
+    const msgpack::object* begin() const;
+    const msgpack::object* end() const;
+
+private:
+    const msgpack::object* m_elements;
+    std::size_t m_size;
+};
+
+/*!
+ * Non-owning view of the entries of a msgpack MAP field.
+ *
+ * Lookups compare keys in place and are O(n) with n being the number
+ * of entries, without allocating.
+ */
+class wamp_map_view
+{
+public:
+    wamp_map_view();
+    explicit wamp_map_view(const msgpack::object_map& map);
+
+    std::size_t size() const;
+    bool empty() const;
+
+    /*!
+     * The value for the given string @p key, or nullptr if there is none.
+     */
+    const msgpack::object* find(wamp_string_view key) const;
+
+    /*!
+     * The value for the given string @p key.
+     *
+     * @throw std::out_of_range
+     */
+    const msgpack::object& at(wamp_string_view key) const;
+
+    const msgpack::object_kv* begin() const;
+    const msgpack::object_kv* end() const;
+
+private:
+    const msgpack::object_kv* m_entries;
+    std::size_t m_size;
+};
+
+/*!
+ * Lazily built hash index over the string keys of a msgpack MAP.
+ *
+ * Maps with fewer than MIN_INDEXED_SIZE entries are scanned linearly. For
+ * larger maps the index is built on the first lookup, which makes every
+ * further lookup O(1) instead of O(n). The index points into the zone that
+ * owns the map; its owner must reset() it whenever the map changes.
+ *
+ * Concurrent lookups are safe: if two threads race to build the index, one
+ * of them discards its copy.
+ */
+class wamp_map_index
+{
+public:
+    /*!
+     * The number of map entries from which on an index is built.
+     */
+    static const std::size_t MIN_INDEXED_SIZE = 16;
+
+    wamp_map_index();
+    wamp_map_index(const wamp_map_index& other) = delete;
+    wamp_map_index(wamp_map_index&& other);
+    ~wamp_map_index();
+
+    wamp_map_index& operator=(const wamp_map_index& other) = delete;
+    wamp_map_index& operator=(wamp_map_index&& other);
+
+    /*!
+     * The value for the given string @p key in @p map, or nullptr if there
+     * is none. The same map must be passed until the index is reset.
+     */
+    const msgpack::object* find(const wamp_map_view& map, wamp_string_view key) const;
+
+    /*!
+     * Whether an index has been built.
+     */
+    bool indexed() const;
+
+    /*!
+     * Drops the index, if any.
+     */
+    void reset();
+
+private:
+    struct key_hash
+    {
+        std::size_t operator()(wamp_string_view key) const;
+    };
+
+    using index_type = std::unordered_map<wamp_string_view, const msgpack::object*, key_hash>;
+
+    mutable std::atomic<index_type*> m_index;
+};
+
+/*!
+ * Returns a view of type View onto the given msgpack @p object, where View
+ * is one of wamp_string_view, wamp_bytes_view, wamp_array_view or
+ * wamp_map_view. The view points into the zone owning @p object and must
+ * not outlive it.
+ *
+ * Example:
+ * `wamp_string_view name = view_of<wamp_string_view>(event.arguments_view()[0]);`
+ *
+ * @throw msgpack::type_error if the object is not of the matching type.
+ */
+template <typename View>
+View view_of(const msgpack::object& object);
+
+} // namespace autobahn
+
+#include "wamp_object_view.ipp"
+
+#endif // AUTOBAHN_WAMP_OBJECT_VIEW_HPP
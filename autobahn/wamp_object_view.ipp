@@ -0,0 +1,304 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <boost/functional/hash.hpp>
+#include <boost/lexical_cast.hpp>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace autobahn {
+
+inline wamp_bytes_view::wamp_bytes_view()
+    : m_data(nullptr)
+    , m_size(0)
+{
+}
+
+inline wamp_bytes_view::wamp_bytes_view(const char* data, std::size_t size)
+    : m_data(data)
+    , m_size(size)
+{
+}
+
+inline const char* wamp_bytes_view::data() const
+{
+    return m_data;
+}
+
+inline std::size_t wamp_bytes_view::size() const
+{
+    return m_size;
+}
+
+inline bool wamp_bytes_view::empty() const
+{
+    return m_size == 0;
+}
+
+inline const char* wamp_bytes_view::begin() const
+{
+    return m_data;
+}
+
+inline const char* wamp_bytes_view::end() const
+{
+    return m_data + m_size;
+}
+
+inline wamp_array_view::wamp_array_view()
+    : m_elements(nullptr)
+    , m_size(0)
+{
+}
+
+inline wamp_array_view::wamp_array_view(const msgpack::object_array& array)
+    : m_elements(array.ptr)
+    , m_size(array.size)
+{
+}
+
+inline std::size_t wamp_array_view::size() const
+{
+    return m_size;
+}
+
+inline bool wamp_array_view::empty() const
+{
+    return m_size == 0;
+}
+
+inline const msgpack::object& wamp_array_view::at(std::size_t index) const
+{
+    if (index >= m_size) {
+        throw std::out_of_range("no element at index " + boost::lexical_cast<std::string>(index));
+    }
+    return m_elements[index];
+}
+
+inline const msgpack::object& wamp_array_view::operator[](std::size_t index) const
+{
+    return m_elements[index];
+}
+
+inline const msgpack::object* wamp_array_view::begin() const
+{
+    return m_elements;
+}
+
+inline const msgpack::object* wamp_array_view::end() const
+{
+    return m_elements + m_size;
+}
+
+inline wamp_map_view::wamp_map_view()
+    : m_entries(nullptr)
+    , m_size(0)
+{
+}
+
+inline wamp_map_view::wamp_map_view(const msgpack::object_map& map)
+    : m_entries(map.ptr)
+    , m_size(map.size)
+{
+}
+
+inline std::size_t wamp_map_view::size() const
+{
+    return m_size;
+}
+
+inline bool wamp_map_view::empty() const
+{
+    return m_size == 0;
+}
+
+inline const msgpack::object* wamp_map_view::find(wamp_string_view key) const
+{
+    for (std::size_t i = 0; i < m_size; ++i) {
+        const msgpack::object_kv& kv = m_entries[i];
+        if (kv.key.type == msgpack::type::STR && key.size() == kv.key.via.str.size
+                && memcmp(key.data(), kv.key.via.str.ptr, key.size()) == 0)
+        {
+            return &kv.val;
+        }
+    }
+    return nullptr;
+}
+
+inline const msgpack::object& wamp_map_view::at(wamp_string_view key) const
+{
+    const msgpack::object* value = find(key);
+    if (!value) {
+        throw std::out_of_range(key.to_string() + " keyword argument doesn't exist");
+    }
+    return *value;
+}
+
+inline const msgpack::object_kv* wamp_map_view::begin() const
+{
+    return m_entries;
+}
+
+inline const msgpack::object_kv* wamp_map_view::end() const
+{
+    return m_entries + m_size;
+}
+
+inline wamp_map_index::wamp_map_index()
+    : m_index(nullptr)
+{
+}
+
+inline wamp_map_index::wamp_map_index(wamp_map_index&& other)
+    : m_index(other.m_index.exchange(nullptr))
+{
+}
+
+inline wamp_map_index::~wamp_map_index()
+{
+    delete m_index.load();
+}
+
+inline wamp_map_index& wamp_map_index::operator=(wamp_map_index&& other)
+{
+    if (this == &other) {
+        return *this;
+    }
+
+    delete m_index.exchange(other.m_index.exchange(nullptr));
+
+    return *this;
+}
+
+inline const msgpack::object* wamp_map_index::find(
+        const wamp_map_view& map, wamp_string_view key) const
+{
+    if (map.size() < MIN_INDEXED_SIZE) {
+        return map.find(key);
+    }
+
+    index_type* index = m_index.load(std::memory_order_acquire);
+    if (!index) {
+        std::unique_ptr<index_type> built(new index_type(map.size()));
+        for (const msgpack::object_kv& kv : map) {
+            if (kv.key.type == msgpack::type::STR) {
+                // emplace() keeps the first of duplicate keys, like map.find().
+                built->emplace(wamp_string_view(kv.key.via.str.ptr, kv.key.via.str.size), &kv.val);
+            }
+        }
+
+        if (m_index.compare_exchange_strong(index, built.get(), std::memory_order_acq_rel)) {
+            index = built.release();
+        }
+    }
+
+    auto itr = index->find(key);
+    return itr != index->end() ? itr->second : nullptr;
+}
+
+inline bool wamp_map_index::indexed() const
+{
+    return m_index.load() != nullptr;
+}
+
+inline void wamp_map_index::reset()
+{
+    delete m_index.exchange(nullptr);
+}
+
+inline std::size_t wamp_map_index::key_hash::operator()(wamp_string_view key) const
+{
+    return boost::hash_range(key.begin(), key.end());
+}
+
+namespace detail {
+
+template <typename View>
+struct object_view;
+
+template <>
+struct object_view<wamp_string_view>
+{
+    static wamp_string_view from(const msgpack::object& object)
+    {
+        if (object.type != msgpack::type::STR) {
+            throw msgpack::type_error();
+        }
+        return wamp_string_view(object.via.str.ptr, object.via.str.size);
+    }
+};
+
+template <>
+struct object_view<wamp_bytes_view>
+{
+    static wamp_bytes_view from(const msgpack::object& object)
+    {
+        if (object.type != msgpack::type::BIN) {
+            throw msgpack::type_error();
+        }
+        return wamp_bytes_view(object.via.bin.ptr, object.via.bin.size);
+    }
+};
+
+template <>
+struct object_view<wamp_array_view>
+{
+    static wamp_array_view from(const msgpack::object& object)
+    {
+        if (object.type != msgpack::type::ARRAY) {
+            throw msgpack::type_error();
+        }
+        return wamp_array_view(object.via.array);
+    }
+};
+
+template <>
+struct object_view<wamp_map_view>
+{
+    static wamp_map_view from(const msgpack::object& object)
+    {
+        if (object.type != msgpack::type::MAP) {
+            throw msgpack::type_error();
+        }
+        return wamp_map_view(object.via.map);
+    }
+};
+
+} // namespace detail
+
+template <typename View>
+inline View view_of(const msgpack::object& object)
+{
+    return detail::object_view<View>::from(object);
+}
+
+} // namespace autobahn
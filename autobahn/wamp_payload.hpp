@@ -0,0 +1,145 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_PAYLOAD_HPP
+#define AUTOBAHN_WAMP_PAYLOAD_HPP
+
+#include "wamp_object_view.hpp"
+
+#include <cstdint>
+#include <msgpack.hpp>
+#include <string>
+
+namespace autobahn {
+
+/*!
+ * The payload transparency options (ppt_*) of an opaque application
+ * payload, e.g. a protobuf message, that the WAMP layer passes on without
+ * interpreting it.
+ *
+ * They are sent in the Options of a PUBLISH, CALL or YIELD and received in
+ * the Details of the EVENT, INVOCATION or RESULT, while the payload itself
+ * travels as the only positional argument, a binary. See
+ * wamp_session::publish_payload(), wamp_session::call_payload() and
+ * wamp_invocation_impl::result_payload().
+ */
+class wamp_payload_options
+{
+public:
+    wamp_payload_options();
+    explicit wamp_payload_options(const std::string& scheme,
+            const std::string& serializer = std::string());
+
+    /*!
+     * The scheme of the payload (ppt_scheme), e.g. "x_myapp", or empty if
+     * the options are not set.
+     */
+    const std::string& scheme() const;
+    void set_scheme(const std::string& scheme);
+
+    /*!
+     * The serializer the payload was encoded with (ppt_serializer), e.g.
+     * "protobuf", or empty if not given.
+     */
+    const std::string& serializer() const;
+    void set_serializer(const std::string& serializer);
+
+    /*!
+     * The cipher the payload was encrypted with (ppt_cipher), or empty if
+     * it is not encrypted.
+     */
+    const std::string& cipher() const;
+    void set_cipher(const std::string& cipher);
+
+    /*!
+     * The id of the key the payload was encrypted with (ppt_keyid), or empty.
+     */
+    const std::string& keyid() const;
+    void set_keyid(const std::string& keyid);
+
+    /*!
+     * Whether a scheme is set, which marks a payload as opaque.
+     */
+    bool is_set() const;
+
+    /*!
+     * The number of entries that pack_entries() packs.
+     */
+    uint32_t size() const;
+
+    /*!
+     * Packs the ppt_* entries into an Options|dict, whose map header the
+     * caller has packed already, counting size() entries for them.
+     */
+    template <typename Stream>
+    void pack_entries(msgpack::packer<Stream>& packer) const;
+
+    /*!
+     * Adds the ppt_* entries to a map of options that is converted to a
+     * msgpack object, allocating their values in @p zone.
+     */
+    template <typename Map>
+    void insert_entries(Map& options_map, msgpack::zone& zone) const;
+
+    /*!
+     * Reads the ppt_* entries of an Options|dict or Details|dict; options
+     * not given in it are cleared. Other entries are skipped without being
+     * converted.
+     *
+     * @throw msgpack::type_error
+     */
+    void read(const msgpack::object& details);
+
+private:
+    std::string m_scheme;
+    std::string m_serializer;
+    std::string m_cipher;
+    std::string m_keyid;
+};
+
+/*!
+ * Packs @p payload as the Arguments|list of a message: an array holding a
+ * single binary with the bytes of the payload.
+ */
+void pack_payload_argument(msgpack::sbuffer& buffer, const wamp_bytes_view& payload);
+
+/*!
+ * The bytes of an opaque payload received as @p arguments, the single
+ * binary in the Arguments|list, pointing into the zone of the message.
+ *
+ * @throw std::bad_cast if the arguments are not a single binary.
+ */
+wamp_bytes_view payload_argument(const msgpack::object& arguments);
+
+} // namespace autobahn
+
+#include "wamp_payload.ipp"
+
+#endif // AUTOBAHN_WAMP_PAYLOAD_HPP
@@ -0,0 +1,214 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <typeinfo>
+
+namespace autobahn {
+
+namespace detail {
+
+template <typename Stream>
+inline void pack_payload_option(msgpack::packer<Stream>& packer,
+        const char* key, const std::string& value)
+{
+    uint32_t key_size = static_cast<uint32_t>(std::strlen(key));
+    packer.pack_str(key_size);
+    packer.pack_str_body(key, key_size);
+    packer.pack_str(static_cast<uint32_t>(value.size()));
+    packer.pack_str_body(value.data(), static_cast<uint32_t>(value.size()));
+}
+
+inline bool is_payload_option(const msgpack::object_str& key, const char* name)
+{
+    std::size_t size = std::strlen(name);
+    return key.size == size && std::memcmp(key.ptr, name, size) == 0;
+}
+
+} // namespace detail
+
+inline wamp_payload_options::wamp_payload_options()
+    : m_scheme()
+    , m_serializer()
+    , m_cipher()
+    , m_keyid()
+{
+}
+
+inline wamp_payload_options::wamp_payload_options(
+        const std::string& scheme, const std::string& serializer)
+    : m_scheme(scheme)
+    , m_serializer(serializer)
+    , m_cipher()
+    , m_keyid()
+{
+}
+
+inline const std::string& wamp_payload_options::scheme() const
+{
+    return m_scheme;
+}
+
+inline void wamp_payload_options::set_scheme(const std::string& scheme)
+{
+    m_scheme = scheme;
+}
+
+inline const std::string& wamp_payload_options::serializer() const
+{
+    return m_serializer;
+}
+
+inline void wamp_payload_options::set_serializer(const std::string& serializer)
+{
+    m_serializer = serializer;
+}
+
+inline const std::string& wamp_payload_options::cipher() const
+{
+    return m_cipher;
+}
+
+inline void wamp_payload_options::set_cipher(const std::string& cipher)
+{
+    m_cipher = cipher;
+}
+
+inline const std::string& wamp_payload_options::keyid() const
+{
+    return m_keyid;
+}
+
+inline void wamp_payload_options::set_keyid(const std::string& keyid)
+{
+    m_keyid = keyid;
+}
+
+inline bool wamp_payload_options::is_set() const
+{
+    return !m_scheme.empty();
+}
+
+inline uint32_t wamp_payload_options::size() const
+{
+    if (!is_set()) {
+        return 0;
+    }
+    return 1 + (m_serializer.empty() ? 0 : 1)
+            + (m_cipher.empty() ? 0 : 1)
+            + (m_keyid.empty() ? 0 : 1);
+}
+
+template <typename Stream>
+inline void wamp_payload_options::pack_entries(msgpack::packer<Stream>& packer) const
+{
+    if (!is_set()) {
+        return;
+    }
+    detail::pack_payload_option(packer, "ppt_scheme", m_scheme);
+    if (!m_serializer.empty()) {
+        detail::pack_payload_option(packer, "ppt_serializer", m_serializer);
+    }
+    if (!m_cipher.empty()) {
+        detail::pack_payload_option(packer, "ppt_cipher", m_cipher);
+    }
+    if (!m_keyid.empty()) {
+        detail::pack_payload_option(packer, "ppt_keyid", m_keyid);
+    }
+}
+
+template <typename Map>
+inline void wamp_payload_options::insert_entries(Map& options_map, msgpack::zone& zone) const
+{
+    if (!is_set()) {
+        return;
+    }
+    options_map["ppt_scheme"] = msgpack::object(m_scheme, zone);
+    if (!m_serializer.empty()) {
+        options_map["ppt_serializer"] = msgpack::object(m_serializer, zone);
+    }
+    if (!m_cipher.empty()) {
+        options_map["ppt_cipher"] = msgpack::object(m_cipher, zone);
+    }
+    if (!m_keyid.empty()) {
+        options_map["ppt_keyid"] = msgpack::object(m_keyid, zone);
+    }
+}
+
+inline void wamp_payload_options::read(const msgpack::object& details)
+{
+    if (details.type != msgpack::type::MAP) {
+        throw msgpack::type_error();
+    }
+
+    m_scheme.clear();
+    m_serializer.clear();
+    m_cipher.clear();
+    m_keyid.clear();
+
+    for (std::size_t i = 0; i < details.via.map.size; ++i) {
+        const msgpack::object_kv& kv = details.via.map.ptr[i];
+        if (kv.key.type != msgpack::type::STR || kv.key.via.str.size < 4
+                || std::memcmp(kv.key.via.str.ptr, "ppt_", 4) != 0) {
+            continue;
+        }
+
+        const msgpack::object_str& key = kv.key.via.str;
+        if (detail::is_payload_option(key, "ppt_scheme")) {
+            kv.val.convert(m_scheme);
+        } else if (detail::is_payload_option(key, "ppt_serializer")) {
+            kv.val.convert(m_serializer);
+        } else if (detail::is_payload_option(key, "ppt_cipher")) {
+            kv.val.convert(m_cipher);
+        } else if (detail::is_payload_option(key, "ppt_keyid")) {
+            kv.val.convert(m_keyid);
+        }
+    }
+}
+
+inline void pack_payload_argument(msgpack::sbuffer& buffer, const wamp_bytes_view& payload)
+{
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(1);
+    packer.pack_bin(static_cast<uint32_t>(payload.size()));
+    packer.pack_bin_body(payload.data(), static_cast<uint32_t>(payload.size()));
+}
+
+inline wamp_bytes_view payload_argument(const msgpack::object& arguments)
+{
+    if (arguments.type != msgpack::type::ARRAY || arguments.via.array.size != 1
+            || arguments.via.array.ptr[0].type != msgpack::type::BIN) {
+        throw std::bad_cast();
+    }
+    const msgpack::object_bin& payload = arguments.via.array.ptr[0].via.bin;
+    return wamp_bytes_view(payload.ptr, payload.size);
+}
+
+} // namespace autobahn
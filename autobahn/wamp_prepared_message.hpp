@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_PREPARED_MESSAGE_HPP
+#define AUTOBAHN_WAMP_PREPARED_MESSAGE_HPP
+
+#include "wamp_call_options.hpp"
+#include "wamp_message_type.hpp"
+#include "wamp_publish_options.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <msgpack.hpp>
+#include <string>
+
+namespace autobahn {
+
+/*!
+ * The part of a request that stays the same from one request to the next:
+ * its options and URI, packed once up front.
+ *
+ * Requests made from it only pack their request id and arguments.
+ */
+class wamp_prepared_message
+{
+public:
+    /*!
+     * The URI the requests are made to.
+     */
+    const std::string& uri() const;
+
+    /*!
+     * The URI the requests are made to, shared by all copies of this
+     * prepared message, so that requests in flight can hold on to it
+     * without copying it.
+     */
+    const std::shared_ptr<const std::string>& shared_uri() const;
+
+    /*!
+     * Whether the options the message was prepared with name a payload
+     * scheme, as wamp_session::publish_payload() and
+     * wamp_session::call_payload() require.
+     */
+    bool has_payload_options() const;
+
+    /*!
+     * Packs the start of a request into @p buffer: the array header, the
+     * message type, @p request_id and then the packed options and URI.
+     *
+     * \param buffer The buffer to pack the request into.
+     * \param request_id The id of the request.
+     * \param num_fields The number of fields of the request, including its arguments.
+     */
+    void pack_prefix(msgpack::sbuffer& buffer, uint64_t request_id, uint32_t num_fields) const;
+
+protected:
+    wamp_prepared_message(message_type type, const std::string& uri, std::string&& encoded,
+            bool has_payload_options);
+
+private:
+    message_type m_type;
+    std::shared_ptr<const std::string> m_uri;
+    bool m_has_payload_options;
+
+    // The options and URI fields, packed.
+    std::string m_encoded;
+};
+
+/*!
+ * A prepared CALL, see wamp_session::prepare_call().
+ */
+class wamp_prepared_call : public wamp_prepared_message
+{
+public:
+    explicit wamp_prepared_call(
+            const std::string& procedure,
+            const wamp_call_options& options = wamp_call_options());
+};
+
+/*!
+ * A prepared PUBLISH, see wamp_session::prepare_publish().
+ */
+class wamp_prepared_publication : public wamp_prepared_message
+{
+public:
+    explicit wamp_prepared_publication(
+            const std::string& topic,
+            const wamp_publish_options& options = wamp_publish_options());
+
+    bool acknowledge() const;
+    bool exclude_me() const;
+
+private:
+    bool m_acknowledge;
+    bool m_exclude_me;
+};
+
+} // namespace autobahn
+
+#include "wamp_prepared_message.ipp"
+
+#endif // AUTOBAHN_WAMP_PREPARED_MESSAGE_HPP
@@ -0,0 +1,113 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <utility>
+
+namespace autobahn {
+
+namespace detail {
+
+/// Packs the Options|dict and URI|uri fields of a request.
+template <typename Options>
+std::string pack_options_and_uri(const Options& options, const std::string& uri)
+{
+    msgpack::sbuffer buffer(0);
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack(options);
+    packer.pack(uri);
+    return std::string(buffer.data(), buffer.size());
+}
+
+} // namespace detail
+
+inline wamp_prepared_message::wamp_prepared_message(
+        message_type type, const std::string& uri, std::string&& encoded,
+        bool has_payload_options)
+    : m_type(type)
+    , m_uri(std::make_shared<const std::string>(uri))
+    , m_has_payload_options(has_payload_options)
+    , m_encoded(std::move(encoded))
+{
+}
+
+inline const std::string& wamp_prepared_message::uri() const
+{
+    return *m_uri;
+}
+
+inline const std::shared_ptr<const std::string>& wamp_prepared_message::shared_uri() const
+{
+    return m_uri;
+}
+
+inline bool wamp_prepared_message::has_payload_options() const
+{
+    return m_has_payload_options;
+}
+
+inline void wamp_prepared_message::pack_prefix(
+        msgpack::sbuffer& buffer, uint64_t request_id, uint32_t num_fields) const
+{
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(num_fields);
+    packer.pack(static_cast<int>(m_type));
+    packer.pack(request_id);
+    buffer.write(m_encoded.data(), m_encoded.size());
+}
+
+inline wamp_prepared_call::wamp_prepared_call(
+        const std::string& procedure, const wamp_call_options& options)
+    : wamp_prepared_message(message_type::CALL, procedure,
+            detail::pack_options_and_uri(options, procedure),
+            options.payload_options().is_set())
+{
+}
+
+inline wamp_prepared_publication::wamp_prepared_publication(
+        const std::string& topic, const wamp_publish_options& options)
+    : wamp_prepared_message(message_type::PUBLISH, topic,
+            detail::pack_options_and_uri(options, topic),
+            options.payload_options().is_set())
+    , m_acknowledge(options.acknowledge())
+    , m_exclude_me(options.exclude_me())
+{
+}
+
+inline bool wamp_prepared_publication::acknowledge() const
+{
+    return m_acknowledge;
+}
+
+inline bool wamp_prepared_publication::exclude_me() const
+{
+    return m_exclude_me;
+}
+
+} // namespace autobahn
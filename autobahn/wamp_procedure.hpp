@@ -32,12 +32,14 @@
 #define AUTOBAHN_WAMP_PROCEDURE_HPP
 
 #include "wamp_arguments.hpp"
+#include "wamp_inplace_function.hpp"
 #include "wamp_invocation.hpp"
 
 namespace autobahn {
 
-/// Handler type for use with wamp_session::provide
-using wamp_procedure = std::function<void(wamp_invocation)>;
+/// Handler type for use with wamp_session::provide. Procedures capturing
+/// up to 64 bytes of state are stored without allocating.
+using wamp_procedure = wamp_inplace_function<void(wamp_invocation)>;
 
 using provide_options = wamp_kw_arguments;
 
@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_PROCEDURE_DISPATCHER_HPP
+#define AUTOBAHN_WAMP_PROCEDURE_DISPATCHER_HPP
+
+#include "wamp_procedure.hpp"
+#include "wamp_typed_procedure.hpp"
+#include "wamp_uri_trie.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace autobahn {
+
+/*!
+ * Routes the invocations of one prefix or wildcard registration to the
+ * procedures provided locally for concrete URIs or narrower patterns
+ * underneath it, matched on the procedure URI in the invocation details.
+ * The best matching procedure handles each invocation, ranked as the
+ * router ranks registrations (see wamp_uri_trie::best_match()). An
+ * invocation that no procedure matches is answered with a
+ * `wamp.error.no_such_procedure` error.
+ *
+ * \code
+ * auto calculator = std::make_shared<wamp_procedure_dispatcher>();
+ * calculator->add<uint64_t(uint64_t, uint64_t)>("com.acme.calculator.add", std::plus<uint64_t>());
+ * calculator->add<uint64_t(uint64_t, uint64_t)>("com.acme.calculator.mul", std::multiplies<uint64_t>());
+ * session->provide("com.acme.calculator.", calculator->procedure(),
+ *         { { "match", msgpack::object("prefix") } });
+ * \endcode
+ *
+ * Procedures are added and removed on the thread running the session, or
+ * before the dispatcher is provided. A procedure may add and remove others
+ * while it is invoked; such changes apply to the next invocation.
+ */
+class wamp_procedure_dispatcher :
+    public std::enable_shared_from_this<wamp_procedure_dispatcher>
+{
+public:
+    wamp_procedure_dispatcher();
+
+    /*!
+     * Adds a procedure for the URIs matching a pattern.
+     *
+     * \param uri The URI, or URI pattern, to handle.
+     * \param procedure The procedure that handles the matching invocations.
+     * \param match The match policy of the pattern: "exact", "prefix" or "wildcard".
+     * \return An id for removing the procedure again.
+     */
+    uint64_t add(const std::string& uri, const wamp_procedure& procedure,
+            const std::string& match = "exact");
+
+    /*!
+     * Adds a procedure with a fixed C++ signature for the URIs matching a
+     * pattern. See autobahn::wamp_typed_procedure.
+     *
+     * \tparam Signature The function type of the procedure, e.g. `int(int, std::string)`.
+     */
+    template <typename Signature, typename Function>
+    uint64_t add(const std::string& uri, Function&& function,
+            const std::string& match = "exact");
+
+    /*!
+     * Removes a procedure.
+     *
+     * \return Whether there was a procedure with the given id.
+     */
+    bool remove(uint64_t id);
+
+    std::size_t size() const;
+
+    /*!
+     * Hands the invocation to the procedure matching its URI best.
+     */
+    void invoke(wamp_invocation invocation);
+
+    /*!
+     * A procedure, for wamp_session::provide, that dispatches to this
+     * dispatcher for as long as it is alive.
+     */
+    wamp_procedure procedure();
+
+private:
+    void apply_deferred();
+
+    wamp_uri_trie<wamp_procedure> m_procedures;
+    uint64_t m_last_id;
+
+    // Changes made while invoking, applied once the invocation is done.
+    unsigned m_invoking;
+    std::vector<std::tuple<uint64_t, std::string, std::string, wamp_procedure>> m_deferred_additions;
+    std::vector<uint64_t> m_deferred_removals;
+};
+
+} // namespace autobahn
+
+#include "wamp_procedure_dispatcher.ipp"
+
+#endif // AUTOBAHN_WAMP_PROCEDURE_DISPATCHER_HPP
@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace autobahn {
+
+inline wamp_procedure_dispatcher::wamp_procedure_dispatcher()
+    : m_procedures()
+    , m_last_id(0)
+    , m_invoking(0)
+    , m_deferred_additions()
+    , m_deferred_removals()
+{
+}
+
+inline uint64_t wamp_procedure_dispatcher::add(
+        const std::string& uri, const wamp_procedure& procedure, const std::string& match)
+{
+    uint64_t id = ++m_last_id;
+    if (m_invoking) {
+        if (match != "exact" && match != "prefix" && match != "wildcard") {
+            throw std::invalid_argument("unknown match policy " + match);
+        }
+        m_deferred_additions.emplace_back(id, uri, match, procedure);
+    } else {
+        m_procedures.insert(id, uri, match, procedure);
+    }
+    return id;
+}
+
+template <typename Signature, typename Function>
+inline uint64_t wamp_procedure_dispatcher::add(
+        const std::string& uri, Function&& function, const std::string& match)
+{
+    return add(uri,
+            wamp_procedure(wamp_typed_procedure<Signature>(std::forward<Function>(function))),
+            match);
+}
+
+inline bool wamp_procedure_dispatcher::remove(uint64_t id)
+{
+    if (!m_invoking) {
+        return m_procedures.erase(id);
+    }
+
+    auto addition_itr = std::find_if(m_deferred_additions.begin(), m_deferred_additions.end(),
+            [id](const std::tuple<uint64_t, std::string, std::string, wamp_procedure>& addition) {
+                return std::get<0>(addition) == id;
+            });
+    if (addition_itr != m_deferred_additions.end()) {
+        m_deferred_additions.erase(addition_itr);
+        return true;
+    }
+
+    if (!m_procedures.contains(id) ||
+            std::find(m_deferred_removals.begin(), m_deferred_removals.end(), id) != m_deferred_removals.end()) {
+        return false;
+    }
+    m_deferred_removals.push_back(id);
+    return true;
+}
+
+inline std::size_t wamp_procedure_dispatcher::size() const
+{
+    return m_procedures.size() + m_deferred_additions.size() - m_deferred_removals.size();
+}
+
+inline void wamp_procedure_dispatcher::invoke(wamp_invocation invocation)
+{
+    const wamp_procedure* procedure = m_procedures.best_match(invocation->uri());
+    if (!procedure) {
+        invocation->error("wamp.error.no_such_procedure");
+        return;
+    }
+
+    ++m_invoking;
+    try {
+        (*procedure)(std::move(invocation));
+    } catch (...) {
+        if (--m_invoking == 0) {
+            apply_deferred();
+        }
+        throw;
+    }
+
+    if (--m_invoking == 0) {
+        apply_deferred();
+    }
+}
+
+inline wamp_procedure wamp_procedure_dispatcher::procedure()
+{
+    auto weak_self = std::weak_ptr<wamp_procedure_dispatcher>(this->shared_from_this());
+    return [weak_self](wamp_invocation invocation) {
+        auto shared_self = weak_self.lock();
+        if (shared_self) {
+            shared_self->invoke(std::move(invocation));
+        } else {
+            invocation->error("wamp.error.no_such_procedure");
+        }
+    };
+}
+
+inline void wamp_procedure_dispatcher::apply_deferred()
+{
+    for (uint64_t id : m_deferred_removals) {
+        m_procedures.erase(id);
+    }
+    m_deferred_removals.clear();
+
+    for (auto& addition : m_deferred_additions) {
+        m_procedures.insert(std::get<0>(addition), std::get<1>(addition), std::get<2>(addition),
+                std::get<3>(addition));
+    }
+    m_deferred_additions.clear();
+}
+
+} // namespace autobahn
@@ -0,0 +1,222 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <map>
+#include <msgpack.hpp>
+#include <string>
+#include <unordered_map>
+
+namespace autobahn {
+
+inline wamp_publish_options::wamp_publish_options()
+    : m_acknowledge(false)
+    , m_exclude_me()
+    , m_exclude()
+    , m_eligible()
+    , m_payload_options()
+{
+}
+
+inline bool wamp_publish_options::acknowledge() const
+{
+    return m_acknowledge;
+}
+
+inline void wamp_publish_options::set_acknowledge(bool acknowledge)
+{
+    m_acknowledge = acknowledge;
+}
+
+inline bool wamp_publish_options::exclude_me() const
+{
+    return m_exclude_me.value_or(true);
+}
+
+inline void wamp_publish_options::set_exclude_me(bool exclude_me)
+{
+    m_exclude_me = exclude_me;
+}
+
+inline bool wamp_publish_options::is_exclude_me_set() const
+{
+    return m_exclude_me.is_initialized();
+}
+
+inline const std::vector<uint64_t>& wamp_publish_options::exclude() const
+{
+    return m_exclude;
+}
+
+inline void wamp_publish_options::set_exclude(const std::vector<uint64_t>& exclude)
+{
+    m_exclude = exclude;
+}
+
+inline const std::vector<uint64_t>& wamp_publish_options::eligible() const
+{
+    return m_eligible;
+}
+
+inline void wamp_publish_options::set_eligible(const std::vector<uint64_t>& eligible)
+{
+    m_eligible = eligible;
+}
+
+inline const wamp_payload_options& wamp_publish_options::payload_options() const
+{
+    return m_payload_options;
+}
+
+inline void wamp_publish_options::set_payload_options(const wamp_payload_options& payload_options)
+{
+    m_payload_options = payload_options;
+}
+
+} // namespace autobahn
+
+namespace msgpack {
+MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS) {
+namespace adaptor {
+
+template<>
+struct convert<autobahn::wamp_publish_options>
+{
+    msgpack::object const& operator()(
+            msgpack::object const& object,
+            autobahn::wamp_publish_options& options) const
+    {
+        std::unordered_map<std::string, msgpack::object> options_map;
+        object >> options_map;
+
+        auto options_map_itr = options_map.find("acknowledge");
+        if (options_map_itr != options_map.end()) {
+            options.set_acknowledge(options_map_itr->second.as<bool>());
+        }
+
+        options_map_itr = options_map.find("exclude_me");
+        if (options_map_itr != options_map.end()) {
+            options.set_exclude_me(options_map_itr->second.as<bool>());
+        }
+
+        options_map_itr = options_map.find("exclude");
+        if (options_map_itr != options_map.end()) {
+            options.set_exclude(options_map_itr->second.as<std::vector<uint64_t>>());
+        }
+
+        options_map_itr = options_map.find("eligible");
+        if (options_map_itr != options_map.end()) {
+            options.set_eligible(options_map_itr->second.as<std::vector<uint64_t>>());
+        }
+
+        autobahn::wamp_payload_options payload_options;
+        payload_options.read(object);
+        options.set_payload_options(payload_options);
+
+        return object;
+    }
+};
+
+template<>
+struct pack<autobahn::wamp_publish_options>
+{
+    template <typename Stream>
+    msgpack::packer<Stream>& operator()(
+            msgpack::packer<Stream>& packer,
+            autobahn::wamp_publish_options const& options) const
+    {
+        // Packed entry by entry, as the values differ in type.
+        uint32_t size = (options.acknowledge() ? 1 : 0)
+                + (options.is_exclude_me_set() ? 1 : 0)
+                + (options.exclude().empty() ? 0 : 1)
+                + (options.eligible().empty() ? 0 : 1)
+                + options.payload_options().size();
+        packer.pack_map(size);
+
+        if (options.acknowledge()) {
+            pack_key(packer, "acknowledge");
+            packer.pack_true();
+        }
+        if (options.is_exclude_me_set()) {
+            pack_key(packer, "exclude_me");
+            packer.pack(options.exclude_me());
+        }
+        if (!options.exclude().empty()) {
+            pack_key(packer, "exclude");
+            packer.pack(options.exclude());
+        }
+        if (!options.eligible().empty()) {
+            pack_key(packer, "eligible");
+            packer.pack(options.eligible());
+        }
+        options.payload_options().pack_entries(packer);
+
+        return packer;
+    }
+
+    template <typename Stream>
+    static void pack_key(msgpack::packer<Stream>& packer, const char* key)
+    {
+        uint32_t size = static_cast<uint32_t>(std::strlen(key));
+        packer.pack_str(size);
+        packer.pack_str_body(key, size);
+    }
+};
+
+template <>
+struct object_with_zone<autobahn::wamp_publish_options>
+{
+    void operator()(
+            msgpack::object::with_zone& object,
+            const autobahn::wamp_publish_options& options)
+    {
+        std::map<std::string, msgpack::object> options_map;
+
+        if (options.acknowledge()) {
+            options_map["acknowledge"] = msgpack::object(true);
+        }
+        if (options.is_exclude_me_set()) {
+            options_map["exclude_me"] = msgpack::object(options.exclude_me());
+        }
+        if (!options.exclude().empty()) {
+            options_map["exclude"] = msgpack::object(options.exclude(), object.zone);
+        }
+        if (!options.eligible().empty()) {
+            options_map["eligible"] = msgpack::object(options.eligible(), object.zone);
+        }
+        options.payload_options().insert_entries(options_map, object.zone);
+
+        object << options_map;
+    }
+};
+
+} // namespace adaptor
+} // MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
+} // namespace msgpack
@@ -32,12 +32,14 @@
 #define AUTOBAHN_WAMP_NETWORK_TRANSPORT_HPP
 
 #include "boost_config.hpp"
+#include "wamp_decode_pipeline.hpp"
 #include "wamp_transport.hpp"
 
 #include <boost/thread/future.hpp>
 #include <boost/asio/io_service.hpp>
 #include <cstddef>
 #include <memory>
+#include <vector>
 #include <msgpack.hpp>
 
 namespace autobahn {
@@ -108,6 +110,35 @@ public:
      */
     virtual void send_message(wamp_message&& message) override;
 
+    /*!
+     * Writes all messages with a single write.
+     */
+    virtual void send_messages(std::vector<wamp_message>&& messages) override;
+
+    /*!
+     * @copydoc wamp_transport::set_zone_pool()
+     */
+    virtual void set_zone_pool(const std::shared_ptr<wamp_zone_pool>& zone_pool) override;
+
+    /*!
+     * @copydoc wamp_transport::set_keep_raw_fields()
+     */
+    virtual void set_keep_raw_fields(bool keep_raw_fields) override;
+
+    /*!
+     * Decodes messages of at least @p threshold bytes on @p decode_service
+     * instead of the io thread, so that a large message does not hold up
+     * the messages received after it. Messages are still passed to the
+     * handler on the io thread, in order per subscription, call and
+     * registration; see wamp_decode_pipeline. A message that fails to
+     * decode closes the connection with a protocol error. Must be called
+     * before connecting.
+     *
+     * @param decode_service The io service to decode on, run by as many threads as desired.
+     * @param threshold The message size in bytes from which to decode on the decode service.
+     */
+    void set_decode_service(boost::asio::io_service& decode_service, std::size_t threshold);
+
     /*!
      * @copydoc wamp_transport::set_pause_handler()
      */
@@ -222,6 +253,32 @@ private:
      */
     msgpack::unpacker m_message_unpacker;
 
+    /*!
+     * The pool that messages are unpacked into, if any.
+     */
+    std::shared_ptr<wamp_zone_pool> m_zone_pool;
+
+    /*!
+     * Whether messages keep the bytes of their fields as received.
+     */
+    bool m_keep_raw_fields;
+
+    /*!
+     * The io service the transport runs on.
+     */
+    boost::asio::io_service& m_io_service;
+
+    /*!
+     * Decodes large messages on another io service, if set.
+     */
+    std::shared_ptr<wamp_decode_pipeline> m_decode_pipeline;
+
+    /*!
+     * The large message being received, which is read into a buffer of its
+     * own to be decoded by the pipeline.
+     */
+    std::shared_ptr<std::vector<char>> m_large_message;
+
     /*!
      * Whether or not debugging is enabled.
      */
@@ -53,6 +53,11 @@ wamp_rawsocket_transport<Socket>::wamp_rawsocket_transport(
     , m_handshake_buffer()
     , m_message_length(0)
     , m_message_unpacker()
+    , m_zone_pool()
+    , m_keep_raw_fields(false)
+    , m_io_service(io_service)
+    , m_decode_pipeline()
+    , m_large_message()
     , m_debug_enabled(debug_enabled)
 {
     memset(m_handshake_buffer, 0, sizeof(m_handshake_buffer));
@@ -122,6 +127,11 @@ boost::future<void> wamp_rawsocket_transport<Socket>::connect()
 template <class Socket>
 void wamp_rawsocket_transport<Socket>::close_socket(bool was_clean, const std::string &reason)
 {
+    // Messages still being decoded are of no use without a connection.
+    if (m_decode_pipeline) {
+        m_decode_pipeline->clear();
+    }
+
     if (m_handler && m_socket.is_open()) {
         m_handler->on_disconnect(was_clean, reason);
     }
@@ -153,20 +163,18 @@ bool wamp_rawsocket_transport<Socket>::is_connected() const
 template <class Socket>
 void wamp_rawsocket_transport<Socket>::send_message(wamp_message&& message)
 {
-    auto buffer = std::make_shared<msgpack::sbuffer>();
-    msgpack::packer<msgpack::sbuffer> packer(*buffer);
-    packer.pack(message.fields());
+    const msgpack::sbuffer& buffer = message.serialize();
 
     // Write the length prefix as the message header.
-    uint32_t length = htonl(buffer->size());
+    uint32_t length = htonl(buffer.size());
     boost::system::error_code ec;
     boost::asio::write(m_socket, boost::asio::buffer(&length, sizeof(length)), ec);
 
     if (!ec) {
         // Write actual serialized message.
-        boost::asio::write(m_socket, boost::asio::buffer(buffer->data(), buffer->size()), ec);
+        boost::asio::write(m_socket, boost::asio::buffer(buffer.data(), buffer.size()), ec);
         if (m_debug_enabled) {
-            std::cerr << "TX message (" << buffer->size() << " octets) ..." << std::endl;
+            std::cerr << "TX message (" << buffer.size() << " octets) ..." << std::endl;
             std::cerr << "TX message: " << message << std::endl;
         }
     }
@@ -175,6 +183,100 @@ void wamp_rawsocket_transport<Socket>::send_message(wamp_message&& message)
     }
 }
 
+template <class Socket>
+void wamp_rawsocket_transport<Socket>::send_messages(std::vector<wamp_message>&& messages)
+{
+    // The messages are copied into one contiguous buffer, as asio splits a
+    // gather write of more than a few dozen buffers into several writes.
+    std::size_t batch_size = 0;
+    for (auto& message : messages) {
+        batch_size += sizeof(uint32_t) + message.serialize().size();
+    }
+
+    std::vector<char> batch;
+    batch.reserve(batch_size);
+    for (auto& message : messages) {
+        const msgpack::sbuffer& buffer = message.serialize();
+        uint32_t length = htonl(buffer.size());
+        const char* length_bytes = reinterpret_cast<const char*>(&length);
+        batch.insert(batch.end(), length_bytes, length_bytes + sizeof(length));
+        batch.insert(batch.end(), buffer.data(), buffer.data() + buffer.size());
+    }
+
+    boost::system::error_code ec;
+    std::size_t bytes = boost::asio::write(m_socket, boost::asio::buffer(batch), ec);
+    if (m_debug_enabled) {
+        std::cerr << "TX " << messages.size() << " messages (" << bytes << " octets) ..." << std::endl;
+    }
+    if (ec) {
+        close_socket(false, ec.message());
+    }
+}
+
+template <class Socket>
+void wamp_rawsocket_transport<Socket>::set_zone_pool(const std::shared_ptr<wamp_zone_pool>& zone_pool)
+{
+    m_zone_pool = zone_pool;
+    if (m_decode_pipeline) {
+        m_decode_pipeline->set_zone_pool(zone_pool);
+    }
+}
+
+template <class Socket>
+void wamp_rawsocket_transport<Socket>::set_keep_raw_fields(bool keep_raw_fields)
+{
+    m_keep_raw_fields = keep_raw_fields;
+    if (m_decode_pipeline) {
+        m_decode_pipeline->set_keep_raw_fields(keep_raw_fields);
+    }
+}
+
+template <class Socket>
+void wamp_rawsocket_transport<Socket>::set_decode_service(
+        boost::asio::io_service& decode_service, std::size_t threshold)
+{
+    auto pipeline = std::make_shared<wamp_decode_pipeline>(m_io_service, decode_service, threshold);
+    pipeline->set_zone_pool(m_zone_pool);
+    pipeline->set_keep_raw_fields(m_keep_raw_fields);
+
+    std::weak_ptr<wamp_rawsocket_transport<Socket>> weak_self = this->shared_from_this();
+    pipeline->set_message_handler([weak_self](wamp_message&& message) {
+        auto shared_self = weak_self.lock();
+        if (!shared_self || !shared_self->m_handler) {
+            return;
+        }
+        if (shared_self->m_debug_enabled) {
+            std::cerr << "RX message: " << message << std::endl;
+        }
+        shared_self->m_handler->on_message(std::move(message));
+    });
+    pipeline->set_error_handler([weak_self](std::exception_ptr error) {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+        std::string reason = "protocol error: ";
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::exception& e) {
+            reason += e.what();
+        } catch (...) {
+            reason += "message could not be decoded";
+        }
+        if (shared_self->m_debug_enabled) {
+            std::cerr << "RX " << reason << std::endl;
+        }
+        try {
+            shared_self->close_socket(false, reason);
+        } catch (const network_error&) {
+            // The session rethrows the error of an unclean disconnect, which
+            // must not escape the handler the pipeline was called from.
+        }
+    });
+
+    m_decode_pipeline = pipeline;
+}
+
 template <class Socket>
 void wamp_rawsocket_transport<Socket>::set_pause_handler(pause_handler&& handler)
 {
@@ -342,6 +444,19 @@ void wamp_rawsocket_transport<Socket>::receive_message_header(
         std::cerr << "RX message (" << m_message_length << " octets) ..." << std::endl;
     }
 
+    if (m_decode_pipeline && m_message_length >= m_decode_pipeline->threshold()) {
+        m_large_message = std::make_shared<std::vector<char>>(m_message_length);
+
+        boost::asio::async_read(
+            m_socket,
+            boost::asio::buffer(m_large_message->data(), m_message_length),
+            bind(&wamp_rawsocket_transport<Socket>::receive_message_body,
+                this->shared_from_this(),
+                boost::asio::placeholders::error,
+                boost::asio::placeholders::bytes_transferred));
+        return;
+    }
+
     m_message_unpacker.reserve_buffer(m_message_length);
 
     boost::asio::async_read(
@@ -372,7 +487,25 @@ void wamp_rawsocket_transport<Socket>::receive_message_body(
         std::cerr << "RX message received." << std::endl;
     }
 
-    if (m_handler) {
+    if (m_handler && m_decode_pipeline) {
+        // The pipeline passes the message on once it is decoded and any
+        // message it has to stay in order with has been passed on.
+        if (m_large_message) {
+            m_decode_pipeline->push(m_large_message);
+            m_large_message.reset();
+        } else {
+            m_decode_pipeline->push(m_message_unpacker.buffer(), m_message_length);
+        }
+    } else if (m_handler && (m_zone_pool || m_keep_raw_fields)) {
+        // The message is unpacked into a pooled zone straight from the
+        // receive buffer, which is left unconsumed to be filled again.
+        wamp_message message = wamp_decode_pipeline::decode(
+                m_message_unpacker.buffer(), m_message_length, m_zone_pool, m_keep_raw_fields);
+        if (m_debug_enabled) {
+            std::cerr << "RX message: " << message << std::endl;
+        }
+        m_handler->on_message(std::move(message));
+    } else if (m_handler) {
         m_message_unpacker.buffer_consumed(m_message_length);
         msgpack::unpacked result;
 
@@ -392,6 +525,7 @@ void wamp_rawsocket_transport<Socket>::receive_message_body(
         std::cerr << "RX message ignored: no handler attached" << std::endl;
     }
 
+    m_large_message.reset();
     receive_message();
 }
 
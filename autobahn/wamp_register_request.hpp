@@ -36,23 +36,41 @@
 #include "boost_config.hpp"
 
 #include <boost/thread/future.hpp>
+#include <string>
 
 namespace autobahn {
 
+/// A local procedure: the URI it is registered under and the procedure.
+struct wamp_provider
+{
+    std::string uri;
+
+    // Whether the registration uses exact matching and a single callee,
+    // which makes it eligible for local calls (see wamp_local_procedures).
+    bool exact_match;
+
+    wamp_procedure procedure;
+};
+
 /// An outstanding wamp call.
 class wamp_register_request
 {
 public:
     wamp_register_request();
     wamp_register_request(const wamp_procedure& procedure);
+    wamp_register_request(const wamp_provider& provider);
     wamp_register_request(wamp_register_request&& other);
 
+    const std::string& uri() const;
+    bool exact_match() const;
     const wamp_procedure& procedure() const;
     boost::promise<wamp_registration>& response();
     void set_procedure(wamp_procedure procedure) const;
     void set_response(const wamp_registration& registration);
 
 private:
+    std::string m_uri;
+    bool m_exact_match;
     wamp_procedure m_procedure;
     boost::promise<wamp_registration> m_response;
 };
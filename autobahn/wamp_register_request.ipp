@@ -31,23 +31,47 @@
 namespace autobahn {
 
 inline wamp_register_request::wamp_register_request()
-    : m_procedure()
+    : m_uri()
+    , m_exact_match(false)
+    , m_procedure()
     , m_response()
 {
 }
 
 inline wamp_register_request::wamp_register_request(const wamp_procedure& procedure)
-    : m_procedure(procedure)
+    : m_uri()
+    , m_exact_match(false)
+    , m_procedure(procedure)
+    , m_response()
+{
+}
+
+inline wamp_register_request::wamp_register_request(const wamp_provider& provider)
+    : m_uri(provider.uri)
+    , m_exact_match(provider.exact_match)
+    , m_procedure(provider.procedure)
     , m_response()
 {
 }
 
 inline wamp_register_request::wamp_register_request(wamp_register_request&& other)
-    : m_procedure(std::move(other.m_procedure))
+    : m_uri(std::move(other.m_uri))
+    , m_exact_match(other.m_exact_match)
+    , m_procedure(std::move(other.m_procedure))
     , m_response(std::move(other.m_response))
 {
 }
 
+inline const std::string& wamp_register_request::uri() const
+{
+    return m_uri;
+}
+
+inline bool wamp_register_request::exact_match() const
+{
+    return m_exact_match;
+}
+
 inline const wamp_procedure& wamp_register_request::procedure() const
 {
     return m_procedure;
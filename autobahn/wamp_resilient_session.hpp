@@ -0,0 +1,281 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_RESILIENT_SESSION_HPP
+#define AUTOBAHN_WAMP_RESILIENT_SESSION_HPP
+
+#include "boost_config.hpp"
+#include "wamp_event_handler.hpp"
+#include "wamp_io_executor.hpp"
+#include "wamp_procedure.hpp"
+#include "wamp_registration.hpp"
+#include "wamp_session.hpp"
+#include "wamp_subscribe_options.hpp"
+#include "wamp_subscription.hpp"
+#include "wamp_transport.hpp"
+#include "wamp_transport_handler.hpp"
+
+#include <atomic>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/optional.hpp>
+#include <boost/thread/future.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace autobahn {
+
+/*!
+ * A session that survives transport failures.
+ *
+ * The resilient session owns a new transport and wamp_session for every
+ * connection. When the transport drops it reconnects with jittered
+ * exponential backoff, joins the realm again and replays all subscriptions
+ * and registrations made through it. The SUBSCRIBE and REGISTER messages
+ * are sent back to back without waiting for each other's acknowledgement,
+ * in batches through wamp_session::subscribe_many() and
+ * wamp_session::provide_many().
+ *
+ * The wamp_subscription and wamp_registration handles returned by
+ * subscribe() and provide() are local to the resilient session and stay
+ * valid across reconnects, while the router assigned ids change.
+ *
+ * Calls and publications are not replayed, use session() to issue them on
+ * the current connection.
+ *
+ * Example:
+ * ```
+ * auto session = std::make_shared<autobahn::wamp_resilient_session>(io,
+ *         [&](boost::asio::io_service& io) {
+ *             return std::make_shared<autobahn::wamp_tcp_transport>(io, endpoint);
+ *         }, "realm1");
+ * session->subscribe("com.example.topic", &on_topic);
+ * session->start();
+ * ```
+ */
+class wamp_resilient_session :
+    public wamp_transport_handler,
+    public std::enable_shared_from_this<wamp_resilient_session>
+{
+public:
+    /// Creates an unconnected transport for each connection attempt.
+    using transport_factory =
+            std::function<std::shared_ptr<wamp_transport>(boost::asio::io_service&)>;
+
+    /// Called on the io service thread after each join and replay.
+    using join_handler = std::function<void(const std::shared_ptr<wamp_session>&)>;
+
+    /// Called on the io service thread whenever a connection is lost.
+    using disconnect_handler = std::function<void(const std::string& reason)>;
+
+    /*!
+     * Constructs a resilient session.
+     *
+     * @param io_service The io service to run the sessions and transports on.
+     * @param factory The factory creating a transport for each connection.
+     * @param realm The realm to join on every connection.
+     * @param debug_enabled Whether or not to enable debugging.
+     */
+    wamp_resilient_session(
+            boost::asio::io_service& io_service,
+            const transport_factory& factory,
+            const std::string& realm,
+            bool debug_enabled = false);
+
+    virtual ~wamp_resilient_session() override;
+
+    /*!
+     * Sets the reconnect backoff. The n-th consecutive attempt waits a random
+     * delay between half and all of `initial_delay * 2^n`, capped at
+     * @p max_delay. Defaults to 500ms and 30s.
+     */
+    void set_reconnect_delay(
+            std::chrono::milliseconds initial_delay,
+            std::chrono::milliseconds max_delay);
+
+    void set_join_handler(join_handler&& handler);
+
+    void set_disconnect_handler(disconnect_handler&& handler);
+
+    /*!
+     * Connects and keeps reconnecting until stop() is called.
+     */
+    void start();
+
+    /*!
+     * Leaves the realm, disconnects and stops reconnecting.
+     *
+     * @return A future that is satisfied once the session has been torn down.
+     */
+    boost::future<void> stop();
+
+    /*!
+     * The session of the current connection, or nullptr if the session is
+     * not joined. Must be called on the io service thread.
+     */
+    std::shared_ptr<wamp_session> session() const;
+
+    /*!
+     * Subscribes a handler to a topic on the current and all future
+     * connections.
+     *
+     * @return A future that resolves to a stable subscription handle once the
+     *         router acknowledged the first subscription.
+     */
+    boost::future<wamp_subscription> subscribe(
+            const std::string& topic,
+            const wamp_event_handler& handler,
+            const wamp_subscribe_options& options = wamp_subscribe_options());
+
+    /*!
+     * Removes a subscription made with subscribe().
+     */
+    boost::future<void> unsubscribe(const wamp_subscription& subscription);
+
+    /*!
+     * Registers a procedure on the current and all future connections.
+     *
+     * The msgpack objects in @p options must stay valid for as long as the
+     * registration exists.
+     *
+     * @return A future that resolves to a stable registration handle once the
+     *         router acknowledged the first registration.
+     */
+    boost::future<wamp_registration> provide(
+            const std::string& uri,
+            const wamp_procedure& procedure,
+            const provide_options& options = provide_options());
+
+    /*!
+     * Removes a registration made with provide().
+     */
+    boost::future<void> unprovide(const wamp_registration& registration);
+
+    //
+    // wamp_transport_handler, forwarding to the current session
+
+    virtual void on_attach(const std::shared_ptr<wamp_transport>& transport) override;
+    virtual void on_detach(bool was_clean, const std::string& reason) override;
+    virtual void on_message(wamp_message&& message) override;
+    virtual void on_disconnect(bool was_clean, const std::string& reason) override;
+
+private:
+    /*!
+     * Forwards the callbacks of a transport to the resilient session
+     * without owning it, so that the transport does not keep the session
+     * alive while the session owns the transport.
+     */
+    class transport_handler : public wamp_transport_handler
+    {
+    public:
+        explicit transport_handler(const std::weak_ptr<wamp_resilient_session>& owner);
+
+        virtual void on_attach(const std::shared_ptr<wamp_transport>& transport) override;
+        virtual void on_detach(bool was_clean, const std::string& reason) override;
+        virtual void on_message(wamp_message&& message) override;
+        virtual void on_disconnect(bool was_clean, const std::string& reason) override;
+
+    private:
+        std::weak_ptr<wamp_resilient_session> m_owner;
+    };
+
+    struct subscription_entry
+    {
+        uint64_t id;
+        std::string topic;
+        wamp_event_handler handler;
+        boost::optional<std::string> match;
+        wamp_subscription router_subscription;
+        std::shared_ptr<boost::promise<wamp_subscription>> established;
+    };
+
+    struct registration_entry
+    {
+        uint64_t id;
+        std::string uri;
+        wamp_procedure procedure;
+        provide_options options;
+        uint64_t router_id;
+        std::shared_ptr<boost::promise<wamp_registration>> established;
+    };
+
+    void connect();
+    void connection_lost(uint64_t generation, const std::string& reason);
+    void teardown();
+    void replay();
+    void resubscribe(
+            const std::string& match, std::vector<std::shared_ptr<subscription_entry>>&& entries);
+    void subscribe_now(const std::shared_ptr<subscription_entry>& entry);
+    void reprovide(
+            const provide_options& options, std::vector<std::shared_ptr<registration_entry>>&& entries);
+    void provide_now(const std::shared_ptr<registration_entry>& entry);
+    std::chrono::milliseconds next_reconnect_delay();
+
+    bool m_debug_enabled;
+    boost::asio::io_service& m_io_service;
+    boost::shared_ptr<wamp_io_executor> m_executor;
+    transport_factory m_transport_factory;
+    std::string m_realm;
+
+    std::chrono::milliseconds m_initial_delay;
+    std::chrono::milliseconds m_max_delay;
+    boost::asio::steady_timer m_reconnect_timer;
+    std::mt19937 m_random;
+    unsigned m_attempts;
+
+    join_handler m_join_handler;
+    disconnect_handler m_disconnect_handler;
+
+    /// Incremented per connection, so that continuations of a lost
+    /// connection can tell they are stale.
+    uint64_t m_generation;
+    bool m_started;
+    bool m_stopping;
+    bool m_joined;
+    std::shared_ptr<wamp_transport> m_transport;
+    std::shared_ptr<wamp_session> m_session;
+    boost::promise<void> m_stopped;
+
+    std::atomic<uint64_t> m_next_id;
+    std::map<uint64_t /*local id*/, std::shared_ptr<subscription_entry>> m_subscriptions;
+    std::map<uint64_t /*local id*/, std::shared_ptr<registration_entry>> m_registrations;
+};
+
+} // namespace autobahn
+
+#include "wamp_resilient_session.ipp"
+
+#endif // AUTOBAHN_WAMP_RESILIENT_SESSION_HPP
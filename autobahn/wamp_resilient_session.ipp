@@ -0,0 +1,765 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "exceptions.hpp"
+
+#include <algorithm>
+#include <boost/system/error_code.hpp>
+#include <iostream>
+
+namespace autobahn {
+
+inline wamp_resilient_session::wamp_resilient_session(
+        boost::asio::io_service& io_service,
+        const transport_factory& factory,
+        const std::string& realm,
+        bool debug_enabled)
+    : m_debug_enabled(debug_enabled)
+    , m_io_service(io_service)
+    , m_executor(boost::make_shared<wamp_io_executor>(io_service))
+    , m_transport_factory(factory)
+    , m_realm(realm)
+    , m_initial_delay(500)
+    , m_max_delay(30000)
+    , m_reconnect_timer(io_service)
+    , m_random(std::random_device()())
+    , m_attempts(0)
+    , m_join_handler()
+    , m_disconnect_handler()
+    , m_generation(0)
+    , m_started(false)
+    , m_stopping(false)
+    , m_joined(false)
+    , m_transport()
+    , m_session()
+    , m_stopped()
+    , m_next_id(ATOMIC_VAR_INIT(0))
+    , m_subscriptions()
+    , m_registrations()
+{
+}
+
+inline wamp_resilient_session::~wamp_resilient_session()
+{
+    // The transport only holds a weak reference to us, so we may well go
+    // away without stop() having been called.
+    teardown();
+}
+
+inline void wamp_resilient_session::set_reconnect_delay(
+        std::chrono::milliseconds initial_delay,
+        std::chrono::milliseconds max_delay)
+{
+    m_initial_delay = initial_delay;
+    m_max_delay = max_delay;
+}
+
+inline void wamp_resilient_session::set_join_handler(join_handler&& handler)
+{
+    m_join_handler = std::move(handler);
+}
+
+inline void wamp_resilient_session::set_disconnect_handler(disconnect_handler&& handler)
+{
+    m_disconnect_handler = std::move(handler);
+}
+
+inline void wamp_resilient_session::start()
+{
+    auto weak_self = std::weak_ptr<wamp_resilient_session>(this->shared_from_this());
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self || m_started) {
+            return;
+        }
+
+        m_started = true;
+        connect();
+    });
+}
+
+inline boost::future<void> wamp_resilient_session::stop()
+{
+    auto weak_self = std::weak_ptr<wamp_resilient_session>(this->shared_from_this());
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self || m_stopping) {
+            return;
+        }
+
+        m_stopping = true;
+        m_reconnect_timer.cancel();
+
+        if (!m_joined) {
+            ++m_generation;
+            teardown();
+            m_stopped.set_value();
+            return;
+        }
+
+        uint64_t generation = m_generation;
+        m_session->leave().then([=](boost::future<std::string> left) {
+            auto shared_self = weak_self.lock();
+            if (!shared_self) {
+                return;
+            }
+
+            try {
+                left.get();
+            } catch (const std::exception& e) {
+                if (m_debug_enabled) {
+                    std::cerr << "leave failed: " << e.what() << std::endl;
+                }
+            }
+
+            if (generation == m_generation) {
+                ++m_generation;
+                teardown();
+            }
+            m_stopped.set_value();
+        });
+    });
+
+    return bind_executor(m_executor, m_stopped);
+}
+
+inline std::shared_ptr<wamp_session> wamp_resilient_session::session() const
+{
+    return m_joined ? m_session : std::shared_ptr<wamp_session>();
+}
+
+inline boost::future<wamp_subscription> wamp_resilient_session::subscribe(
+        const std::string& topic,
+        const wamp_event_handler& handler,
+        const wamp_subscribe_options& options)
+{
+    auto entry = std::make_shared<subscription_entry>();
+    entry->id = ++m_next_id;
+    entry->topic = topic;
+    entry->handler = handler;
+    if (options.is_match_set()) {
+        entry->match = options.match();
+    }
+    entry->established = std::make_shared<boost::promise<wamp_subscription>>();
+
+    auto established = bind_executor(m_executor, *entry->established);
+    auto weak_self = std::weak_ptr<wamp_resilient_session>(this->shared_from_this());
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        m_subscriptions.emplace(entry->id, entry);
+        if (m_joined) {
+            subscribe_now(entry);
+        }
+    });
+
+    return established;
+}
+
+inline boost::future<void> wamp_resilient_session::unsubscribe(const wamp_subscription& subscription)
+{
+    auto weak_self = std::weak_ptr<wamp_resilient_session>(this->shared_from_this());
+    auto unsubscribed = std::make_shared<boost::promise<void>>();
+    uint64_t id = subscription.id();
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        auto itr = m_subscriptions.find(id);
+        if (itr == m_subscriptions.end()) {
+            unsubscribed->set_exception(protocol_error("no subscription with id " + std::to_string(id)));
+            return;
+        }
+
+        auto entry = itr->second;
+        m_subscriptions.erase(itr);
+        if (entry->established) {
+            entry->established->set_exception(
+                    protocol_error("unsubscribed before the subscription was established"));
+            entry->established.reset();
+        }
+
+        if (!m_joined || !entry->router_subscription.id()) {
+            unsubscribed->set_value();
+            return;
+        }
+
+        m_session->unsubscribe(entry->router_subscription).then([=](boost::future<void> result) {
+            try {
+                result.get();
+                unsubscribed->set_value();
+            } catch (const network_error&) {
+                // The subscription went away with the connection.
+                unsubscribed->set_value();
+            } catch (const std::exception&) {
+                unsubscribed->set_exception(boost::current_exception());
+            }
+        });
+    });
+
+    return bind_executor(m_executor, *unsubscribed);
+}
+
+inline boost::future<wamp_registration> wamp_resilient_session::provide(
+        const std::string& uri,
+        const wamp_procedure& procedure,
+        const provide_options& options)
+{
+    auto entry = std::make_shared<registration_entry>();
+    entry->id = ++m_next_id;
+    entry->uri = uri;
+    entry->procedure = procedure;
+    entry->options = options;
+    entry->router_id = 0;
+    entry->established = std::make_shared<boost::promise<wamp_registration>>();
+
+    auto established = bind_executor(m_executor, *entry->established);
+    auto weak_self = std::weak_ptr<wamp_resilient_session>(this->shared_from_this());
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        m_registrations.emplace(entry->id, entry);
+        if (m_joined) {
+            provide_now(entry);
+        }
+    });
+
+    return established;
+}
+
+inline boost::future<void> wamp_resilient_session::unprovide(const wamp_registration& registration)
+{
+    auto weak_self = std::weak_ptr<wamp_resilient_session>(this->shared_from_this());
+    auto unprovided = std::make_shared<boost::promise<void>>();
+    uint64_t id = registration.id();
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        auto itr = m_registrations.find(id);
+        if (itr == m_registrations.end()) {
+            unprovided->set_exception(protocol_error("no registration with id " + std::to_string(id)));
+            return;
+        }
+
+        auto entry = itr->second;
+        m_registrations.erase(itr);
+        if (entry->established) {
+            entry->established->set_exception(
+                    protocol_error("unprovided before the registration was established"));
+            entry->established.reset();
+        }
+
+        if (!m_joined || !entry->router_id) {
+            unprovided->set_value();
+            return;
+        }
+
+        m_session->unprovide(wamp_registration(entry->router_id)).then(
+                [=](boost::future<void> result) {
+            try {
+                result.get();
+                unprovided->set_value();
+            } catch (const network_error&) {
+                // The registration went away with the connection.
+                unprovided->set_value();
+            } catch (const std::exception&) {
+                unprovided->set_exception(boost::current_exception());
+            }
+        });
+    });
+
+    return bind_executor(m_executor, *unprovided);
+}
+
+inline void wamp_resilient_session::on_attach(const std::shared_ptr<wamp_transport>& transport)
+{
+    // wamp_session implements the handler interface privately.
+    if (m_session) {
+        static_cast<wamp_transport_handler&>(*m_session).on_attach(transport);
+    }
+}
+
+inline void wamp_resilient_session::on_detach(bool was_clean, const std::string& reason)
+{
+    // The session of a detached transport is discarded, so there is nothing
+    // to forward.
+}
+
+inline void wamp_resilient_session::on_message(wamp_message&& message)
+{
+    if (m_session) {
+        static_cast<wamp_transport_handler&>(*m_session).on_message(std::move(message));
+    }
+}
+
+inline void wamp_resilient_session::on_disconnect(bool was_clean, const std::string& reason)
+{
+    // The transport is in the middle of closing its socket, so tear it down
+    // once it is done.
+    auto weak_self = std::weak_ptr<wamp_resilient_session>(this->shared_from_this());
+    uint64_t generation = m_generation;
+    m_io_service.post([=]() {
+        auto shared_self = weak_self.lock();
+        if (shared_self) {
+            connection_lost(generation, reason);
+        }
+    });
+}
+
+inline void wamp_resilient_session::connect()
+{
+    uint64_t generation = ++m_generation;
+
+    m_joined = false;
+    m_session = std::make_shared<wamp_session>(m_io_service, m_debug_enabled);
+    try {
+        m_transport = m_transport_factory(m_io_service);
+        m_transport->attach(std::make_shared<transport_handler>(this->shared_from_this()));
+    } catch (const std::exception& e) {
+        connection_lost(generation, e.what());
+        return;
+    }
+
+    auto weak_self = std::weak_ptr<wamp_resilient_session>(this->shared_from_this());
+    auto failed = [=](const std::exception& e) {
+        auto shared_self = weak_self.lock();
+        if (shared_self) {
+            connection_lost(generation, e.what());
+        }
+    };
+
+    bind_executor(m_executor, m_transport->connect()).then([=](boost::future<void> connected) {
+        auto shared_self = weak_self.lock();
+        if (!shared_self || generation != m_generation) {
+            return;
+        }
+
+        try {
+            connected.get();
+        } catch (const std::exception& e) {
+            failed(e);
+            return;
+        }
+
+        m_session->start().then([=](boost::future<void> started) {
+            auto shared_self = weak_self.lock();
+            if (!shared_self || generation != m_generation) {
+                return;
+            }
+
+            try {
+                started.get();
+            } catch (const std::exception& e) {
+                failed(e);
+                return;
+            }
+
+            m_session->join(m_realm).then([=](boost::future<uint64_t> joined) {
+                auto shared_self = weak_self.lock();
+                if (!shared_self || generation != m_generation) {
+                    return;
+                }
+
+                try {
+                    joined.get();
+                } catch (const std::exception& e) {
+                    failed(e);
+                    return;
+                }
+
+                m_joined = true;
+                m_attempts = 0;
+                replay();
+
+                if (m_join_handler) {
+                    m_join_handler(m_session);
+                }
+            });
+        });
+    });
+}
+
+inline void wamp_resilient_session::connection_lost(uint64_t generation, const std::string& reason)
+{
+    if (generation != m_generation) {
+        return;
+    }
+
+    if (m_debug_enabled) {
+        std::cerr << "connection lost: " << reason << std::endl;
+    }
+
+    // Invalidate all continuations of this connection before failing its
+    // pending requests.
+    ++m_generation;
+    auto session = m_session;
+    teardown();
+    if (session) {
+        try {
+            static_cast<wamp_transport_handler&>(*session).on_disconnect(false, reason);
+        } catch (const std::exception&) {
+            // The session rethrows the network error, which we handle here.
+        }
+    }
+
+    for (auto& subscription : m_subscriptions) {
+        subscription.second->router_subscription = wamp_subscription();
+    }
+    for (auto& registration : m_registrations) {
+        registration.second->router_id = 0;
+    }
+
+    if (m_disconnect_handler) {
+        m_disconnect_handler(reason);
+    }
+
+    if (m_stopping) {
+        return;
+    }
+
+    auto weak_self = std::weak_ptr<wamp_resilient_session>(this->shared_from_this());
+    uint64_t reconnect_generation = m_generation;
+    m_reconnect_timer.expires_from_now(next_reconnect_delay());
+    m_reconnect_timer.async_wait([=](const boost::system::error_code& error_code) {
+        auto shared_self = weak_self.lock();
+        if (error_code || !shared_self || reconnect_generation != m_generation || m_stopping) {
+            return;
+        }
+        connect();
+    });
+}
+
+inline void wamp_resilient_session::teardown()
+{
+    m_joined = false;
+    if (m_transport) {
+        if (m_transport->has_handler()) {
+            m_transport->detach();
+        }
+        if (m_transport->is_connected()) {
+            m_transport->disconnect();
+        }
+    }
+    m_transport.reset();
+    m_session.reset();
+}
+
+inline void wamp_resilient_session::replay()
+{
+    // Subscriptions sharing the same options are replayed with one
+    // subscribe_many() each, i.e. written in a single batch.
+    std::map<std::string, std::vector<std::shared_ptr<subscription_entry>>> groups;
+    for (const auto& subscription : m_subscriptions) {
+        const auto& entry = subscription.second;
+        groups[entry->match ? *entry->match : std::string()].push_back(entry);
+    }
+    for (auto& group : groups) {
+        resubscribe(group.first, std::move(group.second));
+    }
+
+    // Registrations carry individual options, so they are grouped by equal
+    // options and replayed with one provide_many() per group.
+    using batch_type = std::pair<provide_options, std::vector<std::shared_ptr<registration_entry>>>;
+    std::vector<batch_type> batches;
+    for (const auto& registration : m_registrations) {
+        const auto& entry = registration.second;
+        auto batch = std::find_if(batches.begin(), batches.end(), [&](const batch_type& candidate) {
+            return candidate.first == entry->options;
+        });
+        if (batch == batches.end()) {
+            batches.emplace_back(entry->options, std::vector<std::shared_ptr<registration_entry>>());
+            batch = batches.end() - 1;
+        }
+        batch->second.push_back(entry);
+    }
+    for (auto& batch : batches) {
+        reprovide(batch.first, std::move(batch.second));
+    }
+}
+
+inline void wamp_resilient_session::resubscribe(
+        const std::string& match, std::vector<std::shared_ptr<subscription_entry>>&& entries)
+{
+    auto weak_self = std::weak_ptr<wamp_resilient_session>(this->shared_from_this());
+    uint64_t generation = m_generation;
+
+    std::vector<std::pair<std::string, wamp_event_handler>> subscriptions;
+    subscriptions.reserve(entries.size());
+    for (const auto& entry : entries) {
+        subscriptions.emplace_back(entry->topic, entry->handler);
+    }
+
+    wamp_subscribe_options options;
+    if (!match.empty()) {
+        options.set_match(match);
+    }
+
+    auto pending = std::make_shared<std::vector<std::shared_ptr<subscription_entry>>>(std::move(entries));
+    m_session->subscribe_many(subscriptions, options).then(
+            [=](boost::future<wamp_subscribe_many_result> subscribed) {
+        auto shared_self = weak_self.lock();
+        if (!shared_self || generation != m_generation) {
+            return;
+        }
+
+        wamp_subscribe_many_result results;
+        try {
+            results = subscribed.get();
+        } catch (const std::exception&) {
+            // Replayed on the next connection.
+            return;
+        }
+
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto& entry = (*pending)[i];
+            if (!results[i].succeeded()) {
+                m_subscriptions.erase(entry->id);
+                if (entry->established) {
+                    entry->established->set_exception(protocol_error(results[i].error_uri()));
+                    entry->established.reset();
+                }
+            } else if (!m_subscriptions.count(entry->id)) {
+                // Unsubscribed while the request was in flight.
+                m_session->unsubscribe(results[i].value());
+            } else {
+                entry->router_subscription = results[i].value();
+                if (entry->established) {
+                    entry->established->set_value(wamp_subscription(entry->id));
+                    entry->established.reset();
+                }
+            }
+        }
+    });
+}
+
+inline void wamp_resilient_session::subscribe_now(const std::shared_ptr<subscription_entry>& entry)
+{
+    auto weak_self = std::weak_ptr<wamp_resilient_session>(this->shared_from_this());
+    uint64_t generation = m_generation;
+
+    wamp_subscribe_options options;
+    if (entry->match) {
+        options.set_match(*entry->match);
+    }
+
+    m_session->subscribe(entry->topic, entry->handler, options).then(
+            [=](boost::future<wamp_subscription> subscribed) {
+        auto shared_self = weak_self.lock();
+        if (!shared_self || generation != m_generation) {
+            return;
+        }
+
+        try {
+            wamp_subscription subscription = subscribed.get();
+            if (!m_subscriptions.count(entry->id)) {
+                // Unsubscribed while the request was in flight.
+                m_session->unsubscribe(subscription);
+                return;
+            }
+
+            entry->router_subscription = subscription;
+            if (entry->established) {
+                entry->established->set_value(wamp_subscription(entry->id));
+                entry->established.reset();
+            }
+        } catch (const network_error&) {
+            // Replayed on the next connection.
+        } catch (const std::exception&) {
+            m_subscriptions.erase(entry->id);
+            if (entry->established) {
+                entry->established->set_exception(boost::current_exception());
+                entry->established.reset();
+            }
+        }
+    });
+}
+
+inline void wamp_resilient_session::reprovide(
+        const provide_options& options, std::vector<std::shared_ptr<registration_entry>>&& entries)
+{
+    auto weak_self = std::weak_ptr<wamp_resilient_session>(this->shared_from_this());
+    uint64_t generation = m_generation;
+
+    std::vector<std::pair<std::string, wamp_procedure>> procedures;
+    procedures.reserve(entries.size());
+    for (const auto& entry : entries) {
+        procedures.emplace_back(entry->uri, entry->procedure);
+    }
+
+    auto pending = std::make_shared<std::vector<std::shared_ptr<registration_entry>>>(std::move(entries));
+    m_session->provide_many(procedures, options).then(
+            [=](boost::future<wamp_provide_many_result> provided) {
+        auto shared_self = weak_self.lock();
+        if (!shared_self || generation != m_generation) {
+            return;
+        }
+
+        wamp_provide_many_result results;
+        try {
+            results = provided.get();
+        } catch (const std::exception&) {
+            // Replayed on the next connection.
+            return;
+        }
+
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto& entry = (*pending)[i];
+            if (!results[i].succeeded()) {
+                m_registrations.erase(entry->id);
+                if (entry->established) {
+                    entry->established->set_exception(protocol_error(results[i].error_uri()));
+                    entry->established.reset();
+                }
+            } else if (!m_registrations.count(entry->id)) {
+                // Unprovided while the request was in flight.
+                m_session->unprovide(results[i].value());
+            } else {
+                entry->router_id = results[i].value().id();
+                if (entry->established) {
+                    entry->established->set_value(wamp_registration(entry->id));
+                    entry->established.reset();
+                }
+            }
+        }
+    });
+}
+
+inline void wamp_resilient_session::provide_now(const std::shared_ptr<registration_entry>& entry)
+{
+    auto weak_self = std::weak_ptr<wamp_resilient_session>(this->shared_from_this());
+    uint64_t generation = m_generation;
+
+    m_session->provide(entry->uri, entry->procedure, entry->options).then(
+            [=](boost::future<wamp_registration> registered) {
+        auto shared_self = weak_self.lock();
+        if (!shared_self || generation != m_generation) {
+            return;
+        }
+
+        try {
+            wamp_registration registration = registered.get();
+            if (!m_registrations.count(entry->id)) {
+                // Unprovided while the request was in flight.
+                m_session->unprovide(registration);
+                return;
+            }
+
+            entry->router_id = registration.id();
+            if (entry->established) {
+                entry->established->set_value(wamp_registration(entry->id));
+                entry->established.reset();
+            }
+        } catch (const network_error&) {
+            // Replayed on the next connection.
+        } catch (const std::exception&) {
+            m_registrations.erase(entry->id);
+            if (entry->established) {
+                entry->established->set_exception(boost::current_exception());
+                entry->established.reset();
+            }
+        }
+    });
+}
+
+inline wamp_resilient_session::transport_handler::transport_handler(
+        const std::weak_ptr<wamp_resilient_session>& owner)
+    : m_owner(owner)
+{
+}
+
+inline void wamp_resilient_session::transport_handler::on_attach(
+        const std::shared_ptr<wamp_transport>& transport)
+{
+    auto owner = m_owner.lock();
+    if (owner) {
+        owner->on_attach(transport);
+    }
+}
+
+inline void wamp_resilient_session::transport_handler::on_detach(
+        bool was_clean, const std::string& reason)
+{
+    auto owner = m_owner.lock();
+    if (owner) {
+        owner->on_detach(was_clean, reason);
+    }
+}
+
+inline void wamp_resilient_session::transport_handler::on_message(wamp_message&& message)
+{
+    auto owner = m_owner.lock();
+    if (owner) {
+        owner->on_message(std::move(message));
+    }
+}
+
+inline void wamp_resilient_session::transport_handler::on_disconnect(
+        bool was_clean, const std::string& reason)
+{
+    auto owner = m_owner.lock();
+    if (owner) {
+        owner->on_disconnect(was_clean, reason);
+    }
+}
+
+inline std::chrono::milliseconds wamp_resilient_session::next_reconnect_delay()
+{
+    // Exponential backoff with "equal jitter": a random delay between half
+    // and all of the capped exponential delay, so that clients dropped by
+    // the same router failover do not reconnect in lockstep.
+    unsigned exponent = std::min(m_attempts++, 30u);
+    std::chrono::milliseconds::rep ceiling = std::min<std::chrono::milliseconds::rep>(
+            m_initial_delay.count() << exponent, m_max_delay.count());
+    if (ceiling <= 0) {
+        ceiling = m_max_delay.count();
+    }
+
+    std::uniform_int_distribution<std::chrono::milliseconds::rep> jitter(ceiling / 2, ceiling);
+    return std::chrono::milliseconds(jitter(m_random));
+}
+
+} // namespace autobahn
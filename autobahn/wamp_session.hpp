@@ -31,18 +31,37 @@
 #ifndef AUTOBAHN_SESSION_HPP
 #define AUTOBAHN_SESSION_HPP
 
+#include "wamp_buffer_pool.hpp"
+#include "wamp_bulk_request.hpp"
+#include "wamp_call.hpp"
 #include "wamp_call_options.hpp"
 #include "wamp_call_result.hpp"
+#include "wamp_chunk_handler.hpp"
 #include "wamp_event_handler.hpp"
+#include "wamp_invocation_sink.hpp"
+#include "wamp_io_executor.hpp"
+#include "wamp_local_procedures.hpp"
 #include "wamp_message.hpp"
+#include "wamp_payload.hpp"
+#include "wamp_prepared_message.hpp"
 #include "wamp_procedure.hpp"
+#include "wamp_publication.hpp"
+#include "wamp_publish_options.hpp"
+#include "wamp_register_request.hpp"
 #include "wamp_subscribe_options.hpp"
+#include "wamp_subscribe_request.hpp"
 #include "wamp_transport_handler.hpp"
+#include "wamp_typed_procedure.hpp"
+#include "wamp_uri_trie.hpp"
+#include "wamp_zone_pool.hpp"
 #include "boost_config.hpp"
 
 #include <boost/asio.hpp>
 #include <boost/thread/future.hpp>
+#include <atomic>
 #include <cstdint>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <istream>
 #include <ostream>
@@ -51,6 +70,7 @@
 #include <msgpack.hpp>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -66,7 +86,6 @@
 
 namespace autobahn {
 
-class wamp_call;
 class wamp_message;
 class wamp_register_request;
 class wamp_registration;
@@ -77,10 +96,26 @@ class wamp_transport;
 class wamp_unsubscribe_request;
 class wamp_authenticate;
 class wamp_challenge;
+class wamp_error;
 
-/// Representation of a WAMP session.
+/// Per-topic outcome of wamp_session::subscribe_many, in request order.
+using wamp_subscribe_many_result = std::vector<wamp_bulk_item<wamp_subscription>>;
+
+/// Per-procedure outcome of wamp_session::provide_many, in request order.
+using wamp_provide_many_result = std::vector<wamp_bulk_item<wamp_registration>>;
+
+/*!
+ * Representation of a WAMP session.
+ *
+ * All futures returned by the session are bound to the session's
+ * wamp_io_executor, so continuations attached with `then(fn)` run on the
+ * io service instead of on a thread spawned per continuation. Pass an
+ * explicit launch policy, e.g. `then(boost::launch::async, fn)`, to opt
+ * out for a particular continuation.
+ */
 class wamp_session :
         public wamp_transport_handler,
+        public wamp_invocation_sink,
         public std::enable_shared_from_this<wamp_session>
 {
 public:
@@ -133,6 +168,67 @@ public:
     boost::future<std::string> leave(
             const std::string& reason = std::string("wamp.error.close_realm"));
 
+    /*!
+     * The executor running continuations of the futures returned by this
+     * session. It can also be passed to `then(executor, fn)` for futures
+     * that do not originate from the session, e.g. the transport's connect().
+     * The futures returned by the session keep the executor alive, but one
+     * passed to then() by reference must outlive the continuation.
+     */
+    wamp_io_executor& executor();
+
+    /*!
+     * The pool of buffers that outgoing messages are packed into. Messages
+     * packed straight into a buffer, like prepared calls and publications,
+     * take it from here, and every buffer is handed back once the transport
+     * has written it. Its limits can be changed from any thread.
+     */
+    wamp_buffer_pool& buffer_pool();
+
+    /*!
+     * The pool of zones that the transport unpacks inbound messages into.
+     * Events, call results and invocations hand their zone back to it when
+     * they are destroyed, wherever that happens. Its limits can be changed
+     * from any thread.
+     */
+    wamp_zone_pool& zone_pool();
+
+    /*!
+     * The pool of invocation objects handed to provided procedures. An
+     * invocation goes back to it once the last wamp_invocation referring
+     * to it is gone. Its limit can be changed from any thread.
+     */
+    wamp_invocation_pool& invocation_pool();
+
+    /*!
+     * Opts in to calling procedures provided in this process directly.
+     *
+     * Calls to a URI that this session, or another session sharing
+     * @p procedures, has registered with exact matching and a single callee
+     * are handed to the procedure in memory rather than sent through the
+     * router. Such calls skip the router's authorization, call options and
+     * shared registrations, which is why this is off unless set. Only
+     * registrations made after this call are entered in @p procedures.
+     *
+     * \param procedures The registry to share, or nullptr to turn local calls off.
+     */
+    void set_local_procedures(const std::shared_ptr<wamp_local_procedures>& procedures);
+
+    /*!
+     * Opts in to delivering this session's own publications to its own
+     * subscribers directly.
+     *
+     * Handlers subscribed to a matching topic receive the event from the
+     * arguments already packed for the PUBLISH, before it is sent, rather
+     * than after a round trip through the router. The router still
+     * delivers the event to other sessions. It does not deliver it back
+     * to this session, as publishers are excluded from receiving their own
+     * events by default.
+     *
+     * \param enabled Whether to deliver publications locally.
+     */
+    void set_local_delivery(bool enabled);
+
 	/*!
 	 * \brief is_connected
 	 * \return true if there is a valid session
@@ -174,9 +270,252 @@ public:
             const List& arguments,
             const Map& kw_arguments);
 
+    /*!
+     * Publish many events with positional payload at once.
+     *
+     * Each PUBLISH is packed straight into its serialized form, and all of
+     * them are written to the transport in one batch. Like the publish()
+     * overloads without options, they are not acknowledged.
+     *
+     * \param publications The topics and the positional payloads of the events.
+     * \return A future that resolves once every event has been published.
+     */
+    template <typename List>
+    boost::future<void> publish_many(
+            const std::vector<std::pair<std::string, List>>& publications);
+
+    /*!
+     * Publish many events with both positional and keyword payload at once.
+     *
+     * \param publications The topics, positional and keyword payloads of the events.
+     * \return A future that resolves once every event has been published.
+     */
+    template <typename List, typename Map>
+    boost::future<void> publish_many(
+            const std::vector<std::tuple<std::string, List, Map>>& publications);
+
+    /*!
+     * Publish an event with empty payload to a topic, with options.
+     *
+     * Unlike the overloads without options, these publications are subject
+     * to the publish window, see set_publish_window().
+     *
+     * \param topic The URI of the topic to publish to.
+     * \param options The options for the publication.
+     * \return A future that resolves once the router acknowledged the
+     *         publication, if acknowledgement was asked for, and once it
+     *         was sent otherwise.
+     */
+    boost::future<wamp_publication> publish(
+            const std::string& topic,
+            const wamp_publish_options& options);
+
+    /*!
+     * Publish an event with positional payload to a topic, with options.
+     *
+     * \param topic The URI of the topic to publish to.
+     * \param arguments The positional payload for the event.
+     * \param options The options for the publication.
+     * \return A future that resolves to the publication, see above.
+     */
+    template <typename List>
+    boost::future<wamp_publication> publish(
+            const std::string& topic,
+            const List& arguments,
+            const wamp_publish_options& options);
+
+    /*!
+     * Publish an event with both positional and keyword payload to a topic,
+     * with options.
+     *
+     * \param topic The URI of the topic to publish to.
+     * \param arguments The positional payload for the event.
+     * \param kw_arguments The keyword payload for the event.
+     * \param options The options for the publication.
+     * \return A future that resolves to the publication, see above.
+     */
+    template <typename List, typename Map>
+    boost::future<wamp_publication> publish(
+            const std::string& topic,
+            const List& arguments,
+            const Map& kw_arguments,
+            const wamp_publish_options& options);
+
+    /*!
+     * Prepares publications to a topic that is published to often.
+     *
+     * The options and the topic URI are packed once, here, so that each
+     * publication made with the returned handle only packs its request id
+     * and its payload. The handle may be kept and used from any thread.
+     *
+     * \param topic The URI of the topic to publish to.
+     * \param options The options for every publication.
+     * \return The prepared publication.
+     */
+    wamp_prepared_publication prepare_publish(
+            const std::string& topic,
+            const wamp_publish_options& options = wamp_publish_options()) const;
+
+    /*!
+     * Publish an event with empty payload to a prepared topic.
+     *
+     * \param prepared The prepared publication.
+     * \return A future that resolves to the publication, as for publish()
+     *         with options.
+     */
+    boost::future<wamp_publication> publish(const wamp_prepared_publication& prepared);
+
+    /*!
+     * Publish an event with positional payload to a prepared topic.
+     *
+     * \param prepared The prepared publication.
+     * \param arguments The positional payload for the event.
+     * \return A future that resolves to the publication.
+     */
+    template <typename List>
+    boost::future<wamp_publication> publish(
+            const wamp_prepared_publication& prepared,
+            const List& arguments);
+
+    /*!
+     * Publish an event with both positional and keyword payload to a
+     * prepared topic.
+     *
+     * \param prepared The prepared publication.
+     * \param arguments The positional payload for the event.
+     * \param kw_arguments The keyword payload for the event.
+     * \return A future that resolves to the publication.
+     */
+    template <typename List, typename Map>
+    boost::future<wamp_publication> publish(
+            const wamp_prepared_publication& prepared,
+            const List& arguments,
+            const Map& kw_arguments);
+
+    /*!
+     * Publish an event with a payload that is msgpack-encoded already.
+     *
+     * The bytes are copied into the PUBLISH message as they are, so that a
+     * payload received in encoded form, e.g. wamp_event::raw_arguments(),
+     * is passed on without being decoded and re-encoded. They only need to
+     * be valid for the duration of the call.
+     *
+     * \param topic The URI of the topic to publish to.
+     * \param arguments The positional payload, an encoded array, or an empty view for none.
+     * \param kw_arguments The keyword payload, an encoded map, or an empty view for none.
+     * \param options Additional options for the publication.
+     * \return A future that resolves to the publication, as for publish() with options.
+     * \throw std::invalid_argument if the payload is not an encoded array or map.
+     */
+    boost::future<wamp_publication> publish_raw(
+            const std::string& topic,
+            const wamp_bytes_view& arguments,
+            const wamp_bytes_view& kw_arguments = wamp_bytes_view(),
+            const wamp_publish_options& options = wamp_publish_options());
+
+    /*!
+     * Publish an event with a payload that is msgpack-encoded already to a
+     * prepared topic. See publish_raw().
+     *
+     * \param prepared The prepared publication.
+     * \param arguments The positional payload, an encoded array, or an empty view for none.
+     * \param kw_arguments The keyword payload, an encoded map, or an empty view for none.
+     * \return A future that resolves to the publication.
+     * \throw std::invalid_argument if the payload is not an encoded array or map.
+     */
+    boost::future<wamp_publication> publish_raw(
+            const wamp_prepared_publication& prepared,
+            const wamp_bytes_view& arguments,
+            const wamp_bytes_view& kw_arguments = wamp_bytes_view());
+
+    /*!
+     * Publish an event with an opaque application payload, e.g. a protobuf
+     * message, that the WAMP layer does not interpret (payload transparency).
+     *
+     * The bytes are sent as the only positional argument, a binary, and the
+     * payload options of @p options as its ppt_* options. Subscribers get
+     * them back with wamp_event::payload() without any msgpack objects being
+     * built for the payload. The bytes only need to be valid for the
+     * duration of the call.
+     *
+     * \param topic The URI of the topic to publish to.
+     * \param payload The bytes of the payload.
+     * \param options Options for the publication, naming the payload scheme
+     *                with wamp_publish_options::set_payload_options().
+     * \return A future that resolves to the publication, as for publish() with options.
+     * \throw std::invalid_argument if no payload scheme is set in @p options.
+     */
+    boost::future<wamp_publication> publish_payload(
+            const std::string& topic,
+            const wamp_bytes_view& payload,
+            const wamp_publish_options& options);
+
+    /*!
+     * Publish an event with an opaque application payload to a prepared
+     * topic, whose options name the payload scheme. See publish_payload().
+     *
+     * \param prepared The prepared publication.
+     * \param payload The bytes of the payload.
+     * \return A future that resolves to the publication.
+     * \throw std::invalid_argument if @p prepared was prepared without a payload scheme.
+     */
+    boost::future<wamp_publication> publish_payload(
+            const wamp_prepared_publication& prepared,
+            const wamp_bytes_view& payload);
+
+    /*!
+     * Bounds the number of acknowledged publications awaiting their PUBLISHED.
+     *
+     * Once @p max_unacknowledged publications are unacknowledged, further
+     * publications made with options are queued in order, and sent as
+     * acknowledgements come in. The queue keeps a fast publisher from
+     * running ahead of the router without blocking any thread. Once
+     * @p max_queued publications are queued, further ones fail with
+     * publish_queue_full_error until the queue drains.
+     *
+     * \param max_unacknowledged The size of the window, or 0 for no limit (the default).
+     * \param max_queued The number of publications to queue at most, or 0 for no limit.
+     */
+    void set_publish_window(std::size_t max_unacknowledged, std::size_t max_queued = 1024);
+
+    /*!
+     * Opts in to serializing calls and publications on the calling thread.
+     *
+     * By default call() and publish() convert their arguments to msgpack
+     * objects on the calling thread, and the io thread packs them when it
+     * sends the message. With this set, the arguments are packed straight
+     * into the wire format on the calling thread instead, and only the
+     * finished bytes are handed to the io thread, so that serializing large
+     * payloads is spread over the threads producing them. Can be changed
+     * from any thread; it applies to calls and publications made afterwards.
+     *
+     * \param enabled Whether to serialize on the calling thread.
+     */
+    void set_serialize_on_caller(bool enabled);
+
+    /*!
+     * Opts in to keeping the arguments of inbound events, call results and
+     * invocations in the msgpack encoding they were received in, so that
+     * raw_arguments() and raw_kw_arguments() return them and they can be
+     * passed on with publish_raw(), call_raw() or result_raw() as they are.
+     *
+     * Each message is then copied once into the zone it is unpacked into,
+     * where its strings and binaries are referenced rather than copied
+     * again. Can be changed from any thread; it applies to messages the
+     * transport decodes afterwards, and to transports attached later.
+     *
+     * \param enabled Whether to keep the encoded arguments.
+     */
+    void set_keep_raw_arguments(bool enabled);
+
     /*!
      * Subscribe a handler to a topic to receive events.
      *
+     * Handlers subscribed to the same topic with the same match policy share
+     * one subscription with the router: only the first of them sends a
+     * SUBSCRIBE, and each event the router delivers is handed to all of them
+     * in the order they subscribed.
+     *
      * \param topic The URI of the topic to subscribe to.
      * \param handler The handler that will receive events under the subscription.
      * \param options The options to pass in the subscribe request to the router.
@@ -190,11 +529,33 @@ public:
     /*!
      * Unubscribe a handler to previosuly subscribed topic.
      *
+     * The UNSUBSCRIBE is only sent to the router once the last local handler
+     * sharing the subscription is gone. A subscription without a handler id
+     * unsubscribes all of them.
+     *
      * \param subscription The subscription to unsubscribe from.
      * \return A future that resolves to the unsubscribed response.
      */
     boost::future<void> unsubscribe(const wamp_subscription& subscription);
 
+    /*!
+     * Subscribe handlers to many topics at once.
+     *
+     * All SUBSCRIBE messages are written to the transport in one batch, and
+     * a single future tracks them. A topic that the router rejects does not
+     * fail the others; its item carries the error URI instead. As with
+     * subscribe(), topics subscribed or being subscribed already share that
+     * router subscription instead of sending another SUBSCRIBE.
+     *
+     * \param subscriptions The topics and the handlers to subscribe to them.
+     * \param options The options to pass in every subscribe request.
+     * \return A future that resolves once every subscription has been acknowledged
+     *         or rejected, to the outcome of each in order.
+     */
+    boost::future<wamp_subscribe_many_result> subscribe_many(
+            const std::vector<std::pair<std::string, wamp_event_handler>>& subscriptions,
+            const wamp_subscribe_options& options = wamp_subscribe_options());
+
     /*!
      * Calls a remote procedure with no arguments.
      *
@@ -235,6 +596,225 @@ public:
             const List& arguments, const Map& kw_arguments,
             const wamp_call_options& options = wamp_call_options());
 
+    /*!
+     * Calls a remote procedure and decodes its result into type R.
+     *
+     * If R is a `std::tuple` all positional result arguments are decoded
+     * into it, otherwise only the first one is. For `void` the result is
+     * discarded. The call result, and with it the zone holding the inbound
+     * message, is released as soon as it has been decoded.
+     *
+     * The arguments are sent as by call(), without being copied into a tuple
+     * first.
+     *
+     * Example:
+     * `boost::future<uint64_t> sum = session->typed_call<uint64_t>("com.example.add2", 23, 777);`
+     *
+     * \tparam R The type of the result.
+     * \param procedure The URI of the remote procedure to call.
+     * \param arguments The positional arguments for the call.
+     * \return A future that resolves to the decoded result of the call.
+     */
+    template <typename R, typename... Args>
+    boost::future<R> typed_call(const std::string& procedure, const Args&... arguments);
+
+    /*!
+     * Calls a remote procedure and decodes its result into type R on the
+     * given executor rather than on the io service. A thread pool can be
+     * passed by wrapping it in an adaptor, e.g.
+     * `boost::executors::executor_adaptor<boost::executors::basic_thread_pool>`.
+     *
+     * The executor must outlive the returned future.
+     *
+     * \tparam R The type of the result.
+     * \param executor The executor to decode the result on.
+     * \param procedure The URI of the remote procedure to call.
+     * \param arguments The positional arguments for the call.
+     * \return A future that resolves to the decoded result of the call.
+     */
+    template <typename R, typename... Args>
+    boost::future<R> typed_call(
+            boost::executors::executor& executor,
+            const std::string& procedure, const Args&... arguments);
+
+    /*!
+     * Calls a remote procedure with the given options, e.g. a timeout or
+     * payload options, and decodes its result into type R as above.
+     *
+     * Example:
+     * `session->typed_call<uint64_t>("com.example.add2", std::make_tuple(23, 777), options);`
+     *
+     * \tparam R The type of the result.
+     * \param procedure The URI of the remote procedure to call.
+     * \param arguments The positional arguments for the call, e.g. a `std::tuple`.
+     * \param options The options to pass in the call to the router.
+     * \return A future that resolves to the decoded result of the call.
+     */
+    template <typename R, typename List>
+    boost::future<R> typed_call(
+            const std::string& procedure, const List& arguments,
+            const wamp_call_options& options);
+
+    /*!
+     * Prepares calls to a procedure that is called often.
+     *
+     * The options and the procedure URI are packed once, here, so that each
+     * call made with the returned handle only packs its request id and its
+     * arguments. The handle may be kept and used from any thread.
+     *
+     * \param procedure The URI of the remote procedure to call.
+     * \param options The options to pass in every call to the router.
+     * \return The prepared call.
+     */
+    wamp_prepared_call prepare_call(
+            const std::string& procedure,
+            const wamp_call_options& options = wamp_call_options()) const;
+
+    /*!
+     * Calls a prepared procedure with no arguments.
+     *
+     * \param prepared The prepared call.
+     * \return A future that resolves to the result of the remote procedure call.
+     */
+    boost::future<wamp_call_result> call(const wamp_prepared_call& prepared);
+
+    /*!
+     * Calls a prepared procedure with positional arguments.
+     *
+     * \param prepared The prepared call.
+     * \param arguments The positional arguments for the call.
+     * \return A future that resolves to the result of the remote procedure call.
+     */
+    template <typename List>
+    boost::future<wamp_call_result> call(
+            const wamp_prepared_call& prepared,
+            const List& arguments);
+
+    /*!
+     * Calls a prepared procedure with positional and keyword arguments.
+     *
+     * \param prepared The prepared call.
+     * \param arguments The positional arguments for the call.
+     * \param kw_arguments The keyword arguments for the call.
+     * \return A future that resolves to the result of the remote procedure call.
+     */
+    template <typename List, typename Map>
+    boost::future<wamp_call_result> call(
+            const wamp_prepared_call& prepared,
+            const List& arguments, const Map& kw_arguments);
+
+    /*!
+     * Calls a remote procedure with arguments that are msgpack-encoded already.
+     *
+     * The bytes are copied into the CALL message as they are, so that
+     * arguments received in encoded form, e.g. wamp_invocation_impl::raw_arguments(),
+     * are passed on without being decoded and re-encoded. They only need to
+     * be valid for the duration of the call.
+     *
+     * \param procedure The URI of the remote procedure to call.
+     * \param arguments The positional arguments, an encoded array, or an empty view for none.
+     * \param kw_arguments The keyword arguments, an encoded map, or an empty view for none.
+     * \param options The options to pass in the call to the router.
+     * \return A future that resolves to the result of the remote procedure call.
+     * \throw std::invalid_argument if the arguments are not an encoded array or map.
+     */
+    boost::future<wamp_call_result> call_raw(
+            const std::string& procedure,
+            const wamp_bytes_view& arguments,
+            const wamp_bytes_view& kw_arguments = wamp_bytes_view(),
+            const wamp_call_options& options = wamp_call_options());
+
+    /*!
+     * Calls a prepared procedure with arguments that are msgpack-encoded
+     * already. See call_raw().
+     *
+     * \param prepared The prepared call.
+     * \param arguments The positional arguments, an encoded array, or an empty view for none.
+     * \param kw_arguments The keyword arguments, an encoded map, or an empty view for none.
+     * \return A future that resolves to the result of the remote procedure call.
+     * \throw std::invalid_argument if the arguments are not an encoded array or map.
+     */
+    boost::future<wamp_call_result> call_raw(
+            const wamp_prepared_call& prepared,
+            const wamp_bytes_view& arguments,
+            const wamp_bytes_view& kw_arguments = wamp_bytes_view());
+
+    /*!
+     * Calls a remote procedure with an opaque application payload that the
+     * WAMP layer does not interpret (payload transparency).
+     *
+     * The bytes are sent as the only positional argument, a binary, and the
+     * payload options of @p options as its ppt_* options. The callee gets
+     * them back with wamp_invocation_impl::payload(), and can reply with
+     * wamp_invocation_impl::result_payload(). The bytes only need to be
+     * valid for the duration of the call.
+     *
+     * \param procedure The URI of the remote procedure to call.
+     * \param payload The bytes of the payload.
+     * \param options Options for the call, naming the payload scheme with
+     *                wamp_call_options::set_payload_options().
+     * \return A future that resolves to the result of the remote procedure call.
+     * \throw std::invalid_argument if no payload scheme is set in @p options.
+     */
+    boost::future<wamp_call_result> call_payload(
+            const std::string& procedure,
+            const wamp_bytes_view& payload,
+            const wamp_call_options& options);
+
+    /*!
+     * Calls a prepared procedure, whose options name the payload scheme,
+     * with an opaque application payload. See call_payload().
+     *
+     * \param prepared The prepared call.
+     * \param payload The bytes of the payload.
+     * \return A future that resolves to the result of the remote procedure call.
+     * \throw std::invalid_argument if @p prepared was prepared without a payload scheme.
+     */
+    boost::future<wamp_call_result> call_payload(
+            const wamp_prepared_call& prepared,
+            const wamp_bytes_view& payload);
+
+    /*!
+     * Calls a remote procedure that replies with a large binary result in
+     * chunks, see wamp_invocation_impl::result_chunked(), and passes each
+     * chunk to @p handler as it arrives, so that the result never has to be
+     * held in memory as a whole.
+     *
+     * The call asks for progressive results, whatever @p options say. The
+     * handler runs on the io thread and the chunk it is given is only valid
+     * for the duration of the call. If it throws, the remaining chunks are
+     * dropped and the returned future fails with its exception.
+     *
+     * \param procedure The URI of the remote procedure to call.
+     * \param arguments The positional arguments for the call.
+     * \param handler The handler to pass the chunks to, in order.
+     * \param options The options to pass in the call to the router.
+     * \return A future that resolves to the size of the result in bytes
+     *         once the last chunk has been passed to the handler.
+     */
+    template <typename List>
+    boost::future<std::uint64_t> call_streamed(
+            const std::string& procedure,
+            const List& arguments,
+            const wamp_chunk_handler& handler,
+            const wamp_call_options& options = wamp_call_options());
+
+    /*!
+     * Calls a remote procedure that replies with a large binary result in
+     * chunks, see wamp_invocation_impl::result_chunked(), and reassembles
+     * them. See call_streamed().
+     *
+     * \param procedure The URI of the remote procedure to call.
+     * \param arguments The positional arguments for the call.
+     * \param options The options to pass in the call to the router.
+     * \return A future that resolves to the bytes of the result.
+     */
+    template <typename List>
+    boost::future<std::string> call_chunked(
+            const std::string& procedure,
+            const List& arguments,
+            const wamp_call_options& options = wamp_call_options());
+
     /*!
      * Register a procedure that can be called remotely.
      *
@@ -247,6 +827,31 @@ public:
             const std::string& uri,
             const wamp_procedure& procedure,
             const provide_options& options = provide_options());
+
+    /*!
+     * Register a procedure with a fixed C++ signature that can be called remotely.
+     *
+     * The positional arguments of each invocation are decoded directly into
+     * the parameters of @p function, and its return value is sent back as
+     * the single positional result. The parameter types, without references
+     * and cv-qualifiers, must be default constructible. See
+     * autobahn::wamp_typed_procedure.
+     *
+     * Example:
+     * `session->provide<uint64_t(uint64_t, uint64_t)>("com.example.add2", std::plus<uint64_t>());`
+     *
+     * \tparam Signature The function type of the procedure, e.g. `int(int, std::string)`.
+     * \param uri The URI associated with the procedure.
+     * \param function The callable to be exposed as a remotely callable procedure.
+     * \param options Options for registering the procedure.
+     * \return A future that resolves to a autobahn::registration
+     */
+    template <typename Signature, typename Function>
+    boost::future<wamp_registration> provide(
+            const std::string& uri,
+            Function&& function,
+            const provide_options& options = provide_options());
+
     /*!
     * Unregister a provider handler to previosuly provided registration.
     *
@@ -254,6 +859,21 @@ public:
     * \return A future that synchronizes to the unregister response.
     */
     boost::future<void> unprovide(const wamp_registration& registration);
+
+    /*!
+     * Register many procedures at once.
+     *
+     * All REGISTER messages are written to the transport in one batch, and a
+     * single future tracks them. See subscribe_many().
+     *
+     * \param procedures The URIs and the procedures to register under them.
+     * \param options Options for registering every procedure.
+     * \return A future that resolves once every registration has been acknowledged
+     *         or rejected, to the outcome of each in order.
+     */
+    boost::future<wamp_provide_many_result> provide_many(
+            const std::vector<std::pair<std::string, wamp_procedure>>& procedures,
+            const provide_options& options = provide_options());
     /*!
      * Function called by the session when authenticating. It always has to be
      * re-implemented (if authentication is part of the system).
@@ -271,12 +891,18 @@ private:
     virtual void on_message(wamp_message&& message) override;
     virtual void on_disconnect(bool was_clean, const std::string& reason) override;
 
+    // Implements the wamp invocation sink interface.
+    virtual msgpack::sbuffer acquire_reply_buffer() override;
+    virtual void on_invocation_reply(wamp_message&& reply, bool local) override;
+    virtual void defer_reply(std::function<void()>&& continuation) override;
+
     // WAMP message processing
     void process_error(wamp_message&& message);
     void process_welcome(wamp_message&& message);
     void process_abort(wamp_message&& message);
     void process_challenge(wamp_message&& message);
     void process_call_result(wamp_message&& message);
+    void process_published(wamp_message&& message);
     void process_subscribed(wamp_message&& message);
     void process_unsubscribed(wamp_message&& message);
     void process_event(wamp_message&& message);
@@ -286,9 +912,59 @@ private:
     void process_goodbye(wamp_message&& message);
 
     // Transmitting/receiving messages
+    template <typename... Fields>
+    std::shared_ptr<wamp_message> make_message(const Fields&... fields);
     void send_message(wamp_message&& message, bool session_established = true);
+    void send_messages(std::vector<wamp_message>&& messages, bool session_established = true);
     void receive_message();
 
+    // Publications
+    boost::future<void> publish_messages(std::vector<wamp_message>&& messages);
+    boost::future<wamp_publication> publish_prepared(const wamp_prepared_publication& prepared,
+            uint64_t request_id, msgpack::sbuffer&& buffer);
+    void publish_message(uint64_t request_id, const std::shared_ptr<wamp_message>& message,
+            const std::shared_ptr<boost::promise<wamp_publication>>& publication,
+            bool acknowledge, bool exclude_me);
+    void send_publication(uint64_t request_id, wamp_message&& message,
+            const std::shared_ptr<boost::promise<wamp_publication>>& publication,
+            bool acknowledge, bool exclude_me);
+    void send_queued_publications();
+
+    // Local subscribers
+    wamp_subscription add_subscriber(uint64_t subscription_id, const wamp_subscriber& subscriber);
+    void complete_subscribe_followers(uint64_t request_id, uint64_t subscription_id);
+    void fail_subscribe_followers(uint64_t request_id, const wamp_error& error);
+    void deliver_event(uint64_t subscription_id, const wamp_event& event);
+    void deliver_locally(const wamp_message& message);
+
+    // Prepared calls
+    boost::future<wamp_call_result> call_prepared(const wamp_prepared_call& prepared,
+            uint64_t request_id, msgpack::sbuffer&& buffer,
+            wamp_call::progress_handler&& progress = wamp_call::progress_handler());
+
+    // Chunked calls
+    struct chunked_call
+    {
+        wamp_chunk_handler handler;
+        std::uint64_t size;
+        std::exception_ptr error;
+    };
+    static void receive_chunk(chunked_call& call, const wamp_call_result& chunk);
+
+    // Local procedures and calls
+    void add_procedure(uint64_t registration_id, const wamp_provider& provider);
+    void remove_local_procedure(uint64_t registration_id);
+    void invoke_procedure(uint64_t registration_id, const wamp_procedure& procedure,
+            const wamp_invocation& invocation);
+    bool call_locally(const std::string& procedure, uint64_t request_id,
+            const std::shared_ptr<wamp_call>& call, const std::shared_ptr<wamp_message>& message);
+    template <typename R>
+    boost::future<R> decode_call_result(boost::executors::executor& executor,
+            boost::future<wamp_call_result>&& result);
+    void invoke_locally(uint64_t registration_id, wamp_message&& message,
+            const std::weak_ptr<wamp_session>& caller);
+    void process_local_reply(wamp_message&& reply);
+
     void got_handshake_reply(const boost::system::error_code& error);
     void got_message_header(const boost::system::error_code& error);
     void got_message_body(const boost::system::error_code& error);
@@ -298,6 +974,10 @@ private:
 
     boost::asio::io_service& m_io_service;
 
+    // Runs continuations of the futures we hand out on the io service. The
+    // futures share it, so that it outlives the session if need be.
+    boost::shared_ptr<wamp_io_executor> m_executor;
+
     // The transport this session runs on.
     std::shared_ptr<wamp_transport> m_transport;
 
@@ -307,6 +987,21 @@ private:
     // WAMP session ID (if the session is joined to a realm).
     uint64_t m_session_id;
 
+    // Recycled buffers for outgoing messages.
+    wamp_buffer_pool m_buffer_pool;
+
+    // Recycled zones for inbound messages, shared with the objects unpacked into them.
+    std::shared_ptr<wamp_zone_pool> m_zone_pool;
+
+    // Recycled invocations handed to provided procedures.
+    std::shared_ptr<wamp_invocation_pool> m_invocation_pool;
+
+    // Whether calls and publications are packed on the calling thread.
+    std::atomic<bool> m_serialize_on_caller;
+
+    // Whether inbound arguments keep their encoding, see set_keep_raw_arguments().
+    std::atomic<bool> m_keep_raw_arguments;
+
     // Synchronization for dealing with starting the session.
     boost::promise<void> m_session_start;
 
@@ -330,17 +1025,82 @@ private:
     // Track pending calls by request id.
     std::map<uint64_t /*request id*/, std::shared_ptr<wamp_call>> m_calls;
 
+    //////////////////////////////////////////////////////////////////////////////////////
+    // Publisher
+
+    // A publication held back by the publish window.
+    struct queued_publication
+    {
+        uint64_t request_id;
+        std::shared_ptr<wamp_message> message;
+        std::shared_ptr<boost::promise<wamp_publication>> publication;
+        bool acknowledge;
+        bool exclude_me;
+    };
+
+    // Acknowledged publications awaiting their PUBLISHED by request id.
+    std::map<uint64_t /*request id*/, std::shared_ptr<boost::promise<wamp_publication>>> m_publish_requests;
+
+    // Publications waiting for room in the publish window, in order.
+    std::deque<queued_publication> m_publish_queue;
+
+    // The maximum number of unacknowledged publications, or 0 for no limit.
+    std::size_t m_publish_window;
+
+    // The maximum number of queued publications, or 0 for no limit.
+    std::size_t m_publish_queue_limit;
+
     //////////////////////////////////////////////////////////////////////////////////////
     // Subscriber
 
+    // Local subscribers sharing a router subscription are keyed by topic and match policy.
+    using subscription_key = std::pair<std::string /*topic*/, std::string /*match*/>;
+
+    // A router subscription and the local handlers it fans events out to,
+    // kept in the order of their (increasing) handler ids. Handlers are
+    // shared so that delivering an event can hold on to one without copying
+    // it.
+    struct subscription_state
+    {
+        subscription_key key;
+        std::vector<std::pair<uint64_t /*handler id*/, std::shared_ptr<const wamp_event_handler>>> handlers;
+    };
+
     // Pending subscribe requests by request id.
     std::map<uint64_t /*request id*/, std::shared_ptr<wamp_subscribe_request>> m_subscribe_requests;
 
+    // Subscribe requests waiting on a pending request for the same topic and match policy.
+    std::multimap<uint64_t /*request id*/, std::shared_ptr<wamp_subscribe_request>> m_subscribe_followers;
+
+    // Request ids of pending subscribe requests by topic and match policy.
+    std::map<subscription_key, uint64_t /*request id*/> m_pending_subscriptions;
+
+    // Pending subscribe_many requests by their first request id.
+    std::map<uint64_t /*request id*/, std::shared_ptr<wamp_bulk_request<wamp_subscription,
+            wamp_subscriber>>> m_subscribe_many_requests;
+
+    // Items of subscribe_many requests waiting on a pending request for the same topic and
+    // match policy, by the request id they wait on and then their own.
+    std::multimap<uint64_t /*request id*/, std::pair<std::shared_ptr<wamp_bulk_request<
+            wamp_subscription, wamp_subscriber>>, uint64_t /*item request id*/>> m_subscribe_many_followers;
+
     // Pending unsubscribe requests by request id.
     std::map<uint64_t /*request id*/, std::shared_ptr<wamp_unsubscribe_request>> m_unsubscribe_requests;
 
-    // Event handlers by subscription id.
-    std::multimap<uint64_t /*subscription id*/, wamp_event_handler> m_subscription_handlers;
+    // Router subscriptions by subscription id.
+    std::map<uint64_t /*subscription id*/, subscription_state> m_subscriptions;
+
+    // Subscription ids of the router subscriptions in use by topic and match policy.
+    std::map<subscription_key, uint64_t /*subscription id*/> m_subscription_ids;
+
+    // The last handler id handed out to a local subscriber.
+    uint64_t m_subscriber_id;
+
+    // Subscription ids by the topic pattern of the subscription, for local delivery.
+    wamp_uri_trie<uint64_t> m_subscription_topics;
+
+    // Whether publications are delivered to local subscribers directly.
+    bool m_local_delivery;
 
     //////////////////////////////////////////////////////////////////////////////////////
     // Callee
@@ -348,11 +1108,21 @@ private:
     // Map of outstanding WAMP register requests (request ID -> register request).
     std::map<uint64_t, std::shared_ptr<wamp_register_request>> m_register_requests;
 
+    // Map of outstanding provide_many requests (first request ID -> request).
+    std::map<uint64_t, std::shared_ptr<wamp_bulk_request<wamp_registration,
+            wamp_provider>>> m_provide_many_requests;
+
     // Map of outstanding WAMP unregister requests (request ID -> unregister request).
     std::map<uint64_t, std::shared_ptr<wamp_unregister_request>> m_unregister_requests;
 
     // Map of registered procedures (registration ID -> procedure)
     std::map<uint64_t, wamp_procedure> m_procedures;
+
+    // Registry of procedures that may be called locally, if opted in.
+    std::shared_ptr<wamp_local_procedures> m_local_procedures;
+
+    // URIs of the registrations entered in the registry (registration ID -> URI).
+    std::map<uint64_t, std::string> m_local_uris;
 };
 
 } // namespace autobahn
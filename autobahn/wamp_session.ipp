@@ -56,24 +56,93 @@
 #endif
 
 #include <boost/system/error_code.hpp>
+#include <algorithm>
 #include <cstdint>
 #include <exception>
 #include <iostream>
 #include <sstream>
 #include <stdlib.h>
+#include <tuple>
 
 namespace autobahn {
 
+namespace detail {
+
+template <typename R>
+struct typed_call_result
+{
+    static R decode(wamp_call_result&& result)
+    {
+        return result.argument<R>(0);
+    }
+};
+
+template <typename... T>
+struct typed_call_result<std::tuple<T...>>
+{
+    static std::tuple<T...> decode(wamp_call_result&& result)
+    {
+        return result.arguments<std::tuple<T...>>();
+    }
+};
+
+template <>
+struct typed_call_result<void>
+{
+    static void decode(wamp_call_result&&)
+    {
+    }
+};
+
+/// Whether registering with @p options makes a single callee match URIs exactly.
+inline bool is_exact_single_registration(const provide_options& options)
+{
+    auto match_itr = options.find("match");
+    if (match_itr != options.end() && match_itr->second.as<std::string>() != "exact") {
+        return false;
+    }
+
+    auto invoke_itr = options.find("invoke");
+    return invoke_itr == options.end() || invoke_itr->second.as<std::string>() == "single";
+}
+
+/// Finds the bulk request whose range of request ids covers @p request_id.
+template <typename Requests>
+typename Requests::iterator find_bulk_request(Requests& requests, uint64_t request_id)
+{
+    auto itr = requests.upper_bound(request_id);
+    if (itr == requests.begin()) {
+        return requests.end();
+    }
+    --itr;
+    return itr->second->contains(request_id) ? itr : requests.end();
+}
+
+} // namespace detail
+
 inline wamp_session::wamp_session(
         boost::asio::io_service& io_service,
         bool debug_enabled)
     : m_debug_enabled(debug_enabled)
     , m_io_service(io_service)
+    , m_executor(boost::make_shared<wamp_io_executor>(io_service))
     , m_transport()
     , m_request_id(ATOMIC_VAR_INIT(0))
     , m_session_id(0)
+    , m_buffer_pool()
+    , m_zone_pool(std::make_shared<wamp_zone_pool>())
+    , m_invocation_pool(std::make_shared<wamp_invocation_pool>())
+    , m_serialize_on_caller(false)
+    , m_keep_raw_arguments(false)
     , m_goodbye_sent(false)
     , m_running(false)
+    , m_publish_requests()
+    , m_publish_queue()
+    , m_publish_window(0)
+    , m_publish_queue_limit(1024)
+    , m_subscriber_id(0)
+    , m_subscription_topics()
+    , m_local_delivery(false)
 {
 }
 
@@ -81,6 +150,93 @@ inline wamp_session::~wamp_session()
 {
 }
 
+inline wamp_buffer_pool& wamp_session::buffer_pool()
+{
+    return m_buffer_pool;
+}
+
+inline wamp_zone_pool& wamp_session::zone_pool()
+{
+    return *m_zone_pool;
+}
+
+inline wamp_invocation_pool& wamp_session::invocation_pool()
+{
+    return *m_invocation_pool;
+}
+
+inline wamp_io_executor& wamp_session::executor()
+{
+    return *m_executor;
+}
+
+inline void wamp_session::set_local_procedures(const std::shared_ptr<wamp_local_procedures>& procedures)
+{
+    auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        for (const auto& local_uri : m_local_uris) {
+            m_local_procedures->remove(local_uri.second, local_uri.first);
+        }
+        m_local_uris.clear();
+        m_local_procedures = procedures;
+    });
+}
+
+inline void wamp_session::set_local_delivery(bool enabled)
+{
+    auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        m_local_delivery = enabled;
+    });
+}
+
+inline void wamp_session::set_publish_window(std::size_t max_unacknowledged, std::size_t max_queued)
+{
+    auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        m_publish_window = max_unacknowledged;
+        m_publish_queue_limit = max_queued;
+        send_queued_publications();
+    });
+}
+
+inline void wamp_session::set_serialize_on_caller(bool enabled)
+{
+    m_serialize_on_caller = enabled;
+}
+
+inline void wamp_session::set_keep_raw_arguments(bool enabled)
+{
+    m_keep_raw_arguments = enabled;
+
+    // The transport decodes on the io thread.
+    auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
+    m_io_service.dispatch([weak_self, enabled]() {
+        auto shared_self = weak_self.lock();
+        if (shared_self && shared_self->m_transport) {
+            shared_self->m_transport->set_keep_raw_fields(enabled);
+        }
+    });
+}
+
 inline boost::future<void> wamp_session::start()
 {
     auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
@@ -91,6 +247,8 @@ inline boost::future<void> wamp_session::start()
             return;
         }
 
+        m_executor->set_io_thread();
+
         if (m_running) {
             m_session_start.set_exception(protocol_error("session already started"));
             return;
@@ -105,7 +263,7 @@ inline boost::future<void> wamp_session::start()
         m_session_start.set_value();
     });
 
-    return m_session_start.get_future();
+    return bind_executor(m_executor, m_session_start);
 }
 
 inline boost::future<void> wamp_session::stop()
@@ -138,7 +296,7 @@ inline boost::future<void> wamp_session::stop()
         m_session_stop.set_value();
     });
 
-    return m_session_stop.get_future();
+    return bind_executor(m_executor, m_session_stop);
 }
 
 inline boost::future<uint64_t> wamp_session::join(
@@ -151,20 +309,30 @@ inline boost::future<uint64_t> wamp_session::join(
 
     std::unordered_map<std::string, bool> caller_features;
     caller_features["call_timeout"] = true;
+    caller_features["payload_transparency"] = true;
+    caller_features["progressive_call_results"] = true;
     std::unordered_map<std::string, msgpack::object> caller;
     caller["features"] = msgpack::object(caller_features, zone);
     roles["caller"] = msgpack::object(caller, zone);
 
     std::unordered_map<std::string, bool> callee_features;
     callee_features["call_timeout"] = true;
+    callee_features["payload_transparency"] = true;
+    callee_features["progressive_call_results"] = true;
     std::unordered_map<std::string, msgpack::object> callee;
     callee["features"] = msgpack::object(callee_features, zone);
     roles["callee"] = msgpack::object(callee, zone);
 
+    std::unordered_map<std::string, bool> publisher_features;
+    publisher_features["payload_transparency"] = true;
     std::unordered_map<std::string, msgpack::object> publisher;
+    publisher["features"] = msgpack::object(publisher_features, zone);
     roles["publisher"] = msgpack::object(publisher, zone);
 
+    std::unordered_map<std::string, bool> subscriber_features;
+    subscriber_features["payload_transparency"] = true;
     std::unordered_map<std::string, msgpack::object> subscriber;
+    subscriber["features"] = msgpack::object(subscriber_features, zone);
     roles["subscriber"] = msgpack::object(subscriber, zone);
 
     std::unordered_map<std::string, msgpack::object> details;
@@ -197,7 +365,7 @@ inline boost::future<uint64_t> wamp_session::join(
         }
     });
 
-    return m_session_join.get_future();
+    return bind_executor(m_executor, m_session_join);
 }
 
 inline boost::future<std::string> wamp_session::leave(const std::string& reason)
@@ -235,18 +403,16 @@ inline boost::future<std::string> wamp_session::leave(const std::string& reason)
         m_session_id = 0;
     });
 
-    return m_session_leave.get_future();
+    return bind_executor(m_executor, m_session_leave);
 }
 
 inline boost::future<void> wamp_session::publish(const std::string& topic)
 {
     uint64_t request_id = ++m_request_id;
 
-    auto message = std::make_shared<wamp_message>(4);
-    message->set_field(0, static_cast<int>(message_type::PUBLISH));
-    message->set_field(1, request_id);
-    message->set_field(2, std::unordered_map<int, int>() /* No Options */);
-    message->set_field(3, topic);
+    auto message = make_message(
+            static_cast<int>(message_type::PUBLISH), request_id,
+            std::unordered_map<int, int>() /* No Options */, topic);
 
     auto result = std::make_shared<boost::promise<void>>();
     auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
@@ -258,6 +424,7 @@ inline boost::future<void> wamp_session::publish(const std::string& topic)
         }
 
         try {
+            deliver_locally(*message);
             send_message(std::move(*message));
             result->set_value();
         } catch (const std::exception& e) {
@@ -265,7 +432,7 @@ inline boost::future<void> wamp_session::publish(const std::string& topic)
         }
     });
 
-    return result->get_future();
+    return bind_executor(m_executor, *result);
 }
 
 template <typename List>
@@ -273,12 +440,9 @@ inline boost::future<void> wamp_session::publish(const std::string& topic, const
 {
     uint64_t request_id = ++m_request_id;
 
-    auto message = std::make_shared<wamp_message>(5);
-    message->set_field(0, static_cast<int>(message_type::PUBLISH));
-    message->set_field(1, request_id);
-    message->set_field(2, std::unordered_map<int, int>() /* No Options */);
-    message->set_field(3, topic);
-    message->set_field(4, arguments);
+    auto message = make_message(
+            static_cast<int>(message_type::PUBLISH), request_id,
+            std::unordered_map<int, int>() /* No Options */, topic, arguments);
 
     auto result = std::make_shared<boost::promise<void>>();
     auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
@@ -290,6 +454,7 @@ inline boost::future<void> wamp_session::publish(const std::string& topic, const
         }
 
         try {
+            deliver_locally(*message);
             send_message(std::move(*message));
             result->set_value();
         } catch (const std::exception& e) {
@@ -297,7 +462,7 @@ inline boost::future<void> wamp_session::publish(const std::string& topic, const
         }
     });
 
-    return result->get_future();
+    return bind_executor(m_executor, *result);
 }
 
 template <typename List, typename Map>
@@ -306,13 +471,9 @@ inline boost::future<void> wamp_session::publish(
 {
     uint64_t request_id = ++m_request_id;
 
-    auto message = std::make_shared<wamp_message>(6);
-    message->set_field(0, static_cast<int>(message_type::PUBLISH));
-    message->set_field(1, request_id);
-    message->set_field(2, std::unordered_map<int, int>() /* No Options */);
-    message->set_field(3, topic);
-    message->set_field(4, arguments);
-    message->set_field(5, kw_arguments);
+    auto message = make_message(
+            static_cast<int>(message_type::PUBLISH), request_id,
+            std::unordered_map<int, int>() /* No Options */, topic, arguments, kw_arguments);
 
     auto result = std::make_shared<boost::promise<void>>();
     auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
@@ -324,6 +485,7 @@ inline boost::future<void> wamp_session::publish(
         }
 
         try {
+            deliver_locally(*message);
             send_message(std::move(*message));
             result->set_value();
         } catch (const std::exception& e) {
@@ -331,24 +493,71 @@ inline boost::future<void> wamp_session::publish(
         }
     });
 
-    return result->get_future();
+    return bind_executor(m_executor, *result);
 }
 
-inline boost::future<wamp_subscription> wamp_session::subscribe(
-        const std::string& topic,
-        const wamp_event_handler& handler,
-        const wamp_subscribe_options& options)
+template <typename List>
+inline boost::future<void> wamp_session::publish_many(
+        const std::vector<std::pair<std::string, List>>& publications)
+{
+    uint64_t first_request_id = m_request_id.fetch_add(publications.size()) + 1;
+
+    std::vector<wamp_message> messages;
+    messages.reserve(publications.size());
+    for (std::size_t i = 0; i < publications.size(); ++i) {
+        // [PUBLISH, Request|id, Options|dict, Topic|uri, Arguments|list]
+        msgpack::sbuffer buffer = m_buffer_pool.acquire();
+        msgpack::packer<msgpack::sbuffer> packer(buffer);
+        packer.pack_array(5);
+        packer.pack(static_cast<int>(message_type::PUBLISH));
+        packer.pack(first_request_id + i);
+        packer.pack_map(0);
+        packer.pack(publications[i].first);
+        packer.pack(publications[i].second);
+        messages.emplace_back(std::move(buffer));
+    }
+
+    return publish_messages(std::move(messages));
+}
+
+template <typename List, typename Map>
+inline boost::future<void> wamp_session::publish_many(
+        const std::vector<std::tuple<std::string, List, Map>>& publications)
+{
+    uint64_t first_request_id = m_request_id.fetch_add(publications.size()) + 1;
+
+    std::vector<wamp_message> messages;
+    messages.reserve(publications.size());
+    for (std::size_t i = 0; i < publications.size(); ++i) {
+        // [PUBLISH, Request|id, Options|dict, Topic|uri, Arguments|list, ArgumentsKw|dict]
+        msgpack::sbuffer buffer = m_buffer_pool.acquire();
+        msgpack::packer<msgpack::sbuffer> packer(buffer);
+        packer.pack_array(6);
+        packer.pack(static_cast<int>(message_type::PUBLISH));
+        packer.pack(first_request_id + i);
+        packer.pack_map(0);
+        packer.pack(std::get<0>(publications[i]));
+        packer.pack(std::get<1>(publications[i]));
+        packer.pack(std::get<2>(publications[i]));
+        messages.emplace_back(std::move(buffer));
+    }
+
+    return publish_messages(std::move(messages));
+}
+
+inline boost::future<wamp_publication> wamp_session::publish(
+        const std::string& topic, const wamp_publish_options& options)
 {
     uint64_t request_id = ++m_request_id;
 
-    auto message = std::make_shared<wamp_message>(4);
-    message->set_field(0, static_cast<int>(message_type::SUBSCRIBE));
-    message->set_field(1, request_id);
-    message->set_field(2, options);
-    message->set_field(3, topic);
+    auto message = make_message(
+            static_cast<int>(message_type::PUBLISH), request_id,
+            options, topic);
 
+    auto publication = std::make_shared<boost::promise<wamp_publication>>();
     auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
-    auto subscribe_request = std::make_shared<wamp_subscribe_request>(handler);
+    bool acknowledge = options.acknowledge();
+    bool exclude_me = options.exclude_me();
 
     m_io_service.dispatch([=]() {
         auto shared_self = weak_self.lock();
@@ -357,27 +566,29 @@ inline boost::future<wamp_subscription> wamp_session::subscribe(
         }
 
         try {
-            send_message(std::move(*message));
-            m_subscribe_requests.emplace(request_id, subscribe_request);
+            publish_message(request_id, message, publication, acknowledge, exclude_me);
         } catch (const std::exception& e) {
-            subscribe_request->response().set_exception(boost::copy_exception(e));
+            publication->set_exception(boost::copy_exception(e));
         }
     });
 
-    return subscribe_request->response().get_future();
+    return bind_executor(m_executor, *publication);
 }
 
-inline boost::future<void> wamp_session::unsubscribe(const wamp_subscription& subscription)
+template <typename List>
+inline boost::future<wamp_publication> wamp_session::publish(
+        const std::string& topic, const List& arguments, const wamp_publish_options& options)
 {
     uint64_t request_id = ++m_request_id;
 
-    auto message = std::make_shared<wamp_message>(3);
-    message->set_field(0, static_cast<int>(message_type::UNSUBSCRIBE));
-    message->set_field(1, request_id);
-    message->set_field(2, subscription.id());
+    auto message = make_message(
+            static_cast<int>(message_type::PUBLISH), request_id,
+            options, topic, arguments);
 
+    auto publication = std::make_shared<boost::promise<wamp_publication>>();
     auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
-    auto unsubscribe_request = std::make_shared<wamp_unsubscribe_request>(subscription);
+    bool acknowledge = options.acknowledge();
+    bool exclude_me = options.exclude_me();
 
     m_io_service.dispatch([=]() {
         auto shared_self = weak_self.lock();
@@ -386,30 +597,30 @@ inline boost::future<void> wamp_session::unsubscribe(const wamp_subscription& su
         }
 
         try {
-            send_message(std::move(*message));
-            m_unsubscribe_requests.emplace(request_id, unsubscribe_request);
+            publish_message(request_id, message, publication, acknowledge, exclude_me);
         } catch (const std::exception& e) {
-            unsubscribe_request->response().set_exception(boost::copy_exception(e));
+            publication->set_exception(boost::copy_exception(e));
         }
     });
 
-    return unsubscribe_request->response().get_future();
+    return bind_executor(m_executor, *publication);
 }
 
-inline boost::future<wamp_call_result> wamp_session::call(
-        const std::string& procedure,
-        const wamp_call_options& options)
+template <typename List, typename Map>
+inline boost::future<wamp_publication> wamp_session::publish(
+        const std::string& topic, const List& arguments, const Map& kw_arguments,
+        const wamp_publish_options& options)
 {
     uint64_t request_id = ++m_request_id;
 
-    auto message = std::make_shared<wamp_message>(4);
-    message->set_field(0, static_cast<int>(message_type::CALL));
-    message->set_field(1, request_id);
-    message->set_field(2, options);
-    message->set_field(3, procedure);
+    auto message = make_message(
+            static_cast<int>(message_type::PUBLISH), request_id,
+            options, topic, arguments, kw_arguments);
 
+    auto publication = std::make_shared<boost::promise<wamp_publication>>();
     auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
-    auto call = std::make_shared<wamp_call>();
+    bool acknowledge = options.acknowledge();
+    bool exclude_me = options.exclude_me();
 
     m_io_service.dispatch([=]() {
         auto shared_self = weak_self.lock();
@@ -418,33 +629,128 @@ inline boost::future<wamp_call_result> wamp_session::call(
         }
 
         try {
-            send_message(std::move(*message));
-            m_calls.emplace(request_id, call);
+            publish_message(request_id, message, publication, acknowledge, exclude_me);
         } catch (const std::exception& e) {
-            call->result().set_exception(boost::copy_exception(e));
+            publication->set_exception(boost::copy_exception(e));
         }
     });
 
-    return call->result().get_future();
+    return bind_executor(m_executor, *publication);
 }
 
-template<typename List>
-inline boost::future<wamp_call_result> wamp_session::call(
-        const std::string& procedure,
-        const List& arguments,
-        const wamp_call_options& options)
+inline wamp_prepared_publication wamp_session::prepare_publish(
+        const std::string& topic, const wamp_publish_options& options) const
+{
+    return wamp_prepared_publication(topic, options);
+}
+
+inline boost::future<wamp_publication> wamp_session::publish(
+        const wamp_prepared_publication& prepared)
+{
+    uint64_t request_id = ++m_request_id;
+
+    // [PUBLISH, Request|id, Options|dict, Topic|uri]
+    msgpack::sbuffer buffer = m_buffer_pool.acquire();
+    prepared.pack_prefix(buffer, request_id, 4);
+
+    return publish_prepared(prepared, request_id, std::move(buffer));
+}
+
+template <typename List>
+inline boost::future<wamp_publication> wamp_session::publish(
+        const wamp_prepared_publication& prepared, const List& arguments)
+{
+    uint64_t request_id = ++m_request_id;
+
+    // [PUBLISH, Request|id, Options|dict, Topic|uri, Arguments|list]
+    msgpack::sbuffer buffer = m_buffer_pool.acquire();
+    prepared.pack_prefix(buffer, request_id, 5);
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack(arguments);
+
+    return publish_prepared(prepared, request_id, std::move(buffer));
+}
+
+template <typename List, typename Map>
+inline boost::future<wamp_publication> wamp_session::publish(
+        const wamp_prepared_publication& prepared, const List& arguments, const Map& kw_arguments)
+{
+    uint64_t request_id = ++m_request_id;
+
+    // [PUBLISH, Request|id, Options|dict, Topic|uri, Arguments|list, ArgumentsKw|dict]
+    msgpack::sbuffer buffer = m_buffer_pool.acquire();
+    prepared.pack_prefix(buffer, request_id, 6);
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack(arguments);
+    packer.pack(kw_arguments);
+
+    return publish_prepared(prepared, request_id, std::move(buffer));
+}
+
+inline boost::future<wamp_publication> wamp_session::publish_raw(
+        const std::string& topic, const wamp_bytes_view& arguments,
+        const wamp_bytes_view& kw_arguments, const wamp_publish_options& options)
+{
+    return publish_raw(wamp_prepared_publication(topic, options), arguments, kw_arguments);
+}
+
+inline boost::future<wamp_publication> wamp_session::publish_raw(
+        const wamp_prepared_publication& prepared,
+        const wamp_bytes_view& arguments, const wamp_bytes_view& kw_arguments)
+{
+    uint64_t request_id = ++m_request_id;
+
+    // [PUBLISH, Request|id, Options|dict, Topic|uri, Arguments|list, ArgumentsKw|dict]
+    msgpack::sbuffer buffer = m_buffer_pool.acquire();
+    prepared.pack_prefix(buffer, request_id, 4 + raw_argument_fields(arguments, kw_arguments));
+    pack_raw_arguments(buffer, arguments, kw_arguments);
+
+    return publish_prepared(prepared, request_id, std::move(buffer));
+}
+
+inline boost::future<wamp_publication> wamp_session::publish_payload(
+        const std::string& topic, const wamp_bytes_view& payload,
+        const wamp_publish_options& options)
+{
+    if (!options.payload_options().is_set()) {
+        throw std::invalid_argument("payload options must name a scheme");
+    }
+    return publish_payload(wamp_prepared_publication(topic, options), payload);
+}
+
+inline boost::future<wamp_publication> wamp_session::publish_payload(
+        const wamp_prepared_publication& prepared, const wamp_bytes_view& payload)
+{
+    if (!prepared.has_payload_options()) {
+        throw std::invalid_argument("payload options must name a scheme");
+    }
+
+    uint64_t request_id = ++m_request_id;
+
+    // [PUBLISH, Request|id, Options|dict, Topic|uri, Arguments|list]
+    msgpack::sbuffer buffer = m_buffer_pool.acquire();
+    prepared.pack_prefix(buffer, request_id, 5);
+    pack_payload_argument(buffer, payload);
+
+    return publish_prepared(prepared, request_id, std::move(buffer));
+}
+
+inline boost::future<wamp_subscription> wamp_session::subscribe(
+        const std::string& topic,
+        const wamp_event_handler& handler,
+        const wamp_subscribe_options& options)
 {
     uint64_t request_id = ++m_request_id;
 
-    auto message = std::make_shared<wamp_message>(5);
-    message->set_field(0, static_cast<int>(message_type::CALL));
+    auto message = std::make_shared<wamp_message>(4);
+    message->set_field(0, static_cast<int>(message_type::SUBSCRIBE));
     message->set_field(1, request_id);
     message->set_field(2, options);
-    message->set_field(3, procedure);
-    message->set_field(4, arguments);
+    message->set_field(3, topic);
 
     auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
-    auto call = std::make_shared<wamp_call>();
+    auto subscribe_request = std::make_shared<wamp_subscribe_request>(
+            topic, options.is_match_set() ? options.match() : "exact", handler);
 
     m_io_service.dispatch([=]() {
         auto shared_self = weak_self.lock();
@@ -452,36 +758,64 @@ inline boost::future<wamp_call_result> wamp_session::call(
             return;
         }
 
+        subscription_key key(subscribe_request->topic(), subscribe_request->match());
+
+        // Share a subscription already held with the router, or one still
+        // being requested, rather than subscribing a second time.
+        auto subscription_id_itr = m_subscription_ids.find(key);
+        if (subscription_id_itr != m_subscription_ids.end()) {
+            subscribe_request->set_response(add_subscriber(subscription_id_itr->second,
+                    wamp_subscriber{key.first, key.second, subscribe_request->handler()}));
+            return;
+        }
+
+        auto pending_itr = m_pending_subscriptions.find(key);
+        if (pending_itr != m_pending_subscriptions.end()) {
+            m_subscribe_followers.emplace(pending_itr->second, subscribe_request);
+            return;
+        }
+
         try {
             send_message(std::move(*message));
-            m_calls.emplace(request_id, call);
+            m_subscribe_requests.emplace(request_id, subscribe_request);
+            m_pending_subscriptions.emplace(key, request_id);
         } catch (const std::exception& e) {
-            call->result().set_exception(boost::copy_exception(e));
+            subscribe_request->response().set_exception(boost::copy_exception(e));
         }
     });
 
-    return call->result().get_future();
+    return bind_executor(m_executor, subscribe_request->response());
 }
 
-template<typename List, typename Map>
-inline boost::future<wamp_call_result> wamp_session::call(
-        const std::string& procedure,
-        const List& arguments,
-        const Map& kw_arguments,
-        const wamp_call_options& options)
+inline boost::future<wamp_subscribe_many_result> wamp_session::subscribe_many(
+        const std::vector<std::pair<std::string, wamp_event_handler>>& subscriptions,
+        const wamp_subscribe_options& options)
 {
-    uint64_t request_id = ++m_request_id;
-
-    auto message = std::make_shared<wamp_message>(6);
-    message->set_field(0, static_cast<int>(message_type::CALL));
-    message->set_field(1, request_id);
-    message->set_field(2, options);
-    message->set_field(3, procedure);
-    message->set_field(4, arguments);
-    message->set_field(5, kw_arguments);
+    uint64_t first_request_id = m_request_id.fetch_add(subscriptions.size()) + 1;
+
+    // Each message is packed straight into its buffer rather than built
+    // from msgpack objects in a zone of its own.
+    auto messages = std::make_shared<std::vector<wamp_message>>();
+    messages->reserve(subscriptions.size());
+    std::vector<wamp_subscriber> subscribers;
+    subscribers.reserve(subscriptions.size());
+    const std::string match = options.is_match_set() ? options.match() : "exact";
+    for (std::size_t i = 0; i < subscriptions.size(); ++i) {
+        // [SUBSCRIBE, Request|id, Options|dict, Topic|uri]
+        msgpack::sbuffer buffer = m_buffer_pool.acquire();
+        msgpack::packer<msgpack::sbuffer> packer(buffer);
+        packer.pack_array(4);
+        packer.pack(static_cast<int>(message_type::SUBSCRIBE));
+        packer.pack(first_request_id + i);
+        packer.pack(options);
+        packer.pack(subscriptions[i].first);
+        messages->emplace_back(std::move(buffer));
+        subscribers.push_back(wamp_subscriber{subscriptions[i].first, match, subscriptions[i].second});
+    }
 
     auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
-    auto call = std::make_shared<wamp_call>();
+    auto request = std::make_shared<wamp_bulk_request<wamp_subscription, wamp_subscriber>>(
+            first_request_id, std::move(subscribers));
 
     m_io_service.dispatch([=]() {
         auto shared_self = weak_self.lock();
@@ -489,32 +823,80 @@ inline boost::future<wamp_call_result> wamp_session::call(
             return;
         }
 
+        if (request->size() == 0) {
+            request->response().set_value(wamp_subscribe_many_result());
+            return;
+        }
+
+        // Topics already subscribed with the router are completed locally,
+        // and topics still being requested join the pending request, as in
+        // subscribe(). Only the rest is sent.
+        std::vector<wamp_message> batch;
+        batch.reserve(messages->size());
+        for (std::size_t i = 0; i < messages->size(); ++i) {
+            uint64_t request_id = first_request_id + i;
+            const wamp_subscriber& subscriber = request->handler(request_id);
+            subscription_key key(subscriber.topic, subscriber.match);
+
+            auto subscription_id_itr = m_subscription_ids.find(key);
+            if (subscription_id_itr != m_subscription_ids.end()) {
+                if (request->set_value(request_id, add_subscriber(subscription_id_itr->second, subscriber))) {
+                    return;
+                }
+                continue;
+            }
+
+            auto pending_itr = m_pending_subscriptions.find(key);
+            if (pending_itr != m_pending_subscriptions.end()) {
+                m_subscribe_many_followers.emplace(pending_itr->second, std::make_pair(request, request_id));
+                continue;
+            }
+
+            batch.push_back(std::move((*messages)[i]));
+            m_pending_subscriptions.emplace(key, request_id);
+        }
+
         try {
-            send_message(std::move(*message));
-            m_calls.emplace(request_id, call);
+            if (!batch.empty()) {
+                send_messages(std::move(batch));
+            }
+            m_subscribe_many_requests.emplace(first_request_id, request);
         } catch (const std::exception& e) {
-            call->result().set_exception(boost::copy_exception(e));
+            // Nothing was sent, so nothing may wait on the requests of the
+            // batch, and none of its items may complete with the requests
+            // of other batches they joined.
+            for (auto pending_itr = m_pending_subscriptions.begin(); pending_itr != m_pending_subscriptions.end();) {
+                if (request->contains(pending_itr->second)) {
+                    pending_itr = m_pending_subscriptions.erase(pending_itr);
+                } else {
+                    ++pending_itr;
+                }
+            }
+            for (auto follower_itr = m_subscribe_many_followers.begin(); follower_itr != m_subscribe_many_followers.end();) {
+                if (follower_itr->second.first == request) {
+                    follower_itr = m_subscribe_many_followers.erase(follower_itr);
+                } else {
+                    ++follower_itr;
+                }
+            }
+            request->set_exception(boost::copy_exception(e));
         }
     });
 
-    return call->result().get_future();
+    return bind_executor(m_executor, request->response());
 }
 
-inline boost::future<wamp_registration> wamp_session::provide(
-        const std::string& name,
-        const wamp_procedure& procedure,
-        const provide_options& options)
+inline boost::future<void> wamp_session::unsubscribe(const wamp_subscription& subscription)
 {
     uint64_t request_id = ++m_request_id;
 
-    auto message = std::make_shared<wamp_message>(4);
-    message->set_field(0, static_cast<int>(message_type::REGISTER));
+    auto message = std::make_shared<wamp_message>(3);
+    message->set_field(0, static_cast<int>(message_type::UNSUBSCRIBE));
     message->set_field(1, request_id);
-    message->set_field(2, options);
-    message->set_field(3, name);
+    message->set_field(2, subscription.id());
 
     auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
-    auto register_request = std::make_shared<wamp_register_request>(procedure);
+    auto unsubscribe_request = std::make_shared<wamp_unsubscribe_request>(subscription);
 
     m_io_service.dispatch([=]() {
         auto shared_self = weak_self.lock();
@@ -522,15 +904,445 @@ inline boost::future<wamp_registration> wamp_session::provide(
             return;
         }
 
+        auto subscription_itr = m_subscriptions.find(subscription.id());
+        if (subscription_itr != m_subscriptions.end()) {
+            auto& handlers = subscription_itr->second.handlers;
+            if (subscription.handler_id() == 0) {
+                handlers.clear();
+            } else {
+                auto handler_itr = std::find_if(handlers.begin(), handlers.end(),
+                        [&](const std::pair<uint64_t, std::shared_ptr<const wamp_event_handler>>& handler) {
+                            return handler.first == subscription.handler_id();
+                        });
+                if (handler_itr != handlers.end()) {
+                    handlers.erase(handler_itr);
+                }
+            }
+
+            // Other local handlers still use the router subscription.
+            if (!handlers.empty()) {
+                unsubscribe_request->set_response();
+                return;
+            }
+
+            // New subscribers to the topic must ask the router again.
+            m_subscription_topics.erase(subscription.id());
+            auto subscription_id_itr = m_subscription_ids.find(subscription_itr->second.key);
+            if (subscription_id_itr != m_subscription_ids.end() &&
+                    subscription_id_itr->second == subscription.id()) {
+                m_subscription_ids.erase(subscription_id_itr);
+            }
+        }
+
         try {
             send_message(std::move(*message));
-            m_register_requests.emplace(request_id, register_request);
+            m_unsubscribe_requests.emplace(request_id, unsubscribe_request);
+        } catch (const std::exception& e) {
+            unsubscribe_request->response().set_exception(boost::copy_exception(e));
+        }
+    });
+
+    return bind_executor(m_executor, unsubscribe_request->response());
+}
+
+inline boost::future<wamp_call_result> wamp_session::call(
+        const std::string& procedure,
+        const wamp_call_options& options)
+{
+    uint64_t request_id = ++m_request_id;
+
+    auto message = make_message(
+            static_cast<int>(message_type::CALL), request_id,
+            options, procedure);
+
+    auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
+    auto call = std::make_shared<wamp_call>();
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        try {
+            if (!call_locally(procedure, request_id, call, message)) {
+                send_message(std::move(*message));
+                m_calls.emplace(request_id, call);
+            }
+        } catch (const std::exception& e) {
+            call->result().set_exception(boost::copy_exception(e));
+        }
+    });
+
+    return bind_executor(m_executor, call->result());
+}
+
+template<typename List>
+inline boost::future<wamp_call_result> wamp_session::call(
+        const std::string& procedure,
+        const List& arguments,
+        const wamp_call_options& options)
+{
+    uint64_t request_id = ++m_request_id;
+
+    auto message = make_message(
+            static_cast<int>(message_type::CALL), request_id,
+            options, procedure, arguments);
+
+    auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
+    auto call = std::make_shared<wamp_call>();
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        try {
+            if (!call_locally(procedure, request_id, call, message)) {
+                send_message(std::move(*message));
+                m_calls.emplace(request_id, call);
+            }
+        } catch (const std::exception& e) {
+            call->result().set_exception(boost::copy_exception(e));
+        }
+    });
+
+    return bind_executor(m_executor, call->result());
+}
+
+template<typename List, typename Map>
+inline boost::future<wamp_call_result> wamp_session::call(
+        const std::string& procedure,
+        const List& arguments,
+        const Map& kw_arguments,
+        const wamp_call_options& options)
+{
+    uint64_t request_id = ++m_request_id;
+
+    auto message = make_message(
+            static_cast<int>(message_type::CALL), request_id,
+            options, procedure, arguments, kw_arguments);
+
+    auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
+    auto call = std::make_shared<wamp_call>();
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        try {
+            if (!call_locally(procedure, request_id, call, message)) {
+                send_message(std::move(*message));
+                m_calls.emplace(request_id, call);
+            }
+        } catch (const std::exception& e) {
+            call->result().set_exception(boost::copy_exception(e));
+        }
+    });
+
+    return bind_executor(m_executor, call->result());
+}
+
+template <typename R, typename... Args>
+inline boost::future<R> wamp_session::typed_call(
+        const std::string& procedure, const Args&... arguments)
+{
+    return decode_call_result<R>(*m_executor,
+            call(procedure, std::forward_as_tuple(arguments...)));
+}
+
+template <typename R, typename... Args>
+inline boost::future<R> wamp_session::typed_call(
+        boost::executors::executor& executor,
+        const std::string& procedure, const Args&... arguments)
+{
+    return decode_call_result<R>(executor,
+            call(procedure, std::forward_as_tuple(arguments...)));
+}
+
+template <typename R, typename List>
+inline boost::future<R> wamp_session::typed_call(
+        const std::string& procedure, const List& arguments,
+        const wamp_call_options& options)
+{
+    return decode_call_result<R>(*m_executor, call(procedure, arguments, options));
+}
+
+template <typename R>
+inline boost::future<R> wamp_session::decode_call_result(
+        boost::executors::executor& executor, boost::future<wamp_call_result>&& result)
+{
+    // The continuation holds on to the io executor, as bind_executor() does,
+    // for when it is the one decoding.
+    auto io_executor = m_executor;
+    return result.then(executor, [io_executor](boost::future<wamp_call_result> result) {
+        return detail::typed_call_result<R>::decode(result.get());
+    });
+}
+
+inline wamp_prepared_call wamp_session::prepare_call(
+        const std::string& procedure, const wamp_call_options& options) const
+{
+    return wamp_prepared_call(procedure, options);
+}
+
+inline boost::future<wamp_call_result> wamp_session::call(const wamp_prepared_call& prepared)
+{
+    uint64_t request_id = ++m_request_id;
+
+    // [CALL, Request|id, Options|dict, Procedure|uri]
+    msgpack::sbuffer buffer = m_buffer_pool.acquire();
+    prepared.pack_prefix(buffer, request_id, 4);
+
+    return call_prepared(prepared, request_id, std::move(buffer));
+}
+
+template <typename List>
+inline boost::future<wamp_call_result> wamp_session::call(
+        const wamp_prepared_call& prepared, const List& arguments)
+{
+    uint64_t request_id = ++m_request_id;
+
+    // [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list]
+    msgpack::sbuffer buffer = m_buffer_pool.acquire();
+    prepared.pack_prefix(buffer, request_id, 5);
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack(arguments);
+
+    return call_prepared(prepared, request_id, std::move(buffer));
+}
+
+template <typename List, typename Map>
+inline boost::future<wamp_call_result> wamp_session::call(
+        const wamp_prepared_call& prepared, const List& arguments, const Map& kw_arguments)
+{
+    uint64_t request_id = ++m_request_id;
+
+    // [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list, ArgumentsKw|dict]
+    msgpack::sbuffer buffer = m_buffer_pool.acquire();
+    prepared.pack_prefix(buffer, request_id, 6);
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack(arguments);
+    packer.pack(kw_arguments);
+
+    return call_prepared(prepared, request_id, std::move(buffer));
+}
+
+inline boost::future<wamp_call_result> wamp_session::call_raw(
+        const std::string& procedure, const wamp_bytes_view& arguments,
+        const wamp_bytes_view& kw_arguments, const wamp_call_options& options)
+{
+    return call_raw(wamp_prepared_call(procedure, options), arguments, kw_arguments);
+}
+
+inline boost::future<wamp_call_result> wamp_session::call_raw(
+        const wamp_prepared_call& prepared,
+        const wamp_bytes_view& arguments, const wamp_bytes_view& kw_arguments)
+{
+    uint64_t request_id = ++m_request_id;
+
+    // [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list, ArgumentsKw|dict]
+    msgpack::sbuffer buffer = m_buffer_pool.acquire();
+    prepared.pack_prefix(buffer, request_id, 4 + raw_argument_fields(arguments, kw_arguments));
+    pack_raw_arguments(buffer, arguments, kw_arguments);
+
+    return call_prepared(prepared, request_id, std::move(buffer));
+}
+
+inline boost::future<wamp_call_result> wamp_session::call_payload(
+        const std::string& procedure, const wamp_bytes_view& payload,
+        const wamp_call_options& options)
+{
+    if (!options.payload_options().is_set()) {
+        throw std::invalid_argument("payload options must name a scheme");
+    }
+    return call_payload(wamp_prepared_call(procedure, options), payload);
+}
+
+inline boost::future<wamp_call_result> wamp_session::call_payload(
+        const wamp_prepared_call& prepared, const wamp_bytes_view& payload)
+{
+    if (!prepared.has_payload_options()) {
+        throw std::invalid_argument("payload options must name a scheme");
+    }
+
+    uint64_t request_id = ++m_request_id;
+
+    // [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list]
+    msgpack::sbuffer buffer = m_buffer_pool.acquire();
+    prepared.pack_prefix(buffer, request_id, 5);
+    pack_payload_argument(buffer, payload);
+
+    return call_prepared(prepared, request_id, std::move(buffer));
+}
+
+template <typename List>
+inline boost::future<std::uint64_t> wamp_session::call_streamed(
+        const std::string& procedure, const List& arguments,
+        const wamp_chunk_handler& handler, const wamp_call_options& options)
+{
+    // The chunks come as progressive results, which have to be asked for.
+    wamp_call_options chunked_options;
+    chunked_options.set_timeout(options.timeout());
+    chunked_options.set_receive_progress(true);
+    chunked_options.set_payload_options(options.payload_options());
+    wamp_prepared_call prepared(procedure, chunked_options);
+
+    uint64_t request_id = ++m_request_id;
+
+    // [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list]
+    msgpack::sbuffer buffer = m_buffer_pool.acquire();
+    prepared.pack_prefix(buffer, request_id, 5);
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack(arguments);
+
+    auto call = std::make_shared<chunked_call>(chunked_call{ handler, 0, nullptr });
+    auto result = call_prepared(prepared, request_id, std::move(buffer),
+            [call](wamp_call_result&& chunk) {
+        receive_chunk(*call, chunk);
+    });
+
+    return bind_executor(m_executor, result.then(
+            [call](boost::future<wamp_call_result> last_chunk) {
+        receive_chunk(*call, last_chunk.get());
+        if (call->error) {
+            std::rethrow_exception(call->error);
+        }
+        return call->size;
+    }));
+}
+
+template <typename List>
+inline boost::future<std::string> wamp_session::call_chunked(
+        const std::string& procedure, const List& arguments, const wamp_call_options& options)
+{
+    auto bytes = std::make_shared<std::string>();
+    auto size = call_streamed(procedure, arguments, [bytes](const wamp_bytes_view& chunk) {
+        bytes->append(chunk.data(), chunk.size());
+    }, options);
+
+    return bind_executor(m_executor, size.then(
+            [bytes](boost::future<std::uint64_t> received) {
+        received.get();
+        return std::move(*bytes);
+    }));
+}
+
+inline void wamp_session::receive_chunk(chunked_call& call, const wamp_call_result& chunk)
+{
+    if (call.error) {
+        return;
+    }
+
+    try {
+        wamp_bytes_view bytes = chunk.number_of_arguments() > 0
+                ? chunk.argument_view<wamp_bytes_view>(0) : wamp_bytes_view();
+        call.size += bytes.size();
+        if (!bytes.empty()) {
+            call.handler(bytes);
+        }
+    } catch (...) {
+        // The remaining chunks are dropped, and the call fails once it is done.
+        call.error = std::current_exception();
+    }
+}
+
+inline boost::future<wamp_registration> wamp_session::provide(
+        const std::string& name,
+        const wamp_procedure& procedure,
+        const provide_options& options)
+{
+    uint64_t request_id = ++m_request_id;
+
+    auto message = std::make_shared<wamp_message>(4);
+    message->set_field(0, static_cast<int>(message_type::REGISTER));
+    message->set_field(1, request_id);
+    message->set_field(2, options);
+    message->set_field(3, name);
+
+    auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
+    auto register_request = std::make_shared<wamp_register_request>(
+            wamp_provider{name, detail::is_exact_single_registration(options), procedure});
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        try {
+            send_message(std::move(*message));
+            m_register_requests.emplace(request_id, register_request);
         } catch (const std::exception& e) {
             register_request->response().set_exception(boost::copy_exception(e));
         }
     });
 
-    return register_request->response().get_future();
+    return bind_executor(m_executor, register_request->response());
+}
+
+template <typename Signature, typename Function>
+inline boost::future<wamp_registration> wamp_session::provide(
+        const std::string& uri,
+        Function&& function,
+        const provide_options& options)
+{
+    return provide(uri,
+            wamp_procedure(wamp_typed_procedure<Signature>(std::forward<Function>(function))),
+            options);
+}
+
+inline boost::future<wamp_provide_many_result> wamp_session::provide_many(
+        const std::vector<std::pair<std::string, wamp_procedure>>& procedures,
+        const provide_options& options)
+{
+    uint64_t first_request_id = m_request_id.fetch_add(procedures.size()) + 1;
+
+    auto messages = std::make_shared<std::vector<wamp_message>>();
+    messages->reserve(procedures.size());
+    std::vector<wamp_provider> providers;
+    providers.reserve(procedures.size());
+    const bool exact_match = detail::is_exact_single_registration(options);
+    for (std::size_t i = 0; i < procedures.size(); ++i) {
+        // [REGISTER, Request|id, Options|dict, Procedure|uri]
+        msgpack::sbuffer buffer = m_buffer_pool.acquire();
+        msgpack::packer<msgpack::sbuffer> packer(buffer);
+        packer.pack_array(4);
+        packer.pack(static_cast<int>(message_type::REGISTER));
+        packer.pack(first_request_id + i);
+        packer.pack(options);
+        packer.pack(procedures[i].first);
+        messages->emplace_back(std::move(buffer));
+        providers.push_back(wamp_provider{procedures[i].first, exact_match, procedures[i].second});
+    }
+
+    auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
+    auto request = std::make_shared<wamp_bulk_request<wamp_registration, wamp_provider>>(
+            first_request_id, std::move(providers));
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        if (request->size() == 0) {
+            request->response().set_value(wamp_provide_many_result());
+            return;
+        }
+
+        try {
+            send_messages(std::move(*messages));
+            m_provide_many_requests.emplace(first_request_id, request);
+        } catch (const std::exception& e) {
+            request->set_exception(boost::copy_exception(e));
+        }
+    });
+
+    return bind_executor(m_executor, request->response());
 }
 
 inline boost::future<void> wamp_session::unprovide(const wamp_registration& registration){
@@ -550,6 +1362,9 @@ inline boost::future<void> wamp_session::unprovide(const wamp_registration& regi
 			return;
 		}
 
+		// Local calls stop reaching the procedure right away.
+		remove_local_procedure(registration.id());
+
 		try {
 			send_message(std::move(*message));
 			m_unregister_requests.emplace(request_id, unregister_request);
@@ -559,7 +1374,7 @@ inline boost::future<void> wamp_session::unprovide(const wamp_registration& regi
 		}
 	});
 
-	return unregister_request->response().get_future();
+	return bind_executor(m_executor, unregister_request->response());
 }
 
 inline boost::future<wamp_authenticate> wamp_session::on_challenge(const wamp_challenge& challenge)
@@ -586,6 +1401,8 @@ inline void wamp_session::on_attach(const std::shared_ptr<wamp_transport>& trans
     assert(!m_running);
 
     m_transport = transport;
+    m_transport->set_zone_pool(m_zone_pool);
+    m_transport->set_keep_raw_fields(m_keep_raw_arguments);
 }
 
 inline void wamp_session::on_detach(bool was_clean, const std::string& reason)
@@ -608,6 +1425,8 @@ inline void wamp_session::on_detach(bool was_clean, const std::string& reason)
     //        session.
     assert(!m_running);
 
+    m_transport->set_zone_pool(nullptr);
+    m_transport->set_keep_raw_fields(false);
     m_transport.reset();
 }
 
@@ -624,6 +1443,20 @@ inline void wamp_session::on_disconnect(bool was_clean, const std::string& reaso
                 // ignore this exception
             }
         }
+        for (auto subscribe_follower : m_subscribe_followers) {
+            try {
+                subscribe_follower.second->response().set_exception(error);
+            }
+            catch (boost::promise_already_satisfied &) {
+                // ignore this exception
+            }
+        }
+        for (auto subscribe_many_request : m_subscribe_many_requests) {
+            subscribe_many_request.second->set_exception(error);
+        }
+        for (auto subscribe_many_follower : m_subscribe_many_followers) {
+            subscribe_many_follower.second.first->set_exception(error);
+        }
         for (auto unsubscribe_request : m_unsubscribe_requests) {
             try {
                 unsubscribe_request.second->response().set_exception(error);
@@ -640,6 +1473,9 @@ inline void wamp_session::on_disconnect(bool was_clean, const std::string& reaso
                 // ignore this exception
             }
         }
+        for (auto provide_many_request : m_provide_many_requests) {
+            provide_many_request.second->set_exception(error);
+        }
         for (auto unregister_request : m_unregister_requests) {
             try {
                 unregister_request.second->response().set_exception(error);
@@ -656,6 +1492,39 @@ inline void wamp_session::on_disconnect(bool was_clean, const std::string& reaso
                 // ignore this exception
             }
         }
+        for (auto publish_request : m_publish_requests) {
+            try {
+                publish_request.second->set_exception(error);
+            }
+            catch (boost::promise_already_satisfied &) {
+                // ignore this exception
+            }
+        }
+        m_publish_requests.clear();
+        for (auto& queued : m_publish_queue) {
+            try {
+                queued.publication->set_exception(error);
+            }
+            catch (boost::promise_already_satisfied &) {
+                // ignore this exception
+            }
+        }
+        m_publish_queue.clear();
+
+        // Subscriptions cannot be shared across a lost connection.
+        m_subscribe_followers.clear();
+        m_subscribe_many_followers.clear();
+        m_pending_subscriptions.clear();
+        m_subscription_ids.clear();
+
+        // Nor can procedures be called locally without a session.
+        if (m_local_procedures) {
+            for (const auto& local_uri : m_local_uris) {
+                m_local_procedures->remove(local_uri.second, local_uri.first);
+            }
+        }
+        m_local_uris.clear();
+
         try {
             m_session_join.set_exception(error);
         }
@@ -680,6 +1549,9 @@ inline void wamp_session::on_disconnect(bool was_clean, const std::string& reaso
 
 inline void wamp_session::on_message(wamp_message&& message)
 {
+    // Transports hand messages over on the io service thread.
+    m_executor->set_io_thread();
+
     // FIXME: Move this check into the transport
     //if (obj.type != msgpack::type::ARRAY) {
     //    throw protocol_error("invalid message structure - message is not an array");
@@ -721,7 +1593,7 @@ inline void wamp_session::on_message(wamp_message&& message)
         case message_type::PUBLISH:
             throw protocol_error("received PUBLISH message unexpected for WAMP client roles");
         case message_type::PUBLISHED:
-            // FIXME
+            process_published(std::move(message));
             break;
         case message_type::SUBSCRIBE:
             throw protocol_error("received SUBSCRIBE message unexpected for WAMP client roles");
@@ -1016,13 +1888,89 @@ inline void wamp_session::process_error(wamp_message&& message)
             }
             break;
 
-        // FIXME: handle other error messages
-        default:
-            throw protocol_error("unhandled ERROR message");
-            break;
-    }
-}
-
+        case message_type::SUBSCRIBE:
+            {
+                //
+                // process SUBSCRIBE ERROR
+                //
+                auto subscribe_request_itr = m_subscribe_requests.find(request_id);
+                if (subscribe_request_itr != m_subscribe_requests.end()) {
+                    auto subscribe_request = subscribe_request_itr->second;
+                    m_subscribe_requests.erase(subscribe_request_itr);
+                    m_pending_subscriptions.erase(
+                            subscription_key(subscribe_request->topic(), subscribe_request->match()));
+
+                    // Requests that joined this one fail with the same error.
+                    wamp_error error(request_type, request_id, error_uri, details, args, kw_args, std::move(message.zone()));
+                    fail_subscribe_followers(request_id, error);
+                    subscribe_request->response().set_exception(error);
+                    break;
+                }
+
+                auto subscribe_many_itr = detail::find_bulk_request(m_subscribe_many_requests, request_id);
+                if (subscribe_many_itr != m_subscribe_many_requests.end()) {
+                    auto request = subscribe_many_itr->second;
+                    const wamp_subscriber& subscriber = request->handler(request_id);
+                    m_pending_subscriptions.erase(subscription_key(subscriber.topic, subscriber.match));
+
+                    wamp_error error(request_type, request_id, error_uri, details, args, kw_args, std::move(message.zone()));
+                    fail_subscribe_followers(request_id, error);
+                    if (request->set_error_uri(request_id, error_uri)) {
+                        m_subscribe_many_requests.erase(request->first_request_id());
+                    }
+                } else {
+                    throw protocol_error("bogus ERROR message for non-pending SUBSCRIBE request ID");
+                }
+            }
+            break;
+
+        case message_type::REGISTER:
+            {
+                //
+                // process REGISTER ERROR
+                //
+                auto register_request_itr = m_register_requests.find(request_id);
+                if (register_request_itr != m_register_requests.end()) {
+                    register_request_itr->second->response().set_exception(wamp_error(request_type, request_id, error_uri, details, args, kw_args, std::move(message.zone())));
+                    m_register_requests.erase(register_request_itr);
+                    break;
+                }
+
+                auto provide_many_itr = detail::find_bulk_request(m_provide_many_requests, request_id);
+                if (provide_many_itr != m_provide_many_requests.end()) {
+                    if (provide_many_itr->second->set_error_uri(request_id, error_uri)) {
+                        m_provide_many_requests.erase(provide_many_itr);
+                    }
+                } else {
+                    throw protocol_error("bogus ERROR message for non-pending REGISTER request ID");
+                }
+            }
+            break;
+
+        case message_type::PUBLISH:
+            {
+                //
+                // process PUBLISH ERROR
+                //
+                auto publish_request_itr = m_publish_requests.find(request_id);
+                if (publish_request_itr != m_publish_requests.end()) {
+                    auto publication = publish_request_itr->second;
+                    m_publish_requests.erase(publish_request_itr);
+                    publication->set_exception(wamp_error(request_type, request_id, error_uri, details, args, kw_args, std::move(message.zone())));
+                    send_queued_publications();
+                } else {
+                    throw protocol_error("bogus ERROR message for non-pending PUBLISH request ID");
+                }
+            }
+            break;
+
+        // FIXME: handle other error messages
+        default:
+            throw protocol_error("unhandled ERROR message");
+            break;
+    }
+}
+
 
 inline void wamp_session::process_invocation(wamp_message&& message)
 {
@@ -1050,7 +1998,7 @@ inline void wamp_session::process_invocation(wamp_message&& message)
             throw protocol_error("INVOCATION.Details must be a map");
         }
 
-        wamp_invocation invocation = std::make_shared<wamp_invocation_impl>();
+        wamp_invocation invocation = m_invocation_pool->acquire();
         invocation->set_request_id(request_id);
         invocation->set_details(message.field(3));
         if (message.size() > 4) {
@@ -1058,65 +2006,52 @@ inline void wamp_session::process_invocation(wamp_message&& message)
                 throw protocol_error("INVOCATION.Arguments must be an array/vector");
             }
             invocation->set_arguments(message.field(4));
+            invocation->set_raw_arguments(message.raw_field(4));
 
             if (message.size() > 5) {
                 if (!message.is_field_type(5, msgpack::type::MAP)) {
                     throw protocol_error("INVOCATION.KwArguments must be a map");
                 }
                 invocation->set_kw_arguments(message.field(5));
+                invocation->set_raw_kw_arguments(message.raw_field(5));
             }
         }
 
-        invocation->set_zone(std::move(message.zone()));
-
-        auto weak_this = std::weak_ptr<wamp_session>(this->shared_from_this());
+        invocation->set_zone(std::move(message.zone()), m_zone_pool);
+        invocation->set_sink(this->shared_from_this(), false);
 
-        auto send_result_fn = [weak_this] (const std::shared_ptr<wamp_message>& message) {
-            // Make sure the session still exists, since the invocation could run
-            // on a different thread.
-            auto shared_this = weak_this.lock();
-            if (!shared_this) {
-                return; // FIXME: or throw exception?
-            }
-
-            // Send to the io_service thread, and make sure the session still exists (again).
-            shared_this->m_io_service.dispatch([weak_this, message] {
-                auto shared_this = weak_this.lock();
-                if (!shared_this) {
-                    return; // FIXME: or throw exception?
-                }
-                shared_this->send_message(std::move(*message));
-            });
-        };
-
-        invocation->set_send_result_fn(std::move(send_result_fn));
+        invoke_procedure(registration_id, procedure_itr->second, invocation);
+    } else {
+        throw protocol_error("bogus INVOCATION message for non-registered registration ID");
+    }
+}
 
-        try {
-            if (m_debug_enabled) {
-                std::cerr << "Invoking procedure registered under " << registration_id << std::endl;
-            }
-            procedure_itr->second(invocation);
+inline void wamp_session::invoke_procedure(
+        uint64_t registration_id, const wamp_procedure& procedure, const wamp_invocation& invocation)
+{
+    try {
+        if (m_debug_enabled) {
+            std::cerr << "Invoking procedure registered under " << registration_id << std::endl;
         }
+        procedure(invocation);
+    }
 
-        // FIXME: implement Autobahn-specific exception with error URI
-        catch (const std::exception& e) {
-            // we can at least describe the error with e.what()
-            //
-            if (invocation->sendable()) {
-                std::map<std::string, std::string> error_kw_arguments;
-                error_kw_arguments["what"] = e.what();
-                invocation->error("wamp.error.runtime_error", EMPTY_ARGUMENTS, error_kw_arguments);
-            }
+    // FIXME: implement Autobahn-specific exception with error URI
+    catch (const std::exception& e) {
+        // we can at least describe the error with e.what()
+        //
+        if (invocation->sendable()) {
+            std::map<std::string, std::string> error_kw_arguments;
+            error_kw_arguments["what"] = e.what();
+            invocation->error("wamp.error.runtime_error", EMPTY_ARGUMENTS, error_kw_arguments);
         }
-        catch (...) {
-            // no information available on actual error
-            //
-            if (invocation->sendable()) {
-                invocation->error("wamp.error.runtime_error");
-            }
+    }
+    catch (...) {
+        // no information available on actual error
+        //
+        if (invocation->sendable()) {
+            invocation->error("wamp.error.runtime_error");
         }
-    } else {
-        throw protocol_error("bogus INVOCATION message for non-registered registration ID");
     }
 }
 
@@ -1141,20 +2076,30 @@ inline void wamp_session::process_call_result(wamp_message&& message)
             throw protocol_error("RESULT - Details must be a dictionary");
         }
 
-        wamp_call_result result(std::move(message.zone()));
+        bool progress = value_for_key_or<bool>(message.field(2), "progress", false);
+
+        wamp_call_result result(std::move(message.zone()), m_zone_pool);
+        result.set_details(message.field(2));
         if (message.size() > 3) {
             if (!message.is_field_type(3, msgpack::type::ARRAY)) {
                 throw protocol_error("RESULT - YIELD.Arguments must be a list");
             }
             result.set_arguments(message.field(3));
+            result.set_raw_arguments(message.raw_field(3));
 
             if (message.size() > 4) {
                 if (!message.is_field_type(4, msgpack::type::MAP)) {
                     throw protocol_error("RESULT - YIELD.ArgumentsKw must be a dictionary");
                 }
                 result.set_kw_arguments(message.field(4));
+                result.set_raw_kw_arguments(message.raw_field(4));
             }
         }
+        if (progress) {
+            // The call stays pending until its final result.
+            call_itr->second->set_progress(std::move(result));
+            return;
+        }
         call_itr->second->set_result(std::move(result));
         m_calls.erase(call_itr);
     } else {
@@ -1162,6 +2107,34 @@ inline void wamp_session::process_call_result(wamp_message&& message)
     }
 }
 
+inline void wamp_session::process_published(wamp_message&& message)
+{
+    // [PUBLISHED, PUBLISH.Request|id, Publication|id]
+    if (message.size() != 3) {
+        throw protocol_error("PUBLISHED - length must be 3");
+    }
+
+    if (!message.is_field_type(1, msgpack::type::POSITIVE_INTEGER)) {
+        throw protocol_error("PUBLISHED - PUBLISH.Request must be an id");
+    }
+    uint64_t request_id = message.field<uint64_t>(1);
+
+    if (!message.is_field_type(2, msgpack::type::POSITIVE_INTEGER)) {
+        throw protocol_error("PUBLISHED - Publication must be an id");
+    }
+    uint64_t publication_id = message.field<uint64_t>(2);
+
+    auto publish_request_itr = m_publish_requests.find(request_id);
+    if (publish_request_itr != m_publish_requests.end()) {
+        auto publication = publish_request_itr->second;
+        m_publish_requests.erase(publish_request_itr);
+        publication->set_value(wamp_publication(publication_id));
+        send_queued_publications();
+    } else {
+        throw protocol_error("PUBLISHED - no pending request ID");
+    }
+}
+
 inline void wamp_session::process_subscribed(wamp_message&& message)
 {
     // [SUBSCRIBED, SUBSCRIBE.Request|id, Subscription|id]
@@ -1181,10 +2154,34 @@ inline void wamp_session::process_subscribed(wamp_message&& message)
         }
 
         uint64_t subscription_id = message.field<uint64_t>(2);
-        m_subscription_handlers.insert(
-                std::make_pair(subscription_id, subscribe_request_itr->second->handler()));
-        subscribe_request_itr->second->set_response(wamp_subscription(subscription_id));
-        m_subscribe_requests.erase(request_id);
+        auto subscribe_request = subscribe_request_itr->second;
+        m_subscribe_requests.erase(subscribe_request_itr);
+        m_pending_subscriptions.erase(
+                subscription_key(subscribe_request->topic(), subscribe_request->match()));
+
+        wamp_subscription subscription = add_subscriber(subscription_id,
+                wamp_subscriber{subscribe_request->topic(), subscribe_request->match(), subscribe_request->handler()});
+        complete_subscribe_followers(request_id, subscription_id);
+        subscribe_request->set_response(subscription);
+        return;
+    }
+
+    auto subscribe_many_itr = detail::find_bulk_request(m_subscribe_many_requests, request_id);
+    if (subscribe_many_itr != m_subscribe_many_requests.end()) {
+        if (!message.is_field_type(2, msgpack::type::POSITIVE_INTEGER)) {
+            throw protocol_error("SUBSCRIBED - SUBSCRIBED.Subscription must be an integer");
+        }
+
+        uint64_t subscription_id = message.field<uint64_t>(2);
+        auto request = subscribe_many_itr->second;
+        const wamp_subscriber& subscriber = request->handler(request_id);
+        m_pending_subscriptions.erase(subscription_key(subscriber.topic, subscriber.match));
+
+        wamp_subscription subscription = add_subscriber(subscription_id, subscriber);
+        complete_subscribe_followers(request_id, subscription_id);
+        if (request->set_value(request_id, subscription)) {
+            m_subscribe_many_requests.erase(request->first_request_id());
+        }
     } else {
         throw protocol_error("SUBSCRIBED - no pending request ID");
     }
@@ -1203,8 +2200,13 @@ inline void wamp_session::process_unsubscribed(wamp_message&& message)
     uint64_t request_id = message.field<uint64_t>(1);
     auto unsubscribe_request_itr = m_unsubscribe_requests.find(request_id);
     if (unsubscribe_request_itr != m_unsubscribe_requests.end()) {
+        // Keep the subscription if a new local handler took it up again while
+        // the UNSUBSCRIBE was in flight.
         uint64_t subscription_id = unsubscribe_request_itr->second->subscription().id();
-        m_subscription_handlers.erase(subscription_id);
+        auto subscription_itr = m_subscriptions.find(subscription_id);
+        if (subscription_itr != m_subscriptions.end() && subscription_itr->second.handlers.empty()) {
+            m_subscriptions.erase(subscription_itr);
+        }
         unsubscribe_request_itr->second->set_response();
         m_unsubscribe_requests.erase(request_id);
     } else {
@@ -1227,11 +2229,10 @@ inline void wamp_session::process_event(wamp_message&& message)
     }
     uint64_t subscription_id = message.field<uint64_t>(1);
 
-    auto subscription_handlers_itr = m_subscription_handlers.lower_bound(subscription_id);
-    auto subscription_handlers_end = m_subscription_handlers.upper_bound(subscription_id);
+    auto subscription_itr = m_subscriptions.find(subscription_id);
 
-    if (subscription_handlers_itr != m_subscription_handlers.end() &&
-            subscription_handlers_itr != subscription_handlers_end) {
+    if (subscription_itr != m_subscriptions.end() &&
+            !subscription_itr->second.handlers.empty()) {
 
         if (!message.is_field_type(2, msgpack::type::POSITIVE_INTEGER)) {
             throw protocol_error("EVENT - PUBLISHED.Publication must be an id");
@@ -1242,7 +2243,7 @@ inline void wamp_session::process_event(wamp_message&& message)
             throw protocol_error("EVENT - Details must be a dictionary");
         }
 
-        wamp_event event(std::move(message.zone()));
+        wamp_event event(std::move(message.zone()), m_zone_pool);
 
         event.set_details(message.field(3));
 
@@ -1251,27 +2252,18 @@ inline void wamp_session::process_event(wamp_message&& message)
                 throw protocol_error("EVENT - EVENT.Arguments must be a list");
             }
             event.set_arguments(message.field(4));
+            event.set_raw_arguments(message.raw_field(4));
 
             if (message.size() > 5) {
                 if (!message.is_field_type(5, msgpack::type::MAP)) {
                     throw protocol_error("EVENT - EVENT.ArgumentsKw must be a dictionary");
                 }
                 event.set_kw_arguments(message.field(5));
+                event.set_raw_kw_arguments(message.raw_field(5));
             }
         }
 
-        try {
-            // now trigger the user supplied event handler ..
-            //
-            while (subscription_handlers_itr != subscription_handlers_end) {
-                 (subscription_handlers_itr->second)(event);
-                 ++subscription_handlers_itr;
-            }
-        } catch (...) {
-            if (m_debug_enabled) {
-                std::cerr << "Warning: event handler threw exception" << std::endl;
-            }
-        }
+        deliver_event(subscription_id, event);
 
     } else {
         // silently swallow EVENT for non-existent subscription IDs.
@@ -1302,9 +2294,25 @@ inline void wamp_session::process_registered(wamp_message&& message)
             throw protocol_error("REGISTERED - REGISTERED.Registration must be an integer");
         }
         uint64_t registration_id = message.field<uint64_t>(2);
-        m_procedures[registration_id] = register_request_itr->second->procedure();
-        register_request_itr->second->set_response(wamp_registration(registration_id));
+        const auto& register_request = register_request_itr->second;
+        add_procedure(registration_id, wamp_provider{register_request->uri(),
+                register_request->exact_match(), register_request->procedure()});
+        register_request->set_response(wamp_registration(registration_id));
         m_register_requests.erase(register_request_itr);
+        return;
+    }
+
+    auto provide_many_itr = detail::find_bulk_request(m_provide_many_requests, request_id);
+    if (provide_many_itr != m_provide_many_requests.end()) {
+        if (!message.is_field_type(2, msgpack::type::POSITIVE_INTEGER)) {
+            throw protocol_error("REGISTERED - REGISTERED.Registration must be an integer");
+        }
+        uint64_t registration_id = message.field<uint64_t>(2);
+        auto& request = provide_many_itr->second;
+        add_procedure(registration_id, request->handler(request_id));
+        if (request->set_value(request_id, wamp_registration(registration_id))) {
+            m_provide_many_requests.erase(provide_many_itr);
+        }
     } else {
         throw protocol_error("REGISTERED - no pending request ID");
     }
@@ -1325,6 +2333,7 @@ inline void wamp_session::process_unregistered(wamp_message&& message)
     auto unregister_request_itr = m_unregister_requests.find(request_id);
     if (unregister_request_itr != m_unregister_requests.end()) {
         uint64_t registration_id = unregister_request_itr->second->registration().id();
+        remove_local_procedure(registration_id);
         m_procedures.erase(registration_id);
         unregister_request_itr->second->set_response();
         m_unregister_requests.erase(request_id);
@@ -1348,6 +2357,514 @@ inline void wamp_session::send_message(wamp_message&& message, bool session_esta
     }
 
     m_transport->send_message(std::move(message));
+
+    // Transports write the message before returning and leave it to us, see
+    // wamp_transport::send_message(), so its buffer can be reused.
+    if (message.is_serialized()) {
+        m_buffer_pool.release(std::move(message.buffer()));
+    }
+}
+
+template <typename... Fields>
+inline std::shared_ptr<wamp_message> wamp_session::make_message(const Fields&... fields)
+{
+    if (m_serialize_on_caller) {
+        msgpack::sbuffer buffer = m_buffer_pool.acquire();
+        msgpack::packer<msgpack::sbuffer> packer(buffer);
+        packer.pack_array(sizeof...(Fields));
+        int expand[] = { 0, (packer.pack(fields), 0)... };
+        (void) expand;
+
+        return std::make_shared<wamp_message>(std::move(buffer));
+    }
+
+    auto message = std::make_shared<wamp_message>(sizeof...(Fields));
+    std::size_t index = 0;
+    int expand[] = { 0, (message->set_field(index++, fields), 0)... };
+    (void) expand;
+
+    return message;
+}
+
+inline msgpack::sbuffer wamp_session::acquire_reply_buffer()
+{
+    return m_buffer_pool.acquire();
+}
+
+inline void wamp_session::on_invocation_reply(wamp_message&& reply, bool local)
+{
+    // Procedures that reply on the io thread take the short way, without
+    // copying the reply or allocating a handler.
+    if (m_executor->running_in_io_thread()) {
+        if (local) {
+            process_local_reply(std::move(reply));
+        } else {
+            send_message(std::move(reply));
+        }
+        return;
+    }
+
+    // Send to the io_service thread, and make sure the session still exists.
+    auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
+    auto shared_reply = std::make_shared<wamp_message>(std::move(reply));
+    m_io_service.dispatch([weak_self, shared_reply, local] {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+        shared_self->on_invocation_reply(std::move(*shared_reply), local);
+    });
+}
+
+inline void wamp_session::defer_reply(std::function<void()>&& continuation)
+{
+    // Posted rather than dispatched, so that whatever is queued runs first.
+    m_io_service.post(std::move(continuation));
+}
+
+inline void wamp_session::send_messages(std::vector<wamp_message>&& messages, bool session_established)
+{
+    if (!m_running) {
+        throw protocol_error("session not running");
+    }
+
+    if (!m_transport) {
+        throw no_transport_error();
+    }
+
+    if (session_established && !m_session_id) {
+        throw no_session_error();
+    }
+
+    m_transport->send_messages(std::move(messages));
+
+    for (auto& message : messages) {
+        if (message.is_serialized()) {
+            m_buffer_pool.release(std::move(message.buffer()));
+        }
+    }
+}
+
+inline wamp_subscription wamp_session::add_subscriber(
+        uint64_t subscription_id, const wamp_subscriber& subscriber)
+{
+    subscription_key key(subscriber.topic, subscriber.match);
+
+    auto& subscription = m_subscriptions[subscription_id];
+    subscription.key = key;
+    subscription.handlers.emplace_back(++m_subscriber_id,
+            std::make_shared<const wamp_event_handler>(subscriber.handler));
+    m_subscription_ids[key] = subscription_id;
+
+    if (!m_subscription_topics.contains(subscription_id)) {
+        try {
+            m_subscription_topics.insert(subscription_id, key.first, key.second, subscription_id);
+        } catch (const std::invalid_argument&) {
+            // A match policy we do not know; the router delivers such events.
+        }
+    }
+
+    return wamp_subscription(subscription_id, m_subscriber_id);
+}
+
+inline void wamp_session::complete_subscribe_followers(uint64_t request_id, uint64_t subscription_id)
+{
+    // Detach the requests that joined this one before completing any of
+    // them, their continuations may subscribe or unsubscribe again.
+    std::vector<std::shared_ptr<wamp_subscribe_request>> followers;
+    auto followers_range = m_subscribe_followers.equal_range(request_id);
+    for (auto follower_itr = followers_range.first; follower_itr != followers_range.second; ++follower_itr) {
+        followers.push_back(follower_itr->second);
+    }
+    m_subscribe_followers.erase(followers_range.first, followers_range.second);
+
+    // Items of bulk requests that failed as a whole get no handler.
+    std::vector<std::pair<std::shared_ptr<wamp_bulk_request<wamp_subscription, wamp_subscriber>>, uint64_t>> items;
+    auto items_range = m_subscribe_many_followers.equal_range(request_id);
+    for (auto item_itr = items_range.first; item_itr != items_range.second; ++item_itr) {
+        if (!item_itr->second.first->done()) {
+            items.push_back(item_itr->second);
+        }
+    }
+    m_subscribe_many_followers.erase(items_range.first, items_range.second);
+
+    std::vector<wamp_subscription> subscriptions;
+    subscriptions.reserve(followers.size() + items.size());
+    for (const auto& follower : followers) {
+        subscriptions.push_back(add_subscriber(subscription_id,
+                wamp_subscriber{follower->topic(), follower->match(), follower->handler()}));
+    }
+    for (const auto& item : items) {
+        subscriptions.push_back(add_subscriber(subscription_id, item.first->handler(item.second)));
+    }
+
+    for (std::size_t i = 0; i < followers.size(); ++i) {
+        followers[i]->set_response(subscriptions[i]);
+    }
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        if (items[i].first->set_value(items[i].second, subscriptions[followers.size() + i])) {
+            m_subscribe_many_requests.erase(items[i].first->first_request_id());
+        }
+    }
+}
+
+inline void wamp_session::fail_subscribe_followers(uint64_t request_id, const wamp_error& error)
+{
+    std::vector<std::shared_ptr<wamp_subscribe_request>> followers;
+    auto followers_range = m_subscribe_followers.equal_range(request_id);
+    for (auto follower_itr = followers_range.first; follower_itr != followers_range.second; ++follower_itr) {
+        followers.push_back(follower_itr->second);
+    }
+    m_subscribe_followers.erase(followers_range.first, followers_range.second);
+
+    std::vector<std::pair<std::shared_ptr<wamp_bulk_request<wamp_subscription, wamp_subscriber>>, uint64_t>> items;
+    auto items_range = m_subscribe_many_followers.equal_range(request_id);
+    for (auto item_itr = items_range.first; item_itr != items_range.second; ++item_itr) {
+        items.push_back(item_itr->second);
+    }
+    m_subscribe_many_followers.erase(items_range.first, items_range.second);
+
+    for (const auto& follower : followers) {
+        follower->response().set_exception(error);
+    }
+    for (const auto& item : items) {
+        if (item.first->set_error_uri(item.second, error.uri())) {
+            m_subscribe_many_requests.erase(item.first->first_request_id());
+        }
+    }
+}
+
+inline void wamp_session::deliver_event(uint64_t subscription_id, const wamp_event& event)
+{
+    auto subscription_itr = m_subscriptions.find(subscription_id);
+    if (subscription_itr == m_subscriptions.end()) {
+        return;
+    }
+
+    try {
+        // now trigger the user supplied event handlers ..
+        //
+        // A handler may unsubscribe itself or others, or subscribe a new
+        // one, which moves the handlers around. So each handler is called
+        // through its own reference to it, and the next one is found again
+        // by handler id after each call rather than by position. Handlers
+        // subscribed meanwhile do not see the event.
+        const auto& handlers = subscription_itr->second.handlers;
+        uint64_t last_handler_id = handlers.empty() ? 0 : handlers.back().first;
+        auto handler_itr = handlers.begin();
+        while (handler_itr != handlers.end() && handler_itr->first <= last_handler_id) {
+            uint64_t handler_id = handler_itr->first;
+            std::shared_ptr<const wamp_event_handler> handler = handler_itr->second;
+            (*handler)(event);
+            handler_itr = std::upper_bound(handlers.begin(), handlers.end(), handler_id,
+                    [](uint64_t id, const std::pair<uint64_t, std::shared_ptr<const wamp_event_handler>>& handler) {
+                        return id < handler.first;
+                    });
+        }
+    } catch (...) {
+        if (m_debug_enabled) {
+            std::cerr << "Warning: event handler threw exception" << std::endl;
+        }
+    }
+}
+
+inline void wamp_session::deliver_locally(const wamp_message& message)
+{
+    // [PUBLISH, Request|id, Options|dict, Topic|uri]
+    // [PUBLISH, Request|id, Options|dict, Topic|uri, Arguments|list]
+    // [PUBLISH, Request|id, Options|dict, Topic|uri, Arguments|list, ArgumentsKw|dict]
+    if (!m_local_delivery || !m_session_id || m_subscription_topics.empty()) {
+        return;
+    }
+
+    const msgpack::object& topic = message.field(3);
+    wamp_string_view topic_view(topic.via.str.ptr, topic.via.str.size);
+
+    // Handlers may subscribe or unsubscribe while the event is delivered.
+    std::vector<uint64_t> subscription_ids;
+    m_subscription_topics.for_each_match(topic_view, [&](uint64_t subscription_id) {
+        subscription_ids.push_back(subscription_id);
+    });
+    if (subscription_ids.empty()) {
+        return;
+    }
+
+    // The event refers to the arguments in the zone of the message, which
+    // outlives the handlers as they only get to see the event by reference.
+    wamp_event event(msgpack::zone(0));
+    event.set_uri(topic_view.to_string());
+    if (message.size() > 4) {
+        event.set_arguments(message.field(4));
+
+        if (message.size() > 5) {
+            event.set_kw_arguments(message.field(5));
+        }
+    }
+
+    for (uint64_t subscription_id : subscription_ids) {
+        deliver_event(subscription_id, event);
+    }
+}
+
+inline boost::future<void> wamp_session::publish_messages(std::vector<wamp_message>&& messages)
+{
+    auto batch = std::make_shared<std::vector<wamp_message>>(std::move(messages));
+    auto result = std::make_shared<boost::promise<void>>();
+    auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        try {
+            for (const auto& message : *batch) {
+                deliver_locally(message);
+            }
+            if (!batch->empty()) {
+                send_messages(std::move(*batch));
+            }
+            result->set_value();
+        } catch (const std::exception& e) {
+            result->set_exception(boost::copy_exception(e));
+        }
+    });
+
+    return bind_executor(m_executor, *result);
+}
+
+inline boost::future<wamp_publication> wamp_session::publish_prepared(
+        const wamp_prepared_publication& prepared, uint64_t request_id, msgpack::sbuffer&& buffer)
+{
+    auto message = std::make_shared<wamp_message>(std::move(buffer));
+    auto publication = std::make_shared<boost::promise<wamp_publication>>();
+    auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
+    bool acknowledge = prepared.acknowledge();
+    bool exclude_me = prepared.exclude_me();
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        try {
+            publish_message(request_id, message, publication, acknowledge, exclude_me);
+        } catch (const std::exception& e) {
+            publication->set_exception(boost::copy_exception(e));
+        }
+    });
+
+    return bind_executor(m_executor, *publication);
+}
+
+inline void wamp_session::publish_message(
+        uint64_t request_id, const std::shared_ptr<wamp_message>& message,
+        const std::shared_ptr<boost::promise<wamp_publication>>& publication,
+        bool acknowledge, bool exclude_me)
+{
+    // Publications queue behind those already waiting, to keep their order.
+    bool window_full = m_publish_window != 0 && m_publish_requests.size() >= m_publish_window;
+    if (!m_publish_queue.empty() || (acknowledge && window_full)) {
+        if (!m_session_id) {
+            throw no_session_error();
+        }
+        if (m_publish_queue_limit != 0 && m_publish_queue.size() >= m_publish_queue_limit) {
+            publication->set_exception(publish_queue_full_error());
+            return;
+        }
+
+        queued_publication queued = { request_id, message, publication, acknowledge, exclude_me };
+        m_publish_queue.push_back(std::move(queued));
+        return;
+    }
+
+    send_publication(request_id, std::move(*message), publication, acknowledge, exclude_me);
+}
+
+inline void wamp_session::send_publication(
+        uint64_t request_id, wamp_message&& message,
+        const std::shared_ptr<boost::promise<wamp_publication>>& publication,
+        bool acknowledge, bool exclude_me)
+{
+    // Without exclude_me the router delivers the event back to this session.
+    if (exclude_me) {
+        deliver_locally(message);
+    }
+
+    send_message(std::move(message));
+
+    if (acknowledge) {
+        m_publish_requests.emplace(request_id, publication);
+    } else {
+        publication->set_value(wamp_publication());
+    }
+}
+
+inline void wamp_session::send_queued_publications()
+{
+    while (!m_publish_queue.empty()) {
+        const queued_publication& next = m_publish_queue.front();
+        if (next.acknowledge && m_publish_window != 0
+                && m_publish_requests.size() >= m_publish_window) {
+            return;
+        }
+
+        queued_publication queued = std::move(m_publish_queue.front());
+        m_publish_queue.pop_front();
+
+        try {
+            send_publication(queued.request_id, std::move(*queued.message),
+                    queued.publication, queued.acknowledge, queued.exclude_me);
+        } catch (const std::exception& e) {
+            queued.publication->set_exception(boost::copy_exception(e));
+        }
+    }
+}
+
+inline void wamp_session::add_procedure(uint64_t registration_id, const wamp_provider& provider)
+{
+    m_procedures[registration_id] = provider.procedure;
+
+    if (m_local_procedures && provider.exact_match) {
+        m_local_procedures->add(provider.uri, this->shared_from_this(), registration_id);
+        m_local_uris[registration_id] = provider.uri;
+    }
+}
+
+inline void wamp_session::remove_local_procedure(uint64_t registration_id)
+{
+    auto local_uri_itr = m_local_uris.find(registration_id);
+    if (local_uri_itr != m_local_uris.end()) {
+        m_local_procedures->remove(local_uri_itr->second, registration_id);
+        m_local_uris.erase(local_uri_itr);
+    }
+}
+
+inline boost::future<wamp_call_result> wamp_session::call_prepared(
+        const wamp_prepared_call& prepared, uint64_t request_id, msgpack::sbuffer&& buffer,
+        wamp_call::progress_handler&& progress)
+{
+    auto message = std::make_shared<wamp_message>(std::move(buffer));
+    auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
+    auto call = std::make_shared<wamp_call>();
+    call->set_progress_handler(std::move(progress));
+    // Shared with the prepared call rather than copied for every request.
+    auto procedure = prepared.shared_uri();
+
+    m_io_service.dispatch([=]() {
+        auto shared_self = weak_self.lock();
+        if (!shared_self) {
+            return;
+        }
+
+        try {
+            if (!call_locally(*procedure, request_id, call, message)) {
+                send_message(std::move(*message));
+                m_calls.emplace(request_id, call);
+            }
+        } catch (const std::exception& e) {
+            call->result().set_exception(boost::copy_exception(e));
+        }
+    });
+
+    return bind_executor(m_executor, call->result());
+}
+
+inline bool wamp_session::call_locally(const std::string& procedure, uint64_t request_id,
+        const std::shared_ptr<wamp_call>& call, const std::shared_ptr<wamp_message>& message)
+{
+    if (!m_local_procedures) {
+        return false;
+    }
+
+    uint64_t registration_id = 0;
+    auto callee = m_local_procedures->find(procedure, registration_id);
+    if (!callee) {
+        return false;
+    }
+
+    if (!m_session_id) {
+        throw no_session_error();
+    }
+
+    // The reply may arrive right away if the callee runs on our io service.
+    m_calls.emplace(request_id, call);
+
+    auto weak_self = std::weak_ptr<wamp_session>(this->shared_from_this());
+    callee->m_io_service.dispatch([callee, registration_id, message, weak_self]() {
+        callee->invoke_locally(registration_id, std::move(*message), weak_self);
+    });
+
+    return true;
+}
+
+inline void wamp_session::invoke_locally(uint64_t registration_id, wamp_message&& message,
+        const std::weak_ptr<wamp_session>& caller)
+{
+    // [CALL, Request|id, Options|dict, Procedure|uri]
+    // [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list]
+    // [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list, ArgumentsKw|dict]
+    uint64_t request_id = message.field<uint64_t>(1);
+
+    auto procedure_itr = m_procedures.find(registration_id);
+    if (!m_session_id || procedure_itr == m_procedures.end()) {
+        auto shared_caller = caller.lock();
+        if (!shared_caller) {
+            return;
+        }
+
+        wamp_message error(5);
+        error.set_field(0, static_cast<int>(message_type::ERROR));
+        error.set_field(1, static_cast<int>(message_type::INVOCATION));
+        error.set_field(2, request_id);
+        error.set_field(3, std::unordered_map<int, int>() /* No Details */);
+        error.set_field(4, std::string("wamp.error.no_such_procedure"));
+        shared_caller->on_invocation_reply(std::move(error), true);
+        return;
+    }
+
+    wamp_invocation invocation = m_invocation_pool->acquire();
+    invocation->set_request_id(request_id);
+    // The options of the CALL hold what the router would pass on in the
+    // details of the INVOCATION, e.g. the ppt_* options of a payload.
+    invocation->set_details(message.field(2));
+    if (message.size() > 4) {
+        invocation->set_arguments(message.field(4));
+
+        if (message.size() > 5) {
+            invocation->set_kw_arguments(message.field(5));
+        }
+    }
+    invocation->set_zone(std::move(message.zone()), m_zone_pool);
+    // Replies go straight back to the caller, as if the router had sent them.
+    invocation->set_sink(caller, true);
+
+    invoke_procedure(registration_id, procedure_itr->second, invocation);
+}
+
+inline void wamp_session::process_local_reply(wamp_message&& reply)
+{
+    try {
+        auto type = static_cast<message_type>(reply.field<int>(0));
+        if (type == message_type::YIELD) {
+            // [YIELD, INVOCATION.Request|id, Options|dict, ...] has the shape of
+            // [RESULT, CALL.Request|id, Details|dict, ...], and the invocation
+            // carries the request id of the call.
+            reply.set_field(0, static_cast<int>(message_type::RESULT));
+            process_call_result(std::move(reply));
+        } else if (type == message_type::ERROR) {
+            // [ERROR, INVOCATION, INVOCATION.Request|id, ...] becomes [ERROR, CALL, CALL.Request|id, ...]
+            reply.set_field(1, static_cast<int>(message_type::CALL));
+            process_error(std::move(reply));
+        }
+    } catch (const std::exception& e) {
+        // The call is no longer pending, e.g. because the session was lost.
+        if (m_debug_enabled) {
+            std::cerr << "dropping reply to local call: " << e.what() << std::endl;
+        }
+    }
 }
 
 } // namespace autobahn
@@ -36,22 +36,37 @@
 #include "boost_config.hpp"
 
 #include <boost/thread/future.hpp>
+#include <string>
 
 namespace autobahn {
 
+/// A local subscriber: the topic and match policy it subscribes with and its handler.
+struct wamp_subscriber
+{
+    std::string topic;
+    std::string match;
+    wamp_event_handler handler;
+};
+
 /// An outstanding wamp call.
 class wamp_subscribe_request
 {
 public:
     wamp_subscribe_request();
     wamp_subscribe_request(const wamp_event_handler& handler);
+    wamp_subscribe_request(const std::string& topic, const std::string& match,
+            const wamp_event_handler& handler);
 
+    const std::string& topic() const;
+    const std::string& match() const;
     const wamp_event_handler& handler() const;
     boost::promise<wamp_subscription>& response();
     void set_handler(const wamp_event_handler& handler) const;
     void set_response(const wamp_subscription& subscription);
 
 private:
+    std::string m_topic;
+    std::string m_match;
     wamp_event_handler m_handler;
     boost::promise<wamp_subscription> m_response;
 };
@@ -31,17 +31,40 @@
 namespace autobahn {
 
 inline wamp_subscribe_request::wamp_subscribe_request()
-    : m_handler()
+    : m_topic()
+    , m_match()
+    , m_handler()
     , m_response()
 {
 }
 
 inline wamp_subscribe_request::wamp_subscribe_request(const wamp_event_handler& handler)
-    : m_handler(handler)
+    : m_topic()
+    , m_match()
+    , m_handler(handler)
     , m_response()
 {
 }
 
+inline wamp_subscribe_request::wamp_subscribe_request(
+        const std::string& topic, const std::string& match, const wamp_event_handler& handler)
+    : m_topic(topic)
+    , m_match(match)
+    , m_handler(handler)
+    , m_response()
+{
+}
+
+inline const std::string& wamp_subscribe_request::topic() const
+{
+    return m_topic;
+}
+
+inline const std::string& wamp_subscribe_request::match() const
+{
+    return m_match;
+}
+
 inline const wamp_event_handler& wamp_subscribe_request::handler() const
 {
     return m_handler;
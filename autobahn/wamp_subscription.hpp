@@ -41,10 +41,20 @@ class wamp_subscription
 public:
     wamp_subscription();
     wamp_subscription(uint64_t id);
+    wamp_subscription(uint64_t id, uint64_t handler_id);
     uint64_t id() const;
 
+    /*!
+     * Identifies the local handler this subscription was made for. Handlers
+     * subscribed to the same topic with the same match policy share one
+     * router subscription id but keep a handler id of their own. A handler
+     * id of 0 stands for every local handler of the subscription.
+     */
+    uint64_t handler_id() const;
+
 private:
     uint64_t m_id;
+    uint64_t m_handler_id;
 };
 
 } // namespace autobahn
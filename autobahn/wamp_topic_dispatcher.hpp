@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_TOPIC_DISPATCHER_HPP
+#define AUTOBAHN_WAMP_TOPIC_DISPATCHER_HPP
+
+#include "wamp_event_handler.hpp"
+#include "wamp_uri_trie.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace autobahn {
+
+/*!
+ * Fans the events of one prefix or wildcard subscription out to handlers
+ * for concrete topics or narrower patterns underneath it, matched on the
+ * topic the router puts in the event details.
+ *
+ * \code
+ * auto sensors = std::make_shared<wamp_topic_dispatcher>();
+ * sensors->add("com.acme.sensors.hall.temperature", on_hall_temperature);
+ * sensors->add("com.acme.sensors..humidity", on_humidity, "wildcard");
+ * session->subscribe("com.acme.sensors.", sensors->handler(),
+ *         wamp_subscribe_options("prefix"));
+ * \endcode
+ *
+ * Handlers are added and removed on the thread running the session, or
+ * before the dispatcher is subscribed. Handlers may add and remove others
+ * while an event is dispatched; such changes apply to the next event.
+ */
+class wamp_topic_dispatcher :
+    public std::enable_shared_from_this<wamp_topic_dispatcher>
+{
+public:
+    wamp_topic_dispatcher();
+
+    /*!
+     * Adds a handler for the topics matching a pattern.
+     *
+     * \param topic The topic, or topic pattern, to handle.
+     * \param handler The handler that receives the matching events.
+     * \param match The match policy of the pattern: "exact", "prefix" or "wildcard".
+     * \return An id for removing the handler again.
+     */
+    uint64_t add(const std::string& topic, const wamp_event_handler& handler,
+            const std::string& match = "exact");
+
+    /*!
+     * Removes a handler.
+     *
+     * \return Whether there was a handler with the given id.
+     */
+    bool remove(uint64_t id);
+
+    std::size_t size() const;
+
+    /*!
+     * Hands the event to every handler matching its topic.
+     */
+    void dispatch(const wamp_event& event);
+
+    /*!
+     * An event handler, for wamp_session::subscribe, that dispatches to this
+     * dispatcher for as long as it is alive.
+     */
+    wamp_event_handler handler();
+
+private:
+    void apply_deferred();
+
+    wamp_uri_trie<wamp_event_handler> m_handlers;
+    uint64_t m_last_id;
+
+    // Changes made while dispatching, applied once dispatching is done.
+    unsigned m_dispatching;
+    std::vector<std::tuple<uint64_t, std::string, std::string, wamp_event_handler>> m_deferred_additions;
+    std::vector<uint64_t> m_deferred_removals;
+};
+
+} // namespace autobahn
+
+#include "wamp_topic_dispatcher.ipp"
+
+#endif // AUTOBAHN_WAMP_TOPIC_DISPATCHER_HPP
@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace autobahn {
+
+inline wamp_topic_dispatcher::wamp_topic_dispatcher()
+    : m_handlers()
+    , m_last_id(0)
+    , m_dispatching(0)
+    , m_deferred_additions()
+    , m_deferred_removals()
+{
+}
+
+inline uint64_t wamp_topic_dispatcher::add(
+        const std::string& topic, const wamp_event_handler& handler, const std::string& match)
+{
+    uint64_t id = ++m_last_id;
+    if (m_dispatching) {
+        if (match != "exact" && match != "prefix" && match != "wildcard") {
+            throw std::invalid_argument("unknown match policy " + match);
+        }
+        m_deferred_additions.emplace_back(id, topic, match, handler);
+    } else {
+        m_handlers.insert(id, topic, match, handler);
+    }
+    return id;
+}
+
+inline bool wamp_topic_dispatcher::remove(uint64_t id)
+{
+    if (!m_dispatching) {
+        return m_handlers.erase(id);
+    }
+
+    auto addition_itr = std::find_if(m_deferred_additions.begin(), m_deferred_additions.end(),
+            [id](const std::tuple<uint64_t, std::string, std::string, wamp_event_handler>& addition) {
+                return std::get<0>(addition) == id;
+            });
+    if (addition_itr != m_deferred_additions.end()) {
+        m_deferred_additions.erase(addition_itr);
+        return true;
+    }
+
+    if (!m_handlers.contains(id) ||
+            std::find(m_deferred_removals.begin(), m_deferred_removals.end(), id) != m_deferred_removals.end()) {
+        return false;
+    }
+    m_deferred_removals.push_back(id);
+    return true;
+}
+
+inline std::size_t wamp_topic_dispatcher::size() const
+{
+    return m_handlers.size() + m_deferred_additions.size() - m_deferred_removals.size();
+}
+
+inline void wamp_topic_dispatcher::dispatch(const wamp_event& event)
+{
+    ++m_dispatching;
+    try {
+        m_handlers.for_each_match(event.uri(), [&](const wamp_event_handler& handler) {
+            handler(event);
+        });
+    } catch (...) {
+        if (--m_dispatching == 0) {
+            apply_deferred();
+        }
+        throw;
+    }
+
+    if (--m_dispatching == 0) {
+        apply_deferred();
+    }
+}
+
+inline wamp_event_handler wamp_topic_dispatcher::handler()
+{
+    auto weak_self = std::weak_ptr<wamp_topic_dispatcher>(this->shared_from_this());
+    return [weak_self](const wamp_event& event) {
+        auto shared_self = weak_self.lock();
+        if (shared_self) {
+            shared_self->dispatch(event);
+        }
+    };
+}
+
+inline void wamp_topic_dispatcher::apply_deferred()
+{
+    for (uint64_t id : m_deferred_removals) {
+        m_handlers.erase(id);
+    }
+    m_deferred_removals.clear();
+
+    for (auto& addition : m_deferred_additions) {
+        m_handlers.insert(std::get<0>(addition), std::get<1>(addition), std::get<2>(addition),
+                std::get<3>(addition));
+    }
+    m_deferred_additions.clear();
+}
+
+} // namespace autobahn
@@ -32,14 +32,16 @@
 #define AUTOBAHN_WAMP_TRANSPORT_HPP
 
 #include "boost_config.hpp"
+#include "wamp_message.hpp"
+#include "wamp_zone_pool.hpp"
 
 #include <boost/thread/future.hpp>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace autobahn {
 
-class wamp_message;
 class wamp_transport_handler;
 
 /*!
@@ -98,10 +100,60 @@ public:
     /*!
      * Send the message synchronously over the transport.
      *
+     * The message is passed by rvalue reference only to spare a copy: the
+     * transport must neither move from it nor keep a reference to it or to
+     * its buffer. Once this returns, the session takes the serialized
+     * buffer of the message back to reuse it for the next message.
+     * Transports that write asynchronously must copy the bytes.
+     *
      * @param message The message to be sent.
      */
     virtual void send_message(wamp_message&& message) = 0;
 
+    /*!
+     * Send a batch of messages synchronously over the transport, in order.
+     *
+     * Transports that can write several messages at once should override
+     * this. The default implementation sends the messages one by one. As
+     * with send_message(), the messages and their buffers are left in
+     * @p messages for the session to reuse.
+     *
+     * @param messages The messages to be sent.
+     */
+    virtual void send_messages(std::vector<wamp_message>&& messages)
+    {
+        for (auto& message : messages) {
+            send_message(std::move(message));
+        }
+    }
+
+    /*!
+     * Set the pool that inbound messages are unpacked into. The zone of a
+     * message returns to the pool once the event, call result or
+     * invocation made from it is destroyed.
+     *
+     * Transports that unpack messages themselves should override this. By
+     * default every message gets a zone of its own.
+     *
+     * @param zone_pool The pool to take zones from, or nullptr for none.
+     */
+    virtual void set_zone_pool(const std::shared_ptr<wamp_zone_pool>& zone_pool)
+    {
+    }
+
+    /*!
+     * Set whether inbound messages keep the bytes of their fields as
+     * received, see wamp_message::raw_field().
+     *
+     * Transports that unpack messages themselves should override this. By
+     * default messages do not keep them.
+     *
+     * @param keep_raw_fields Whether to keep the encoded fields.
+     */
+    virtual void set_keep_raw_fields(bool keep_raw_fields)
+    {
+    }
+
     /*!
      * Set the handler to be invoked when the transport detects congestion
      * sending to the remote peer and needs to apply backpressure on the
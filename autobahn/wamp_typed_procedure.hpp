@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_TYPED_PROCEDURE_HPP
+#define AUTOBAHN_WAMP_TYPED_PROCEDURE_HPP
+
+#include "wamp_invocation.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+
+namespace autobahn {
+
+namespace detail {
+
+template <std::size_t... I>
+struct index_sequence {};
+
+template <std::size_t N, std::size_t... I>
+struct make_index_sequence : make_index_sequence<N - 1, N - 1, I...> {};
+
+template <std::size_t... I>
+struct make_index_sequence<0, I...> : index_sequence<I...> {};
+
+template <typename... T>
+struct all_default_constructible : std::true_type {};
+
+template <typename T, typename... Rest>
+struct all_default_constructible<T, Rest...> : std::integral_constant<bool,
+        std::is_default_constructible<T>::value && all_default_constructible<Rest...>::value> {};
+
+} // namespace detail
+
+/*!
+ * Adapts a function with a fixed C++ signature to a wamp_procedure.
+ *
+ * The positional arguments of an invocation are decoded in one go into a
+ * tuple of the parameter types, and the return value is packed straight
+ * into the YIELD message. An invocation with the wrong number of arguments,
+ * or with arguments of the wrong type, is answered with a
+ * `wamp.error.invalid_argument` error.
+ *
+ * The decayed parameter types must be default constructible, as the tuple
+ * is constructed before the arguments are decoded into it.
+ *
+ * Used by wamp_session::provide<Signature>().
+ */
+template <typename Signature>
+class wamp_typed_procedure;
+
+template <typename R, typename... Args>
+class wamp_typed_procedure<R(Args...)>
+{
+public:
+    using function_type = std::function<R(Args...)>;
+    using arguments_type = std::tuple<typename std::decay<Args>::type...>;
+
+    static_assert(detail::all_default_constructible<typename std::decay<Args>::type...>::value,
+            "the parameter types of a typed procedure must be default constructible");
+
+    explicit wamp_typed_procedure(function_type&& function);
+
+    void operator()(wamp_invocation invocation) const;
+
+private:
+    template <std::size_t... I>
+    void invoke(
+            const wamp_invocation& invocation, arguments_type& arguments,
+            detail::index_sequence<I...>, std::true_type /* void */) const;
+
+    template <std::size_t... I>
+    void invoke(
+            const wamp_invocation& invocation, arguments_type& arguments,
+            detail::index_sequence<I...>, std::false_type /* void */) const;
+
+    function_type m_function;
+};
+
+} // namespace autobahn
+
+#include "wamp_typed_procedure.ipp"
+
+#endif // AUTOBAHN_WAMP_TYPED_PROCEDURE_HPP
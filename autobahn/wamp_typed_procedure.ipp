@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <map>
+#include <string>
+#include <utility>
+
+namespace autobahn {
+
+template <typename R, typename... Args>
+inline wamp_typed_procedure<R(Args...)>::wamp_typed_procedure(function_type&& function)
+    : m_function(std::move(function))
+{
+}
+
+template <typename R, typename... Args>
+inline void wamp_typed_procedure<R(Args...)>::operator()(wamp_invocation invocation) const
+{
+    if (invocation->number_of_arguments() != sizeof...(Args)) {
+        std::map<std::string, std::string> error_kw_arguments;
+        error_kw_arguments["what"] = "expected " + std::to_string(sizeof...(Args))
+                + " positional arguments, got "
+                + std::to_string(invocation->number_of_arguments());
+        invocation->error("wamp.error.invalid_argument", EMPTY_ARGUMENTS, error_kw_arguments);
+        return;
+    }
+
+    arguments_type arguments;
+    if (sizeof...(Args) > 0) {
+        try {
+            invocation->get_arguments(arguments);
+        } catch (const std::bad_cast& e) {
+            std::map<std::string, std::string> error_kw_arguments;
+            error_kw_arguments["what"] = e.what();
+            invocation->error("wamp.error.invalid_argument", EMPTY_ARGUMENTS, error_kw_arguments);
+            return;
+        }
+    }
+
+    invoke(invocation, arguments,
+            detail::make_index_sequence<sizeof...(Args)>(), std::is_void<R>());
+}
+
+template <typename R, typename... Args>
+template <std::size_t... I>
+inline void wamp_typed_procedure<R(Args...)>::invoke(
+        const wamp_invocation& invocation, arguments_type& arguments,
+        detail::index_sequence<I...>, std::true_type) const
+{
+    m_function(std::move(std::get<I>(arguments))...);
+    invocation->empty_result();
+}
+
+template <typename R, typename... Args>
+template <std::size_t... I>
+inline void wamp_typed_procedure<R(Args...)>::invoke(
+        const wamp_invocation& invocation, arguments_type& arguments,
+        detail::index_sequence<I...>, std::false_type) const
+{
+    invocation->packed_result(m_function(std::move(std::get<I>(arguments))...));
+}
+
+} // namespace autobahn
@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_URI_TRIE_HPP
+#define AUTOBAHN_WAMP_URI_TRIE_HPP
+
+#include "wamp_object_view.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace autobahn {
+
+/*!
+ * Maps URI patterns to values, with the match policies WAMP defines for
+ * subscriptions and registrations:
+ *
+ * - "exact": the pattern is the URI.
+ * - "prefix": the URI starts with the pattern.
+ * - "wildcard": the URI has as many components as the pattern, and empty
+ *   pattern components match any component, e.g. "com..update" matches
+ *   "com.acme.update".
+ *
+ * Patterns are stored by their dot separated components, so a look-up
+ * walks the components of the URI once rather than testing every pattern,
+ * and does not allocate.
+ *
+ * The trie must not be modified while a look-up is visiting it.
+ */
+template <typename T>
+class wamp_uri_trie
+{
+public:
+    wamp_uri_trie();
+
+    wamp_uri_trie(wamp_uri_trie&& other) = default;
+    wamp_uri_trie& operator=(wamp_uri_trie&& other) = default;
+    wamp_uri_trie(const wamp_uri_trie& other) = delete;
+    wamp_uri_trie& operator=(const wamp_uri_trie& other) = delete;
+
+    /*!
+     * Adds a value for a pattern under the given id, which must not be in
+     * use already.
+     *
+     * @throw std::invalid_argument if the match policy is unknown.
+     */
+    void insert(uint64_t id, const std::string& pattern, const std::string& match, const T& value);
+
+    /*!
+     * Removes the value with the given id.
+     *
+     * @return Whether there was such a value.
+     */
+    bool erase(uint64_t id);
+
+    bool contains(uint64_t id) const;
+    std::size_t size() const;
+    bool empty() const;
+
+    /*!
+     * Calls the visitor with every value whose pattern matches the URI.
+     */
+    template <typename Visitor>
+    void for_each_match(wamp_string_view uri, Visitor&& visitor) const;
+
+    /*!
+     * The value of the pattern matching the URI best, or nullptr. As with
+     * registrations in WAMP an exact match wins over a prefix match, which
+     * wins over a wildcard match. Longer prefixes win over shorter ones and
+     * wildcard patterns with more concrete components over those with fewer.
+     * Ties go to the pattern with the lowest id.
+     */
+    const T* best_match(wamp_string_view uri) const;
+
+private:
+    enum class kind { wildcard, prefix, exact };
+
+    struct entry
+    {
+        uint64_t id;
+        kind match;
+        std::size_t rank;
+        std::string remainder;
+        T value;
+    };
+
+    struct node
+    {
+        // Children by component, sorted so that look-ups can bisect.
+        std::vector<std::pair<std::string, std::unique_ptr<node>>> children;
+
+        // The child for an empty component of a wildcard pattern.
+        std::unique_ptr<node> any;
+
+        // Exact and wildcard patterns ending at this node.
+        std::vector<entry> values;
+
+        // Prefix patterns whose complete components end at this node. The
+        // rest of the pattern must start the rest of the URI.
+        std::vector<entry> prefixes;
+    };
+
+    static node* child(node& parent, wamp_string_view component);
+    static const node* find_child(const node& parent, wamp_string_view component);
+    static bool better(const entry& candidate, const entry* best);
+
+    template <typename Visitor>
+    static void visit(const node& current, wamp_string_view uri, std::size_t position,
+            bool ended, Visitor& visitor);
+
+    std::unique_ptr<node> m_root;
+    std::unordered_map<uint64_t, node*> m_owners;
+};
+
+} // namespace autobahn
+
+#include "wamp_uri_trie.ipp"
+
+#endif // AUTOBAHN_WAMP_URI_TRIE_HPP
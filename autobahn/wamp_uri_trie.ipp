@@ -0,0 +1,251 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace autobahn {
+
+template <typename T>
+inline wamp_uri_trie<T>::wamp_uri_trie()
+    : m_root(new node())
+    , m_owners()
+{
+}
+
+template <typename T>
+inline void wamp_uri_trie<T>::insert(
+        uint64_t id, const std::string& pattern, const std::string& match, const T& value)
+{
+    kind policy;
+    if (match == "exact") {
+        policy = kind::exact;
+    } else if (match == "prefix") {
+        policy = kind::prefix;
+    } else if (match == "wildcard") {
+        policy = kind::wildcard;
+    } else {
+        throw std::invalid_argument("unknown match policy " + match);
+    }
+
+    if (m_owners.count(id)) {
+        throw std::invalid_argument("id already in use");
+    }
+
+    // The components to walk; for a prefix pattern only the complete ones.
+    wamp_string_view path(pattern);
+    wamp_string_view remainder;
+    bool has_components = true;
+    if (policy == kind::prefix) {
+        std::size_t last_dot = path.rfind('.');
+        if (last_dot == wamp_string_view::npos) {
+            remainder = path;
+            has_components = false;
+        } else {
+            remainder = path.substr(last_dot + 1);
+            path = path.substr(0, last_dot);
+        }
+    }
+
+    node* current = m_root.get();
+    std::size_t concrete = 0;
+    if (has_components) {
+        std::size_t start = 0;
+        while (true) {
+            std::size_t dot = path.find('.', start);
+            wamp_string_view component = path.substr(start,
+                    dot == wamp_string_view::npos ? wamp_string_view::npos : dot - start);
+            if (policy == kind::wildcard && component.empty()) {
+                if (!current->any) {
+                    current->any.reset(new node());
+                }
+                current = current->any.get();
+            } else {
+                current = child(*current, component);
+                ++concrete;
+            }
+
+            if (dot == wamp_string_view::npos) {
+                break;
+            }
+            start = dot + 1;
+        }
+    }
+
+    entry value_entry{id, policy, policy == kind::prefix ? pattern.size() : concrete,
+            remainder.to_string(), value};
+    if (policy == kind::prefix) {
+        current->prefixes.push_back(std::move(value_entry));
+    } else {
+        current->values.push_back(std::move(value_entry));
+    }
+    m_owners.emplace(id, current);
+}
+
+template <typename T>
+inline bool wamp_uri_trie<T>::erase(uint64_t id)
+{
+    auto owner_itr = m_owners.find(id);
+    if (owner_itr == m_owners.end()) {
+        return false;
+    }
+
+    auto has_id = [id](const entry& candidate) { return candidate.id == id; };
+    for (auto* entries : {&owner_itr->second->values, &owner_itr->second->prefixes}) {
+        auto itr = std::find_if(entries->begin(), entries->end(), has_id);
+        if (itr != entries->end()) {
+            entries->erase(itr);
+            break;
+        }
+    }
+    m_owners.erase(owner_itr);
+    return true;
+}
+
+template <typename T>
+inline bool wamp_uri_trie<T>::contains(uint64_t id) const
+{
+    return m_owners.count(id) != 0;
+}
+
+template <typename T>
+inline std::size_t wamp_uri_trie<T>::size() const
+{
+    return m_owners.size();
+}
+
+template <typename T>
+inline bool wamp_uri_trie<T>::empty() const
+{
+    return m_owners.empty();
+}
+
+template <typename T>
+template <typename Visitor>
+inline void wamp_uri_trie<T>::for_each_match(wamp_string_view uri, Visitor&& visitor) const
+{
+    auto visit_value = [&](const entry& match) {
+        visitor(match.value);
+    };
+    visit(*m_root, uri, 0, false, visit_value);
+}
+
+template <typename T>
+inline const T* wamp_uri_trie<T>::best_match(wamp_string_view uri) const
+{
+    const entry* best = nullptr;
+    auto keep_best = [&](const entry& match) {
+        if (better(match, best)) {
+            best = &match;
+        }
+    };
+    visit(*m_root, uri, 0, false, keep_best);
+
+    return best ? &best->value : nullptr;
+}
+
+template <typename T>
+inline typename wamp_uri_trie<T>::node* wamp_uri_trie<T>::child(
+        node& parent, wamp_string_view component)
+{
+    auto itr = std::lower_bound(parent.children.begin(), parent.children.end(), component,
+            [](const std::pair<std::string, std::unique_ptr<node>>& child, wamp_string_view key) {
+                return wamp_string_view(child.first) < key;
+            });
+    if (itr == parent.children.end() || wamp_string_view(itr->first) != component) {
+        itr = parent.children.emplace(itr, component.to_string(), std::unique_ptr<node>(new node()));
+    }
+    return itr->second.get();
+}
+
+template <typename T>
+inline const typename wamp_uri_trie<T>::node* wamp_uri_trie<T>::find_child(
+        const node& parent, wamp_string_view component)
+{
+    auto itr = std::lower_bound(parent.children.begin(), parent.children.end(), component,
+            [](const std::pair<std::string, std::unique_ptr<node>>& child, wamp_string_view key) {
+                return wamp_string_view(child.first) < key;
+            });
+    if (itr == parent.children.end() || wamp_string_view(itr->first) != component) {
+        return nullptr;
+    }
+    return itr->second.get();
+}
+
+template <typename T>
+inline bool wamp_uri_trie<T>::better(const entry& candidate, const entry* best)
+{
+    if (!best) {
+        return true;
+    }
+    if (candidate.match != best->match) {
+        return candidate.match > best->match;
+    }
+    if (candidate.rank != best->rank) {
+        return candidate.rank > best->rank;
+    }
+    return candidate.id < best->id;
+}
+
+template <typename T>
+template <typename Visitor>
+inline void wamp_uri_trie<T>::visit(const node& current, wamp_string_view uri,
+        std::size_t position, bool ended, Visitor& visitor)
+{
+    // All components of the URI were consumed by the path to this node.
+    if (ended) {
+        for (const auto& match : current.values) {
+            visitor(match);
+        }
+        return;
+    }
+
+    wamp_string_view rest = uri.substr(position);
+    for (const auto& match : current.prefixes) {
+        if (rest.starts_with(match.remainder)) {
+            visitor(match);
+        }
+    }
+
+    std::size_t dot = rest.find('.');
+    wamp_string_view component = rest.substr(0, dot);
+    std::size_t next = dot == wamp_string_view::npos ? uri.size() : position + dot + 1;
+    bool next_ended = dot == wamp_string_view::npos;
+
+    const node* matching_child = find_child(current, component);
+    if (matching_child) {
+        visit(*matching_child, uri, next, next_ended, visitor);
+    }
+    if (current.any) {
+        visit(*current.any, uri, next, next_ended, visitor);
+    }
+}
+
+} // namespace autobahn
@@ -32,6 +32,7 @@
 #define AUTOBAHN_WEBSOCKET_TRANSPORT_HPP
 
 #include "boost_config.hpp"
+#include "wamp_decode_pipeline.hpp"
 #include "wamp_transport.hpp"
 
 #include <boost/thread/future.hpp>
@@ -94,6 +95,16 @@ namespace autobahn {
         */
         virtual void send_message(wamp_message&& message) override;
 
+        /*!
+        * @copydoc wamp_transport::set_zone_pool()
+        */
+        virtual void set_zone_pool(const std::shared_ptr<wamp_zone_pool>& zone_pool) override;
+
+        /*!
+        * @copydoc wamp_transport::set_keep_raw_fields()
+        */
+        virtual void set_keep_raw_fields(bool keep_raw_fields) override;
+
         /*!
         * @copydoc wamp_transport::set_pause_handler()
         */
@@ -184,6 +195,16 @@ namespace autobahn {
             */
             msgpack::unpacker m_message_unpacker;
 
+            /*!
+            * The pool that messages are unpacked into, if any.
+            */
+            std::shared_ptr<wamp_zone_pool> m_zone_pool;
+
+            /*!
+            * Whether messages keep the bytes of their fields as received.
+            */
+            bool m_keep_raw_fields;
+
             /*!
             * Whether or not debugging is enabled.
             */
@@ -47,6 +47,8 @@ inline wamp_websocket_transport::wamp_websocket_transport(
     , m_connect()
     , m_disconnect()
     , m_message_unpacker()
+    , m_zone_pool()
+    , m_keep_raw_fields(false)
     , m_debug_enabled(debug_enabled)
     , m_uri(uri)
 {
@@ -83,20 +85,28 @@ inline bool wamp_websocket_transport::is_connected() const
 
 inline void wamp_websocket_transport::send_message(wamp_message&& message)
 {
-    auto buffer = std::make_shared<msgpack::sbuffer>();
-    msgpack::packer<msgpack::sbuffer> packer(*buffer);
-    packer.pack(message.fields());
+    const msgpack::sbuffer& buffer = message.serialize();
 
    
     // Write actual serialized message.
-    write(buffer->data(), buffer->size());
+    write(buffer.data(), buffer.size());
 
     if (m_debug_enabled) {
-        std::cerr << "TX message (" << buffer->size() << " octets) ..." << std::endl;
+        std::cerr << "TX message (" << buffer.size() << " octets) ..." << std::endl;
         std::cerr << "TX message: " << message << std::endl;
     }
 }
 
+inline void wamp_websocket_transport::set_zone_pool(const std::shared_ptr<wamp_zone_pool>& zone_pool)
+{
+    m_zone_pool = zone_pool;
+}
+
+inline void wamp_websocket_transport::set_keep_raw_fields(bool keep_raw_fields)
+{
+    m_keep_raw_fields = keep_raw_fields;
+}
+
 inline void wamp_websocket_transport::set_pause_handler(pause_handler&& handler)
 {
     m_pause_handler = std::move(handler);
@@ -155,7 +165,18 @@ inline void wamp_websocket_transport::receive_message(const std::string& msg)
         std::cerr << "RX message received." << std::endl;
     }
 
-    if (m_handler) {
+    if (m_handler && (m_zone_pool || m_keep_raw_fields)) {
+        // A websocket message holds exactly one WAMP message, which is
+        // unpacked into a pooled zone straight from the frame.
+        wamp_message message = wamp_decode_pipeline::decode(
+                msg.data(), msg.size(), m_zone_pool, m_keep_raw_fields);
+        if (m_debug_enabled) {
+            std::cerr << "RX message: " << message << std::endl;
+        }
+
+        m_handler->on_message(std::move(message));
+    }
+    else if (m_handler) {
         m_message_unpacker.reserve_buffer(msg.size());
         memcpy(m_message_unpacker.buffer(), msg.data(), msg.size());
         m_message_unpacker.buffer_consumed(msg.size());
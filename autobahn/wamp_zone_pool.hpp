@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_WAMP_ZONE_POOL_HPP
+#define AUTOBAHN_WAMP_ZONE_POOL_HPP
+
+#include <cstddef>
+#include <msgpack.hpp>
+#include <mutex>
+#include <vector>
+
+namespace autobahn {
+
+/*!
+ * A free list of zones for unpacking inbound messages into.
+ *
+ * Transports unpack each message into a zone taken from the pool, and the
+ * event, call result or invocation made from the message hands the zone
+ * back when it is destroyed. A cleared zone keeps its first chunk, so a
+ * steady stream of messages reuses the same few chunks rather than
+ * allocating new ones for each. The pool is safe to use from any thread.
+ */
+class wamp_zone_pool
+{
+public:
+    /*!
+     * Constructs a pool.
+     *
+     * \param max_zones The number of idle zones kept at most.
+     * \param chunk_size The size of the first chunk of newly created zones.
+     */
+    explicit wamp_zone_pool(std::size_t max_zones = 16, std::size_t chunk_size = 8192);
+
+    wamp_zone_pool(const wamp_zone_pool&) = delete;
+    wamp_zone_pool& operator=(const wamp_zone_pool&) = delete;
+
+    /*!
+     * Takes an empty zone from the pool, or creates one if there is none.
+     */
+    msgpack::zone acquire();
+
+    /*!
+     * Hands a zone back to the pool. Everything allocated in it is freed,
+     * so nothing may refer to it any more.
+     */
+    void release(msgpack::zone&& zone);
+
+    /*!
+     * Changes the limits of the pool, see the constructor.
+     */
+    void set_limits(std::size_t max_zones, std::size_t chunk_size);
+
+    /*!
+     * The number of idle zones in the pool.
+     */
+    std::size_t size() const;
+
+    /*!
+     * The number of zones the pool had to create as it was empty.
+     */
+    std::size_t created() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<msgpack::zone> m_zones;
+    std::size_t m_max_zones;
+    std::size_t m_chunk_size;
+    std::size_t m_created;
+};
+
+} // namespace autobahn
+
+#include "wamp_zone_pool.ipp"
+
+#endif // AUTOBAHN_WAMP_ZONE_POOL_HPP
@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <utility>
+
+namespace autobahn {
+
+inline wamp_zone_pool::wamp_zone_pool(std::size_t max_zones, std::size_t chunk_size)
+    : m_mutex()
+    , m_zones()
+    , m_max_zones(max_zones)
+    , m_chunk_size(chunk_size)
+    , m_created(0)
+{
+    // Reserved up front so that releasing a zone never allocates.
+    m_zones.reserve(m_max_zones);
+}
+
+inline msgpack::zone wamp_zone_pool::acquire()
+{
+    std::size_t chunk_size;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_zones.empty()) {
+            msgpack::zone zone(std::move(m_zones.back()));
+            m_zones.pop_back();
+            return zone;
+        }
+
+        ++m_created;
+        chunk_size = m_chunk_size;
+    }
+
+    return msgpack::zone(chunk_size);
+}
+
+inline void wamp_zone_pool::release(msgpack::zone&& zone)
+{
+    // Cleared outside the lock, as it runs the finalizers of the zone.
+    zone.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_zones.size() < m_max_zones) {
+        m_zones.push_back(std::move(zone));
+    }
+}
+
+inline void wamp_zone_pool::set_limits(std::size_t max_zones, std::size_t chunk_size)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_max_zones = max_zones;
+    m_chunk_size = chunk_size;
+
+    if (m_zones.size() > m_max_zones) {
+        m_zones.erase(m_zones.begin() + m_max_zones, m_zones.end());
+    }
+    m_zones.reserve(m_max_zones);
+}
+
+inline std::size_t wamp_zone_pool::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_zones.size();
+}
+
+inline std::size_t wamp_zone_pool::created() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_created;
+}
+
+} // namespace autobahn
@@ -0,0 +1,335 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUTOBAHN_TEST_LOOPBACK_ROUTER_HPP
+#define AUTOBAHN_TEST_LOOPBACK_ROUTER_HPP
+
+#include <autobahn/autobahn.hpp>
+
+#include <boost/asio.hpp>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Stands in for the transport and the router of a single session in tests.
+// Every message the session sends is handed to the reply function of the
+// test, which answers it with deliver(). Answers reach the session from
+// the io service, as they would from a real transport.
+class loopback_router :
+    public autobahn::wamp_transport,
+    public std::enable_shared_from_this<loopback_router>
+{
+public:
+    // Answers a message sent by the session.
+    using reply_function = std::function<void(loopback_router& router, autobahn::wamp_message&& message)>;
+
+    // Answers a request sent by the session, decoded, given its type.
+    using request_function = std::function<void(loopback_router& router,
+            autobahn::message_type type, autobahn::wamp_message& request)>;
+
+    // Makes a reply function that decodes every message the session sends,
+    // answers HELLO and hands all other requests to @p answer.
+    static reply_function answering(request_function answer)
+    {
+        return [answer](loopback_router& router, autobahn::wamp_message&& message) {
+            autobahn::wamp_message request = decode(message);
+            auto type = static_cast<autobahn::message_type>(request.field<int>(0));
+            if (type == autobahn::message_type::HELLO) {
+                router.welcome();
+            } else {
+                answer(router, type, request);
+            }
+        };
+    }
+
+    loopback_router(boost::asio::io_service& io, reply_function reply)
+        : m_io(io)
+        , m_reply(std::move(reply))
+        , m_zone_pool()
+        , m_keep_raw_fields(false)
+        , m_connected(true)
+        , m_writes(0)
+    {
+    }
+
+    virtual boost::future<void> connect() override
+    {
+        m_connected = true;
+        return boost::make_ready_future();
+    }
+
+    virtual boost::future<void> disconnect() override
+    {
+        m_connected = false;
+        return boost::make_ready_future();
+    }
+
+    virtual bool is_connected() const override { return m_connected; }
+
+    virtual void send_message(autobahn::wamp_message&& message) override
+    {
+        ++m_writes;
+        m_reply(*this, std::move(message));
+    }
+
+    virtual void send_messages(std::vector<autobahn::wamp_message>&& messages) override
+    {
+        ++m_writes;
+        for (auto& message : messages) {
+            m_reply(*this, std::move(message));
+        }
+    }
+
+    virtual void set_keep_raw_fields(bool keep_raw_fields) override
+    {
+        m_keep_raw_fields = keep_raw_fields;
+    }
+
+    virtual void set_zone_pool(const std::shared_ptr<autobahn::wamp_zone_pool>& zone_pool) override
+    {
+        m_zone_pool = zone_pool;
+    }
+
+    virtual void set_pause_handler(pause_handler&&) override {}
+    virtual void set_resume_handler(resume_handler&&) override {}
+    virtual void pause() override {}
+    virtual void resume() override {}
+
+    virtual void attach(const std::shared_ptr<autobahn::wamp_transport_handler>& handler) override
+    {
+        m_handler = handler;
+        handler->on_attach(shared_from_this());
+    }
+
+    virtual void detach() override { m_handler.reset(); }
+    virtual bool has_handler() const override { return m_handler != nullptr; }
+
+    const std::shared_ptr<autobahn::wamp_transport_handler>& handler() const { return m_handler; }
+
+    // The number of writes the session asked for, a batch counting as one.
+    // Read it from the io thread, or once the io service is idle.
+    std::size_t writes() const { return m_writes; }
+
+    // Decodes a message as sent by the session, keeping the bytes of its fields.
+    static autobahn::wamp_message decode(autobahn::wamp_message& message)
+    {
+        const msgpack::sbuffer& sent = message.serialize();
+        return autobahn::wamp_decode_pipeline::decode(sent.data(), sent.size(), nullptr, true);
+    }
+
+    // Appends already encoded fields, e.g. the raw fields of a request, to
+    // an answer.
+    static void write(msgpack::sbuffer& buffer, const autobahn::wamp_bytes_view& bytes)
+    {
+        buffer.write(bytes.data(), bytes.size());
+    }
+
+    // Reads the type of a message as sent by the session without decoding
+    // it, for tests that count allocations.
+    static autobahn::message_type peek_type(autobahn::wamp_message& message)
+    {
+        return static_cast<autobahn::message_type>(bytes(message)[1]);
+    }
+
+    // Reads the request id, the second field, of a message as sent by the
+    // session without decoding it.
+    static uint64_t peek_request_id(autobahn::wamp_message& message)
+    {
+        const unsigned char* p = bytes(message) + 2;
+        switch (p[0]) {
+            case 0xcc: return p[1];
+            case 0xcd: return (uint64_t(p[1]) << 8) | p[2];
+            case 0xce: return (uint64_t(p[1]) << 24) | (uint64_t(p[2]) << 16) | (uint64_t(p[3]) << 8) | p[4];
+            case 0xcf: {
+                uint64_t value = 0;
+                for (int i = 1; i <= 8; ++i) {
+                    value = (value << 8) | p[i];
+                }
+                return value;
+            }
+            default: return p[0];
+        }
+    }
+
+    // Hands a serialized message to the session on the io thread, unpacked
+    // into a zone from the pool of the session.
+    void deliver(const msgpack::sbuffer& message)
+    {
+        auto frame = std::make_shared<std::string>(message.data(), message.size());
+        auto handler = m_handler;
+        auto zone_pool = m_zone_pool;
+        bool keep_raw_fields = m_keep_raw_fields;
+        m_io.post([handler, frame, zone_pool, keep_raw_fields]() {
+            handler->on_message(autobahn::wamp_decode_pipeline::decode(
+                    frame->data(), frame->size(), zone_pool, keep_raw_fields));
+        });
+    }
+
+    // Hands the message returned by @p make to the session on the io
+    // thread, without serializing it.
+    template <typename Make>
+    void deliver_made(Make make)
+    {
+        auto handler = m_handler;
+        m_io.post([handler, make]() {
+            handler->on_message(make());
+        });
+    }
+
+    // Answers HELLO.
+    void welcome()
+    {
+        deliver_made([]() {
+            autobahn::wamp_message welcome(3);
+            welcome.set_field(0, static_cast<int>(autobahn::message_type::WELCOME));
+            welcome.set_field(1, static_cast<uint64_t>(1));
+            welcome.set_field(2, std::map<std::string, int>());
+            return welcome;
+        });
+    }
+
+    // Answers SUBSCRIBE, REGISTER, UNSUBSCRIBE or UNREGISTER. The id is the
+    // subscription or registration id to assign and ignored otherwise.
+    void acknowledge(autobahn::message_type type, uint64_t request_id, uint64_t id = 0)
+    {
+        deliver_made([type, request_id, id]() {
+            bool assigns = type == autobahn::message_type::SUBSCRIBE
+                    || type == autobahn::message_type::REGISTER;
+            autobahn::wamp_message acknowledgement(assigns ? 3 : 2);
+            acknowledgement.set_field(0, static_cast<int>(acknowledgement_of(type)));
+            acknowledgement.set_field(1, request_id);
+            if (assigns) {
+                acknowledgement.set_field(2, id);
+            }
+            return acknowledgement;
+        });
+    }
+
+    // Tells the session that the connection was lost.
+    void drop(const std::string& reason = "wamp.error.network_failure")
+    {
+        m_connected = false;
+        auto handler = m_handler;
+        m_io.post([handler, reason]() {
+            try {
+                handler->on_disconnect(false, reason);
+            } catch (const autobahn::network_error&) {
+                // A session rethrows the error of an unclean disconnect.
+            }
+        });
+    }
+
+private:
+    static const unsigned char* bytes(autobahn::wamp_message& message)
+    {
+        return reinterpret_cast<const unsigned char*>(message.serialize().data());
+    }
+
+    static autobahn::message_type acknowledgement_of(autobahn::message_type type)
+    {
+        switch (type) {
+            case autobahn::message_type::SUBSCRIBE: return autobahn::message_type::SUBSCRIBED;
+            case autobahn::message_type::REGISTER: return autobahn::message_type::REGISTERED;
+            case autobahn::message_type::UNSUBSCRIBE: return autobahn::message_type::UNSUBSCRIBED;
+            default: return autobahn::message_type::UNREGISTERED;
+        }
+    }
+
+    boost::asio::io_service& m_io;
+    reply_function m_reply;
+    std::shared_ptr<autobahn::wamp_transport_handler> m_handler;
+    std::shared_ptr<autobahn::wamp_zone_pool> m_zone_pool;
+    bool m_keep_raw_fields;
+    bool m_connected;
+    std::size_t m_writes;
+};
+
+// Runs an io service on a thread of its own, for a test to post to.
+class io_thread
+{
+public:
+    explicit io_thread(boost::asio::io_service& io)
+        : m_io(io)
+        , m_work(new boost::asio::io_service::work(io))
+        , m_thread([&io]() { io.run(); })
+    {
+    }
+
+    io_thread(const io_thread&) = delete;
+    io_thread& operator=(const io_thread&) = delete;
+
+    ~io_thread() { stop(); }
+
+    // Stops the io service, dropping what is still queued, and joins the
+    // thread.
+    void stop()
+    {
+        if (m_thread.joinable()) {
+            m_work.reset();
+            m_io.stop();
+            m_thread.join();
+        }
+    }
+
+    std::thread::id id() const { return m_thread.get_id(); }
+
+private:
+    boost::asio::io_service& m_io;
+    std::unique_ptr<boost::asio::io_service::work> m_work;
+    std::thread m_thread;
+};
+
+// Runs @p fn on the io thread and waits for it.
+template <typename Function>
+void run_on_io(boost::asio::io_service& io, Function fn)
+{
+    boost::promise<void> done;
+    io.post([&]() {
+        fn();
+        done.set_value();
+    });
+    done.get_future().get();
+}
+
+// Waits until the io service has run everything posted to it so far, and
+// with @p rounds greater than 1 also what that posts in turn.
+inline void drain(boost::asio::io_service& io, int rounds = 1)
+{
+    for (int i = 0; i < rounds; ++i) {
+        run_on_io(io, []() {});
+    }
+}
+
+#endif // AUTOBAHN_TEST_LOOPBACK_ROUTER_HPP
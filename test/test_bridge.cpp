@@ -0,0 +1,289 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Relays events and calls through a wamp_bridge between two sessions, each
+// joined to a loopback transport that acts as its router. Checks that the
+// arguments reach the other side as the bytes they were sent as, that topics
+// are rewritten, and that nothing had to be re-encoded; then relays a batch
+// of large events and prints the bridge statistics. Finally relays a
+// wildcard subscription, checking that the matched components of the topic
+// and the publish options, payload options included, are passed on.
+
+#include "loopback_router.hpp"
+
+#include <boost/asio.hpp>
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+static const uint64_t SUBSCRIPTION_ID = 7;
+static const uint64_t WILDCARD_SUBSCRIPTION_ID = 8;
+static const uint64_t REGISTRATION_ID = 9;
+static const std::size_t NUM_EVENTS = 1000;
+static const std::size_t EVENT_PAYLOAD = 64 * 1024;
+
+template <typename T>
+static std::string encode(const T& value)
+{
+    msgpack::sbuffer buffer;
+    msgpack::pack(buffer, value);
+    return std::string(buffer.data(), buffer.size());
+}
+
+// What a loopback router received: the message type, the topic and the
+// payload scheme of a PUBLISH and the encoded arguments.
+struct received_message
+{
+    autobahn::message_type type;
+    std::string topic;
+    std::string scheme;
+    std::string arguments;
+    std::string kw_arguments;
+};
+
+// Collects what a loopback router received, for the test to wait on.
+class received_messages
+{
+public:
+    void record(autobahn::message_type type, const std::string& topic, const std::string& scheme,
+            const autobahn::wamp_bytes_view& arguments, const autobahn::wamp_bytes_view& kw_arguments)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_received.push_back(received_message{ type, topic, scheme,
+                std::string(arguments.data(), arguments.size()),
+                std::string(kw_arguments.data(), kw_arguments.size()) });
+        m_recorded.notify_all();
+    }
+
+    // Waits until @p count messages have been recorded and returns them.
+    std::vector<received_message> wait_for(std::size_t count)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_recorded.wait(lock, [&]() { return m_received.size() >= count; });
+        return m_received;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_recorded;
+    std::vector<received_message> m_received;
+};
+
+// Answers HELLO, SUBSCRIBE and REGISTER, echoes CALL as RESULT and records
+// PUBLISH and YIELD. EVENTs and INVOCATIONs are delivered with deliver().
+// Wildcard subscriptions get a subscription id of their own.
+static loopback_router::reply_function recording_reply(const std::shared_ptr<received_messages>& received)
+{
+    return loopback_router::answering([received](loopback_router& router,
+            autobahn::message_type type, autobahn::wamp_message& request) {
+        switch (type) {
+            case autobahn::message_type::SUBSCRIBE: {
+                // [SUBSCRIBE, Request|id, Options|dict, Topic|uri]
+                bool wildcard = autobahn::value_for_key_or<std::string>(
+                        request.field(2), "match", std::string()) == "wildcard";
+                router.acknowledge(type, request.field<uint64_t>(1),
+                        wildcard ? WILDCARD_SUBSCRIPTION_ID : SUBSCRIPTION_ID);
+                break;
+            }
+            case autobahn::message_type::REGISTER:
+                router.acknowledge(type, request.field<uint64_t>(1), REGISTRATION_ID);
+                break;
+            case autobahn::message_type::CALL: {
+                // [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list, ArgumentsKw|dict]
+                autobahn::wamp_bytes_view arguments = request.raw_field(4);
+                autobahn::wamp_bytes_view kw_arguments = request.raw_field(5);
+                msgpack::sbuffer reply;
+                msgpack::packer<msgpack::sbuffer> packer(reply);
+                packer.pack_array(3 + autobahn::raw_argument_fields(arguments, kw_arguments));
+                packer.pack(static_cast<int>(autobahn::message_type::RESULT));
+                packer.pack(request.field<uint64_t>(1));
+                packer.pack_map(0);
+                autobahn::pack_raw_arguments(reply, arguments, kw_arguments);
+                router.deliver(reply);
+                break;
+            }
+            case autobahn::message_type::PUBLISH:
+                // [PUBLISH, Request|id, Options|dict, Topic|uri, Arguments|list, ArgumentsKw|dict]
+                received->record(type, request.field<std::string>(3),
+                        autobahn::value_for_key_or<std::string>(request.field(2), "ppt_scheme", std::string()),
+                        request.raw_field(4), request.raw_field(5));
+                break;
+            case autobahn::message_type::YIELD:
+                // [YIELD, INVOCATION.Request|id, Options|dict, Arguments|list, ArgumentsKw|dict]
+                received->record(type, std::string(), std::string(), request.raw_field(3), request.raw_field(4));
+                break;
+            default:
+                break;
+        }
+    });
+}
+
+// Packs [EVENT, Subscription|id, Publication|id, {"topic": topic}, ...arguments].
+static msgpack::sbuffer pack_event(uint64_t publication_id, const std::string& topic,
+        const std::string& arguments, const std::string& kw_arguments,
+        uint64_t subscription_id = SUBSCRIPTION_ID)
+{
+    msgpack::sbuffer buffer;
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(6);
+    packer.pack(static_cast<int>(autobahn::message_type::EVENT));
+    packer.pack(subscription_id);
+    packer.pack(publication_id);
+    packer.pack_map(1);
+    packer.pack(std::string("topic"));
+    packer.pack(topic);
+    buffer.write(arguments.data(), arguments.size());
+    buffer.write(kw_arguments.data(), kw_arguments.size());
+    return buffer;
+}
+
+int main()
+{
+    int failures = 0;
+
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    auto edge_received = std::make_shared<received_messages>();
+    auto core_received = std::make_shared<received_messages>();
+    auto edge_router = std::make_shared<loopback_router>(io, recording_reply(edge_received));
+    auto core_router = std::make_shared<loopback_router>(io, recording_reply(core_received));
+    auto edge = std::make_shared<autobahn::wamp_session>(io);
+    auto core = std::make_shared<autobahn::wamp_session>(io);
+    edge_router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(edge));
+    core_router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(core));
+    edge->start().get();
+    core->start().get();
+    edge->join("realm1").get();
+    core->join("realm1").get();
+
+    auto bridge = std::make_shared<autobahn::wamp_bridge>(edge, core);
+    autobahn::wamp_subscribe_options prefix("prefix");
+    bridge->relay_events("com.edge.", "com.core.", prefix).get();
+    bridge->relay_calls("com.edge.echo", "com.core.echo").get();
+
+    const std::string arguments = encode(std::make_tuple(std::string("hello"), 23));
+    std::map<std::string, int> kw = { { "x", 1 } };
+    const std::string kw_arguments = encode(kw);
+
+    // EVENT on the edge -> PUBLISH on the core
+    edge_router->deliver(pack_event(1, "com.edge.tick", arguments, kw_arguments));
+    received_message published = core_received->wait_for(1)[0];
+    if (published.type != autobahn::message_type::PUBLISH || published.topic != "com.core.tick") {
+        std::cerr << "event was not published to the rewritten topic, but to " << published.topic << std::endl;
+        ++failures;
+    }
+    if (published.arguments != arguments || published.kw_arguments != kw_arguments) {
+        std::cerr << "event arguments were not relayed as received" << std::endl;
+        ++failures;
+    }
+
+    // INVOCATION on the edge -> CALL on the core -> RESULT -> YIELD on the edge
+    msgpack::sbuffer invocation;
+    msgpack::packer<msgpack::sbuffer> packer(invocation);
+    packer.pack_array(5);
+    packer.pack(static_cast<int>(autobahn::message_type::INVOCATION));
+    packer.pack(static_cast<uint64_t>(1));
+    packer.pack(REGISTRATION_ID);
+    packer.pack_map(0);
+    invocation.write(arguments.data(), arguments.size());
+    edge_router->deliver(invocation);
+
+    received_message yielded = edge_received->wait_for(1)[0];
+    if (yielded.type != autobahn::message_type::YIELD || yielded.arguments != arguments) {
+        std::cerr << "call result was not relayed as received" << std::endl;
+        ++failures;
+    }
+
+    drain(io);
+    autobahn::wamp_bridge_stats stats = bridge->stats();
+    if (stats.events != 1 || stats.calls != 1 || stats.failed_calls != 0 || stats.reencoded != 0) {
+        std::cerr << "unexpected statistics: " << stats.events << " events, " << stats.calls
+                  << " calls, " << stats.failed_calls << " failed, " << stats.reencoded << " re-encoded" << std::endl;
+        ++failures;
+    }
+
+    // A batch of large events.
+    const std::string payload = encode(std::make_tuple(std::string(EVENT_PAYLOAD, 'x')));
+    const std::string no_kw_arguments = encode(std::map<std::string, int>());
+    bridge->reset_stats();
+    for (std::size_t i = 0; i < NUM_EVENTS; ++i) {
+        edge_router->deliver(pack_event(i + 2, "com.edge.bulk", payload, no_kw_arguments));
+    }
+    core_received->wait_for(NUM_EVENTS + 1);
+
+    drain(io);
+    stats = bridge->stats();
+    std::cout << "relayed " << stats.events << " events of " << EVENT_PAYLOAD / 1024 << " kB: "
+              << stats.events_per_second() << " events/s, "
+              << stats.bytes_per_second() / (1024 * 1024) << " MB/s, latency "
+              << std::chrono::duration<double, std::micro>(stats.mean_event_latency()).count() << " us mean, "
+              << std::chrono::duration<double, std::micro>(stats.max_event_latency).count() << " us max"
+              << std::endl;
+    if (stats.events != NUM_EVENTS || stats.reencoded != 0) {
+        std::cerr << "large events were not all relayed as received" << std::endl;
+        ++failures;
+    }
+
+    // EVENT of a wildcard subscription -> PUBLISH to the matched topic,
+    // with the payload options of the relay.
+    autobahn::wamp_subscribe_options wildcard("wildcard");
+    autobahn::wamp_publish_options payload_options;
+    payload_options.set_payload_options(autobahn::wamp_payload_options("x_custom", "protobuf"));
+    bridge->relay_events("com.edge..status", "com.core..status", wildcard, payload_options).get();
+    edge_router->deliver(pack_event(NUM_EVENTS + 2, "com.edge.hall.status", arguments, kw_arguments,
+            WILDCARD_SUBSCRIPTION_ID));
+    published = core_received->wait_for(NUM_EVENTS + 2)[NUM_EVENTS + 1];
+    if (published.topic != "com.core.hall.status") {
+        std::cerr << "a wildcard event was published to " << published.topic << std::endl;
+        ++failures;
+    }
+    if (published.scheme != "x_custom") {
+        std::cerr << "the payload options of a relay were not published" << std::endl;
+        ++failures;
+    }
+
+    try {
+        bridge->relay_events("com.edge..status", "com.core...status", wildcard);
+        std::cerr << "a relay to more wildcards than subscribed to was accepted" << std::endl;
+        ++failures;
+    } catch (const std::invalid_argument&) {
+    }
+
+    thread.stop();
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,250 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Transfers large results in chunks through a joined session over a
+// loopback transport that acts as the router: CALLs to the exporting
+// procedure come back as INVOCATIONs and YIELDs as RESULTs, passing on
+// whether progressive results were asked for and sent. Checks that chunked
+// results are reassembled and streamed unchanged, that callers that did not
+// ask for progressive results get the whole result at once unless it is too
+// large, and that a call made while chunks are sent is answered before the
+// transfer is done.
+
+#include "loopback_router.hpp"
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+
+static const uint64_t REGISTRATION_ID = 9;
+static const std::size_t LARGE_RESULT = 64 * 1024 * 1024;
+static const std::size_t CHUNK_SIZE = 64 * 1024;
+
+static void pack_flag(msgpack::packer<msgpack::sbuffer>& packer, const std::string& key, bool flag)
+{
+    packer.pack_map(flag ? 1 : 0);
+    if (flag) {
+        packer.pack(key);
+        packer.pack_true();
+    }
+}
+
+// Answers HELLO and REGISTER, echoes CALLs to com.example.ping as RESULTs,
+// turns all other CALLs into INVOCATIONs and YIELDs into RESULTs.
+static void answer(loopback_router& router, autobahn::message_type type, autobahn::wamp_message& request)
+{
+    msgpack::sbuffer reply;
+    msgpack::packer<msgpack::sbuffer> packer(reply);
+    switch (type) {
+        case autobahn::message_type::REGISTER:
+            router.acknowledge(type, request.field<uint64_t>(1), REGISTRATION_ID);
+            return;
+        case autobahn::message_type::CALL:
+            // [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list]
+            if (request.field<std::string>(3) == "com.example.ping") {
+                packer.pack_array(4);
+                packer.pack(static_cast<int>(autobahn::message_type::RESULT));
+                packer.pack(request.field<uint64_t>(1));
+                packer.pack_map(0);
+                loopback_router::write(reply, request.raw_field(4));
+            } else {
+                // The invocation takes the request id of the call.
+                bool receive_progress = autobahn::value_for_key_or<bool>(
+                        request.field(2), "receive_progress", false);
+                packer.pack_array(5);
+                packer.pack(static_cast<int>(autobahn::message_type::INVOCATION));
+                packer.pack(request.field<uint64_t>(1));
+                packer.pack(REGISTRATION_ID);
+                pack_flag(packer, "receive_progress", receive_progress);
+                loopback_router::write(reply, request.raw_field(4));
+            }
+            break;
+        case autobahn::message_type::YIELD: {
+            // [YIELD, INVOCATION.Request|id, Options|dict, Arguments|list]
+            bool progress = autobahn::value_for_key_or<bool>(request.field(2), "progress", false);
+            packer.pack_array(4);
+            packer.pack(static_cast<int>(autobahn::message_type::RESULT));
+            packer.pack(request.field<uint64_t>(1));
+            pack_flag(packer, "progress", progress);
+            loopback_router::write(reply, request.raw_field(3));
+            break;
+        }
+        case autobahn::message_type::ERROR:
+            // [ERROR, INVOCATION, INVOCATION.Request|id, Details|dict, Error|uri]
+            packer.pack_array(5);
+            packer.pack(static_cast<int>(autobahn::message_type::ERROR));
+            packer.pack(static_cast<int>(autobahn::message_type::CALL));
+            packer.pack(request.field<uint64_t>(2));
+            packer.pack_map(0);
+            packer.pack(request.field<std::string>(4));
+            break;
+        default:
+            return;
+    }
+
+    router.deliver(reply);
+}
+
+static char byte_at(std::size_t offset)
+{
+    return static_cast<char>(offset % 251);
+}
+
+static bool is_export(const std::string& bytes, std::size_t size)
+{
+    if (bytes.size() != size) {
+        return false;
+    }
+    for (std::size_t offset = 0; offset < size; ++offset) {
+        if (bytes[offset] != byte_at(offset)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    int failures = 0;
+
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    auto router = std::make_shared<loopback_router>(io, loopback_router::answering(&answer));
+    auto session = std::make_shared<autobahn::wamp_session>(io);
+    router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(session));
+    session->start().get();
+    session->join("realm1").get();
+
+    // Exports the given number of bytes in chunks of the given size, or
+    // fails half way through if asked to.
+    session->provide("com.example.export", [](const autobahn::wamp_invocation& invocation) {
+        auto size = invocation->argument<std::size_t>(0);
+        auto chunk_size = invocation->argument<std::size_t>(1);
+        bool fail = invocation->argument<bool>(2);
+        auto offset = std::make_shared<std::size_t>(0);
+        invocation->result_chunked([size, fail, offset](char* data, std::size_t capacity) {
+            if (fail && *offset >= size / 2) {
+                throw std::runtime_error("export failed");
+            }
+            std::size_t written = std::min(capacity, size - *offset);
+            for (std::size_t i = 0; i < written; ++i) {
+                data[i] = byte_at(*offset + i);
+            }
+            *offset += written;
+            return written;
+        }, chunk_size);
+    }).get();
+
+    // Reassembled
+    std::string exported = session->call_chunked("com.example.export",
+            std::make_tuple(std::size_t(1000000), std::size_t(4096), false)).get();
+    if (!is_export(exported, 1000000)) {
+        std::cerr << "chunked result was not reassembled as exported" << std::endl;
+        ++failures;
+    }
+
+    // Streamed, with a call made and answered while the chunks come in.
+    std::size_t chunks = 0;
+    std::size_t chunks_before_ping = 0;
+    boost::future<void> ping;
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration ping_latency;
+    std::uint64_t streamed = session->call_streamed("com.example.export",
+            std::make_tuple(LARGE_RESULT, CHUNK_SIZE, false), [&](const autobahn::wamp_bytes_view& chunk) {
+        if (chunk.size() > CHUNK_SIZE) {
+            std::cerr << "chunk of " << chunk.size() << " bytes is too large" << std::endl;
+            ++failures;
+        }
+        if (chunks++ == 0) {
+            auto ping_start = std::chrono::steady_clock::now();
+            ping = session->call("com.example.ping", std::make_tuple(1)).then(boost::launch::sync,
+                    [&, ping_start](boost::future<autobahn::wamp_call_result> result) {
+                result.get();
+                ping_latency = std::chrono::steady_clock::now() - ping_start;
+                chunks_before_ping = chunks;
+            });
+        }
+    }).get();
+    auto streamed_time = std::chrono::steady_clock::now() - start;
+    ping.get();
+    if (streamed != LARGE_RESULT) {
+        std::cerr << "streamed " << streamed << " bytes instead of " << LARGE_RESULT << std::endl;
+        ++failures;
+    }
+    if (chunks_before_ping >= chunks) {
+        std::cerr << "the call made during the transfer was only answered after it" << std::endl;
+        ++failures;
+    }
+
+    // Without progressive results the whole result comes at once.
+    autobahn::wamp_call_result whole = session->call("com.example.export",
+            std::make_tuple(std::size_t(100000), std::size_t(4096), false)).get();
+    autobahn::wamp_bytes_view whole_bytes = whole.argument_view<autobahn::wamp_bytes_view>(0);
+    if (!is_export(std::string(whole_bytes.data(), whole_bytes.size()), 100000)) {
+        std::cerr << "result was not sent whole to a caller without progressive results" << std::endl;
+        ++failures;
+    }
+
+    // ... unless it is too large to be sent whole.
+    try {
+        session->call("com.example.export", std::make_tuple(
+                autobahn::MAX_UNCHUNKED_RESULT_SIZE + 1, std::size_t(4096), false)).get();
+        std::cerr << "a result too large to be sent whole was sent" << std::endl;
+        ++failures;
+    } catch (const autobahn::wamp_error& e) {
+        if (std::string(e.uri()) != "wamp.error.invalid_argument") {
+            std::cerr << "a result too large to be sent whole failed with " << e.uri() << std::endl;
+            ++failures;
+        }
+    }
+
+    // A failing source ends the transfer with an error.
+    try {
+        session->call_chunked("com.example.export",
+                std::make_tuple(std::size_t(100000), std::size_t(4096), true)).get();
+        std::cerr << "a failed transfer was not reported" << std::endl;
+        ++failures;
+    } catch (const std::exception&) {
+    }
+
+    thread.stop();
+
+    std::cout << "streamed " << LARGE_RESULT / (1024 * 1024) << " MB in " << chunks << " chunks in "
+              << std::chrono::duration<double, std::milli>(streamed_time).count() << " ms, "
+              << "a call made meanwhile was answered after "
+              << std::chrono::duration<double, std::milli>(ping_latency).count() << " ms and "
+              << chunks_before_ping << " chunks" << std::endl;
+
+    return failures ? 1 : 0;
+}
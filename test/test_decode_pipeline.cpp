@@ -0,0 +1,214 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Checks that wamp_decode_pipeline passes small messages on while a large
+// one is being decoded, unless they have to stay in order with it, that a
+// large message that fails to decode is reported to the error handler and
+// drops the messages waiting behind it, and compares the time to the first
+// small message with and without the pipeline.
+
+#include <autobahn/autobahn.hpp>
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+static const std::size_t THRESHOLD = 64 * 1024;
+static const std::size_t LARGE_PAYLOAD = 16 * 1024 * 1024;
+
+// Packs [EVENT, subscription, publication, {}, [payload]].
+static std::shared_ptr<std::vector<char>> pack_event(
+        uint64_t subscription_id, uint64_t publication_id, const std::string& payload)
+{
+    msgpack::sbuffer buffer;
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(5);
+    packer.pack(static_cast<int>(autobahn::message_type::EVENT));
+    packer.pack(subscription_id);
+    packer.pack(publication_id);
+    packer.pack_map(0);
+    packer.pack(std::make_tuple(payload));
+    return std::make_shared<std::vector<char>>(buffer.data(), buffer.data() + buffer.size());
+}
+
+// Packs [SUBSCRIBED, request, subscription].
+static std::shared_ptr<std::vector<char>> pack_subscribed(uint64_t request_id, uint64_t subscription_id)
+{
+    msgpack::sbuffer buffer;
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer.pack_array(3);
+    packer.pack(static_cast<int>(autobahn::message_type::SUBSCRIBED));
+    packer.pack(request_id);
+    packer.pack(subscription_id);
+    return std::make_shared<std::vector<char>>(buffer.data(), buffer.data() + buffer.size());
+}
+
+static void push(autobahn::wamp_decode_pipeline& pipeline, const std::shared_ptr<std::vector<char>>& frame)
+{
+    if (frame->size() >= pipeline.threshold()) {
+        pipeline.push(frame);
+    } else {
+        pipeline.push(frame->data(), frame->size());
+    }
+}
+
+// A large frame that starts as an EVENT of the given subscription, so that
+// it is ordered as one, and continues with a byte msgpack never uses.
+static std::shared_ptr<std::vector<char>> pack_corrupt_event(uint64_t subscription_id)
+{
+    auto frame = std::make_shared<std::vector<char>>(THRESHOLD, static_cast<char>(0xc1));
+    (*frame)[0] = static_cast<char>(0x95);
+    (*frame)[1] = static_cast<char>(autobahn::message_type::EVENT);
+    (*frame)[2] = static_cast<char>(subscription_id);
+    return frame;
+}
+
+// The id of a received message: the publication of an EVENT, the request of anything else.
+static uint64_t id_of(autobahn::wamp_message& message)
+{
+    if (message.field<int>(0) == static_cast<int>(autobahn::message_type::EVENT)) {
+        return message.field<uint64_t>(2);
+    }
+    return message.field<uint64_t>(1);
+}
+
+int main()
+{
+    int failures = 0;
+    std::string large(LARGE_PAYLOAD, 'x');
+
+    // The decode service is only run once the small messages have been pushed.
+    boost::asio::io_service io;
+    boost::asio::io_service decoders;
+    auto pipeline = std::make_shared<autobahn::wamp_decode_pipeline>(io, decoders, THRESHOLD);
+
+    std::vector<uint64_t> received;
+    pipeline->set_message_handler([&](autobahn::wamp_message&& message) {
+        received.push_back(id_of(message));
+    });
+
+    push(*pipeline, pack_event(1, 100, large));   // large, subscription 1
+    push(*pipeline, pack_event(2, 101, "small")); // other subscription: passed on right away
+    push(*pipeline, pack_event(1, 102, "small")); // same subscription: waits for 100
+    push(*pipeline, pack_subscribed(103, 3));     // waits for everything before it
+    push(*pipeline, pack_event(2, 104, "small")); // waits for the SUBSCRIBED
+
+    if (received != std::vector<uint64_t>{101}) {
+        std::cerr << "only the event of the other subscription should have been passed on" << std::endl;
+        ++failures;
+    }
+
+    decoders.run();
+    io.run();
+
+    if (received != std::vector<uint64_t>{101, 100, 102, 103, 104}) {
+        std::cerr << "messages were passed on out of order:";
+        for (uint64_t id : received) {
+            std::cerr << " " << id;
+        }
+        std::cerr << std::endl;
+        ++failures;
+    }
+    if (pipeline->pending() != 0) {
+        std::cerr << "messages were left in the pipeline" << std::endl;
+        ++failures;
+    }
+
+    // A large message that fails to decode.
+    std::vector<uint64_t> received_around_error;
+    pipeline->set_message_handler([&](autobahn::wamp_message&& message) {
+        received_around_error.push_back(id_of(message));
+    });
+    std::size_t errors = 0;
+    pipeline->set_error_handler([&](std::exception_ptr) { ++errors; });
+
+    push(*pipeline, pack_corrupt_event(1));       // large, subscription 1, fails
+    push(*pipeline, pack_event(2, 301, "small")); // other subscription: passed on right away
+    push(*pipeline, pack_event(1, 302, "small")); // same subscription: dropped with it
+    push(*pipeline, pack_subscribed(303, 3));     // waits for everything before it: dropped
+
+    try {
+        decoders.restart();
+        decoders.run();
+        io.restart();
+        io.run();
+    } catch (const std::exception& e) {
+        std::cerr << "a decode error escaped the io service: " << e.what() << std::endl;
+        ++failures;
+    }
+    if (errors != 1 || received_around_error != std::vector<uint64_t>{301} || pipeline->pending() != 0) {
+        std::cerr << "a failed decode was reported " << errors << " times and left "
+                  << pipeline->pending() << " messages in the pipeline" << std::endl;
+        ++failures;
+    }
+
+    push(*pipeline, pack_event(2, 304, "small"));
+    if (received_around_error != std::vector<uint64_t>{301, 304}) {
+        std::cerr << "the pipeline did not pass messages on after a failed decode" << std::endl;
+        ++failures;
+    }
+
+    // Time until a small message behind a large one of another subscription is
+    // passed on, decoding inline versus with the pipeline.
+    auto large_frame = pack_event(1, 200, large);
+    auto small_frame = pack_event(2, 201, "small");
+
+    auto start = std::chrono::steady_clock::now();
+    autobahn::wamp_decode_pipeline::decode(large_frame->data(), large_frame->size(), nullptr);
+    autobahn::wamp_decode_pipeline::decode(small_frame->data(), small_frame->size(), nullptr);
+    double inline_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+    double pipelined_ms = 0;
+    pipeline->set_message_handler([&](autobahn::wamp_message&& message) {
+        if (id_of(message) == 201) {
+            pipelined_ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+        }
+    });
+    start = std::chrono::steady_clock::now();
+    pipeline->push(large_frame);
+    pipeline->push(small_frame->data(), small_frame->size());
+    decoders.restart();
+    decoders.run();
+    io.restart();
+    io.run();
+
+    std::cout << "small message behind a " << LARGE_PAYLOAD / (1024 * 1024) << " MB one: "
+              << inline_ms << " ms decoding inline, " << pipelined_ms << " ms with the pipeline"
+              << std::endl;
+
+    return failures;
+}
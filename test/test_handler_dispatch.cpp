@@ -0,0 +1,166 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Compares storing and calling event handlers that capture some state as
+// std::function with storing and calling them as wamp_event_handler, which
+// keeps such handlers in place. Storing and copying a wamp_event_handler
+// that fits its buffer must not allocate, and an empty std::function must
+// convert to an empty wamp_event_handler.
+
+#include <autobahn/autobahn.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+
+static std::atomic<std::size_t> allocations(0);
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+static const std::size_t NUM_HANDLERS = 1000;
+static const std::size_t NUM_ROUNDS = 1000;
+
+// The state a typical subscriber captures: a shared object, a couple of
+// pointers and a key, 40 bytes on 64 bit platforms.
+struct subscriber_state
+{
+    std::shared_ptr<std::atomic<std::size_t>> counter;
+    const std::size_t* weights;
+    std::size_t* total;
+    std::size_t key;
+};
+
+static subscriber_state make_state(std::size_t* total, const std::size_t* weights, std::size_t key)
+{
+    return subscriber_state{std::make_shared<std::atomic<std::size_t>>(0), weights, total, key};
+}
+
+template <typename Handler>
+static double dispatch(const std::vector<Handler>& handlers, const autobahn::wamp_event& event)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round < NUM_ROUNDS; ++round) {
+        for (const auto& handler : handlers) {
+            handler(event);
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() / (NUM_ROUNDS * NUM_HANDLERS);
+}
+
+template <typename Handler>
+static std::size_t store(std::vector<Handler>& handlers, std::size_t* total, const std::size_t* weights)
+{
+    std::vector<subscriber_state> states;
+    for (std::size_t i = 0; i < NUM_HANDLERS; ++i) {
+        states.push_back(make_state(total, weights, i % 16));
+    }
+    handlers.reserve(NUM_HANDLERS);
+    std::vector<Handler> copies;
+    copies.reserve(NUM_HANDLERS);
+
+    std::size_t before = allocations;
+    for (const auto& state : states) {
+        handlers.push_back([state](const autobahn::wamp_event&) {
+            ++*state.counter;
+            *state.total += state.weights[state.key];
+        });
+    }
+
+    // Handlers are copied, e.g. from the subscribe request into the session.
+    copies.insert(copies.end(), handlers.begin(), handlers.end());
+
+    return allocations - before;
+}
+
+int main()
+{
+    std::size_t weights[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+    std::size_t total = 0;
+    autobahn::wamp_event event((msgpack::zone()));
+
+    std::vector<std::function<void(const autobahn::wamp_event&)>> functions;
+    std::size_t function_allocations = store(functions, &total, weights);
+
+    std::vector<autobahn::wamp_event_handler> handlers;
+    std::size_t handler_allocations = store(handlers, &total, weights);
+
+    double function_ns = dispatch(functions, event);
+    double handler_ns = dispatch(handlers, event);
+
+    std::cout << "std::function:      " << function_allocations << " allocations storing "
+              << NUM_HANDLERS << " handlers, " << function_ns << " ns per call" << std::endl;
+    std::cout << "wamp_event_handler: " << handler_allocations << " allocations storing "
+              << NUM_HANDLERS << " handlers, " << handler_ns << " ns per call" << std::endl;
+
+    int failures = 0;
+    if (!handlers.front().stored_inline() || handler_allocations != 0) {
+        std::cerr << "wamp_event_handler allocated for a handler that fits its buffer" << std::endl;
+        ++failures;
+    }
+
+    std::function<void(const autobahn::wamp_event&)> empty_function;
+    autobahn::wamp_event_handler empty_handler(empty_function);
+    if (empty_handler) {
+        std::cerr << "an empty std::function converted to a non-empty wamp_event_handler" << std::endl;
+        ++failures;
+    }
+
+    // Every handler of both kinds adds its weight once per round.
+    std::size_t expected_total = 0;
+    for (std::size_t i = 0; i < NUM_HANDLERS; ++i) {
+        expected_total += weights[i % 16];
+    }
+    if (total != 2 * NUM_ROUNDS * expected_total) {
+        std::cerr << "handlers were not called as often as expected" << std::endl;
+        ++failures;
+    }
+
+    return failures;
+}
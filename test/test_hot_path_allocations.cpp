@@ -0,0 +1,333 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Counts heap allocations made through a replaced global operator new on
+// the hot paths of a joined session, over a loopback transport that acts
+// as the router:
+//
+//  - dispatching EVENTs to a subscribed handler must not allocate at all,
+//    even if the handler captures more than the 64 bytes kept in place,
+//  - handing INVOCATIONs to a provided procedure that yields its result on
+//    the io thread must not allocate once the session has warmed up,
+//  - dispatching RESULTs to pending calls must not allocate at all,
+//  - prepared publications and calls must reuse their buffers and must stay
+//    within a fixed number of allocations per request once the session has
+//    warmed up, whatever the length of their URI.
+//
+// Futures allocate their shared state, so calls and publications are not
+// allocation free; the budgets below list what they may allocate.
+
+#include "loopback_router.hpp"
+
+#include <array>
+#include <atomic>
+#include <boost/asio.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <tuple>
+#include <vector>
+
+static std::atomic<std::size_t> allocations(0);
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+static const std::size_t NUM_REQUESTS = 10000;
+static const uint64_t SUBSCRIPTION_ID = 7;
+static const uint64_t REGISTRATION_ID = 9;
+
+// A prepared publication allocates its message, its promise and the shared
+// state of the promise.
+static const std::size_t PUBLISH_BUDGET = 3;
+
+// A prepared call allocates its message, its call, the shared state of the
+// call's promise and its entry among the pending calls. The loopback router
+// adds the handler it posts the RESULT with and the fields of the RESULT.
+static const std::size_t CALL_BUDGET = 6;
+
+int main()
+{
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    // Answers the way a router would, reading the message type and request
+    // id from the serialized message so as not to allocate on behalf of the
+    // session. CALLs are only answered while answer_calls is set, their
+    // request ids are recorded in unanswered otherwise.
+    bool answer_calls = true;
+    std::vector<uint64_t> unanswered;
+    unanswered.reserve(NUM_REQUESTS);
+    auto router = std::make_shared<loopback_router>(io,
+            [&](loopback_router& router, autobahn::wamp_message&& message) {
+        auto type = loopback_router::peek_type(message);
+        switch (type) {
+            case autobahn::message_type::HELLO:
+                router.welcome();
+                break;
+            case autobahn::message_type::SUBSCRIBE:
+                router.acknowledge(type, loopback_router::peek_request_id(message), SUBSCRIPTION_ID);
+                break;
+            case autobahn::message_type::REGISTER:
+                router.acknowledge(type, loopback_router::peek_request_id(message), REGISTRATION_ID);
+                break;
+            case autobahn::message_type::CALL: {
+                uint64_t request_id = loopback_router::peek_request_id(message);
+                if (!answer_calls) {
+                    unanswered.push_back(request_id);
+                    break;
+                }
+                router.deliver_made([request_id]() {
+                    autobahn::wamp_message result(4);
+                    result.set_field(0, static_cast<int>(autobahn::message_type::RESULT));
+                    result.set_field(1, request_id);
+                    result.set_field(2, std::map<std::string, int>());
+                    result.set_field(3, std::make_tuple(1));
+                    return result;
+                });
+                break;
+            }
+            default:
+                break;
+        }
+    });
+    auto session = std::make_shared<autobahn::wamp_session>(io);
+    router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(session));
+    session->start().get();
+    session->join("realm1").get();
+
+    int failures = 0;
+
+    // EVENT dispatch, to a handler too large to be stored in place.
+    std::size_t events_received = 0;
+    std::array<uint64_t, 12> ballast{};
+    session->subscribe("com.example.tick", [&events_received, ballast](const autobahn::wamp_event& event) {
+        events_received += 1 + ballast[0];
+    }).get();
+
+    std::vector<autobahn::wamp_message> events;
+    events.reserve(NUM_REQUESTS);
+    for (std::size_t i = 0; i < NUM_REQUESTS; ++i) {
+        events.emplace_back(5);
+        events.back().set_field(0, static_cast<int>(autobahn::message_type::EVENT));
+        events.back().set_field(1, SUBSCRIPTION_ID);
+        events.back().set_field(2, static_cast<uint64_t>(i + 1));
+        events.back().set_field(3, std::map<std::string, int>());
+        events.back().set_field(4, std::make_tuple(i));
+    }
+
+    std::size_t event_allocations = 0;
+    run_on_io(io, [&]() {
+        std::size_t before = allocations;
+        for (auto& event : events) {
+            router->handler()->on_message(std::move(event));
+        }
+        event_allocations = allocations - before;
+    });
+    std::cout << "EVENT dispatch:    " << events_received << " events, "
+              << event_allocations << " allocations" << std::endl;
+    if (events_received != NUM_REQUESTS || event_allocations != 0) {
+        std::cerr << "EVENT dispatch allocated" << std::endl;
+        ++failures;
+    }
+
+    // INVOCATIONs of a provided procedure, yielding on the io thread.
+    std::size_t invocations_received = 0;
+    session->provide("com.example.echo", [&](autobahn::wamp_invocation invocation) {
+        ++invocations_received;
+        invocation->result(std::make_tuple(invocation->argument<uint64_t>(0)));
+    }).get();
+
+    std::size_t invocation_allocations[2];
+    std::size_t invocation_objects[2];
+    for (int batch = 0; batch < 2; ++batch) {
+        std::vector<autobahn::wamp_message> invocations;
+        invocations.reserve(NUM_REQUESTS);
+        for (std::size_t i = 0; i < NUM_REQUESTS; ++i) {
+            invocations.emplace_back(5);
+            invocations.back().set_field(0, static_cast<int>(autobahn::message_type::INVOCATION));
+            invocations.back().set_field(1, static_cast<uint64_t>(i + 1));
+            invocations.back().set_field(2, REGISTRATION_ID);
+            invocations.back().set_field(3, std::map<std::string, int>());
+            invocations.back().set_field(4, std::make_tuple(i));
+        }
+
+        run_on_io(io, [&]() {
+            std::size_t before = allocations;
+            std::size_t objects_before = session->invocation_pool().created();
+            for (auto& invocation : invocations) {
+                router->handler()->on_message(std::move(invocation));
+            }
+            invocation_allocations[batch] = allocations - before;
+            invocation_objects[batch] = session->invocation_pool().created() - objects_before;
+        });
+    }
+    std::cout << "INVOCATION/YIELD:  " << invocations_received << " invocations, "
+              << invocation_allocations[1] << " allocations, "
+              << invocation_objects[1] << " new invocations" << std::endl;
+    if (invocations_received != 2 * NUM_REQUESTS || invocation_allocations[1] != 0
+            || invocation_objects[1] != 0) {
+        std::cerr << "INVOCATION dispatch allocated once warmed up" << std::endl;
+        ++failures;
+    }
+
+    // Prepared publications, made on the io thread.
+    auto publication = session->prepare_publish("com.example.tick");
+    std::size_t publish_allocations[2];
+    std::size_t publish_buffers[2];
+    for (int batch = 0; batch < 2; ++batch) {
+        run_on_io(io, [&]() {
+            std::size_t before = allocations;
+            std::size_t buffers_before = session->buffer_pool().created();
+            for (std::size_t i = 0; i < NUM_REQUESTS; ++i) {
+                session->publish(publication, std::make_tuple(i));
+            }
+            publish_allocations[batch] = allocations - before;
+            publish_buffers[batch] = session->buffer_pool().created() - buffers_before;
+        });
+    }
+    std::cout << "prepared publish:  " << double(publish_allocations[1]) / NUM_REQUESTS
+              << " allocations per request, " << publish_buffers[1] << " new buffers" << std::endl;
+    if (publish_allocations[1] > PUBLISH_BUDGET * NUM_REQUESTS || publish_buffers[1] != 0) {
+        std::cerr << "prepared publications exceed their budget of " << PUBLISH_BUDGET
+                  << " allocations" << std::endl;
+        ++failures;
+    }
+
+    // Prepared calls and their RESULTs.
+    auto call = session->prepare_call("com.example.price");
+    std::size_t call_allocations[2];
+    std::size_t call_buffers[2];
+    for (int batch = 0; batch < 2; ++batch) {
+        std::size_t before = allocations;
+        std::size_t buffers_before = session->buffer_pool().created();
+        boost::future<autobahn::wamp_call_result> last;
+        run_on_io(io, [&]() {
+            for (std::size_t i = 0; i < NUM_REQUESTS; ++i) {
+                last = session->call(call, std::make_tuple(i));
+            }
+        });
+        last.get();
+        call_allocations[batch] = allocations - before;
+        call_buffers[batch] = session->buffer_pool().created() - buffers_before;
+    }
+    std::cout << "prepared call:     " << double(call_allocations[1]) / NUM_REQUESTS
+              << " allocations per request, " << call_buffers[1] << " new buffers" << std::endl;
+    if (call_allocations[1] > CALL_BUDGET * NUM_REQUESTS || call_buffers[1] != 0) {
+        std::cerr << "prepared calls exceed their budget of " << CALL_BUDGET
+                  << " allocations" << std::endl;
+        ++failures;
+    }
+
+    // The same with a URI that does not fit in the inline buffer of a
+    // std::string, which would allocate if copied.
+    auto long_call = session->prepare_call(
+            "com.example.pricing.instruments.derivatives.options.european.black_scholes.price");
+    std::size_t long_call_allocations = 0;
+    {
+        std::size_t before = allocations;
+        boost::future<autobahn::wamp_call_result> last;
+        run_on_io(io, [&]() {
+            for (std::size_t i = 0; i < NUM_REQUESTS; ++i) {
+                last = session->call(long_call, std::make_tuple(i));
+            }
+        });
+        last.get();
+        long_call_allocations = allocations - before;
+    }
+    std::cout << "prepared long URI: " << double(long_call_allocations) / NUM_REQUESTS
+              << " allocations per request" << std::endl;
+    if (long_call_allocations > CALL_BUDGET * NUM_REQUESTS) {
+        std::cerr << "prepared calls with a long URI exceed their budget of " << CALL_BUDGET
+                  << " allocations" << std::endl;
+        ++failures;
+    }
+
+    // RESULT dispatch, to calls left pending by the router.
+    std::vector<boost::future<autobahn::wamp_call_result>> pending;
+    pending.reserve(NUM_REQUESTS);
+    run_on_io(io, [&]() {
+        answer_calls = false;
+        for (std::size_t i = 0; i < NUM_REQUESTS; ++i) {
+            pending.push_back(session->call(call, std::make_tuple(i)));
+        }
+    });
+
+    std::vector<autobahn::wamp_message> results;
+    results.reserve(NUM_REQUESTS);
+    for (uint64_t request_id : unanswered) {
+        results.emplace_back(4);
+        results.back().set_field(0, static_cast<int>(autobahn::message_type::RESULT));
+        results.back().set_field(1, request_id);
+        results.back().set_field(2, std::map<std::string, int>());
+        results.back().set_field(3, std::make_tuple(1));
+    }
+
+    std::size_t result_allocations = 0;
+    run_on_io(io, [&]() {
+        std::size_t before = allocations;
+        for (auto& result : results) {
+            router->handler()->on_message(std::move(result));
+        }
+        result_allocations = allocations - before;
+    });
+    std::size_t results_received = 0;
+    for (auto& result : pending) {
+        if (result.is_ready()) {
+            ++results_received;
+        }
+    }
+    std::cout << "RESULT dispatch:   " << results_received << " results, "
+              << result_allocations << " allocations" << std::endl;
+    if (unanswered.size() != NUM_REQUESTS || results_received != NUM_REQUESTS
+            || result_allocations != 0) {
+        std::cerr << "RESULT dispatch allocated" << std::endl;
+        ++failures;
+    }
+
+    thread.stop();
+
+    return failures ? 1 : 0;
+}
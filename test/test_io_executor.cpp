@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Counts the threads running continuations attached to futures, once with
+// boost's default launch policy and once with futures bound to a
+// wamp_io_executor as returned by wamp_session.
+
+#include <autobahn/wamp_io_executor.hpp>
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static const int NUM_FUTURES = 2000;
+
+static thread_local bool counted = false;
+static std::atomic<int> continuation_threads(0);
+static std::atomic<int> on_io_thread(0);
+static std::thread::id io_thread_id;
+
+static void count_thread()
+{
+    if (!counted) {
+        counted = true;
+        ++continuation_threads;
+    }
+    if (std::this_thread::get_id() == io_thread_id) {
+        ++on_io_thread;
+    }
+}
+
+template <typename Bind>
+static double run(boost::asio::io_service& io, Bind bind)
+{
+    continuation_threads = 0;
+    on_io_thread = 0;
+
+    std::vector<std::shared_ptr<boost::promise<int>>> promises;
+    std::vector<boost::future<void>> continuations;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < NUM_FUTURES; ++i) {
+        auto promise = std::make_shared<boost::promise<int>>();
+        promises.push_back(promise);
+        continuations.push_back(bind(*promise).then([](boost::future<int> f) {
+            f.get();
+            count_thread();
+        }));
+    }
+
+    // Satisfy the promises from the io thread, just like wamp_session does.
+    for (auto& promise : promises) {
+        io.post([promise]() { promise->set_value(1); });
+    }
+
+    for (auto& continuation : continuations) {
+        continuation.get();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+int main()
+{
+    boost::asio::io_service io;
+    std::unique_ptr<boost::asio::io_service::work> work(new boost::asio::io_service::work(io));
+    std::thread io_thread([&io]() { io.run(); });
+    io_thread_id = io_thread.get_id();
+
+    auto executor = boost::make_shared<autobahn::wamp_io_executor>(io);
+
+    double ms = run(io, [](boost::promise<int>& promise) { return promise.get_future(); });
+    std::cout << "default policy:   " << NUM_FUTURES << " continuations, "
+              << continuation_threads << " threads, " << ms << " ms" << std::endl;
+
+    ms = run(io, [&executor](boost::promise<int>& promise) {
+        return autobahn::bind_executor(executor, promise);
+    });
+    int threads = continuation_threads;
+    int inline_on_io = on_io_thread;
+    std::cout << "wamp_io_executor: " << NUM_FUTURES << " continuations, "
+              << threads << " threads, " << ms << " ms" << std::endl;
+
+    work.reset();
+    io_thread.join();
+
+    if (threads != 1 || inline_on_io != NUM_FUTURES) {
+        std::cerr << "continuations did not run on the io thread" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Compares keyword argument look-ups by linear scan (wamp_map_view::find)
+// with look-ups through the lazily built wamp_map_index, across map sizes.
+// A handler reads NUM_LOOKUPS keys from each map, as a config-sync event
+// handler would.
+
+#include <autobahn/wamp_event.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <msgpack.hpp>
+#include <string>
+#include <vector>
+
+static const int NUM_LOOKUPS = 20;
+static const int NUM_ROUNDS = 2000;
+
+static std::string key_name(std::size_t i)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "config.setting.%zu", i);
+    return name;
+}
+
+template <typename Lookup>
+static double run(const std::vector<std::string>& keys, Lookup lookup, std::size_t& found)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < NUM_ROUNDS; ++round) {
+        found += lookup(round, keys);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::micro>(elapsed).count() / NUM_ROUNDS;
+}
+
+int main()
+{
+    int result = 0;
+
+    for (std::size_t size : { 4, 16, 64, 200, 1000 }) {
+        msgpack::zone zone;
+        std::map<std::string, uint64_t> kw_arguments;
+        for (std::size_t i = 0; i < size; ++i) {
+            kw_arguments[key_name(i)] = i;
+        }
+        msgpack::object kw_object(kw_arguments, zone);
+
+        // Spread the looked up keys over the whole map.
+        std::vector<std::string> keys;
+        for (int i = 0; i < NUM_LOOKUPS; ++i) {
+            keys.push_back(key_name((i * 7919) % size));
+        }
+
+        std::size_t linear_found = 0;
+        double linear_us = run(keys, [&](int, const std::vector<std::string>& keys) {
+            autobahn::wamp_map_view view(kw_object.via.map);
+            std::size_t found = 0;
+            for (const auto& key : keys) {
+                found += view.find(key) != nullptr;
+            }
+            return found;
+        }, linear_found);
+
+        // A fresh event per round, so that building the index is included.
+        std::size_t indexed_found = 0;
+        double indexed_us = run(keys, [&](int, const std::vector<std::string>& keys) {
+            autobahn::wamp_event event{msgpack::zone()};
+            event.set_kw_arguments(kw_object);
+            std::size_t found = 0;
+            for (const auto& key : keys) {
+                found += event.kw_argument<uint64_t>(key) < size;
+            }
+            return found;
+        }, indexed_found);
+
+        std::cout << size << " keys, " << NUM_LOOKUPS << " look-ups: linear "
+                  << linear_us << " us, event.kw_argument " << indexed_us << " us" << std::endl;
+
+        if (linear_found != indexed_found) {
+            std::cerr << "look-ups disagree for " << size << " keys" << std::endl;
+            result = 1;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,161 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Calls procedures provided by another session of the process through a
+// shared wamp_local_procedures registry, over loopback routers that count
+// the CALLs reaching them. Checks that such calls are answered without the
+// router, that a registration the callee no longer holds fails the call
+// with wamp.error.no_such_procedure, and that a reply to a caller that has
+// gone away is dropped.
+
+#include "loopback_router.hpp"
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+
+static std::atomic<unsigned> calls(0);
+
+// Answers HELLO and REGISTER and counts CALLs, which it leaves unanswered.
+static void answer(loopback_router& router, autobahn::message_type type, autobahn::wamp_message& request)
+{
+    switch (type) {
+        case autobahn::message_type::REGISTER:
+            router.acknowledge(type, request.field<uint64_t>(1), request.field<uint64_t>(1));
+            break;
+        case autobahn::message_type::CALL:
+            ++calls;
+            break;
+        default:
+            break;
+    }
+}
+
+static std::shared_ptr<autobahn::wamp_session> join(boost::asio::io_service& io,
+        const std::shared_ptr<loopback_router>& router,
+        const std::shared_ptr<autobahn::wamp_local_procedures>& procedures)
+{
+    auto session = std::make_shared<autobahn::wamp_session>(io);
+    session->set_local_procedures(procedures);
+    router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(session));
+    session->start().get();
+    session->join("realm1").get();
+    return session;
+}
+
+// The error URI a call failed with, or an empty string if it succeeded.
+static std::string error_of(boost::future<autobahn::wamp_call_result>&& result)
+{
+    try {
+        result.get();
+        return std::string();
+    } catch (const autobahn::wamp_error& e) {
+        return e.uri();
+    } catch (const std::exception& e) {
+        return e.what();
+    }
+}
+
+int main()
+{
+    int failures = 0;
+
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    auto procedures = std::make_shared<autobahn::wamp_local_procedures>();
+    auto callee_router = std::make_shared<loopback_router>(io, loopback_router::answering(&answer));
+    auto callee = join(io, callee_router, procedures);
+    auto caller_router = std::make_shared<loopback_router>(io, loopback_router::answering(&answer));
+    auto caller = join(io, caller_router, procedures);
+
+    callee->provide("com.example.add2", [](autobahn::wamp_invocation invocation) {
+        invocation->result(std::make_tuple(
+                invocation->argument<uint64_t>(0) + invocation->argument<uint64_t>(1)));
+    }).get();
+
+    auto result = caller->call("com.example.add2", std::make_tuple(23, 777)).get();
+    if (result.argument<uint64_t>(0) != 800) {
+        std::cerr << "the local call returned the wrong result" << std::endl;
+        ++failures;
+    }
+    if (calls != 0) {
+        std::cerr << "the local call went through the router" << std::endl;
+        ++failures;
+    }
+
+    // The registry names a registration the callee does not hold.
+    procedures->add("com.example.gone", callee, 424242);
+    std::string error = error_of(caller->call("com.example.gone", std::make_tuple(1)));
+    if (error != "wamp.error.no_such_procedure") {
+        std::cerr << "a call to a stale registration failed with '" << error << "'" << std::endl;
+        ++failures;
+    }
+
+    // The callee replies once the caller is gone.
+    boost::promise<autobahn::wamp_invocation> invoked;
+    callee->provide("com.example.later", [&invoked](autobahn::wamp_invocation invocation) {
+        invoked.set_value(invocation);
+    }).get();
+
+    auto pending = caller->call("com.example.later", std::make_tuple(1));
+    autobahn::wamp_invocation invocation = invoked.get_future().get();
+
+    std::weak_ptr<autobahn::wamp_session> weak_caller = caller;
+    caller_router->detach();
+    caller.reset();
+    drain(io);
+    if (!weak_caller.expired()) {
+        std::cerr << "the caller outlived its last reference" << std::endl;
+        ++failures;
+    }
+
+    invocation->result(std::make_tuple(1));
+    invocation.reset();
+
+    // The callee still answers calls afterwards.
+    auto other_router = std::make_shared<loopback_router>(io, loopback_router::answering(&answer));
+    auto other = join(io, other_router, procedures);
+    if (other->call("com.example.add2", std::make_tuple(1, 2)).get().argument<uint64_t>(0) != 3) {
+        std::cerr << "the callee stopped answering after a reply was dropped" << std::endl;
+        ++failures;
+    }
+    if (error_of(std::move(pending)).empty()) {
+        std::cerr << "the call of a destroyed caller succeeded" << std::endl;
+        ++failures;
+    }
+
+    thread.stop();
+
+    return failures ? 1 : 0;
+}
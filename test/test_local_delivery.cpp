@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Publishes to topics the publishing session subscribes to itself, with
+// local delivery turned on, over a loopback router that counts the
+// PUBLISHes reaching it and never sends an EVENT. Checks that matching
+// handlers receive the arguments of the publication directly, that the
+// router still receives every publication, and that publications which
+// the router delivers back, as they do not exclude the publisher, and
+// publications with local delivery turned off are not delivered locally.
+
+#include "loopback_router.hpp"
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+
+static std::atomic<unsigned> publishes(0);
+
+// Answers HELLO and SUBSCRIBE and counts PUBLISHes.
+static void answer(loopback_router& router, autobahn::message_type type, autobahn::wamp_message& request)
+{
+    switch (type) {
+        case autobahn::message_type::SUBSCRIBE:
+            router.acknowledge(type, request.field<uint64_t>(1), request.field<uint64_t>(1));
+            break;
+        case autobahn::message_type::PUBLISH:
+            ++publishes;
+            break;
+        default:
+            break;
+    }
+}
+
+int main()
+{
+    int failures = 0;
+
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    auto router = std::make_shared<loopback_router>(io, loopback_router::answering(&answer));
+    auto session = std::make_shared<autobahn::wamp_session>(io);
+    router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(session));
+    session->start().get();
+    session->join("realm1").get();
+    session->set_local_delivery(true);
+
+    // Written on the io thread, read once it is drained.
+    unsigned exact = 0;
+    unsigned prefix = 0;
+    unsigned other = 0;
+    std::string text;
+    unsigned count = 0;
+
+    autobahn::wamp_subscribe_options prefix_match;
+    prefix_match.set_match("prefix");
+    session->subscribe("com.example.local", [&](const autobahn::wamp_event& event) {
+        ++exact;
+        text = event.argument<std::string>(0);
+        if (event.number_of_kw_arguments()) {
+            count = event.kw_argument<unsigned>("count");
+        }
+    }).get();
+    session->subscribe("com.example.", [&](const autobahn::wamp_event&) { ++prefix; }, prefix_match).get();
+    session->subscribe("com.example.other", [&](const autobahn::wamp_event&) { ++other; }).get();
+
+    session->publish("com.example.local", std::make_tuple(std::string("hello")));
+    drain(io);
+    if (exact != 1 || prefix != 1 || other != 0 || text != "hello") {
+        std::cerr << "the publication reached the handlers " << exact << ", " << prefix
+                << " and " << other << " times" << std::endl;
+        ++failures;
+    }
+
+    std::map<std::string, unsigned> kw_arguments;
+    kw_arguments["count"] = 3;
+    session->publish("com.example.local", std::make_tuple(std::string("again")), kw_arguments);
+    drain(io);
+    if (exact != 2 || text != "again" || count != 3) {
+        std::cerr << "the keyword arguments of the publication were not delivered" << std::endl;
+        ++failures;
+    }
+
+    // The router delivers this one back to us.
+    autobahn::wamp_publish_options include_me;
+    include_me.set_exclude_me(false);
+    session->publish("com.example.local", std::make_tuple(std::string("echo")), include_me).get();
+    drain(io);
+    if (exact != 2 || prefix != 2) {
+        std::cerr << "a publication not excluding the publisher was delivered locally" << std::endl;
+        ++failures;
+    }
+
+    session->set_local_delivery(false);
+    session->publish("com.example.local", std::make_tuple(std::string("remote")));
+    drain(io);
+    if (exact != 2) {
+        std::cerr << "a publication was delivered locally with local delivery off" << std::endl;
+        ++failures;
+    }
+
+    if (publishes != 4) {
+        std::cerr << "the router received " << publishes << " of 4 publications" << std::endl;
+        ++failures;
+    }
+
+    thread.stop();
+
+    return failures ? 1 : 0;
+}
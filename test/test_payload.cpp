@@ -0,0 +1,262 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Sends opaque payloads through a joined session over a loopback transport
+// that acts as the router: PUBLISHes come back as EVENTs and CALLs as
+// RESULTs, with their options passed on as details, and INVOCATIONs are
+// injected to be answered with YIELDs. Checks that the payload travels as a
+// single binary tagged with its ppt_* options and comes out unchanged, then
+// times taking a large payload out of a message against converting it.
+
+#include "loopback_router.hpp"
+
+#include <algorithm>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+
+static const uint64_t SUBSCRIPTION_ID = 7;
+static const uint64_t REGISTRATION_ID = 9;
+static const std::size_t LARGE_PAYLOAD = 16 * 1024 * 1024;
+static const int ROUNDS = 10;
+
+static std::string bytes_of(const autobahn::wamp_bytes_view& view)
+{
+    return std::string(view.data(), view.size());
+}
+
+static autobahn::wamp_bytes_view view_of(const std::string& bytes)
+{
+    return autobahn::wamp_bytes_view(bytes.data(), bytes.size());
+}
+
+// Answers HELLO, SUBSCRIBE and REGISTER, echoes PUBLISH as EVENT and CALL as
+// RESULT, and hands every YIELD to the yield promise.
+static loopback_router::reply_function echo_reply(
+        const std::shared_ptr<boost::promise<std::tuple<std::string, std::string>>>& yield)
+{
+    return loopback_router::answering([yield](loopback_router& router,
+            autobahn::message_type type, autobahn::wamp_message& request) {
+        msgpack::sbuffer reply;
+        msgpack::packer<msgpack::sbuffer> packer(reply);
+        switch (type) {
+            case autobahn::message_type::SUBSCRIBE:
+                router.acknowledge(type, request.field<uint64_t>(1), SUBSCRIPTION_ID);
+                return;
+            case autobahn::message_type::REGISTER:
+                router.acknowledge(type, request.field<uint64_t>(1), REGISTRATION_ID);
+                return;
+            case autobahn::message_type::PUBLISH:
+                // [PUBLISH, Request|id, Options|dict, Topic|uri, Arguments|list]
+                packer.pack_array(5);
+                packer.pack(static_cast<int>(autobahn::message_type::EVENT));
+                packer.pack(SUBSCRIPTION_ID);
+                packer.pack(request.field<uint64_t>(1));
+                loopback_router::write(reply, request.raw_field(2));
+                loopback_router::write(reply, request.raw_field(4));
+                break;
+            case autobahn::message_type::CALL:
+                // [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list]
+                packer.pack_array(4);
+                packer.pack(static_cast<int>(autobahn::message_type::RESULT));
+                packer.pack(request.field<uint64_t>(1));
+                loopback_router::write(reply, request.raw_field(2));
+                loopback_router::write(reply, request.raw_field(4));
+                break;
+            case autobahn::message_type::YIELD:
+                // [YIELD, INVOCATION.Request|id, Options|dict, Arguments|list]
+                yield->set_value(std::make_tuple(
+                        request.field<autobahn::wamp_kw_arguments>(2).at("ppt_scheme").as<std::string>(),
+                        bytes_of(autobahn::payload_argument(request.field(3)))));
+                return;
+            default:
+                return;
+        }
+
+        router.deliver(reply);
+    });
+}
+
+// [EVENT, SUBSCRIBED.Subscription|id, PUBLISHED.Publication|id, Details|dict, PUBLISH.Arguments|list]
+// carrying the payload as a binary, or as a string for comparison.
+static msgpack::sbuffer event_frame(const std::string& payload, bool opaque)
+{
+    msgpack::sbuffer frame;
+    msgpack::packer<msgpack::sbuffer> packer(frame);
+    packer.pack_array(5);
+    packer.pack(static_cast<int>(autobahn::message_type::EVENT));
+    packer.pack(SUBSCRIPTION_ID);
+    packer.pack(static_cast<uint64_t>(1));
+    if (opaque) {
+        packer.pack_map(autobahn::wamp_payload_options("x_test").size());
+        autobahn::wamp_payload_options("x_test").pack_entries(packer);
+        autobahn::pack_payload_argument(frame, view_of(payload));
+    } else {
+        packer.pack_map(0);
+        packer.pack(std::make_tuple(payload));
+    }
+    return frame;
+}
+
+int main()
+{
+    int failures = 0;
+
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    auto yield_promise = std::make_shared<boost::promise<std::tuple<std::string, std::string>>>();
+    auto router = std::make_shared<loopback_router>(io, echo_reply(yield_promise));
+    auto session = std::make_shared<autobahn::wamp_session>(io);
+    router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(session));
+    session->start().get();
+    session->join("realm1").get();
+
+    const std::string payload("\x08\x96\x01\x12\x07testing", 12);
+    autobahn::wamp_payload_options payload_options("x_test", "protobuf");
+    payload_options.set_keyid("key-1");
+
+    // PUBLISH -> EVENT
+    boost::promise<std::string> event_payload;
+    session->subscribe("com.example.opaque", [&](const autobahn::wamp_event& event) {
+        if (event.payload_options().scheme() != "x_test"
+                || event.payload_options().serializer() != "protobuf"
+                || event.payload_options().keyid() != "key-1"
+                || !event.payload_options().cipher().empty()) {
+            std::cerr << "event payload options were not received as published" << std::endl;
+            ++failures;
+        }
+        event_payload.set_value(bytes_of(event.payload()));
+    }).get();
+
+    autobahn::wamp_publish_options publish_options;
+    publish_options.set_payload_options(payload_options);
+    session->publish_payload("com.example.opaque", view_of(payload), publish_options);
+    if (event_payload.get_future().get() != payload) {
+        std::cerr << "event payload was not received as published" << std::endl;
+        ++failures;
+    }
+
+    // CALL -> RESULT
+    autobahn::wamp_call_options call_options;
+    call_options.set_payload_options(payload_options);
+    autobahn::wamp_call_result result = session->call_payload(
+            "com.example.echo", view_of(payload), call_options).get();
+    if (bytes_of(result.payload()) != payload || result.payload_options().scheme() != "x_test") {
+        std::cerr << "call result payload was not received as sent" << std::endl;
+        ++failures;
+    }
+
+    // INVOCATION -> YIELD
+    session->provide("com.example.opaque", [&](const autobahn::wamp_invocation& invocation) {
+        if (invocation->payload_options().serializer() != "protobuf") {
+            std::cerr << "invocation payload options were not received as sent" << std::endl;
+            ++failures;
+        }
+        std::string reversed(invocation->payload().begin(), invocation->payload().end());
+        std::reverse(reversed.begin(), reversed.end());
+        invocation->result_payload(view_of(reversed), autobahn::wamp_payload_options("x_reply"));
+    }).get();
+
+    msgpack::sbuffer invocation;
+    msgpack::packer<msgpack::sbuffer> packer(invocation);
+    packer.pack_array(5);
+    packer.pack(static_cast<int>(autobahn::message_type::INVOCATION));
+    packer.pack(static_cast<uint64_t>(1));
+    packer.pack(REGISTRATION_ID);
+    packer.pack_map(payload_options.size());
+    payload_options.pack_entries(packer);
+    autobahn::pack_payload_argument(invocation, view_of(payload));
+    router->deliver(invocation);
+
+    auto yield = yield_promise->get_future().get();
+    if (std::get<0>(yield) != "x_reply"
+            || std::get<1>(yield) != std::string(payload.rbegin(), payload.rend())) {
+        std::cerr << "invocation payload was not answered as expected" << std::endl;
+        ++failures;
+    }
+
+    try {
+        session->publish_payload("com.example.opaque", view_of(payload), autobahn::wamp_publish_options());
+        std::cerr << "a payload without a scheme was published" << std::endl;
+        ++failures;
+    } catch (const std::invalid_argument&) {
+    }
+
+    try {
+        session->call_payload(session->prepare_call("com.example.opaque"), view_of(payload));
+        std::cerr << "a prepared call without a payload scheme was made" << std::endl;
+        ++failures;
+    } catch (const std::invalid_argument&) {
+    }
+
+    thread.stop();
+
+    // Taking a large payload out of an EVENT, as the view of an opaque
+    // binary versus converting a string argument.
+    const std::string large(LARGE_PAYLOAD, 'x');
+    msgpack::sbuffer opaque_frame = event_frame(large, true);
+    msgpack::sbuffer converted_frame = event_frame(large, false);
+
+    double opaque_ms = 0;
+    double converted_ms = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        {
+            autobahn::wamp_message event = autobahn::wamp_decode_pipeline::decode(
+                    opaque_frame.data(), opaque_frame.size(), nullptr);
+            autobahn::wamp_payload_options options;
+            options.read(event.field(3));
+            if (autobahn::payload_argument(event.field(4)).size() != LARGE_PAYLOAD) {
+                ++failures;
+            }
+        }
+        auto middle = std::chrono::steady_clock::now();
+        {
+            autobahn::wamp_message event = autobahn::wamp_decode_pipeline::decode(
+                    converted_frame.data(), converted_frame.size(), nullptr);
+            if (std::get<0>(event.field<std::tuple<std::string>>(4)).size() != LARGE_PAYLOAD) {
+                ++failures;
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        opaque_ms += std::chrono::duration<double, std::milli>(middle - start).count();
+        converted_ms += std::chrono::duration<double, std::milli>(end - middle).count();
+    }
+
+    std::cout << "taking " << LARGE_PAYLOAD / (1024 * 1024) << " MB out of an event: "
+              << opaque_ms / ROUNDS << " ms as an opaque payload, "
+              << converted_ms / ROUNDS << " ms converting an argument" << std::endl;
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,219 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Routes the invocations of a prefix registration through a
+// wamp_procedure_dispatcher, over a loopback transport that acts as the
+// router: CALLs come back as INVOCATIONs carrying the called URI, YIELDs
+// and ERRORs as RESULTs and ERRORs. Checks that the best matching
+// procedure handles each call, that a URI no procedure matches fails with
+// wamp.error.no_such_procedure, that typed procedures decode their
+// arguments, and that procedures removed while an invocation is in flight
+// still answer it.
+
+#include "loopback_router.hpp"
+
+#include <boost/asio.hpp>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+
+static const uint64_t REGISTRATION_ID = 9;
+
+// Answers HELLO and REGISTER, turns CALLs into INVOCATIONs, YIELDs into
+// RESULTs and invocation ERRORs into call ERRORs.
+static void answer(loopback_router& router, autobahn::message_type type, autobahn::wamp_message& request)
+{
+    msgpack::sbuffer reply;
+    msgpack::packer<msgpack::sbuffer> packer(reply);
+    switch (type) {
+        case autobahn::message_type::REGISTER:
+            router.acknowledge(type, request.field<uint64_t>(1), REGISTRATION_ID);
+            return;
+        case autobahn::message_type::CALL:
+            // [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list]
+            // The invocation takes the request id of the call.
+            packer.pack_array(5);
+            packer.pack(static_cast<int>(autobahn::message_type::INVOCATION));
+            packer.pack(request.field<uint64_t>(1));
+            packer.pack(REGISTRATION_ID);
+            packer.pack_map(1);
+            packer.pack(std::string("procedure"));
+            loopback_router::write(reply, request.raw_field(3));
+            loopback_router::write(reply, request.raw_field(4));
+            break;
+        case autobahn::message_type::YIELD:
+            // [YIELD, INVOCATION.Request|id, Options|dict, Arguments|list]
+            packer.pack_array(4);
+            packer.pack(static_cast<int>(autobahn::message_type::RESULT));
+            packer.pack(request.field<uint64_t>(1));
+            packer.pack_map(0);
+            loopback_router::write(reply, request.raw_field(3));
+            break;
+        case autobahn::message_type::ERROR:
+            // [ERROR, INVOCATION, INVOCATION.Request|id, Details|dict, Error|uri]
+            packer.pack_array(5);
+            packer.pack(static_cast<int>(autobahn::message_type::ERROR));
+            packer.pack(static_cast<int>(autobahn::message_type::CALL));
+            packer.pack(request.field<uint64_t>(2));
+            packer.pack_map(0);
+            packer.pack(request.field<std::string>(4));
+            break;
+        default:
+            return;
+    }
+
+    router.deliver(reply);
+}
+
+// A procedure that answers with its name.
+static autobahn::wamp_procedure named(const std::string& name)
+{
+    return [name](autobahn::wamp_invocation invocation) {
+        invocation->result(std::make_tuple(name));
+    };
+}
+
+// The name of the procedure that answered a call, or the error URI it
+// failed with.
+static std::string answer_to(autobahn::wamp_session& session, const std::string& uri)
+{
+    try {
+        return session.call(uri, std::make_tuple()).get().argument<std::string>(0);
+    } catch (const autobahn::wamp_error& e) {
+        return e.uri();
+    } catch (const std::exception& e) {
+        return e.what();
+    }
+}
+
+static bool expect(autobahn::wamp_session& session, const std::string& uri, const std::string& expected)
+{
+    std::string got = answer_to(session, uri);
+    if (got == expected) {
+        return true;
+    }
+    std::cerr << "a call to " << uri << " was answered by '" << got << "' rather than '"
+              << expected << "'" << std::endl;
+    return false;
+}
+
+int main()
+{
+    int failures = 0;
+
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    auto router = std::make_shared<loopback_router>(io, loopback_router::answering(&answer));
+    auto session = std::make_shared<autobahn::wamp_session>(io);
+    router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(session));
+    session->start().get();
+    session->join("realm1").get();
+
+    auto dispatcher = std::make_shared<autobahn::wamp_procedure_dispatcher>();
+    dispatcher->add("com.acme.calc.add", named("exact"));
+    dispatcher->add("com.acme.calc.", named("prefix"), "prefix");
+    dispatcher->add("com.acme.calc.a", named("longer prefix"), "prefix");
+    dispatcher->add("com.acme..add", named("wildcard"), "wildcard");
+    dispatcher->add("com...add", named("looser wildcard"), "wildcard");
+    dispatcher->add("com...sub", named("sub wildcard"), "wildcard");
+    dispatcher->add<uint64_t(uint64_t, uint64_t)>("com.acme.math.add2", std::plus<uint64_t>());
+
+    autobahn::provide_options options;
+    options["match"] = msgpack::object("prefix");
+    session->provide("com.", dispatcher->procedure(), options).get();
+
+    // An exact match beats a prefix match, which beats a wildcard match.
+    // Longer prefixes and more concrete wildcards win.
+    failures += !expect(*session, "com.acme.calc.add", "exact");
+    failures += !expect(*session, "com.acme.calc.and", "longer prefix");
+    failures += !expect(*session, "com.acme.calc.sub", "prefix");
+    failures += !expect(*session, "com.acme.stock.add", "wildcard");
+    failures += !expect(*session, "com.other.stock.add", "looser wildcard");
+    failures += !expect(*session, "com.other.stock.sub", "sub wildcard");
+    failures += !expect(*session, "com.acme.stock.mul", "wamp.error.no_such_procedure");
+
+    // Typed procedures.
+    uint64_t sum = session->call("com.acme.math.add2", std::make_tuple(23, 777)).get().argument<uint64_t>(0);
+    if (sum != 800) {
+        std::cerr << "a typed procedure returned " << sum << std::endl;
+        ++failures;
+    }
+    failures += !expect(*session, "com.acme.math.add2", "wamp.error.invalid_argument");
+
+    // A procedure removed while one of its invocations is pending still
+    // answers it, while later calls no longer reach it.
+    boost::promise<autobahn::wamp_invocation> invoked;
+    uint64_t slow = 0;
+    run_on_io(io, [&]() {
+        slow = dispatcher->add("com.acme.slow", [&invoked](autobahn::wamp_invocation invocation) {
+            invoked.set_value(invocation);
+        });
+    });
+    auto pending = session->call("com.acme.slow", std::make_tuple());
+    autobahn::wamp_invocation invocation = invoked.get_future().get();
+
+    bool removed = false;
+    run_on_io(io, [&]() { removed = dispatcher->remove(slow); });
+    if (!removed) {
+        std::cerr << "a procedure with a pending invocation could not be removed" << std::endl;
+        ++failures;
+    }
+    failures += !expect(*session, "com.acme.slow", "wamp.error.no_such_procedure");
+
+    run_on_io(io, [&]() { invocation->result(std::make_tuple(std::string("late"))); });
+    invocation.reset();
+    if (pending.get().argument<std::string>(0) != "late") {
+        std::cerr << "the pending invocation of a removed procedure was not answered" << std::endl;
+        ++failures;
+    }
+
+    // A procedure removing itself, and adding another, while it is invoked.
+    uint64_t once = 0;
+    run_on_io(io, [&]() {
+        once = dispatcher->add("com.acme.once", [&](autobahn::wamp_invocation invocation) {
+            dispatcher->remove(once);
+            dispatcher->add("com.acme.once", named("replacement"));
+            invocation->result(std::make_tuple(std::string("once")));
+        });
+    });
+    failures += !expect(*session, "com.acme.once", "once");
+    failures += !expect(*session, "com.acme.once", "replacement");
+
+    // The procedure of a destroyed dispatcher fails its invocations.
+    dispatcher.reset();
+    failures += !expect(*session, "com.acme.calc.add", "wamp.error.no_such_procedure");
+
+    thread.stop();
+
+    return failures ? 1 : 0;
+}
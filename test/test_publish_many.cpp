@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Compares the rate of publishing events one by one with publish() to
+// publishing them in batches with publish_many(), over a loopback transport
+// that serializes every message and counts the writes it is asked to make.
+
+#include "loopback_router.hpp"
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+static const std::size_t NUM_EVENTS = 100000;
+static const std::size_t BATCH_SIZE = 256;
+
+// What the router was sent since the last reset, written on the io thread
+// and read once it is drained.
+struct sent_counts
+{
+    std::size_t writes;
+    std::size_t messages;
+    std::size_t bytes;
+};
+
+static void report(const char* name, double ms, const sent_counts& sent)
+{
+    std::cout << name << NUM_EVENTS << " events, " << sent.writes << " writes, "
+              << sent.bytes << " octets, " << ms << " ms, "
+              << static_cast<uint64_t>(NUM_EVENTS / (ms / 1000.0)) << " events/s" << std::endl;
+}
+
+int main()
+{
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    // Welcomes the session and swallows everything else.
+    sent_counts sent = { 0, 0, 0 };
+    auto router = std::make_shared<loopback_router>(io,
+            [&sent](loopback_router& router, autobahn::wamp_message&& message) {
+        ++sent.messages;
+        sent.bytes += message.serialize().size();
+        if (loopback_router::peek_type(message) == autobahn::message_type::HELLO) {
+            router.welcome();
+        }
+    });
+    auto session = std::make_shared<autobahn::wamp_session>(io);
+    router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(session));
+    session->start().get();
+    session->join("realm1").get();
+
+    const std::string topic("com.example.log");
+    const auto arguments = std::make_tuple(std::string("GET /index.html"), 200, 5120);
+
+    std::size_t writes_before = 0;
+    run_on_io(io, [&]() {
+        sent = sent_counts{ 0, 0, 0 };
+        writes_before = router->writes();
+    });
+    auto start = std::chrono::steady_clock::now();
+    boost::future<void> published;
+    for (std::size_t i = 0; i < NUM_EVENTS; ++i) {
+        published = session->publish(topic, arguments);
+    }
+    published.get();
+    double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+    run_on_io(io, [&]() {
+        sent.writes = router->writes() - writes_before;
+    });
+    report("publish():      ", ms, sent);
+    sent_counts single = sent;
+
+    run_on_io(io, [&]() {
+        sent = sent_counts{ 0, 0, 0 };
+        writes_before = router->writes();
+    });
+    start = std::chrono::steady_clock::now();
+    std::vector<std::pair<std::string, std::tuple<std::string, int, int>>> batch;
+    batch.reserve(BATCH_SIZE);
+    for (std::size_t i = 0; i < NUM_EVENTS; ++i) {
+        batch.emplace_back(topic, arguments);
+        if (batch.size() == BATCH_SIZE || i + 1 == NUM_EVENTS) {
+            published = session->publish_many(batch);
+            batch.clear();
+        }
+    }
+    published.get();
+    ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+    run_on_io(io, [&]() {
+        sent.writes = router->writes() - writes_before;
+    });
+    report("publish_many(): ", ms, sent);
+
+    thread.stop();
+
+    std::size_t expected_writes = (NUM_EVENTS + BATCH_SIZE - 1) / BATCH_SIZE;
+    if (single.writes != NUM_EVENTS || sent.writes != expected_writes
+            || sent.messages != NUM_EVENTS) {
+        std::cerr << "batched publications differ from single ones" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,169 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Publishes with acknowledgement through a session with a publish window
+// of two and a queue of two over a loopback router that only answers the
+// PUBLISHes when told to. Checks that publications beyond the window are
+// queued and sent as PUBLISHED or ERROR answers come in, that publications
+// beyond the queue fail right away, and that a lost connection fails both
+// the unacknowledged and the queued publications.
+
+#include "loopback_router.hpp"
+
+#include <boost/asio.hpp>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// The request ids of the PUBLISHes received, in order. Written on the io
+// thread, read once it is drained.
+static std::vector<uint64_t> published;
+
+// Answers HELLO and records PUBLISHes.
+static void answer(loopback_router& router, autobahn::message_type type, autobahn::wamp_message& request)
+{
+    if (type == autobahn::message_type::PUBLISH) {
+        published.push_back(request.field<uint64_t>(1));
+    }
+}
+
+static void acknowledge(loopback_router& router, uint64_t request_id)
+{
+    router.deliver_made([request_id]() {
+        // [PUBLISHED, PUBLISH.Request|id, Publication|id]
+        autobahn::wamp_message acknowledgement(3);
+        acknowledgement.set_field(0, static_cast<int>(autobahn::message_type::PUBLISHED));
+        acknowledgement.set_field(1, request_id);
+        acknowledgement.set_field(2, request_id + 1000);
+        return acknowledgement;
+    });
+}
+
+static void refuse(loopback_router& router, uint64_t request_id)
+{
+    router.deliver_made([request_id]() {
+        // [ERROR, PUBLISH, PUBLISH.Request|id, Details|dict, Error|uri]
+        autobahn::wamp_message refusal(5);
+        refusal.set_field(0, static_cast<int>(autobahn::message_type::ERROR));
+        refusal.set_field(1, static_cast<int>(autobahn::message_type::PUBLISH));
+        refusal.set_field(2, request_id);
+        refusal.set_field(3, std::map<std::string, int>());
+        refusal.set_field(4, std::string("wamp.error.not_authorized"));
+        return refusal;
+    });
+}
+
+// The message a publication failed with, or an empty string if it has not
+// failed (yet).
+static std::string failure_of(boost::future<autobahn::wamp_publication>& publication)
+{
+    if (!publication.has_exception()) {
+        return std::string();
+    }
+    try {
+        publication.get();
+    } catch (const std::exception& e) {
+        return e.what();
+    }
+    return std::string();
+}
+
+int main()
+{
+    int failures = 0;
+
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    auto router = std::make_shared<loopback_router>(io, loopback_router::answering(&answer));
+    auto session = std::make_shared<autobahn::wamp_session>(io);
+    router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(session));
+    session->start().get();
+    session->join("realm1").get();
+    session->set_publish_window(2, 2);
+
+    autobahn::wamp_publish_options options;
+    options.set_acknowledge(true);
+    const auto arguments = std::make_tuple(std::string("tick"));
+
+    // Two in flight, two queued, one too many.
+    std::vector<boost::future<autobahn::wamp_publication>> publications;
+    for (int i = 0; i < 5; ++i) {
+        publications.push_back(session->publish("com.example.ticks", arguments, options));
+    }
+    drain(io);
+
+    if (published.size() != 2) {
+        std::cerr << published.size() << " publications sent with a window of 2" << std::endl;
+        ++failures;
+    }
+    if (failure_of(publications[4]) != "publish queue is full") {
+        std::cerr << "a publication beyond the queue did not fail" << std::endl;
+        ++failures;
+    }
+
+    acknowledge(*router, published[0]);
+    drain(io);
+    if (publications[0].get().id() != published[0] + 1000 || published.size() != 3) {
+        std::cerr << "an acknowledgement did not make room for a queued publication" << std::endl;
+        ++failures;
+    }
+
+    refuse(*router, published[1]);
+    drain(io);
+    if (failure_of(publications[1]) != "wamp.error.not_authorized" || published.size() != 4) {
+        std::cerr << "an error did not make room for a queued publication" << std::endl;
+        ++failures;
+    }
+
+    // Two in flight, two more queued, then the connection is lost.
+    publications.push_back(session->publish("com.example.ticks", arguments, options));
+    publications.push_back(session->publish("com.example.ticks", arguments, options));
+    drain(io);
+    router->drop();
+    drain(io);
+
+    for (std::size_t i = 2; i < publications.size(); ++i) {
+        if (i != 4 && failure_of(publications[i]).empty()) {
+            std::cerr << "publication " << i << " survived the lost connection" << std::endl;
+            ++failures;
+        }
+    }
+    if (published.size() != 4) {
+        std::cerr << "queued publications were sent after the connection was lost" << std::endl;
+        ++failures;
+    }
+
+    thread.stop();
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,201 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Forwards pre-encoded payloads through a joined session over a loopback
+// transport that acts as the router: PUBLISHes come back as EVENTs and CALLs
+// as RESULTs, with their argument bytes spliced in as they are. Checks that
+// publish_raw() and call_raw() put the bytes on the wire unchanged and that
+// wamp_event::raw_arguments() and wamp_call_result::raw_arguments() return
+// them as received, then times passing on a large payload by decoding and
+// re-encoding it against passing on its bytes.
+
+#include "loopback_router.hpp"
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+static const uint64_t SUBSCRIPTION_ID = 7;
+static const std::size_t LARGE_PAYLOAD = 16 * 1024 * 1024;
+static const int ROUNDS = 10;
+
+static std::string bytes_of(const autobahn::wamp_bytes_view& view)
+{
+    return std::string(view.data(), view.size());
+}
+
+template <typename T>
+static std::string encode(const T& value)
+{
+    msgpack::sbuffer buffer;
+    msgpack::pack(buffer, value);
+    return std::string(buffer.data(), buffer.size());
+}
+
+// Answers HELLO and SUBSCRIBE, echoes PUBLISH as EVENT and CALL as RESULT.
+// Everything the session sends is decoded with its raw fields kept, the way
+// a transport does for a session that keeps raw arguments.
+static void answer(loopback_router& router, autobahn::message_type type, autobahn::wamp_message& request)
+{
+    msgpack::sbuffer reply;
+    msgpack::packer<msgpack::sbuffer> packer(reply);
+    switch (type) {
+        case autobahn::message_type::SUBSCRIBE:
+            router.acknowledge(type, request.field<uint64_t>(1), SUBSCRIPTION_ID);
+            return;
+        case autobahn::message_type::PUBLISH: {
+            // [PUBLISH, Request|id, Options|dict, Topic|uri, Arguments|list, ArgumentsKw|dict]
+            autobahn::wamp_bytes_view arguments = request.raw_field(4);
+            autobahn::wamp_bytes_view kw_arguments = request.raw_field(5);
+            packer.pack_array(4 + autobahn::raw_argument_fields(arguments, kw_arguments));
+            packer.pack(static_cast<int>(autobahn::message_type::EVENT));
+            packer.pack(SUBSCRIPTION_ID);
+            packer.pack(request.field<uint64_t>(1));
+            packer.pack_map(0);
+            autobahn::pack_raw_arguments(reply, arguments, kw_arguments);
+            break;
+        }
+        case autobahn::message_type::CALL: {
+            // [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list, ArgumentsKw|dict]
+            autobahn::wamp_bytes_view arguments = request.raw_field(4);
+            autobahn::wamp_bytes_view kw_arguments = request.raw_field(5);
+            packer.pack_array(3 + autobahn::raw_argument_fields(arguments, kw_arguments));
+            packer.pack(static_cast<int>(autobahn::message_type::RESULT));
+            packer.pack(request.field<uint64_t>(1));
+            packer.pack_map(0);
+            autobahn::pack_raw_arguments(reply, arguments, kw_arguments);
+            break;
+        }
+        default:
+            return;
+    }
+
+    router.deliver(reply);
+}
+
+int main()
+{
+    int failures = 0;
+
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    auto router = std::make_shared<loopback_router>(io, loopback_router::answering(&answer));
+    auto session = std::make_shared<autobahn::wamp_session>(io);
+    session->set_keep_raw_arguments(true);
+    router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(session));
+    session->start().get();
+    session->join("realm1").get();
+
+    const std::string arguments = encode(std::make_tuple(std::string("hello"), 23));
+    std::map<std::string, int> kw = { { "x", 1 } };
+    const std::string kw_arguments = encode(kw);
+
+    // PUBLISH -> EVENT
+    boost::promise<std::string> event_bytes;
+    session->subscribe("com.example.raw", [&](const autobahn::wamp_event& event) {
+        if (event.argument<std::string>(0) != "hello" || event.kw_argument<int>("x") != 1) {
+            std::cerr << "event arguments were not decoded" << std::endl;
+            ++failures;
+        }
+        event_bytes.set_value(bytes_of(event.raw_arguments()) + bytes_of(event.raw_kw_arguments()));
+    }).get();
+
+    session->publish_raw("com.example.raw",
+            autobahn::wamp_bytes_view(arguments.data(), arguments.size()),
+            autobahn::wamp_bytes_view(kw_arguments.data(), kw_arguments.size()));
+    if (event_bytes.get_future().get() != arguments + kw_arguments) {
+        std::cerr << "event arguments were not received as published" << std::endl;
+        ++failures;
+    }
+
+    // CALL -> RESULT
+    autobahn::wamp_call_result result = session->call_raw("com.example.echo",
+            autobahn::wamp_bytes_view(arguments.data(), arguments.size())).get();
+    if (bytes_of(result.raw_arguments()) != arguments || !result.raw_kw_arguments().empty()
+            || result.argument<int>(1) != 23) {
+        std::cerr << "call result arguments were not received as sent" << std::endl;
+        ++failures;
+    }
+
+    try {
+        session->publish_raw("com.example.raw", autobahn::wamp_bytes_view(kw_arguments.data(), kw_arguments.size()));
+        std::cerr << "a map was accepted as positional arguments" << std::endl;
+        ++failures;
+    } catch (const std::invalid_argument&) {
+    }
+
+    thread.stop();
+
+    // Passing on the arguments of a large EVENT as the arguments of a PUBLISH,
+    // by re-encoding the decoded arguments versus copying their bytes.
+    msgpack::sbuffer frame;
+    msgpack::packer<msgpack::sbuffer> packer(frame);
+    packer.pack_array(5);
+    packer.pack(static_cast<int>(autobahn::message_type::EVENT));
+    packer.pack(SUBSCRIPTION_ID);
+    packer.pack(static_cast<uint64_t>(1));
+    packer.pack_map(0);
+    packer.pack(std::make_tuple(std::string(LARGE_PAYLOAD, 'x')));
+
+    double reencode_ms = 0;
+    double raw_ms = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        {
+            autobahn::wamp_message event = autobahn::wamp_decode_pipeline::decode(
+                    frame.data(), frame.size(), nullptr);
+            msgpack::sbuffer forwarded;
+            msgpack::pack(forwarded, event.field(4));
+        }
+        auto middle = std::chrono::steady_clock::now();
+        {
+            autobahn::wamp_message event = autobahn::wamp_decode_pipeline::decode(
+                    frame.data(), frame.size(), nullptr, true);
+            msgpack::sbuffer forwarded;
+            autobahn::pack_raw_arguments(forwarded, event.raw_field(4), autobahn::wamp_bytes_view());
+        }
+        auto end = std::chrono::steady_clock::now();
+        reencode_ms += std::chrono::duration<double, std::milli>(middle - start).count();
+        raw_ms += std::chrono::duration<double, std::milli>(end - middle).count();
+    }
+
+    std::cout << "passing on " << LARGE_PAYLOAD / (1024 * 1024) << " MB of arguments: "
+              << reencode_ms / ROUNDS << " ms re-encoding, "
+              << raw_ms / ROUNDS << " ms passing on the bytes" << std::endl;
+
+    return failures ? 1 : 0;
+}
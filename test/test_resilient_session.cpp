@@ -0,0 +1,214 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Drops the transport of a resilient session and checks that it reconnects
+// and replays its subscriptions and registrations, subscriptions with one
+// SUBSCRIBE batch per match policy and registrations with one REGISTER
+// batch per set of options, and that events and invocations then reach the
+// handlers under the new router assigned ids. Finally checks that the
+// resilient session and its transport go away when the last reference to
+// the session is released without stopping it.
+
+#include "loopback_router.hpp"
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// What the router of one connection has seen.
+struct connection
+{
+    std::weak_ptr<loopback_router> router;
+    uint64_t next_id;
+    unsigned subscribes;
+    unsigned registers;
+    std::map<std::string, uint64_t> subscriptions;
+    std::map<std::string, uint64_t> registrations;
+    boost::promise<std::string> yielded;
+};
+
+// Answers HELLO, SUBSCRIBE and REGISTER, assigning ids that differ from
+// connection to connection, and records YIELDs.
+static loopback_router::reply_function recording_reply(const std::shared_ptr<connection>& seen)
+{
+    return loopback_router::answering([seen](loopback_router& router,
+            autobahn::message_type type, autobahn::wamp_message& request) {
+        switch (type) {
+            case autobahn::message_type::SUBSCRIBE:
+                // [SUBSCRIBE, Request|id, Options|dict, Topic|uri]
+                ++seen->subscribes;
+                seen->subscriptions[request.field<std::string>(3)] = ++seen->next_id;
+                router.acknowledge(type, request.field<uint64_t>(1), seen->next_id);
+                break;
+            case autobahn::message_type::REGISTER:
+                // [REGISTER, Request|id, Options|dict, Procedure|uri]
+                ++seen->registers;
+                seen->registrations[request.field<std::string>(3)] = ++seen->next_id;
+                router.acknowledge(type, request.field<uint64_t>(1), seen->next_id);
+                break;
+            case autobahn::message_type::YIELD:
+                // [YIELD, INVOCATION.Request|id, Options|dict, Arguments|list]
+                seen->yielded.set_value(request.field<std::vector<std::string>>(3).at(0));
+                break;
+            default:
+                break;
+        }
+    });
+}
+
+int main()
+{
+    int failures = 0;
+
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    // Accessed on the io thread only.
+    std::vector<std::shared_ptr<connection>> connections;
+    auto factory = [&connections](boost::asio::io_service& io) {
+        auto seen = std::make_shared<connection>();
+        seen->next_id = 100 * (connections.size() + 1);
+        seen->subscribes = 0;
+        seen->registers = 0;
+        auto router = std::make_shared<loopback_router>(io, recording_reply(seen));
+        seen->router = router;
+        connections.push_back(seen);
+        return std::static_pointer_cast<autobahn::wamp_transport>(router);
+    };
+
+    auto session = std::make_shared<autobahn::wamp_resilient_session>(io, factory, "realm1");
+    session->set_reconnect_delay(std::chrono::milliseconds(10), std::chrono::milliseconds(10));
+
+    std::vector<boost::promise<std::shared_ptr<connection>>> joined(2);
+    unsigned joins = 0;
+    session->set_join_handler([&](const std::shared_ptr<autobahn::wamp_session>&) {
+        if (joins < joined.size()) {
+            joined[joins++].set_value(connections.back());
+        }
+    });
+    unsigned disconnects = 0;
+    session->set_disconnect_handler([&](const std::string&) { ++disconnects; });
+
+    boost::promise<std::string> received;
+    auto on_event = [&received](const autobahn::wamp_event& event) {
+        received.set_value(event.argument<std::string>(0));
+    };
+    auto echo = [](autobahn::wamp_invocation invocation) {
+        invocation->result(std::make_tuple(invocation->argument<std::string>(0)));
+    };
+
+    autobahn::wamp_subscribe_options prefix;
+    prefix.set_match("prefix");
+    session->subscribe("com.example.a", on_event);
+    session->subscribe("com.example.b", [](const autobahn::wamp_event&) {});
+    session->subscribe("com.example.", [](const autobahn::wamp_event&) {}, prefix);
+    session->provide("com.example.echo", echo);
+    auto provided = session->provide("com.example.other", [](autobahn::wamp_invocation) {});
+
+    session->start();
+    auto first = joined[0].get_future().get();
+    provided.get();
+    drain(io, 2);
+
+    if (first->subscribes != 3 || first->registers != 2) {
+        std::cerr << "the first connection saw " << first->subscribes << " SUBSCRIBEs and "
+                << first->registers << " REGISTERs" << std::endl;
+        ++failures;
+    }
+
+    first->router.lock()->drop();
+    auto second = joined[1].get_future().get();
+    drain(io, 2);
+
+    if (disconnects != 1) {
+        std::cerr << "the disconnect handler was called " << disconnects << " times" << std::endl;
+        ++failures;
+    }
+    if (second->subscribes != 3 || second->registers != 2) {
+        std::cerr << "the second connection saw " << second->subscribes << " SUBSCRIBEs and "
+                << second->registers << " REGISTERs" << std::endl;
+        ++failures;
+    }
+
+    auto router = second->router.lock();
+
+    // [EVENT, SUBSCRIBED.Subscription|id, PUBLISHED.Publication|id, Details|dict, Arguments|list]
+    uint64_t subscription_id = second->subscriptions["com.example.a"];
+    router->deliver_made([subscription_id]() {
+        autobahn::wamp_message event(5);
+        event.set_field(0, static_cast<int>(autobahn::message_type::EVENT));
+        event.set_field(1, subscription_id);
+        event.set_field(2, static_cast<uint64_t>(1));
+        event.set_field(3, std::map<std::string, int>());
+        event.set_field(4, std::make_tuple(std::string("hello")));
+        return event;
+    });
+    if (received.get_future().get() != "hello") {
+        std::cerr << "the event was not delivered after the reconnect" << std::endl;
+        ++failures;
+    }
+
+    // [INVOCATION, Request|id, REGISTERED.Registration|id, Details|dict, Arguments|list]
+    uint64_t registration_id = second->registrations["com.example.echo"];
+    router->deliver_made([registration_id]() {
+        autobahn::wamp_message invocation(5);
+        invocation.set_field(0, static_cast<int>(autobahn::message_type::INVOCATION));
+        invocation.set_field(1, static_cast<uint64_t>(1));
+        invocation.set_field(2, registration_id);
+        invocation.set_field(3, std::map<std::string, int>());
+        invocation.set_field(4, std::make_tuple(std::string("echo")));
+        return invocation;
+    });
+    if (second->yielded.get_future().get() != "echo") {
+        std::cerr << "the invocation was not answered after the reconnect" << std::endl;
+        ++failures;
+    }
+
+    // Released without stop()
+    std::weak_ptr<autobahn::wamp_resilient_session> weak_session = session;
+    std::weak_ptr<loopback_router> weak_router = router;
+    router.reset();
+    session.reset();
+    drain(io, 2);
+
+    if (!weak_session.expired() || !weak_router.expired()) {
+        std::cerr << "the resilient session or its transport leaked" << std::endl;
+        ++failures;
+    }
+
+    thread.stop();
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,243 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Makes the same calls and publications through two joined sessions over
+// loopback transports that act as the router, one serializing on the io
+// thread and one on the calling thread (set_serialize_on_caller()). Checks
+// that the PUBLISH and CALL frames reaching the routers are byte for byte
+// the same, that local delivery and local calls still work on serialized
+// messages, and that toggling the flag while traffic flows loses nothing.
+
+#include "loopback_router.hpp"
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+static const std::size_t NUM_REQUESTS = 2000;
+
+// Publications to com.example.local the routers received.
+static std::atomic<unsigned> local_publications(0);
+
+// Answers HELLO, SUBSCRIBE and REGISTER, echoes the arguments of CALLs as
+// RESULTs and counts the publications to com.example.local.
+static void answer(loopback_router& router, autobahn::message_type type, autobahn::wamp_message& request)
+{
+    switch (type) {
+        case autobahn::message_type::SUBSCRIBE:
+            router.acknowledge(type, request.field<uint64_t>(1), request.field<uint64_t>(1));
+            break;
+        case autobahn::message_type::REGISTER:
+            router.acknowledge(type, request.field<uint64_t>(1), request.field<uint64_t>(1));
+            break;
+        case autobahn::message_type::CALL: {
+            // [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list, ArgumentsKw|dict]
+            msgpack::sbuffer reply;
+            msgpack::packer<msgpack::sbuffer> packer(reply);
+            packer.pack_array(request.size() > 4 ? 4 : 3);
+            packer.pack(static_cast<int>(autobahn::message_type::RESULT));
+            packer.pack(request.field<uint64_t>(1));
+            packer.pack_map(0);
+            if (request.size() > 4) {
+                loopback_router::write(reply, request.raw_field(4));
+            }
+            router.deliver(reply);
+            break;
+        }
+        case autobahn::message_type::PUBLISH:
+            // [PUBLISH, Request|id, Options|dict, Topic|uri, Arguments|list]
+            if (request.field<std::string>(3) == "com.example.local") {
+                ++local_publications;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Records the PUBLISH and CALL frames sent by the session, as sent, and
+// then answers them. Written on the io thread, read once it is drained.
+static loopback_router::reply_function recording(std::vector<std::string>& frames)
+{
+    auto answer_request = loopback_router::answering(&answer);
+    return [&frames, answer_request](loopback_router& router, autobahn::wamp_message&& message) {
+        auto type = loopback_router::peek_type(message);
+        if (type == autobahn::message_type::PUBLISH || type == autobahn::message_type::CALL) {
+            const msgpack::sbuffer& sent = message.serialize();
+            frames.emplace_back(sent.data(), sent.size());
+        }
+        answer_request(router, std::move(message));
+    };
+}
+
+static std::shared_ptr<autobahn::wamp_session> join(boost::asio::io_service& io,
+        const std::shared_ptr<loopback_router>& router,
+        const std::shared_ptr<autobahn::wamp_local_procedures>& procedures)
+{
+    auto session = std::make_shared<autobahn::wamp_session>(io);
+    session->set_local_procedures(procedures);
+    router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(session));
+    session->start().get();
+    session->join("realm1").get();
+    return session;
+}
+
+// Publishes and calls with every kind of arguments and options. Returns
+// whether the calls were answered with their arguments.
+static bool send_traffic(autobahn::wamp_session& session)
+{
+    auto arguments = std::make_tuple(uint64_t(23), std::string("text"), std::vector<int>{ 1, 2, 3 });
+    std::map<std::string, std::string> kw_arguments;
+    kw_arguments["colour"] = "orange";
+    kw_arguments["size"] = std::string(1024, 'x');
+
+    autobahn::wamp_publish_options include_me;
+    include_me.set_exclude_me(false);
+    autobahn::wamp_call_options timeout;
+    timeout.set_timeout(std::chrono::milliseconds(2500));
+
+    session.publish("com.example.topic").get();
+    session.publish("com.example.topic", arguments).get();
+    session.publish("com.example.topic", arguments, kw_arguments).get();
+    session.publish("com.example.topic", arguments, include_me).get();
+
+    bool answered = true;
+    session.call("com.example.echo").get();
+    auto result = session.call("com.example.echo", arguments).get();
+    answered &= result.argument<std::string>(1) == "text";
+    result = session.call("com.example.echo", arguments, kw_arguments).get();
+    answered &= result.argument<uint64_t>(0) == 23;
+    result = session.call("com.example.echo", arguments, timeout).get();
+    answered &= result.argument<std::vector<int>>(2).size() == 3;
+    return answered;
+}
+
+int main()
+{
+    int failures = 0;
+
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    auto procedures = std::make_shared<autobahn::wamp_local_procedures>();
+    std::vector<std::string> io_frames;
+    auto io_router = std::make_shared<loopback_router>(io, recording(io_frames));
+    auto io_session = join(io, io_router, procedures);
+    std::vector<std::string> caller_frames;
+    auto caller_router = std::make_shared<loopback_router>(io, recording(caller_frames));
+    auto caller_session = join(io, caller_router, procedures);
+    caller_session->set_serialize_on_caller(true);
+
+    // The same traffic, serialized on either thread.
+    if (!send_traffic(*io_session) || !send_traffic(*caller_session)) {
+        std::cerr << "a call was not answered with its arguments" << std::endl;
+        ++failures;
+    }
+    drain(io);
+    if (io_frames.empty() || caller_frames != io_frames) {
+        std::cerr << "frames serialized on the calling thread differ from those serialized "
+                  << "on the io thread" << std::endl;
+        ++failures;
+    }
+
+    // Local delivery and local calls, from serialized messages.
+    unsigned delivered = 0;
+    uint64_t last = 0;
+    caller_session->set_local_delivery(true);
+    caller_session->subscribe("com.example.local", [&](const autobahn::wamp_event& event) {
+        ++delivered;
+        last = event.argument<uint64_t>(0);
+    }).get();
+    caller_session->publish("com.example.local", std::make_tuple(uint64_t(42))).get();
+    drain(io);
+    if (delivered != 1 || last != 42) {
+        std::cerr << "a publication serialized on the calling thread was not delivered locally"
+                  << std::endl;
+        ++failures;
+    }
+
+    io_session->provide<uint64_t(uint64_t, uint64_t)>("com.example.add2", std::plus<uint64_t>()).get();
+    auto sum = caller_session->call("com.example.add2", std::make_tuple(23, 777)).get();
+    if (sum.argument<uint64_t>(0) != 800) {
+        std::cerr << "a local call serialized on the calling thread returned the wrong result"
+                  << std::endl;
+        ++failures;
+    }
+
+    // Toggling the flag while publications and calls are made.
+    std::atomic<bool> stop(false);
+    std::thread toggler([&]() {
+        bool enabled = false;
+        while (!stop) {
+            caller_session->set_serialize_on_caller(enabled = !enabled);
+            std::this_thread::yield();
+        }
+    });
+
+    delivered = 0;
+    local_publications = 0;
+    std::vector<boost::future<autobahn::wamp_call_result>> results;
+    results.reserve(NUM_REQUESTS);
+    for (std::size_t i = 0; i < NUM_REQUESTS; ++i) {
+        caller_session->publish("com.example.local", std::make_tuple(uint64_t(i)));
+        results.push_back(caller_session->call("com.example.echo", std::make_tuple(uint64_t(i))));
+    }
+    std::size_t wrong = 0;
+    for (std::size_t i = 0; i < NUM_REQUESTS; ++i) {
+        wrong += results[i].get().argument<uint64_t>(0) != i;
+    }
+
+    stop = true;
+    toggler.join();
+    drain(io);
+
+    if (wrong != 0) {
+        std::cerr << wrong << " calls made while toggling were answered wrongly" << std::endl;
+        ++failures;
+    }
+    if (delivered != NUM_REQUESTS || local_publications != NUM_REQUESTS) {
+        std::cerr << "of " << NUM_REQUESTS << " publications made while toggling, " << delivered
+                  << " were delivered locally and " << local_publications
+                  << " reached the router" << std::endl;
+        ++failures;
+    }
+
+    thread.stop();
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,238 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Subscribes several local handlers to one topic over a loopback router and
+// checks that they share one router subscription: subscribe() and
+// subscribe_many() join a SUBSCRIBE still pending for the topic, an event
+// fans out to every handler, and only the last unsubscribe reaches the
+// router. A handler that unsubscribes itself and subscribes another handler
+// while the event is delivered must not disturb the delivery, and the new
+// handler only sees the next event. A batch that joined the pending
+// SUBSCRIBE of another batch and then failed must not get a handler once
+// the other batch completes.
+
+#include "loopback_router.hpp"
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+static const uint64_t SUBSCRIPTION_ID = 7;
+static const std::string TOPIC("com.example.shared");
+static const uint64_t HELD_SUBSCRIPTION_ID = 8;
+static const std::string HELD_TOPIC("com.example.held");
+static const std::string FAILING_TOPIC("com.example.failing");
+
+static std::atomic<unsigned> subscribes(0);
+static std::atomic<unsigned> unsubscribes(0);
+
+// Answers HELLO, SUBSCRIBE and UNSUBSCRIBE and counts the latter two.
+static void answer(loopback_router& router, autobahn::message_type type, autobahn::wamp_message& request)
+{
+    switch (type) {
+        case autobahn::message_type::SUBSCRIBE:
+            ++subscribes;
+            router.acknowledge(type, request.field<uint64_t>(1), SUBSCRIPTION_ID);
+            break;
+        case autobahn::message_type::UNSUBSCRIBE:
+            ++unsubscribes;
+            router.acknowledge(type, request.field<uint64_t>(1));
+            break;
+        default:
+            break;
+    }
+}
+
+// The SUBSCRIBE for the held topic, left unanswered. Written on the io
+// thread, read once it is drained.
+static uint64_t held_request = 0;
+
+// Holds the SUBSCRIBE for the held topic, fails to send the one for the
+// failing topic and answers all others.
+static void hold_or_fail(loopback_router& router, autobahn::message_type type, autobahn::wamp_message& request)
+{
+    if (type != autobahn::message_type::SUBSCRIBE) {
+        return;
+    }
+    // [SUBSCRIBE, Request|id, Options|dict, Topic|uri]
+    std::string topic = request.field<std::string>(3);
+    if (topic == HELD_TOPIC) {
+        held_request = request.field<uint64_t>(1);
+    } else if (topic == FAILING_TOPIC) {
+        throw std::runtime_error("the transport failed");
+    } else {
+        router.acknowledge(type, request.field<uint64_t>(1), SUBSCRIPTION_ID);
+    }
+}
+
+static void publish(loopback_router& router, uint64_t subscription_id = SUBSCRIPTION_ID)
+{
+    // [EVENT, SUBSCRIBED.Subscription|id, PUBLISHED.Publication|id, Details|dict, Arguments|list]
+    router.deliver_made([subscription_id]() {
+        autobahn::wamp_message event(5);
+        event.set_field(0, static_cast<int>(autobahn::message_type::EVENT));
+        event.set_field(1, subscription_id);
+        event.set_field(2, static_cast<uint64_t>(1));
+        event.set_field(3, std::map<std::string, int>());
+        event.set_field(4, std::make_tuple(1));
+        return event;
+    });
+}
+
+int main()
+{
+    int failures = 0;
+
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    auto router = std::make_shared<loopback_router>(io, loopback_router::answering(&answer));
+    auto session = std::make_shared<autobahn::wamp_session>(io);
+    router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(session));
+    session->start().get();
+    session->join("realm1").get();
+
+    std::atomic<unsigned> first(0);
+    std::atomic<unsigned> second(0);
+    std::atomic<unsigned> third(0);
+    std::atomic<unsigned> late(0);
+
+    // The handler that replaces itself while the event is delivered.
+    autobahn::wamp_subscription replaced;
+    auto replacing = [&](const autobahn::wamp_event&) {
+        ++second;
+        session->unsubscribe(replaced);
+        session->subscribe(TOPIC, [&late](const autobahn::wamp_event&) { ++late; });
+    };
+
+    // Both requests are issued before the router answers the first one.
+    auto subscribed = session->subscribe(TOPIC, [&first](const autobahn::wamp_event&) { ++first; });
+    std::vector<std::pair<std::string, autobahn::wamp_event_handler>> many;
+    many.emplace_back(TOPIC, replacing);
+    many.emplace_back(TOPIC, [&third](const autobahn::wamp_event&) { ++third; });
+    auto subscribed_many = session->subscribe_many(many);
+
+    autobahn::wamp_subscription kept = subscribed.get();
+    autobahn::wamp_subscribe_many_result results = subscribed_many.get();
+    if (results.size() != 2 || !results[0].succeeded() || !results[1].succeeded()) {
+        std::cerr << "subscribe_many() did not join the pending subscription" << std::endl;
+        return 1;
+    }
+    replaced = results[0].value();
+
+    if (subscribes != 1) {
+        std::cerr << subscribes << " SUBSCRIBEs for one topic" << std::endl;
+        ++failures;
+    }
+    if (kept.id() != SUBSCRIPTION_ID || replaced.id() != SUBSCRIPTION_ID
+            || results[1].value().id() != SUBSCRIPTION_ID) {
+        std::cerr << "the local subscribers do not share the router subscription" << std::endl;
+        ++failures;
+    }
+
+    publish(*router);
+    drain(io);
+    if (first != 1 || second != 1 || third != 1 || late != 0) {
+        std::cerr << "the first event reached " << first << ", " << second << ", " << third
+                << " and " << late << " times" << std::endl;
+        ++failures;
+    }
+
+    publish(*router);
+    drain(io);
+    if (first != 2 || second != 1 || third != 2 || late != 1) {
+        std::cerr << "the second event reached " << first << ", " << second << ", " << third
+                << " and " << late << " times" << std::endl;
+        ++failures;
+    }
+
+    // Only the last local handler unsubscribes from the router.
+    session->unsubscribe(kept).get();
+    session->unsubscribe(results[1].value()).get();
+    if (unsubscribes != 0) {
+        std::cerr << "unsubscribed from the router while handlers remain" << std::endl;
+        ++failures;
+    }
+    session->unsubscribe(autobahn::wamp_subscription(SUBSCRIPTION_ID)).get();
+    if (unsubscribes != 1) {
+        std::cerr << unsubscribes << " UNSUBSCRIBEs once all handlers are gone" << std::endl;
+        ++failures;
+    }
+
+    // Batch B joins the pending SUBSCRIBE of batch A, then fails.
+    auto failing_router = std::make_shared<loopback_router>(io, loopback_router::answering(&hold_or_fail));
+    auto failing_session = std::make_shared<autobahn::wamp_session>(io);
+    failing_router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(failing_session));
+    failing_session->start().get();
+    failing_session->join("realm1").get();
+
+    std::atomic<unsigned> in_a(0);
+    std::atomic<unsigned> in_b(0);
+    std::vector<std::pair<std::string, autobahn::wamp_event_handler>> batch_a;
+    batch_a.emplace_back(HELD_TOPIC, [&in_a](const autobahn::wamp_event&) { ++in_a; });
+    auto subscribed_a = failing_session->subscribe_many(batch_a);
+    drain(io);
+
+    std::vector<std::pair<std::string, autobahn::wamp_event_handler>> batch_b;
+    batch_b.emplace_back(HELD_TOPIC, [&in_b](const autobahn::wamp_event&) { ++in_b; });
+    batch_b.emplace_back(FAILING_TOPIC, [&in_b](const autobahn::wamp_event&) { ++in_b; });
+    try {
+        failing_session->subscribe_many(batch_b).get();
+        std::cerr << "a batch that failed to send succeeded" << std::endl;
+        ++failures;
+    } catch (const std::exception&) {
+    }
+
+    run_on_io(io, [&]() {
+        failing_router->acknowledge(autobahn::message_type::SUBSCRIBE, held_request, HELD_SUBSCRIPTION_ID);
+    });
+    autobahn::wamp_subscribe_many_result results_a = subscribed_a.get();
+    if (results_a.size() != 1 || !results_a[0].succeeded()) {
+        std::cerr << "the batch that was joined did not complete" << std::endl;
+        ++failures;
+    }
+
+    publish(*failing_router, HELD_SUBSCRIPTION_ID);
+    drain(io);
+    if (in_a != 1 || in_b != 0) {
+        std::cerr << "the event reached the batches " << in_a << " and " << in_b << " times" << std::endl;
+        ++failures;
+    }
+
+    thread.stop();
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Measures the time from join until all subscriptions are active when
+// subscribing to many topics one by one with subscribe() and at once with
+// subscribe_many(), over a loopback router. Checks that subscribe_many()
+// and provide_many() send their requests in a single write, complete topics
+// already subscribed locally, and report the errors of single items
+// without failing the others.
+
+#include "loopback_router.hpp"
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+static const std::size_t NUM_TOPICS = 10000;
+
+static const std::string DENIED_TOPIC("com.example.denied");
+static const std::string TAKEN_PROCEDURE("com.example.taken");
+
+// Answers an error to the request with the given type and id.
+static void refuse(loopback_router& router, autobahn::message_type type, uint64_t request_id,
+        const std::string& error)
+{
+    router.deliver_made([type, request_id, error]() {
+        // [ERROR, REQUEST.Type|int, REQUEST.Request|id, Details|dict, Error|uri]
+        autobahn::wamp_message refusal(5);
+        refusal.set_field(0, static_cast<int>(autobahn::message_type::ERROR));
+        refusal.set_field(1, static_cast<int>(type));
+        refusal.set_field(2, request_id);
+        refusal.set_field(3, std::map<std::string, int>());
+        refusal.set_field(4, error);
+        return refusal;
+    });
+}
+
+// Answers HELLO, SUBSCRIBE and REGISTER, refusing the denied topic and the
+// taken procedure.
+static void answer(loopback_router& router, autobahn::message_type type, autobahn::wamp_message& request)
+{
+    switch (type) {
+        case autobahn::message_type::SUBSCRIBE:
+        case autobahn::message_type::REGISTER: {
+            // [SUBSCRIBE, Request|id, Options|dict, Topic|uri]
+            // [REGISTER, Request|id, Options|dict, Procedure|uri]
+            uint64_t request_id = request.field<uint64_t>(1);
+            std::string uri = request.field<std::string>(3);
+            if (uri == DENIED_TOPIC) {
+                refuse(router, type, request_id, "wamp.error.not_authorized");
+            } else if (uri == TAKEN_PROCEDURE) {
+                refuse(router, type, request_id, "wamp.error.procedure_already_exists");
+            } else {
+                router.acknowledge(type, request_id, request_id);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    int failures = 0;
+
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    std::vector<std::pair<std::string, autobahn::wamp_event_handler>> subscriptions;
+    subscriptions.reserve(NUM_TOPICS);
+    for (std::size_t i = 0; i < NUM_TOPICS; ++i) {
+        subscriptions.emplace_back("com.example.topic." + std::to_string(i),
+                [](const autobahn::wamp_event&) {});
+    }
+
+    // subscribe()
+    {
+        auto router = std::make_shared<loopback_router>(io, loopback_router::answering(&answer));
+        auto session = std::make_shared<autobahn::wamp_session>(io);
+        router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(session));
+        session->start().get();
+        session->join("realm1").get();
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<boost::future<autobahn::wamp_subscription>> subscribed;
+        subscribed.reserve(NUM_TOPICS);
+        for (const auto& subscription : subscriptions) {
+            subscribed.push_back(session->subscribe(subscription.first, subscription.second));
+        }
+        for (auto& future : subscribed) {
+            future.get();
+        }
+        std::cout << "subscribe():      join to active " << elapsed_ms(start) << " ms" << std::endl;
+    }
+
+    // subscribe_many()
+    auto router = std::make_shared<loopback_router>(io, loopback_router::answering(&answer));
+    auto session = std::make_shared<autobahn::wamp_session>(io);
+    router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(session));
+    session->start().get();
+    session->join("realm1").get();
+    drain(io);
+    std::size_t writes = router->writes();
+
+    auto start = std::chrono::steady_clock::now();
+    autobahn::wamp_subscribe_many_result results = session->subscribe_many(subscriptions).get();
+    std::cout << "subscribe_many(): join to active " << elapsed_ms(start) << " ms" << std::endl;
+
+    std::size_t succeeded = 0;
+    for (const auto& result : results) {
+        succeeded += result.succeeded() ? 1 : 0;
+    }
+    if (results.size() != NUM_TOPICS || succeeded != NUM_TOPICS) {
+        std::cerr << succeeded << " of " << results.size() << " subscriptions succeeded" << std::endl;
+        ++failures;
+    }
+    if (router->writes() != writes + 1) {
+        std::cerr << "the subscriptions took " << router->writes() - writes << " writes" << std::endl;
+        ++failures;
+    }
+
+    // A topic already subscribed is completed without asking the router, a
+    // denied one fails on its own.
+    std::vector<std::pair<std::string, autobahn::wamp_event_handler>> mixed;
+    mixed.emplace_back(subscriptions[0].first, [](const autobahn::wamp_event&) {});
+    mixed.emplace_back(DENIED_TOPIC, [](const autobahn::wamp_event&) {});
+    results = session->subscribe_many(mixed).get();
+    if (results.size() != 2 || !results[0].succeeded() || results[1].succeeded()
+            || results[1].error_uri() != "wamp.error.not_authorized") {
+        std::cerr << "the results of a partly denied subscribe_many() are wrong" << std::endl;
+        ++failures;
+    }
+
+    drain(io);
+    writes = router->writes();
+    std::vector<std::pair<std::string, autobahn::wamp_procedure>> procedures;
+    procedures.emplace_back("com.example.one", [](autobahn::wamp_invocation) {});
+    procedures.emplace_back(TAKEN_PROCEDURE, [](autobahn::wamp_invocation) {});
+    procedures.emplace_back("com.example.two", [](autobahn::wamp_invocation) {});
+    autobahn::wamp_provide_many_result provided = session->provide_many(procedures).get();
+    if (provided.size() != 3 || !provided[0].succeeded() || provided[1].succeeded()
+            || provided[1].error_uri() != "wamp.error.procedure_already_exists"
+            || !provided[2].succeeded()) {
+        std::cerr << "the results of a partly refused provide_many() are wrong" << std::endl;
+        ++failures;
+    }
+    if (router->writes() != writes + 1) {
+        std::cerr << "the registrations took " << router->writes() - writes << " writes" << std::endl;
+        ++failures;
+    }
+
+    thread.stop();
+
+    return failures ? 1 : 0;
+}
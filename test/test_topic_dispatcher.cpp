@@ -0,0 +1,202 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Dispatches hand-made events through a wamp_topic_dispatcher. Checks
+// exact, prefix and wildcard matching, including topics and patterns with
+// empty components, that an event matching several patterns reaches each
+// of their handlers once, and that handlers added or removed while an
+// event is dispatched only take part from the next event on.
+
+#include <autobahn/wamp_event.hpp>
+#include <autobahn/wamp_topic_dispatcher.hpp>
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <msgpack.hpp>
+#include <stdexcept>
+#include <string>
+
+// The number of events each handler was called with, by handler name.
+static std::map<std::string, unsigned> counts;
+
+static autobahn::wamp_event_handler counting(const std::string& name)
+{
+    return [name](const autobahn::wamp_event&) {
+        ++counts[name];
+    };
+}
+
+// Dispatches an event for the topic and returns the counts it added.
+static std::map<std::string, unsigned> dispatch(autobahn::wamp_topic_dispatcher& dispatcher,
+        const std::string& topic)
+{
+    counts.clear();
+    autobahn::wamp_event event{msgpack::zone()};
+    event.set_uri(topic);
+    dispatcher.dispatch(event);
+    return counts;
+}
+
+static bool expect(const std::string& topic, const std::map<std::string, unsigned>& got,
+        const std::map<std::string, unsigned>& expected)
+{
+    if (got == expected) {
+        return true;
+    }
+    std::cerr << topic << " reached";
+    for (const auto& count : got) {
+        std::cerr << " " << count.first << " x" << count.second;
+    }
+    std::cerr << std::endl;
+    return false;
+}
+
+int main()
+{
+    int failures = 0;
+
+    // Matching.
+    {
+        autobahn::wamp_topic_dispatcher dispatcher;
+        dispatcher.add("com.acme.hall.temperature", counting("exact"));
+        dispatcher.add("com..status", counting("empty"));
+        dispatcher.add("com.acme.hall.temp", counting("prefix"), "prefix");
+        dispatcher.add("com.acme.", counting("acme"), "prefix");
+        dispatcher.add("com..temperature", counting("wildcard"), "wildcard");
+        dispatcher.add("com...temperature", counting("deep"), "wildcard");
+        dispatcher.add("com..", counting("any"), "wildcard");
+        dispatcher.add("com.acme..humidity", counting("humidity"), "wildcard");
+
+        // Every pattern matching the topic reaches its handler once.
+        std::string topic = "com.acme.hall.temperature";
+        failures += !expect(topic, dispatch(dispatcher, topic),
+                { { "exact", 1 }, { "prefix", 1 }, { "acme", 1 }, { "deep", 1 } });
+        topic = "com.acme.hall.temperatures";
+        failures += !expect(topic, dispatch(dispatcher, topic), { { "prefix", 1 }, { "acme", 1 } });
+        topic = "com.acme.temperature";
+        failures += !expect(topic, dispatch(dispatcher, topic),
+                { { "acme", 1 }, { "wildcard", 1 }, { "any", 1 } });
+        topic = "com.other.temperature";
+        failures += !expect(topic, dispatch(dispatcher, topic), { { "wildcard", 1 }, { "any", 1 } });
+        topic = "com.temperature";
+        failures += !expect(topic, dispatch(dispatcher, topic), {});
+        topic = "org.acme.hall.temperature";
+        failures += !expect(topic, dispatch(dispatcher, topic), {});
+
+        // Empty components of a topic match empty pattern components, and
+        // the empty components of a wildcard pattern match anything.
+        topic = "com..status";
+        failures += !expect(topic, dispatch(dispatcher, topic), { { "empty", 1 }, { "any", 1 } });
+        topic = "com.acme.status";
+        failures += !expect(topic, dispatch(dispatcher, topic), { { "acme", 1 }, { "any", 1 } });
+        topic = "com..temperature";
+        failures += !expect(topic, dispatch(dispatcher, topic), { { "wildcard", 1 }, { "any", 1 } });
+        topic = "com.acme.";
+        failures += !expect(topic, dispatch(dispatcher, topic), { { "acme", 1 }, { "any", 1 } });
+        topic = "com.acme..humidity";
+        failures += !expect(topic, dispatch(dispatcher, topic), { { "acme", 1 }, { "humidity", 1 } });
+        topic = "com...";
+        failures += !expect(topic, dispatch(dispatcher, topic), {});
+
+        try {
+            dispatcher.add("com.acme", counting("fuzzy"), "fuzzy");
+            std::cerr << "an unknown match policy was accepted" << std::endl;
+            ++failures;
+        } catch (const std::invalid_argument&) {
+        }
+    }
+
+    // Handlers added and removed while an event is dispatched.
+    {
+        autobahn::wamp_topic_dispatcher dispatcher;
+        bool changed = false;
+        uint64_t removed = 0;
+        dispatcher.add("com.acme.update", [&](const autobahn::wamp_event& event) {
+            counting("changing")(event);
+            if (changed) {
+                return;
+            }
+            changed = true;
+
+            dispatcher.add("com.acme.", counting("added"), "prefix");
+            if (!dispatcher.remove(removed) || dispatcher.remove(removed)) {
+                std::cerr << "a handler was not removed exactly once while dispatching" << std::endl;
+                ++failures;
+            }
+            uint64_t transient = dispatcher.add("com.acme.update", counting("transient"));
+            if (!dispatcher.remove(transient)) {
+                std::cerr << "a handler added while dispatching could not be removed" << std::endl;
+                ++failures;
+            }
+            if (dispatcher.size() != 2) {
+                std::cerr << "the size did not count the changes made while dispatching" << std::endl;
+                ++failures;
+            }
+        });
+        removed = dispatcher.add("com.acme.update", counting("removed"));
+
+        std::string topic = "com.acme.update";
+        failures += !expect(topic, dispatch(dispatcher, topic), { { "changing", 1 }, { "removed", 1 } });
+        failures += !expect(topic, dispatch(dispatcher, topic), { { "changing", 1 }, { "added", 1 } });
+
+        // Changes made before a handler throws are applied all the same.
+        dispatcher.add("com.acme.failing", [&](const autobahn::wamp_event&) {
+            dispatcher.add("com.acme.failing", counting("late"));
+            throw std::runtime_error("handler failed");
+        });
+        try {
+            dispatch(dispatcher, "com.acme.failing");
+            std::cerr << "the exception of a handler was swallowed" << std::endl;
+            ++failures;
+        } catch (const std::runtime_error&) {
+        }
+        if (dispatcher.size() != 4) {
+            std::cerr << "a handler added before a handler threw was lost" << std::endl;
+            ++failures;
+        }
+    }
+
+    // The handler of a destroyed dispatcher drops events.
+    {
+        auto dispatcher = std::make_shared<autobahn::wamp_topic_dispatcher>();
+        dispatcher->add("com.acme.update", counting("gone"));
+        autobahn::wamp_event_handler handler = dispatcher->handler();
+        dispatcher.reset();
+
+        counts.clear();
+        autobahn::wamp_event event{msgpack::zone()};
+        event.set_uri("com.acme.update");
+        handler(event);
+        failures += !expect("com.acme.update", counts, {});
+    }
+
+    return failures ? 1 : 0;
+}
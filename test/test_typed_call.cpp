@@ -0,0 +1,163 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Calls procedures provided with a C++ signature through typed_call() over
+// a loopback transport that acts as the router: CALLs come back as
+// INVOCATIONs and YIELDs and ERRORs as RESULTs and ERRORs. Checks that
+// results are decoded into the requested type, that arguments or results of
+// the wrong type fail the call, and that call options reach the router.
+
+#include "loopback_router.hpp"
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+
+static const uint64_t REGISTRATION_ID = 9;
+
+// Answers HELLO and REGISTER, turns CALLs into INVOCATIONs, YIELDs into
+// RESULTs and invocation ERRORs into call ERRORs. Keeps the timeout of the
+// last CALL.
+static loopback_router::reply_function routing_reply(const std::shared_ptr<std::atomic<unsigned>>& timeout)
+{
+    return loopback_router::answering([timeout](loopback_router& router,
+            autobahn::message_type type, autobahn::wamp_message& request) {
+        msgpack::sbuffer reply;
+        msgpack::packer<msgpack::sbuffer> packer(reply);
+        switch (type) {
+            case autobahn::message_type::REGISTER:
+                router.acknowledge(type, request.field<uint64_t>(1), REGISTRATION_ID);
+                return;
+            case autobahn::message_type::CALL:
+                // [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list]
+                // The invocation takes the request id of the call.
+                *timeout = autobahn::value_for_key_or<unsigned>(request.field(2), "timeout", 0);
+                packer.pack_array(5);
+                packer.pack(static_cast<int>(autobahn::message_type::INVOCATION));
+                packer.pack(request.field<uint64_t>(1));
+                packer.pack(REGISTRATION_ID);
+                packer.pack_map(0);
+                loopback_router::write(reply, request.raw_field(4));
+                break;
+            case autobahn::message_type::YIELD:
+                // [YIELD, INVOCATION.Request|id, Options|dict, Arguments|list]
+                packer.pack_array(4);
+                packer.pack(static_cast<int>(autobahn::message_type::RESULT));
+                packer.pack(request.field<uint64_t>(1));
+                packer.pack_map(0);
+                loopback_router::write(reply, request.raw_field(3));
+                break;
+            case autobahn::message_type::ERROR:
+                // [ERROR, INVOCATION, INVOCATION.Request|id, Details|dict, Error|uri]
+                packer.pack_array(5);
+                packer.pack(static_cast<int>(autobahn::message_type::ERROR));
+                packer.pack(static_cast<int>(autobahn::message_type::CALL));
+                packer.pack(request.field<uint64_t>(2));
+                packer.pack_map(0);
+                packer.pack(request.field<std::string>(4));
+                break;
+            default:
+                return;
+        }
+
+        router.deliver(reply);
+    });
+}
+
+template <typename R>
+static bool fails(boost::future<R>&& result)
+{
+    try {
+        result.get();
+        return false;
+    } catch (const std::exception&) {
+        return true;
+    }
+}
+
+int main()
+{
+    int failures = 0;
+
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    auto timeout = std::make_shared<std::atomic<unsigned>>(0);
+    auto router = std::make_shared<loopback_router>(io, routing_reply(timeout));
+    auto session = std::make_shared<autobahn::wamp_session>(io);
+    router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(session));
+    session->start().get();
+    session->join("realm1").get();
+
+    session->provide<uint64_t(uint64_t, uint64_t)>("com.example.add2", std::plus<uint64_t>()).get();
+
+    if (session->typed_call<uint64_t>("com.example.add2", 23, 777).get() != 800) {
+        std::cerr << "result was not decoded" << std::endl;
+        ++failures;
+    }
+
+    if (std::get<0>(session->typed_call<std::tuple<uint64_t>>("com.example.add2", 1, 2).get()) != 3) {
+        std::cerr << "result was not decoded into a tuple" << std::endl;
+        ++failures;
+    }
+
+    session->typed_call<void>("com.example.add2", 1, 2).get();
+
+    if (!fails(session->typed_call<uint64_t>("com.example.add2", std::string("one"), 2))) {
+        std::cerr << "a call with arguments of the wrong type succeeded" << std::endl;
+        ++failures;
+    }
+
+    if (!fails(session->typed_call<std::string>("com.example.add2", 1, 2))) {
+        std::cerr << "a result of the wrong type was decoded" << std::endl;
+        ++failures;
+    }
+
+    // With options
+    autobahn::wamp_call_options options;
+    options.set_timeout(std::chrono::milliseconds(2500));
+    if (session->typed_call<uint64_t>("com.example.add2", std::make_tuple(4, 5), options).get() != 9) {
+        std::cerr << "result of a call with options was not decoded" << std::endl;
+        ++failures;
+    }
+    if (*timeout != 2500) {
+        std::cerr << "the call options did not reach the router" << std::endl;
+        ++failures;
+    }
+
+    thread.stop();
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,218 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) Tavendo GmbH
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Unpacks messages into zones taken from a wamp_zone_pool, both directly
+// and through a joined session over a loopback transport that acts as the
+// router and unpacks into the session's pool. Checks that the pool stops
+// creating zones once warmed up, and that events, call results and
+// invocations hand their zones back when destroyed, also when that happens
+// on another thread than the io thread.
+
+#include "loopback_router.hpp"
+
+#include <boost/asio.hpp>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+static const std::size_t NUM_MESSAGES = 1000;
+static const std::size_t NUM_HELD = 8;
+static const uint64_t SUBSCRIPTION_ID = 7;
+static const uint64_t REGISTRATION_ID = 9;
+
+// [EVENT, SUBSCRIBED.Subscription|id, PUBLISHED.Publication|id, Details|dict, PUBLISH.Arguments|list]
+static msgpack::sbuffer pack_event(uint64_t publication_id)
+{
+    msgpack::sbuffer event;
+    msgpack::packer<msgpack::sbuffer> packer(event);
+    packer.pack_array(5);
+    packer.pack(static_cast<int>(autobahn::message_type::EVENT));
+    packer.pack(SUBSCRIPTION_ID);
+    packer.pack(publication_id);
+    packer.pack_map(0);
+    packer.pack(std::make_tuple(publication_id, std::string(256, 'x')));
+    return event;
+}
+
+// Answers HELLO, SUBSCRIBE and REGISTER, echoes CALLs to com.example.echo
+// as RESULTs and turns all other CALLs into INVOCATIONs and YIELDs into
+// RESULTs.
+static void answer(loopback_router& router, autobahn::message_type type, autobahn::wamp_message& request)
+{
+    msgpack::sbuffer reply;
+    msgpack::packer<msgpack::sbuffer> packer(reply);
+    switch (type) {
+        case autobahn::message_type::SUBSCRIBE:
+            router.acknowledge(type, request.field<uint64_t>(1), SUBSCRIPTION_ID);
+            return;
+        case autobahn::message_type::REGISTER:
+            router.acknowledge(type, request.field<uint64_t>(1), REGISTRATION_ID);
+            return;
+        case autobahn::message_type::CALL:
+            // [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list]
+            if (request.field<std::string>(3) == "com.example.echo") {
+                packer.pack_array(4);
+                packer.pack(static_cast<int>(autobahn::message_type::RESULT));
+                packer.pack(request.field<uint64_t>(1));
+                packer.pack_map(0);
+                loopback_router::write(reply, request.raw_field(4));
+            } else {
+                // The invocation takes the request id of the call.
+                packer.pack_array(5);
+                packer.pack(static_cast<int>(autobahn::message_type::INVOCATION));
+                packer.pack(request.field<uint64_t>(1));
+                packer.pack(REGISTRATION_ID);
+                packer.pack_map(0);
+                loopback_router::write(reply, request.raw_field(4));
+            }
+            break;
+        case autobahn::message_type::YIELD:
+            // [YIELD, INVOCATION.Request|id, Options|dict, Arguments|list]
+            packer.pack_array(4);
+            packer.pack(static_cast<int>(autobahn::message_type::RESULT));
+            packer.pack(request.field<uint64_t>(1));
+            packer.pack_map(0);
+            loopback_router::write(reply, request.raw_field(3));
+            break;
+        default:
+            return;
+    }
+
+    router.deliver(reply);
+}
+
+int main()
+{
+    int failures = 0;
+
+    // Decoding into the pool directly, one event at a time.
+    {
+        auto pool = std::make_shared<autobahn::wamp_zone_pool>(4);
+        msgpack::sbuffer frame = pack_event(1);
+        std::size_t created = 0;
+        for (std::size_t i = 0; i < NUM_MESSAGES; ++i) {
+            autobahn::wamp_message message =
+                    autobahn::wamp_decode_pipeline::decode(frame.data(), frame.size(), pool);
+            autobahn::wamp_event event(std::move(message.zone()), pool);
+            event.set_arguments(message.field(4));
+            if (event.argument<uint64_t>(0) != 1) {
+                std::cerr << "an event decoded into a pooled zone was corrupt" << std::endl;
+                ++failures;
+                break;
+            }
+            if (i == 0) {
+                created = pool->created();
+            }
+        }
+        if (pool->created() != created || pool->size() != 1) {
+            std::cerr << "decoding one event at a time created " << pool->created()
+                      << " zones and left " << pool->size() << " idle" << std::endl;
+            ++failures;
+        }
+    }
+
+    boost::asio::io_service io;
+    io_thread thread(io);
+
+    auto router = std::make_shared<loopback_router>(io, loopback_router::answering(&answer));
+    auto session = std::make_shared<autobahn::wamp_session>(io);
+    router->attach(std::static_pointer_cast<autobahn::wamp_transport_handler>(session));
+    session->start().get();
+    session->join("realm1").get();
+
+    autobahn::wamp_zone_pool& pool = session->zone_pool();
+
+    // Events, destroyed on the io thread once their handler returns.
+    std::size_t events_received = 0;
+    session->subscribe("com.example.tick", [&](const autobahn::wamp_event& event) {
+        events_received += event.argument<uint64_t>(0) != 0;
+    }).get();
+
+    run_on_io(io, [&]() { router->deliver(pack_event(1)); });
+    drain(io);
+    std::size_t created = pool.created();
+    run_on_io(io, [&]() {
+        for (std::size_t i = 1; i <= NUM_MESSAGES; ++i) {
+            router->deliver(pack_event(i));
+        }
+    });
+    drain(io);
+    if (events_received != NUM_MESSAGES + 1 || pool.created() != created) {
+        std::cerr << "delivering " << events_received << " events created "
+                  << pool.created() - created << " zones once warmed up" << std::endl;
+        ++failures;
+    }
+
+    // Call results, held and then destroyed on this thread.
+    for (int round = 0; round < 2; ++round) {
+        std::vector<autobahn::wamp_call_result> results;
+        for (std::size_t i = 0; i < NUM_HELD; ++i) {
+            results.push_back(session->call("com.example.echo", std::make_tuple(i)).get());
+        }
+        if (round == 0) {
+            created = pool.created();
+        }
+        results.clear();
+        if (pool.size() < NUM_HELD) {
+            std::cerr << "only " << pool.size() << " of " << NUM_HELD
+                      << " call results destroyed off the io thread handed their zone back" << std::endl;
+            ++failures;
+        }
+    }
+    if (pool.created() != created) {
+        std::cerr << "holding the same number of call results again created "
+                  << pool.created() - created << " zones" << std::endl;
+        ++failures;
+    }
+
+    // An invocation, released on this thread after it was answered.
+    boost::promise<autobahn::wamp_invocation> invoked;
+    session->provide("com.example.hold", [&invoked](autobahn::wamp_invocation invocation) {
+        invoked.set_value(invocation);
+    }).get();
+
+    std::size_t idle = pool.size();
+    auto pending = session->call("com.example.hold", std::make_tuple(1));
+    autobahn::wamp_invocation invocation = invoked.get_future().get();
+    run_on_io(io, [&]() { invocation->result(std::make_tuple(2)); });
+    pending.get();
+    drain(io);
+    invocation.reset();
+    if (pool.size() != idle || pool.created() != created) {
+        std::cerr << "an invocation released off the io thread did not hand its zone back" << std::endl;
+        ++failures;
+    }
+
+    thread.stop();
+
+    return failures ? 1 : 0;
+}